@@ -0,0 +1,417 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Runs AsyncRegisterAccess against a simulated SPI chip (the reply to a
+// datagram is carried by the next one) and checks that
+// - a polled result that is not fetched does not block further submissions,
+// - requests are transferred in submission order when slots are reused out of order,
+// - a stale handle cannot consume the result of a newer request in the same slot,
+// - the completion callback receives the handle returned on submission.
+// It also runs the UART datagrams against a simulated UART chip and checks the
+// request datagrams (node address, CRC) and that replies with a corrupted CRC,
+// sync nibble, master or register address, and missing replies fail the request.
+
+#include <stdio.h>
+
+#include "tmc/helpers/AsyncRegisterAccess.h"
+#include "tmc/helpers/Macros.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static int32_t registers[128];
+static uint8_t previousAddress = 0;
+static bool transferRunning = false;
+static bool transferFailed  = false;
+
+// UART chip
+#define UART_SYNC    0x05
+#define UART_MASTER  0xFF
+
+typedef enum {
+	UART_REPLY_OK,
+	UART_REPLY_CRC,      // Last byte corrupted
+	UART_REPLY_VALUE,    // Value corrupted after the CRC was calculated
+	UART_REPLY_SYNC,     // The following faults have a valid CRC
+	UART_REPLY_MASTER,
+	UART_REPLY_ADDRESS,
+	UART_REPLY_MISSING,  // Timeout, the transfer fails
+	UART_REPLY_FAULTS
+} UARTReplyFault;
+
+static UARTReplyFault uartFault = UART_REPLY_OK;
+static int uartRequests      = 0;
+static int uartRequestErrors = 0;  // Requests with wrong length, sync, node address or CRC
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+static bool startTransfer(TMCAsyncBus *bus, uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(bus);
+	UNUSED(icID);
+	UNUSED(writeLength);
+	UNUSED(readLength);
+
+	uint8_t address = data[0] & 0x7F;
+	int32_t reply = registers[previousAddress];
+
+	if(data[0] & 0x80)
+		registers[address] = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
+
+	previousAddress = address;
+
+	data[0] = 0;
+	data[1] = 0xFF & (reply >> 24);
+	data[2] = 0xFF & (reply >> 16);
+	data[3] = 0xFF & (reply >> 8);
+	data[4] = 0xFF & (reply);
+
+	transferRunning = true;
+	transferFailed  = false;
+	return true;
+}
+
+// Bitwise CRC8 of the UART datagrams as in the datasheets, independent of the CRC tables
+static uint8_t referenceCRC(const uint8_t *data, size_t bytes)
+{
+	uint8_t crc = 0;
+
+	for(size_t i = 0; i < bytes; i++)
+	{
+		uint8_t byte = data[i];
+		for(int j = 0; j < 8; j++)
+		{
+			crc = ((crc >> 7) ^ (byte & 1)) ? (uint8_t) ((crc << 1) ^ 0x07) : (uint8_t) (crc << 1);
+			byte >>= 1;
+		}
+	}
+
+	return crc;
+}
+
+static uint8_t uartNodeAddress(uint16_t icID)
+{
+	return 0x10 + icID;
+}
+
+static bool startTransferUART(TMCAsyncBus *bus, uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(bus);
+
+	bool isWrite = (data[2] & 0x80) != 0;
+	uint8_t address = data[2] & 0x7F;
+
+	uartRequests++;
+
+	if(writeLength != (isWrite ? 8u : 4u) || readLength != (isWrite ? 0u : 8u)
+	|| data[0] != UART_SYNC || data[1] != uartNodeAddress(icID) || data[writeLength - 1] != referenceCRC(data, writeLength - 1))
+	{
+		uartRequestErrors++;
+	}
+	else if(isWrite)
+	{
+		registers[address] = ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+	}
+	else
+	{
+		int32_t value = registers[address];
+
+		data[0] = UART_SYNC;
+		data[1] = UART_MASTER;
+		data[2] = address;
+		data[3] = 0xFF & (value >> 24);
+		data[4] = 0xFF & (value >> 16);
+		data[5] = 0xFF & (value >> 8);
+		data[6] = 0xFF & (value);
+		data[7] = referenceCRC(data, 7);
+
+		switch(uartFault)
+		{
+		case UART_REPLY_CRC:
+			data[7] ^= 0x01;
+			break;
+		case UART_REPLY_VALUE:
+			data[5] ^= 0x40;
+			break;
+		case UART_REPLY_SYNC:
+			data[0] = 0x0A;
+			break;
+		case UART_REPLY_MASTER:
+			data[1] = uartNodeAddress(icID);
+			break;
+		case UART_REPLY_ADDRESS:
+			data[2] = (address + 1) & 0x7F;
+			break;
+		default:
+			break;
+		}
+
+		if(uartFault >= UART_REPLY_SYNC && uartFault < UART_REPLY_MISSING)
+			data[7] = referenceCRC(data, 7);
+	}
+
+	transferRunning = true;
+	transferFailed  = (uartFault == UART_REPLY_MISSING);
+	return true;
+}
+
+// Completes transfers until the bus is idle, like the DMA interrupt would
+static void runBus(TMCAsyncBus *bus)
+{
+	while(transferRunning)
+	{
+		transferRunning = false;
+		tmc_async_transferComplete(bus, !transferFailed);
+	}
+}
+
+static TMCAsyncHandle callbackHandle;
+static int32_t callbackValue;
+
+static void callback(void *context, TMCAsyncHandle handle, uint8_t address, int32_t value, bool success)
+{
+	UNUSED(context);
+	UNUSED(address);
+	UNUSED(success);
+
+	callbackHandle = handle;
+	callbackValue = value;
+}
+
+static void testUnfetchedResult(void)
+{
+	TMCAsyncBus bus;
+	tmc_async_init(&bus, TMC_ASYNC_BUS_SPI, startTransfer, NULL);
+
+	registers[0x10] = 0x1234;
+
+	// Polled read whose result is never fetched
+	TMCAsyncHandle blocked = tmc_async_readRegister(&bus, 0, 0x10, NULL, NULL);
+	CHECK(blocked != TMC_ASYNC_INVALID_HANDLE);
+	runBus(&bus);
+	CHECK(tmc_async_getStatus(&bus, blocked) == TMC_ASYNC_DONE);
+
+	// All other slots keep working, also after wrapping around the queue several times
+	for(int i = 0; i < 4 * TMC_ASYNC_QUEUE_LENGTH; i++)
+	{
+		TMCAsyncHandle handle = tmc_async_writeRegister(&bus, 0, 0x20, i, NULL, NULL);
+		CHECK(handle != TMC_ASYNC_INVALID_HANDLE);
+		runBus(&bus);
+		CHECK(tmc_async_getResult(&bus, handle, NULL, NULL));
+		CHECK(registers[0x20] == i);
+	}
+
+	// Fill the remaining slots without running the bus: only the unfetched slot is missing
+	for(int i = 0; i < TMC_ASYNC_QUEUE_LENGTH - 1; i++)
+		CHECK(tmc_async_writeRegister(&bus, 0, 0x30 + i, i, callback, NULL) != TMC_ASYNC_INVALID_HANDLE);
+
+	CHECK(tmc_async_writeRegister(&bus, 0, 0x40, 0, callback, NULL) == TMC_ASYNC_INVALID_HANDLE);
+	runBus(&bus);
+
+	int32_t value = 0;
+	bool success = false;
+	CHECK(tmc_async_getResult(&bus, blocked, &value, &success));
+	CHECK(success && value == 0x1234);
+}
+
+static void testSubmissionOrder(void)
+{
+	TMCAsyncBus bus;
+	tmc_async_init(&bus, TMC_ASYNC_BUS_SPI, startTransfer, NULL);
+
+	// Occupy slot 0 with an unfetched result, then free slot 1 again
+	TMCAsyncHandle first = tmc_async_readRegister(&bus, 0, 0x01, NULL, NULL);
+	runBus(&bus);
+	TMCAsyncHandle second = tmc_async_readRegister(&bus, 0, 0x02, NULL, NULL);
+	runBus(&bus);
+	CHECK(tmc_async_getResult(&bus, second, NULL, NULL));
+
+	// The writes are queued into slots 1, 2, ... and must arrive in this order
+	for(int i = 0; i < TMC_ASYNC_QUEUE_LENGTH - 1; i++)
+		CHECK(tmc_async_writeRegister(&bus, 0, 0x50, 100 + i, NULL, NULL) != TMC_ASYNC_INVALID_HANDLE);
+
+	// Releasing slot 0 in between: the next write goes there, but is still transferred last
+	CHECK(tmc_async_getResult(&bus, first, NULL, NULL));
+	CHECK(tmc_async_writeRegister(&bus, 0, 0x50, 999, NULL, NULL) != TMC_ASYNC_INVALID_HANDLE);
+
+	runBus(&bus);
+	CHECK(registers[0x50] == 999);
+}
+
+static void testStaleHandle(void)
+{
+	TMCAsyncBus bus;
+	tmc_async_init(&bus, TMC_ASYNC_BUS_SPI, startTransfer, NULL);
+
+	registers[0x11] = 111;
+	registers[0x22] = 222;
+
+	TMCAsyncHandle old = tmc_async_readRegister(&bus, 0, 0x11, NULL, NULL);
+	runBus(&bus);
+
+	int32_t value = 0;
+	CHECK(tmc_async_getResult(&bus, old, &value, NULL));
+	CHECK(value == 111);
+
+	// The slot is reused for the next request
+	TMCAsyncHandle new = tmc_async_readRegister(&bus, 0, 0x22, NULL, NULL);
+	CHECK(new != old);
+	CHECK(tmc_async_getStatus(&bus, old) == TMC_ASYNC_FREE);
+	runBus(&bus);
+
+	// The stale handle must not consume the newer result
+	CHECK(tmc_async_getStatus(&bus, old) == TMC_ASYNC_FREE);
+	CHECK(!tmc_async_getResult(&bus, old, &value, NULL));
+	CHECK(tmc_async_getStatus(&bus, new) == TMC_ASYNC_DONE);
+	CHECK(tmc_async_getResult(&bus, new, &value, NULL));
+	CHECK(value == 222);
+
+	// Once fetched, the handle is stale as well
+	CHECK(!tmc_async_getResult(&bus, new, &value, NULL));
+}
+
+static void testCallbackHandle(void)
+{
+	TMCAsyncBus bus;
+	tmc_async_init(&bus, TMC_ASYNC_BUS_SPI, startTransfer, NULL);
+
+	registers[0x33] = 333;
+
+	for(int i = 0; i < 3; i++)
+	{
+		callbackHandle = TMC_ASYNC_INVALID_HANDLE;
+		TMCAsyncHandle handle = tmc_async_readRegister(&bus, 0, 0x33, callback, NULL);
+		runBus(&bus);
+		CHECK(callbackHandle == handle);
+		CHECK(callbackValue == 333);
+	}
+}
+
+static void testUART(void)
+{
+	TMCAsyncBus bus;
+	tmc_async_init(&bus, TMC_ASYNC_BUS_UART, startTransferUART, uartNodeAddress);
+
+	uartFault = UART_REPLY_OK;
+	uartRequests = 0;
+	uartRequestErrors = 0;
+
+	// Writes and reads of several chips, the replies are decoded
+	for(uint16_t icID = 0; icID < 3; icID++)
+	{
+		TMCAsyncHandle write = tmc_async_writeRegister(&bus, icID, 0x60 + icID, (int32_t) (0x81234560u + icID), NULL, NULL);
+		runBus(&bus);
+
+		bool success = false;
+		CHECK(tmc_async_getResult(&bus, write, NULL, &success));
+		CHECK(success);
+
+		callbackHandle = TMC_ASYNC_INVALID_HANDLE;
+		callbackValue  = 0;
+		TMCAsyncHandle read = tmc_async_readRegister(&bus, icID, 0x60 + icID, callback, NULL);
+		runBus(&bus);
+		CHECK(callbackHandle == read);
+		CHECK(callbackValue == (int32_t) (0x81234560u + icID));
+	}
+
+	// Every faulty reply fails the read, the bus keeps working afterwards
+	registers[0x70] = 0x00C0FFEE;
+
+	for(int fault = UART_REPLY_CRC; fault < UART_REPLY_FAULTS; fault++)
+	{
+		int32_t value = -1;
+		bool success = true;
+
+		uartFault = (UARTReplyFault) fault;
+		TMCAsyncHandle read = tmc_async_readRegister(&bus, 0, 0x70, NULL, NULL);
+		runBus(&bus);
+		CHECK(tmc_async_getResult(&bus, read, &value, &success));
+		if(success)
+			printf("FAIL: UART reply fault %d not detected\n", fault);
+		CHECK(!success);
+		CHECK(value == 0);
+
+		uartFault = UART_REPLY_OK;
+		read = tmc_async_readRegister(&bus, 0, 0x70, NULL, NULL);
+		runBus(&bus);
+		CHECK(tmc_async_getResult(&bus, read, &value, &success));
+		CHECK(success && value == 0x00C0FFEE);
+	}
+
+	// A write without acknowledgement of the transfer fails as well
+	uartFault = UART_REPLY_MISSING;
+	bool success = true;
+	TMCAsyncHandle write = tmc_async_writeRegister(&bus, 0, 0x71, 1, NULL, NULL);
+	runBus(&bus);
+	CHECK(tmc_async_getResult(&bus, write, NULL, &success));
+	CHECK(!success);
+
+	// Random queued requests with random faults
+	int faults = 0;
+	for(int i = 0; i < 2000; i++)
+	{
+		TMCAsyncHandle handles[TMC_ASYNC_QUEUE_LENGTH];
+		int32_t expected[TMC_ASYNC_QUEUE_LENGTH];
+		int count = randomRange(1, TMC_ASYNC_QUEUE_LENGTH);
+
+		uartFault = (randomRange(0, 3) == 0) ? (UARTReplyFault) randomRange(UART_REPLY_CRC, UART_REPLY_FAULTS - 1) : UART_REPLY_OK;
+		faults += (uartFault != UART_REPLY_OK);
+
+		for(int j = 0; j < count; j++)
+		{
+			uint8_t address = randomRange(0, 0x7F);
+
+			expected[j] = registers[address];
+			handles[j]  = tmc_async_readRegister(&bus, randomRange(0, 3), address, NULL, NULL);
+			CHECK(handles[j] != TMC_ASYNC_INVALID_HANDLE);
+		}
+
+		runBus(&bus);
+
+		for(int j = 0; j < count; j++)
+		{
+			int32_t value = 0;
+
+			CHECK(tmc_async_getResult(&bus, handles[j], &value, &success));
+			CHECK(success == (uartFault == UART_REPLY_OK));
+			CHECK(!success || value == expected[j]);
+		}
+
+		// Change some registers for the next round
+		registers[randomRange(0, 0x7F)] = (int32_t) randomNext();
+	}
+
+	uartFault = UART_REPLY_OK;
+
+	printf("UART: %d requests (%d with faulty replies), %d invalid requests\n", uartRequests, faults, uartRequestErrors);
+	CHECK(uartRequestErrors == 0);
+	CHECK(tmc_async_isIdle(&bus));
+}
+
+int main(void)
+{
+	testUnfetchedResult();
+	testSubmissionOrder();
+	testStaleHandle();
+	testCallbackHandle();
+	testUART();
+
+	printf("%d failures\n", failures);
+	return failures != 0;
+}
@@ -0,0 +1,183 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Runs the TMC5160 driver with bus statistics (TMC5160_BUS_STATISTICS) against a
+// simulated chip (helpers/RegisterSimulator) and checks the recorded transfers,
+// datagrams, bytes, cache hits and misses, latencies and reply errors over SPI
+// and UART, including a UART reply with a corrupted byte.
+
+#include <stdio.h>
+
+#include "tmc/helpers/Macros.h"
+#include "tmc/helpers/RegisterSimulator.h"
+#include "tmc/ic/TMC5160/TMC5160.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static TMC_RegisterSimulator simulator;
+static TMC5160BusType busType = IC_BUS_SPI;
+static bool corruptReply = false;
+static bool dropReply = false;
+
+void tmc5160_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	UNUSED(icID);
+
+	tmc_simulator_readWriteSPI(&simulator, data, dataLength);
+}
+
+bool tmc5160_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(icID);
+
+	if(dropReply)
+		return false;
+
+	bool success = tmc_simulator_readWriteUART(&simulator, data, writeLength, readLength);
+
+	// Flip one data bit of the reply, the CRC no longer matches
+	if(success && corruptReply && readLength == 8)
+		data[5] ^= 0x10;
+
+	return success;
+}
+
+TMC5160BusType tmc5160_getBusType(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return busType;
+}
+
+uint8_t tmc5160_getNodeAddress(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return 0;
+}
+
+// Latencies in ns of simulated bus time
+uint32_t tmc_bus_statistics_getTime(void)
+{
+	return (uint32_t) simulator.busTime;
+}
+
+static TMC_BusStatistics *reset(void)
+{
+	TMC_BusStatistics *statistics = tmc5160_getBusStatistics(0);
+
+	tmc_bus_statistics_reset(statistics);
+	tmc_simulator_resetStatistics(&simulator);
+
+	return statistics;
+}
+
+static void checkSPI(void)
+{
+	TMC_BusStatistics *statistics = reset();
+	busType = IC_BUS_SPI;
+
+	// A read takes two datagrams (request and reply)
+	tmc_simulator_setRegister(&simulator, TMC5160_XACTUAL, 1234);
+	CHECK(tmc5160_readRegister(0, TMC5160_XACTUAL) == 1234);
+	CHECK(statistics->transfers == 2);
+	CHECK(statistics->datagrams == 2);
+	CHECK(statistics->bytesSent == 10 && statistics->bytesReceived == 10);
+	CHECK(statistics->registers[TMC5160_XACTUAL].reads == 2);
+	CHECK(statistics->registers[TMC5160_XACTUAL].cacheMisses == 1);
+	CHECK(statistics->registers[TMC5160_XACTUAL].cacheHits == 0);
+
+	// A write takes one datagram
+	tmc5160_writeRegister(0, TMC5160_XTARGET, 5000);
+	CHECK(statistics->registers[TMC5160_XTARGET].writes == 1);
+	CHECK(statistics->registers[TMC5160_XTARGET].reads == 0);
+	CHECK(statistics->datagrams == 3);
+
+	// Write only registers are read from the cache without a transfer
+	tmc5160_writeRegister(0, TMC5160_IHOLD_IRUN, 0x00061F0A);
+	CHECK(tmc5160_readRegister(0, TMC5160_IHOLD_IRUN) == 0x00061F0A);
+	CHECK(tmc5160_readRegister(0, TMC5160_IHOLD_IRUN) == 0x00061F0A);
+	CHECK(statistics->registers[TMC5160_IHOLD_IRUN].cacheHits == 2);
+	CHECK(statistics->registers[TMC5160_IHOLD_IRUN].reads == 0);
+	CHECK(statistics->datagrams == 4);
+
+	// Read-through registers miss once, then hit
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, true);
+	tmc_simulator_setRegister(&simulator, TMC5160_CHOPCONF, 0x10410153);
+	for(int i = 0; i < 5; i++)
+		CHECK(tmc5160_readRegister(0, TMC5160_CHOPCONF) == 0x10410153);
+	CHECK(statistics->registers[TMC5160_CHOPCONF].cacheMisses == 1);
+	CHECK(statistics->registers[TMC5160_CHOPCONF].cacheHits == 4);
+	CHECK(statistics->registers[TMC5160_CHOPCONF].reads == 2);
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, false);
+
+	// Every SPI transfer took the same simulated time
+	uint32_t latency = (uint32_t) (simulator.busTime / simulator.spiTransfers);
+	uint8_t bin = tmc_bus_statistics_getBin(latency);
+	CHECK(statistics->transfers == simulator.spiTransfers);
+	CHECK(statistics->latencyMax == latency);
+	CHECK(statistics->latencySum == simulator.busTime);
+	CHECK(statistics->latencyHistogram[bin] == statistics->transfers);
+	CHECK(tmc_bus_statistics_getLatencyPercentile(statistics, 50) >= latency);
+	CHECK(statistics->crcErrors == 0 && statistics->replyErrors == 0);
+
+	printf("SPI: %u transfers, %u datagrams, %u bytes sent, latency %u ns (bin %u)\n",
+		statistics->transfers, statistics->datagrams, statistics->bytesSent, latency, bin);
+}
+
+static void checkUART(void)
+{
+	TMC_BusStatistics *statistics = reset();
+	busType = IC_BUS_UART;
+
+	// Request of 4 bytes, reply of 8 bytes in one transfer
+	tmc_simulator_setRegister(&simulator, TMC5160_XACTUAL, -77);
+	CHECK(tmc5160_readRegister(0, TMC5160_XACTUAL) == -77);
+	CHECK(statistics->transfers == 1);
+	CHECK(statistics->bytesSent == 4 && statistics->bytesReceived == 8);
+	CHECK(statistics->registers[TMC5160_XACTUAL].reads == 1);
+
+	tmc5160_writeRegister(0, TMC5160_XTARGET, 1000);
+	CHECK(statistics->registers[TMC5160_XTARGET].writes == 1);
+	CHECK(statistics->bytesSent == 12 && statistics->bytesReceived == 8);
+
+	// Corrupted reply: counted as CRC error, not as missing reply
+	corruptReply = true;
+	CHECK(tmc5160_readRegister(0, TMC5160_XACTUAL) == 0);
+	corruptReply = false;
+	CHECK(statistics->crcErrors == 1);
+	CHECK(statistics->replyErrors == 0);
+
+	// Missing reply
+	dropReply = true;
+	CHECK(tmc5160_readRegister(0, TMC5160_XACTUAL) == 0);
+	dropReply = false;
+	CHECK(statistics->crcErrors == 1);
+	CHECK(statistics->replyErrors == 1);
+	CHECK(statistics->bytesReceived == 16);
+
+	CHECK(tmc5160_readRegister(0, TMC5160_XACTUAL) == -77);
+	CHECK(statistics->registers[TMC5160_XACTUAL].reads == 4);
+	CHECK(statistics->registers[TMC5160_XACTUAL].cacheMisses == 4);
+	CHECK(statistics->transfers == 5);
+
+	printf("UART: %u transfers, %u CRC errors, %u reply errors, max latency %u ns\n",
+		statistics->transfers, statistics->crcErrors, statistics->replyErrors, statistics->latencyMax);
+}
+
+int main(void)
+{
+	tmc_simulator_init(&simulator, tmc5160_registerAccess, tmc5160_sampleRegisterPreset);
+	tmc5160_initCache();
+
+	checkSPI();
+	checkUART();
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
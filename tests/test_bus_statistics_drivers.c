@@ -0,0 +1,366 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Runs one of the TMC2240, TMC2209, TMC7300 and TMC4361A drivers with bus statistics
+// (<IC>_BUS_STATISTICS set to '1' on the command line selects the driver) against a
+// simulated chip (helpers/RegisterSimulator) and checks the recorded transfers,
+// datagrams, bytes, cache hits and misses, latencies and reply errors on the buses
+// the driver supports. test_bus_statistics covers the TMC5160 the same way.
+
+#include <stdio.h>
+
+#include "tmc/helpers/Macros.h"
+#include "tmc/helpers/RegisterSimulator.h"
+
+#if defined(TMC2240_BUS_STATISTICS)
+#include "tmc/ic/TMC2240/TMC2240.h"
+
+#define DRIVER                "TMC2240"
+#define HAS_SPI               1
+#define HAS_UART              1
+#define READ_ONLY_REGISTER    TMC2240_MSCNT
+#define WRITE_REGISTER        TMC2240_GCONF
+#define WRITE_ONLY_REGISTER   TMC2240_MSLUT0
+#define CONFIG_REGISTER       TMC2240_CHOPCONF
+
+#define registerAccess        tmc2240_registerAccess
+#define registerPreset        tmc2240_sampleRegisterPreset
+#define readRegister          tmc2240_readRegister
+#define readRegisters         tmc2240_readRegisters
+#define writeRegister         tmc2240_writeRegister
+#define setCacheReadThrough   tmc2240_setCacheReadThrough
+#define initCache             tmc2240_initCache
+#define getBusStatistics      tmc2240_getBusStatistics
+
+#elif defined(TMC2209_BUS_STATISTICS)
+#include "tmc/ic/TMC2209/TMC2209.h"
+
+#define DRIVER                "TMC2209"
+#define HAS_SPI               0
+#define HAS_UART              1
+#define READ_ONLY_REGISTER    TMC2209_MSCNT
+#define WRITE_REGISTER        TMC2209_GCONF
+#define WRITE_ONLY_REGISTER   TMC2209_IHOLD_IRUN
+#define CONFIG_REGISTER       TMC2209_CHOPCONF
+
+#define registerAccess        tmc2209_registerAccess
+#define registerPreset        tmc2209_sampleRegisterPreset
+#define readRegister          tmc2209_readRegister
+#define writeRegister         tmc2209_writeRegister
+#define setCacheReadThrough   tmc2209_setCacheReadThrough
+#define initCache             tmc2209_initCache
+#define getBusStatistics      tmc2209_getBusStatistics
+
+#elif defined(TMC7300_BUS_STATISTICS)
+#include "tmc/ic/TMC7300/TMC7300.h"
+
+#define DRIVER                "TMC7300"
+#define HAS_SPI               0
+#define HAS_UART              1
+#define READ_ONLY_REGISTER    TMC7300_IOIN
+#define WRITE_REGISTER        TMC7300_GCONF
+#define WRITE_ONLY_REGISTER   TMC7300_PWM_AB
+#define CONFIG_REGISTER       TMC7300_CHOPCONF
+
+#define registerAccess        tmc7300_registerAccess
+#define registerPreset        tmc7300_sampleRegisterPreset
+#define readRegister          tmc7300_readRegister
+#define writeRegister         tmc7300_writeRegister
+#define setCacheReadThrough   tmc7300_setCacheReadThrough
+#define initCache             tmc7300_initCache
+#define getBusStatistics      tmc7300_getBusStatistics
+
+#elif defined(TMC4361A_BUS_STATISTICS)
+#include "tmc/ic/TMC4361A/TMC4361A.h"
+
+#define DRIVER                "TMC4361A"
+#define HAS_SPI               1
+#define HAS_UART              0
+#define READ_ONLY_REGISTER    TMC4361A_VACTUAL
+#define WRITE_REGISTER        TMC4361A_XACTUAL
+#define WRITE_ONLY_REGISTER   TMC4361A_ENC_OUT_RES
+#define CONFIG_REGISTER       TMC4361A_GENERAL_CONF
+
+#define registerAccess        tmc4361A_registerAccess
+#define registerPreset        tmc4361A_sampleRegisterPreset
+#define readRegister          tmc4361A_readRegister
+#define readRegisters         tmc4361A_readRegisters
+#define writeRegister         tmc4361A_writeRegister
+#define setCacheReadThrough   tmc4361A_setCacheReadThrough
+#define initCache             tmc4361A_initCache
+#define getBusStatistics      tmc4361A_getBusStatistics
+
+#else
+#error "Select the driver with -DTMC2240_BUS_STATISTICS=1, -DTMC2209_BUS_STATISTICS=1, -DTMC7300_BUS_STATISTICS=1 or -DTMC4361A_BUS_STATISTICS=1"
+#endif
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define CONFIG_VALUE  0x10410153
+
+static TMC_RegisterSimulator simulator;
+static bool useUART = !HAS_SPI;
+#if HAS_UART
+static bool corruptReply = false;
+static bool corruptAddress = false;
+static bool dropReply = false;
+#endif
+
+/******************************************************************************/
+
+#if HAS_SPI
+static void simulateSPI(uint8_t *data, size_t dataLength)
+{
+	tmc_simulator_readWriteSPI(&simulator, data, dataLength);
+}
+#endif
+
+#if HAS_UART
+static bool simulateUART(uint8_t *data, size_t writeLength, size_t readLength)
+{
+	if(dropReply)
+		return false;
+
+	bool success = tmc_simulator_readWriteUART(&simulator, data, writeLength, readLength);
+
+	if(success && readLength == 8)
+	{
+		// Flip one data bit of the reply, the CRC no longer matches
+		if(corruptReply)
+			data[5] ^= 0x10;
+
+		// Reply of another register, checked before the CRC
+		if(corruptAddress)
+			data[2] ^= 0x01;
+	}
+
+	return success;
+}
+#endif
+
+#if defined(TMC2240_BUS_STATISTICS)
+void tmc2240_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	UNUSED(icID);
+
+	simulateSPI(data, dataLength);
+}
+
+bool tmc2240_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(icID);
+
+	return simulateUART(data, writeLength, readLength);
+}
+
+TMC2240BusType tmc2240_getBusType(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return (useUART) ? IC_BUS_UART : IC_BUS_SPI;
+}
+
+uint8_t tmc2240_getNodeAddress(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return 0;
+}
+#elif defined(TMC2209_BUS_STATISTICS)
+bool tmc2209_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(icID);
+
+	return simulateUART(data, writeLength, readLength);
+}
+
+uint8_t tmc2209_getNodeAddress(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return 0;
+}
+#elif defined(TMC7300_BUS_STATISTICS)
+bool tmc7300_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(icID);
+
+	return simulateUART(data, writeLength, readLength);
+}
+
+uint8_t tmc7300_getNodeAddress(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return 0;
+}
+#elif defined(TMC4361A_BUS_STATISTICS)
+void tmc4361A_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	UNUSED(icID);
+
+	simulateSPI(data, dataLength);
+}
+
+void tmc4361A_setStatus(uint16_t icID, uint8_t *data)
+{
+	UNUSED(icID);
+	UNUSED(data);
+}
+#endif
+
+/******************************************************************************/
+
+// Latencies in ns of simulated bus time
+uint32_t tmc_bus_statistics_getTime(void)
+{
+	return (uint32_t) simulator.busTime;
+}
+
+static TMC_BusStatistics *reset(void)
+{
+	TMC_BusStatistics *statistics = getBusStatistics(0);
+
+	tmc_bus_statistics_reset(statistics);
+	tmc_simulator_resetStatistics(&simulator);
+
+	return statistics;
+}
+
+// Register accesses common to both buses, a read takes [readDatagrams] datagrams
+static void checkRegisters(TMC_BusStatistics *statistics, uint32_t readDatagrams)
+{
+	// Only one statistics block is kept
+	CHECK(getBusStatistics(1) == NULL);
+
+	tmc_simulator_setRegister(&simulator, READ_ONLY_REGISTER, 1234);
+	CHECK(readRegister(0, READ_ONLY_REGISTER) == 1234);
+	CHECK(statistics->datagrams == readDatagrams);
+	CHECK(statistics->registers[READ_ONLY_REGISTER].reads == readDatagrams);
+	CHECK(statistics->registers[READ_ONLY_REGISTER].cacheMisses == 1);
+	CHECK(statistics->registers[READ_ONLY_REGISTER].cacheHits == 0);
+
+	// A write takes one datagram
+	writeRegister(0, WRITE_REGISTER, 5);
+	CHECK(statistics->registers[WRITE_REGISTER].writes == 1);
+	CHECK(statistics->registers[WRITE_REGISTER].reads == 0);
+	CHECK(statistics->datagrams == readDatagrams + 1);
+
+	// Write only registers are read from the cache without a transfer
+	writeRegister(0, WRITE_ONLY_REGISTER, 0x00061F0A);
+	CHECK(readRegister(0, WRITE_ONLY_REGISTER) == 0x00061F0A);
+	CHECK(readRegister(0, WRITE_ONLY_REGISTER) == 0x00061F0A);
+	CHECK(statistics->registers[WRITE_ONLY_REGISTER].cacheHits == 2);
+	CHECK(statistics->registers[WRITE_ONLY_REGISTER].reads == 0);
+	CHECK(statistics->datagrams == readDatagrams + 2);
+
+	// Read-through registers miss once, then hit
+	CHECK(setCacheReadThrough(0, CONFIG_REGISTER, true));
+	tmc_simulator_setRegister(&simulator, CONFIG_REGISTER, CONFIG_VALUE);
+	for(int i = 0; i < 5; i++)
+		CHECK(readRegister(0, CONFIG_REGISTER) == CONFIG_VALUE);
+	CHECK(statistics->registers[CONFIG_REGISTER].cacheMisses == 1);
+	CHECK(statistics->registers[CONFIG_REGISTER].cacheHits == 4);
+	CHECK(statistics->registers[CONFIG_REGISTER].reads == readDatagrams);
+	setCacheReadThrough(0, CONFIG_REGISTER, false);
+}
+
+#if HAS_SPI
+static void checkSPI(void)
+{
+	TMC_BusStatistics *statistics = reset();
+	useUART = false;
+
+	checkRegisters(statistics, 2);
+	CHECK(statistics->bytesSent == statistics->datagrams * 5);
+	CHECK(statistics->bytesReceived == statistics->bytesSent);
+
+	// Pipelined reads: the cached register is skipped, two reads take three transfers
+	uint8_t addresses[] = { READ_ONLY_REGISTER, WRITE_ONLY_REGISTER, READ_ONLY_REGISTER };
+	int32_t values[ARRAY_SIZE(addresses)];
+	uint32_t transfers = statistics->transfers;
+	readRegisters(0, addresses, values, ARRAY_SIZE(addresses));
+	CHECK(values[0] == 1234 && values[1] == 0x00061F0A && values[2] == 1234);
+	CHECK(statistics->transfers == transfers + 3);
+	CHECK(statistics->registers[WRITE_ONLY_REGISTER].cacheHits == 3);
+	CHECK(statistics->registers[READ_ONLY_REGISTER].cacheMisses == 3);
+
+	// Every SPI transfer took the same simulated time
+	uint32_t latency = (uint32_t) (simulator.busTime / simulator.spiTransfers);
+	uint8_t bin = tmc_bus_statistics_getBin(latency);
+	CHECK(statistics->transfers == simulator.spiTransfers);
+	CHECK(statistics->latencyMax == latency);
+	CHECK(statistics->latencySum == simulator.busTime);
+	CHECK(statistics->latencyHistogram[bin] == statistics->transfers);
+	CHECK(statistics->crcErrors == 0 && statistics->replyErrors == 0);
+
+	printf("%s SPI: %u transfers, %u datagrams, %u bytes sent, latency %u ns (bin %u)\n",
+		DRIVER, statistics->transfers, statistics->datagrams, statistics->bytesSent, latency, bin);
+}
+#endif
+
+#if HAS_UART
+static void checkUART(void)
+{
+	TMC_BusStatistics *statistics = reset();
+	useUART = true;
+
+	// Request of 4 bytes, reply of 8 bytes in one transfer
+	checkRegisters(statistics, 1);
+	CHECK(statistics->transfers == 4);
+	CHECK(statistics->bytesSent == 4 + 8 + 8 + 4 && statistics->bytesReceived == 8 + 8);
+	CHECK(statistics->transfers == simulator.uartTransfers);
+	CHECK(statistics->latencySum == simulator.busTime);
+
+	// Corrupted reply: counted as CRC error, not as missing reply
+	corruptReply = true;
+	CHECK(readRegister(0, READ_ONLY_REGISTER) == 0);
+	corruptReply = false;
+	CHECK(statistics->crcErrors == 1);
+	CHECK(statistics->replyErrors == 0);
+
+	// Wrong register address: counted as reply error
+	corruptAddress = true;
+	CHECK(readRegister(0, READ_ONLY_REGISTER) == 0);
+	corruptAddress = false;
+	CHECK(statistics->crcErrors == 1);
+	CHECK(statistics->replyErrors == 1);
+
+	// Missing reply
+	dropReply = true;
+	readRegister(0, READ_ONLY_REGISTER);
+	dropReply = false;
+	CHECK(statistics->crcErrors == 1);
+	CHECK(statistics->replyErrors == 2);
+	CHECK(statistics->bytesReceived == 4 * 8);
+
+	CHECK(readRegister(0, READ_ONLY_REGISTER) == 1234);
+	CHECK(statistics->registers[READ_ONLY_REGISTER].reads == 5);
+	CHECK(statistics->registers[READ_ONLY_REGISTER].cacheMisses == 5);
+	CHECK(statistics->transfers == 8);
+
+	printf("%s UART: %u transfers, %u CRC errors, %u reply errors, max latency %u ns\n",
+		DRIVER, statistics->transfers, statistics->crcErrors, statistics->replyErrors, statistics->latencyMax);
+}
+#endif
+
+int main(void)
+{
+	tmc_simulator_init(&simulator, registerAccess, registerPreset);
+	initCache();
+
+#if HAS_SPI
+	checkSPI();
+#endif
+#if HAS_UART
+	checkUART();
+#endif
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
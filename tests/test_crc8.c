@@ -0,0 +1,120 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Checks tmc_CRC8() against bitwise references for reflected and non-reflected
+// CRCs and measures its throughput. The Makefile builds this test for every
+// TMC_CRC_SLICE_COUNT and with TMC_CRC_FLIPPED_TABLE, so the throughput of the
+// variants can be compared.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "tmc/helpers/CRC.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define POLYNOMIAL  0x07
+
+// 64 KiB plus room for the varying start offset of the benchmark
+static uint8_t buffer[(1 << 16) + 8];
+
+// Reflected CRC as used by the TMC UART datagrams: bytes LSB first, result bit-reversed
+static uint8_t referenceReflected(const uint8_t *data, uint32_t bytes)
+{
+	uint8_t crc = 0;
+
+	for(uint32_t i = 0; i < bytes; i++)
+	{
+		uint8_t byte = data[i];
+		for(int j = 0; j < 8; j++)
+		{
+			if((crc >> 7) ^ (byte & 1))
+				crc = (crc << 1) ^ POLYNOMIAL;
+			else
+				crc <<= 1;
+			byte >>= 1;
+		}
+	}
+
+	return crc;
+}
+
+static uint8_t referenceNonReflected(const uint8_t *data, uint32_t bytes)
+{
+	uint8_t crc = 0;
+
+	for(uint32_t i = 0; i < bytes; i++)
+	{
+		crc ^= data[i];
+		for(int j = 0; j < 8; j++)
+			crc = (crc & 0x80)? (crc << 1) ^ POLYNOMIAL : (crc << 1);
+	}
+
+	return crc;
+}
+
+static void checkEquivalence(void)
+{
+	long mismatches = 0;
+
+	for(int i = 0; i < 200000; i++)
+	{
+		uint32_t offset = rand() % 1000;
+		uint32_t bytes  = rand() % 70;
+
+		if(tmc_CRC8(buffer + offset, bytes, 0) != referenceReflected(buffer + offset, bytes))
+			mismatches++;
+		if(tmc_CRC8(buffer + offset, bytes, 1) != referenceNonReflected(buffer + offset, bytes))
+			mismatches++;
+	}
+
+	CHECK(tmc_CRC8(buffer, sizeof(buffer), 0) == referenceReflected(buffer, sizeof(buffer)));
+	CHECK(tmc_CRC8(buffer, sizeof(buffer), 1) == referenceNonReflected(buffer, sizeof(buffer)));
+
+	printf("400000 random buffers: %ld mismatches\n", mismatches);
+	CHECK(mismatches == 0);
+}
+
+static void benchmark(void)
+{
+	static const uint32_t sizes[] = { 3, 7, 64, 1 << 16 };
+
+	for(size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+	{
+		uint32_t bytes = sizes[i];
+		long iterations = (64L << 20) / bytes;
+		volatile uint8_t sink = 0;
+
+		clock_t start = clock();
+		for(long j = 0; j < iterations; j++)
+			sink ^= tmc_CRC8(buffer + (j & 7), bytes, 0);
+		double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+		printf("%5u bytes: %7.1f MB/s\n", bytes, 64 / seconds);
+	}
+}
+
+int main(void)
+{
+	printf("TMC_CRC_SLICE_COUNT %d, TMC_CRC_FLIPPED_TABLE %d, %u bytes of tables\n",
+		TMC_CRC_SLICE_COUNT, TMC_CRC_FLIPPED_TABLE, tmc_CRC8RAMSize());
+
+	srand(1);
+	for(size_t i = 0; i < sizeof(buffer); i++)
+		buffer[i] = rand();
+
+	CHECK(tmc_fillCRC8Table(POLYNOMIAL, true, 0));
+	CHECK(tmc_fillCRC8Table(POLYNOMIAL, false, 1));
+
+	checkEquivalence();
+	benchmark();
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
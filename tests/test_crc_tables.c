@@ -0,0 +1,256 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Checks the CRC tables generated by helpers/CRCTables.c against the tables the
+// drivers carry themselves. Every driver source tmc/ic/<IC>/<IC>.c is searched for
+// CRC table definitions, each of which has to match the shared table of the same
+// name entry by entry. A change to the table macros thus fails here instead of
+// breaking the CRC of every driver built with TMC_API_EXTERNAL_CRC_TABLE.
+// The UART table is also checked against a bitwise CRC of random datagrams.
+//
+// Usage: test_crc_tables [TMC-API root directory, default ..]
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tmc/helpers/CRCTables.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define MAX_DRIVERS  128
+
+typedef struct
+{
+	const char *name;
+	const uint8_t *table;
+	int drivers;
+} SharedTable;
+
+static SharedTable sharedTables[] =
+{
+	{ "tmcCRCTable_Poly7Reflected",          tmcCRCTable_Poly7Reflected,          0 },
+	{ "tmcCRCTable_Poly100011011Reflected",  tmcCRCTable_Poly100011011Reflected,  0 },
+	{ "tmcCRCTable_Poly110101",              tmcCRCTable_Poly110101,              0 },
+};
+
+#define SHARED_TABLES  (sizeof(sharedTables) / sizeof(sharedTables[0]))
+
+static char *readFile(const char *path)
+{
+	FILE *file = fopen(path, "rb");
+
+	if(!file)
+		return NULL;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *data = malloc(size + 1);
+	size_t read = fread(data, 1, size, file);
+	data[read] = '\0';
+	fclose(file);
+
+	return data;
+}
+
+static SharedTable *findSharedTable(const char *name, size_t length)
+{
+	for(size_t i = 0; i < SHARED_TABLES; i++)
+	{
+		if(strlen(sharedTables[i].name) == length && strncmp(sharedTables[i].name, name, length) == 0)
+			return &sharedTables[i];
+	}
+
+	return NULL;
+}
+
+// Compares the table definitions "tmcCRCTable_<name>[256] = { ... }" of a driver source
+// with the shared tables. Returns the number of tables found.
+static int checkDriver(const char *root, const char *ic)
+{
+	static const char definition[] = "[256] = {";
+	char path[512];
+
+	snprintf(path, sizeof(path), "%s/tmc/ic/%s/%s.c", root, ic, ic);
+
+	char *source = readFile(path);
+	int tables = 0;
+
+	if(!source)
+		return 0;
+
+	for(char *name = strstr(source, "tmcCRCTable_"); name; name = strstr(name + 1, "tmcCRCTable_"))
+	{
+		size_t nameLength = strcspn(name, "[;, ");
+
+		// Skip the extern declarations and the uses of the table
+		if(strncmp(name + nameLength, definition, sizeof(definition) - 1) != 0)
+			continue;
+
+		tables++;
+
+		SharedTable *shared = findSharedTable(name, nameLength);
+		if(!shared)
+		{
+			printf("FAIL %s: %.*s has no shared table in CRCTables.c\n", ic, (int) nameLength, name);
+			failures++;
+			continue;
+		}
+
+		char *entry = name + nameLength + sizeof(definition) - 1;
+		char *end   = strchr(entry, '}');
+		int entries = 0;
+		int differences = 0;
+
+		while(end && (entry = strstr(entry, "0x")) && entry < end)
+		{
+			uint8_t value = strtoul(entry, &entry, 16);
+
+			if(entries < 256 && value != shared->table[entries])
+				differences++;
+
+			entries++;
+		}
+
+		// Missing entries are zero
+		for(int i = entries; i < 256; i++)
+		{
+			if(shared->table[i] != 0)
+				differences++;
+		}
+
+		shared->drivers++;
+
+		printf("%-9s %-36s %3d entries, %3d differences\n", ic, shared->name, entries, differences);
+		CHECK(entries == 256);
+		CHECK(differences == 0);
+	}
+
+	free(source);
+
+	return tables;
+}
+
+static int compareNames(const void *a, const void *b)
+{
+	return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+static void checkDrivers(const char *root)
+{
+	char path[512];
+	char *names[MAX_DRIVERS];
+	int count = 0;
+	int tables = 0;
+
+	snprintf(path, sizeof(path), "%s/tmc/ic", root);
+
+	DIR *directory = opendir(path);
+	CHECK(directory != NULL);
+	if(!directory)
+		return;
+
+	for(struct dirent *entry = readdir(directory); entry && count < MAX_DRIVERS; entry = readdir(directory))
+	{
+		if(entry->d_name[0] != '.')
+			names[count++] = strdup(entry->d_name);
+	}
+	closedir(directory);
+
+	qsort(names, count, sizeof(names[0]), compareNames);
+
+	for(int i = 0; i < count; i++)
+	{
+		tables += checkDriver(root, names[i]);
+		free(names[i]);
+	}
+
+	printf("%d drivers, %d CRC tables\n", count, tables);
+
+	// Every shared table replaces at least one driver table
+	for(size_t i = 0; i < SHARED_TABLES; i++)
+	{
+		if(sharedTables[i].drivers == 0)
+			printf("FAIL %s: no driver uses this table\n", sharedTables[i].name);
+		CHECK(sharedTables[i].drivers > 0);
+	}
+}
+
+// CRC8 of the TMC UART datagrams as described in the datasheets: polynomial 0x07,
+// bytes LSB first
+static uint8_t referenceUART(const uint8_t *data, uint32_t bytes)
+{
+	uint8_t crc = 0;
+
+	for(uint32_t i = 0; i < bytes; i++)
+	{
+		uint8_t byte = data[i];
+		for(int j = 0; j < 8; j++)
+		{
+			if((crc >> 7) ^ (byte & 1))
+				crc = (crc << 1) ^ 0x07;
+			else
+				crc <<= 1;
+			byte >>= 1;
+		}
+	}
+
+	return crc;
+}
+
+// CRC8 as computed by the drivers with the reflected table
+static uint8_t tableUART(const uint8_t *data, uint32_t bytes)
+{
+	uint8_t result = 0;
+
+	while(bytes--)
+		result = tmcCRCTable_Poly7Reflected[result ^ *data++];
+
+	result = ((result >> 1) & 0x55) | ((result & 0x55) << 1);
+	result = ((result >> 2) & 0x33) | ((result & 0x33) << 2);
+	result = ((result >> 4) & 0x0F) | ((result & 0x0F) << 4);
+
+	return result;
+}
+
+static void checkUART(void)
+{
+	uint8_t datagram[8];
+	long mismatches = 0;
+
+	srand(1);
+	for(int i = 0; i < 100000; i++)
+	{
+		uint32_t bytes = 1 + rand() % 7;
+
+		for(uint32_t j = 0; j < bytes; j++)
+			datagram[j] = rand();
+
+		if(tableUART(datagram, bytes) != referenceUART(datagram, bytes))
+			mismatches++;
+	}
+
+	printf("100000 random UART datagrams: %ld mismatches\n", mismatches);
+	CHECK(mismatches == 0);
+}
+
+int main(int argc, char **argv)
+{
+	const char *root = (argc > 1)? argv[1] : "..";
+
+	checkDrivers(root);
+	checkUART();
+
+	CHECK(tmc_CRCTablesFlashSize() == 3 * 256);
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
@@ -0,0 +1,178 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Runs helpers/DaisyChain against a chain of three simulated TMC5130 (see
+// helpers/RegisterSimulator). Checks that the delayed SPI replies are routed to
+// the right chip, including a pending reply of a chip while another chip of the
+// chain is accessed, and that the padding datagrams don't clear the read to clear
+// flags (GSTAT) of the chips that are not accessed.
+
+#include <stdio.h>
+
+#include "tmc/helpers/Constants.h"
+#include "tmc/helpers/DaisyChain.h"
+#include "tmc/helpers/Macros.h"
+#include "tmc/helpers/RegisterSimulator.h"
+#include "tmc/ic/TMC5130/TMC5130.h"
+
+#define CHAIN_LENGTH  3
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static TMC_RegisterSimulator simulators[CHAIN_LENGTH];
+
+// The chain shifts the first datagram of the frame to the last chip, so after the
+// transfer every chip holds the datagram at its position and replies in place.
+void tmc_daisychain_readWriteSPI(uint8_t chain, uint8_t *data, size_t dataLength)
+{
+	UNUSED(chain);
+
+	CHECK(dataLength == CHAIN_LENGTH * TMC_DAISYCHAIN_DATAGRAM_LENGTH);
+
+	for(uint8_t i = 0; i < CHAIN_LENGTH; i++)
+		tmc_simulator_readWriteSPI(&simulators[i], &data[(CHAIN_LENGTH - 1 - i) * TMC_DAISYCHAIN_DATAGRAM_LENGTH], TMC_DAISYCHAIN_DATAGRAM_LENGTH);
+}
+
+bool tmc_daisychain_getChainPosition(uint16_t icID, uint8_t *chain, uint8_t *position)
+{
+	if(icID >= CHAIN_LENGTH)
+		return false;
+
+	*chain = 0;
+	*position = icID;
+
+	return true;
+}
+
+uint8_t tmc_daisychain_getChainLength(uint8_t chain)
+{
+	UNUSED(chain);
+
+	return CHAIN_LENGTH;
+}
+
+// Sends one datagram to [icID] and returns the value of the reply
+static uint32_t transfer(uint16_t icID, uint8_t address, uint32_t value)
+{
+	uint8_t data[5] = { address, 0xFF & (value>>24), 0xFF & (value>>16), 0xFF & (value>>8), 0xFF & value };
+
+	tmc_daisychain_readWriteDatagram(icID, data, sizeof(data));
+
+	return ((uint32_t) data[1] << 24) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 8) | data[4];
+}
+
+// Read request and the datagram fetching its reply
+static uint32_t readRegister(uint16_t icID, uint8_t address)
+{
+	transfer(icID, address, 0);
+
+	return transfer(icID, address, 0);
+}
+
+static void initChain(const uint8_t *registerAccess)
+{
+	for(uint8_t i = 0; i < CHAIN_LENGTH; i++)
+	{
+		tmc_simulator_init(&simulators[i], tmc5130_registerAccess, tmc5130_sampleRegisterPreset);
+		tmc_simulator_setRegister(&simulators[i], TMC5130_XACTUAL, 1000 + i);
+		tmc_simulator_setRegister(&simulators[i], TMC5130_VACTUAL, 2000 + i);
+	}
+
+	tmc_daisychain_setRegisterAccess(0, registerAccess);
+
+	// Bring the padding of every chip to a known state
+	for(uint8_t i = 0; i < CHAIN_LENGTH; i++)
+		readRegister(i, TMC5130_GCONF);
+}
+
+static void testRouting(const uint8_t *registerAccess)
+{
+	initChain(registerAccess);
+
+	for(uint8_t i = 0; i < CHAIN_LENGTH; i++)
+	{
+		CHECK(readRegister(i, TMC5130_XACTUAL) == 1000u + i);
+		CHECK(readRegister(i, TMC5130_VACTUAL) == 2000u + i);
+	}
+
+	// Writes only reach the addressed chip
+	transfer(1, TMC5130_XTARGET | TMC_WRITE_BIT, 12345);
+	for(uint8_t i = 0; i < CHAIN_LENGTH; i++)
+		CHECK(tmc_simulator_getWrittenRegister(&simulators[i], TMC5130_XTARGET) == ((i == 1) ? 12345u : 0u));
+
+	// Pipelined reads of one chip return the reply of the previous request
+	transfer(2, TMC5130_XACTUAL, 0);
+	CHECK(transfer(2, TMC5130_VACTUAL, 0) == 1002);
+	CHECK(transfer(2, TMC5130_GCONF, 0) == 2002);
+
+	// A pending reply survives accesses to the other chips of the chain, as long
+	// as the padding can repeat the read
+	transfer(0, TMC5130_XACTUAL, 0);
+	CHECK(readRegister(1, TMC5130_VACTUAL) == 2001);
+	CHECK(readRegister(2, TMC5130_VACTUAL) == 2002);
+	uint32_t pending = transfer(0, TMC5130_GCONF, 0);
+	if(registerAccess)
+		CHECK(pending == 1000);
+}
+
+static void testFlags(const uint8_t *registerAccess)
+{
+	initChain(registerAccess);
+
+	// Read GSTAT of the outer chips, clearing the reset flag
+	for(uint8_t i = 0; i < CHAIN_LENGTH; i += 2)
+	{
+		CHECK(readRegister(i, TMC5130_GSTAT) & 0x01);
+		CHECK(readRegister(i, TMC5130_GSTAT) == 0);
+	}
+
+	// New flags of the outer chips, while the middle chip is accessed
+	tmc_simulator_setFlags(&simulators[0], TMC5130_GSTAT, 0x02);
+	tmc_simulator_setFlags(&simulators[2], TMC5130_GSTAT, 0x04);
+
+	uint32_t reads0 = simulators[0].readCount[TMC5130_GSTAT];
+	uint32_t reads2 = simulators[2].readCount[TMC5130_GSTAT];
+
+	for(int i = 0; i < 10; i++)
+	{
+		readRegister(1, TMC5130_XACTUAL);
+		transfer(1, TMC5130_XTARGET | TMC_WRITE_BIT, i);
+	}
+
+	// The padding must not have read GSTAT of the outer chips
+	CHECK(simulators[0].readCount[TMC5130_GSTAT] == reads0);
+	CHECK(simulators[2].readCount[TMC5130_GSTAT] == reads2);
+
+	CHECK(readRegister(0, TMC5130_GSTAT) == 0x02);
+	CHECK(readRegister(2, TMC5130_GSTAT) == 0x04);
+
+	// Same after a chain-wide read of GSTAT
+	int32_t values[CHAIN_LENGTH];
+	tmc_daisychain_readRegisterAll(0, TMC5130_GSTAT, values, NULL);
+	CHECK(values[0] == 0 && values[1] == 0x01 && values[2] == 0);
+
+	tmc_simulator_setFlags(&simulators[0], TMC5130_GSTAT, 0x04);
+	tmc_simulator_setFlags(&simulators[2], TMC5130_GSTAT, 0x02);
+	readRegister(1, TMC5130_XACTUAL);
+
+	CHECK(readRegister(0, TMC5130_GSTAT) == 0x04);
+	CHECK(readRegister(2, TMC5130_GSTAT) == 0x02);
+}
+
+int main(void)
+{
+	testRouting(tmc5130_registerAccess);
+	testFlags(tmc5130_registerAccess);
+
+	// Without an access table every padding datagram reads GCONF
+	testRouting(NULL);
+	testFlags(NULL);
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
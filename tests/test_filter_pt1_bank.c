@@ -0,0 +1,104 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Runs the PT1 filter bank (tmc_filterPT1Bank()) on random channels and compares
+// every output and accumulator with tmc_filterPT1() called per channel. The filter
+// constants and inputs are chosen so (newValue - lastValue) << (maxFilter - actualFilter)
+// fits into 32 bit, above that tmc_filterPT1() overflows while the bank shifts in 64 bit.
+//
+// Usage: test_filter_pt1_bank [banks] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tmc/helpers/Functions.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define MAX_CHANNELS  64
+#define MAX_FILTER    16
+#define STEPS         200
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+// Runs one bank of random channels for STEPS inputs, returns the mismatching channel outputs
+static int checkBank(void)
+{
+	int64_t akku[MAX_CHANNELS];
+	int32_t values[MAX_CHANNELS];
+	int32_t newValues[MAX_CHANNELS];
+	uint8_t actualFilter[MAX_CHANNELS];
+	int64_t referenceAkku[MAX_CHANNELS];
+	int32_t referenceValues[MAX_CHANNELS];
+	int32_t inputRange[MAX_CHANNELS];
+	int mismatches = 0;
+
+	uint32_t count = randomRange(1, MAX_CHANNELS);
+	uint8_t maxFilter = randomRange(0, MAX_FILTER);
+
+	for(uint32_t i = 0; i < count; i++)
+	{
+		actualFilter[i] = randomRange(0, maxFilter);
+
+		// Inputs and outputs stay within +-inputRange, their difference shifted
+		// by (maxFilter - actualFilter) stays below 2^31
+		inputRange[i] = (1 << (29 - (maxFilter - actualFilter[i]))) - 1;
+
+		values[i] = referenceValues[i] = randomRange(-inputRange[i], inputRange[i]);
+		akku[i] = referenceAkku[i] = (int64_t) values[i] * (1 << maxFilter);
+	}
+
+	for(int step = 0; step < STEPS; step++)
+	{
+		for(uint32_t i = 0; i < count; i++)
+			newValues[i] = randomRange(-inputRange[i], inputRange[i]);
+
+		tmc_filterPT1Bank(akku, values, newValues, actualFilter, maxFilter, count);
+
+		for(uint32_t i = 0; i < count; i++)
+		{
+			referenceValues[i] = tmc_filterPT1(&referenceAkku[i], newValues[i], referenceValues[i], actualFilter[i], maxFilter);
+
+			if(values[i] != referenceValues[i] || akku[i] != referenceAkku[i])
+			{
+				if(mismatches++ == 0)
+					printf("channel %u of %u, filter %u/%u, step %d: %d (reference %d)\n",
+						i, count, actualFilter[i], maxFilter, step, values[i], referenceValues[i]);
+			}
+		}
+	}
+
+	return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+	int banks = (argc > 1) ? atoi(argv[1]) : 2000;
+	if(argc > 2)
+		randomState = strtoull(argv[2], NULL, 0);
+
+	for(int i = 0; i < banks; i++)
+		CHECK(checkBank() == 0);
+
+	printf("%d banks of up to %d channels, %d steps each\n", banks, MAX_CHANNELS, STEPS);
+
+	printf("%d failures\n", failures);
+	return failures != 0;
+}
@@ -0,0 +1,215 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Checks the integer square roots of helpers/Functions against their definition:
+//   r = tmc_sqrti32(x), tmc_sqrti64(x):  r^2 <= x < (r + 1)^2
+//   r = tmc_rsqrti32(x):                 r^2 * x <= 2^64 < (r + 1)^2 * x  (x > 1)
+// All inputs below 2^24, the ends of every result interval (r^2 - 1, r^2, (r + 1)^2 - 1)
+// and random inputs are checked. Run with the argument "all" to check every 32 bit
+// input of tmc_sqrti32() (takes minutes).
+// Built twice, with and without TMC_SQRTI_HARDWARE_DIVISION.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "tmc/helpers/Functions.h"
+
+static int failures = 0;
+static long errors = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static double now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static void report(const char *name, uint64_t x, uint64_t result)
+{
+	if(errors++ < 10)
+		printf("%s(%llu) = %llu\n", name, (unsigned long long) x, (unsigned long long) result);
+}
+
+static void checkSqrt32(uint32_t x)
+{
+	uint64_t r = tmc_sqrti32(x);
+
+	if(!(r * r <= x && (r + 1) * (r + 1) > x))
+		report("tmc_sqrti32", x, r);
+}
+
+static void checkSqrt64(uint64_t x)
+{
+	unsigned __int128 r = tmc_sqrti64(x);
+
+	if(!(r * r <= x && (r + 1) * (r + 1) > x))
+		report("tmc_sqrti64", x, (uint64_t) r);
+}
+
+static void checkRsqrt32(uint32_t x)
+{
+	if(x <= 1)
+	{
+		if(tmc_rsqrti32(x) != 0xFFFFFFFFu)
+			report("tmc_rsqrti32", x, tmc_rsqrti32(x));
+		return;
+	}
+
+	const unsigned __int128 limit = (unsigned __int128) 1 << 64;
+	unsigned __int128 r = tmc_rsqrti32(x);
+
+	if(!(r * r * x <= limit && (r + 1) * (r + 1) * x > limit))
+		report("tmc_rsqrti32", x, (uint64_t) r);
+}
+
+static void checkSqrti32(bool all)
+{
+	errors = 0;
+
+	if(all)
+	{
+		uint32_t x = 0;
+		do
+			checkSqrt32(x);
+		while(++x != 0);
+	}
+	else
+	{
+		for(uint32_t x = 0; x < ((uint32_t) 1 << 24); x++)
+			checkSqrt32(x);
+
+		for(uint64_t r = 1; r <= 0xFFFF; r++)
+		{
+			checkSqrt32(r * r - 1);
+			checkSqrt32(r * r);
+			checkSqrt32((r + 1) * (r + 1) - 1);
+		}
+		checkSqrt32(0xFFFFFFFFu);
+
+		for(int i = 0; i < 2000000; i++)
+			checkSqrt32(randomNext());
+	}
+
+	printf("tmc_sqrti32: %s, %ld errors\n", all ? "all inputs" : "dense range, interval ends and random inputs", errors);
+	CHECK(errors == 0);
+
+	// tmc_sqrti() is the signed variant
+	CHECK(tmc_sqrti(-1) == -1);
+	CHECK(tmc_sqrti(0x7FFFFFFF) == 46340);
+}
+
+static void checkSqrti64(void)
+{
+	errors = 0;
+
+	for(uint64_t x = 0; x < ((uint64_t) 1 << 20); x++)
+		checkSqrt64(x);
+
+	// Around 2^32, where the 64 bit calculation takes over
+	for(uint64_t x = 0xFFFFFFFFu - (1 << 20); x < 0xFFFFFFFFu + ((uint64_t) 1 << 20); x++)
+		checkSqrt64(x);
+
+	// Interval ends of random and large results, including the largest one
+	for(int i = 0; i < 2000000; i++)
+	{
+		uint64_t r = (i < 200000) ? 0xFFFFFFFFu - (uint32_t) i : (uint32_t) randomNext();
+		if(r == 0)
+			continue;
+
+		checkSqrt64(r * r - 1);
+		checkSqrt64(r * r);
+		checkSqrt64(r * r + 2 * r);
+	}
+	checkSqrt64(UINT64_MAX);
+
+	// Powers of two and random inputs of every size
+	for(int bit = 0; bit < 64; bit++)
+	{
+		checkSqrt64(((uint64_t) 1 << bit) - 1);
+		checkSqrt64((uint64_t) 1 << bit);
+		checkSqrt64(((uint64_t) 1 << bit) + 1);
+	}
+	for(int i = 0; i < 2000000; i++)
+		checkSqrt64(randomNext() >> (randomNext() % 64));
+
+	printf("tmc_sqrti64: %ld errors\n", errors);
+	CHECK(errors == 0);
+}
+
+static void checkRsqrti32(void)
+{
+	errors = 0;
+
+	for(uint32_t x = 0; x < ((uint32_t) 1 << 20); x++)
+		checkRsqrt32(x);
+
+	// The results change at x = 2^64 / r^2: check around these points of small results
+	for(uint64_t r = 1; r <= 0x10000; r++)
+	{
+		uint64_t x = (uint64_t) (((unsigned __int128) 1 << 64) / ((unsigned __int128) r * r));
+		if(x > 0xFFFFFFFFu)
+			continue;
+
+		checkRsqrt32(x - 1);
+		checkRsqrt32(x);
+		if(x < 0xFFFFFFFFu)
+			checkRsqrt32(x + 1);
+	}
+	for(uint32_t x = 0xFFFFFFFFu - (1 << 20); x != 0; x++)
+		checkRsqrt32(x);
+
+	for(int i = 0; i < 2000000; i++)
+		checkRsqrt32(randomNext() >> (randomNext() % 32));
+
+	printf("tmc_rsqrti32: %ld errors\n", errors);
+	CHECK(errors == 0);
+}
+
+static void benchmark(void)
+{
+	const long count = 5000000;
+	volatile uint32_t sink = 0;
+
+	double t0 = now();
+	for(long i = 0; i < count; i++)
+		sink += tmc_sqrti32((uint32_t) i * 2654435761u);
+	double t1 = now();
+	for(long i = 0; i < count; i++)
+		sink += tmc_sqrti64(((uint64_t) i * 2654435761u) << 24);
+	double t2 = now();
+	for(long i = 0; i < count; i++)
+		sink += tmc_rsqrti32((uint32_t) i * 2654435761u);
+	double t3 = now();
+
+	printf("TMC_SQRTI_HARDWARE_DIVISION %d: tmc_sqrti32 %.2f ns, tmc_sqrti64 %.2f ns, tmc_rsqrti32 %.2f ns\n",
+		TMC_SQRTI_HARDWARE_DIVISION, (t1 - t0) / count * 1e9, (t2 - t1) / count * 1e9, (t3 - t2) / count * 1e9);
+}
+
+int main(int argc, char *argv[])
+{
+	bool all = argc > 1 && strcmp(argv[1], "all") == 0;
+
+	checkSqrti32(all);
+	checkSqrti64();
+	checkRsqrti32();
+	benchmark();
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
@@ -0,0 +1,193 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Checks that TMC_LinearRamp64 computes the same ramps as TMC_LinearRamp within
+// the 32 bit range, runs moves beyond it and compares the runtime of both.
+
+#include <stdio.h>
+#include <time.h>
+
+#include "tmc/ramp/LinearRamp1.h"
+#include "tmc/ramp/LinearRamp64.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static double now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+// Runs the 64 bit ramp in position mode until it stands at its target, returns the ticks needed
+static long runToTarget(TMC_LinearRamp64 *ramp)
+{
+	long ticks = 0;
+
+	do
+	{
+		tmc_ramp_linear64_compute(ramp);
+		ticks++;
+	} while(!(ramp->state == TMC_RAMP_LINEAR_STATE_IDLE && ramp->rampPosition == ramp->targetPosition) && ticks < 10000000);
+
+	return ticks;
+}
+
+static void checkEquivalence(void)
+{
+	long mismatches = 0;
+	const int cases = 3000;
+
+	for(int i = 0; i < cases; i++)
+	{
+		TMC_LinearRamp ramp;
+		TMC_LinearRamp64 ramp64;
+		tmc_ramp_linear_init(&ramp);
+		tmc_ramp_linear64_init(&ramp64);
+
+		uint32_t precision = (randomNext() & 1) ? ((uint32_t) 1 << (10 + randomNext() % 10)) : (1000 + randomNext() % 200000);
+		tmc_ramp_linear_set_precision(&ramp, precision);
+		tmc_ramp_linear64_set_precision(&ramp64, precision);
+
+		uint32_t limit = tmc_ramp_linear_get_acceleration_limit(&ramp);
+		int32_t acceleration = 1 + randomNext() % ((limit / 2 < 0x7FFFFFFF) ? limit / 2 : 0x7FFFFFFF);
+		uint32_t maxVelocity = 1 + randomNext() % precision;
+		bool positionMode = randomNext() % 2;
+
+		ramp.acceleration   = ramp64.acceleration   = acceleration;
+		ramp.maxVelocity    = ramp64.maxVelocity    = maxVelocity;
+		ramp.stopVelocity   = ramp64.stopVelocity   = precision / 50;
+		ramp.rampMode       = ramp64.rampMode       = positionMode ? TMC_RAMP_LINEAR_MODE_POSITION : TMC_RAMP_LINEAR_MODE_VELOCITY;
+		ramp.targetPosition = ramp64.targetPosition = (int32_t) (randomNext() % 20000) - 10000;
+		ramp.targetVelocity = ramp64.targetVelocity = (int32_t) (randomNext() % (2 * precision)) - (int32_t) precision;
+
+		for(int tick = 0; tick < 200000; tick++)
+		{
+			// Retarget during the move
+			if(tick == 50000 && positionMode)
+				ramp.targetPosition = ramp64.targetPosition = (int32_t) (randomNext() % 20000) - 10000;
+			if(tick == 60000 && !positionMode)
+				ramp.targetVelocity = ramp64.targetVelocity = (int32_t) (randomNext() % (2 * precision)) - (int32_t) precision;
+
+			int32_t steps   = tmc_ramp_linear_compute(&ramp);
+			int32_t steps64 = tmc_ramp_linear64_compute(&ramp64);
+
+			if(steps != steps64 || ramp.rampPosition != ramp64.rampPosition
+			|| ramp.rampVelocity != ramp64.rampVelocity || ramp.state != ramp64.state)
+			{
+				if(mismatches++ < 5)
+					printf("case %d: precision %u, tick %d\n", i, precision, tick);
+				break;
+			}
+		}
+	}
+
+	printf("%d random ramps against TMC_LinearRamp: %ld mismatches\n", cases, mismatches);
+	CHECK(mismatches == 0);
+}
+
+static void checkLongTravel(void)
+{
+	TMC_LinearRamp64 ramp;
+
+	// Velocity mode past INT32_MAX
+	tmc_ramp_linear64_init(&ramp);
+	ramp.targetVelocity = ramp.precision;
+	ramp.acceleration   = (int64_t) ramp.precision * ramp.precision / 4;
+	ramp.rampPosition   = INT32_MAX - 1000;
+	for(int i = 0; i < 5000; i++)
+		tmc_ramp_linear64_compute(&ramp);
+
+	printf("velocity mode from INT32_MAX - 1000: position %lld after 5000 ticks\n", (long long) ramp.rampPosition);
+	CHECK(ramp.rampPosition > (int64_t) INT32_MAX + 3000);
+	CHECK(ramp.rampVelocity == (int32_t) ramp.precision);
+
+	// Position mode around 2^33
+	tmc_ramp_linear64_init(&ramp);
+	ramp.rampMode       = TMC_RAMP_LINEAR_MODE_POSITION;
+	ramp.rampPosition   = (int64_t) 1 << 33;
+	ramp.targetPosition = ((int64_t) 1 << 33) + 20000;
+	ramp.maxVelocity    = ramp.precision / 2;
+	ramp.acceleration   = (int64_t) ramp.precision * 8;
+
+	long ticks = runToTarget(&ramp);
+	printf("position mode at 2^33: 20000 steps after %ld ticks\n", ticks);
+	CHECK(ramp.rampPosition == ((int64_t) 1 << 33) + 20000);
+
+	// Precision 2^24 with 1/4 step/tick^2, beyond the 32 bit acceleration limit
+	tmc_ramp_linear64_init(&ramp);
+	tmc_ramp_linear64_set_precision(&ramp, (uint32_t) 1 << 24);
+	ramp.rampMode       = TMC_RAMP_LINEAR_MODE_POSITION;
+	ramp.targetPosition = 100000;
+	ramp.maxVelocity    = (uint32_t) 1 << 23;
+	ramp.acceleration   = ((int64_t) 1 << 48) / 4;
+	ramp.stopVelocity   = ramp.precision / 50;
+
+	ticks = runToTarget(&ramp);
+	printf("precision 2^24, acceleration 2^46 (32 bit limit %u): 100000 steps after %ld ticks\n", (0xFFFFFFFFu >> 24) << 24, ticks);
+	CHECK(ramp.rampPosition == 100000);
+}
+
+static void benchmark(uint32_t precision, const char *name)
+{
+	const long count = 20000000;
+	volatile int32_t sink = 0;
+	TMC_LinearRamp ramp;
+	TMC_LinearRamp64 ramp64;
+
+	tmc_ramp_linear_init(&ramp);
+	tmc_ramp_linear64_init(&ramp64);
+	tmc_ramp_linear_set_precision(&ramp, precision);
+	tmc_ramp_linear64_set_precision(&ramp64, precision);
+
+	ramp.rampMode     = ramp64.rampMode     = TMC_RAMP_LINEAR_MODE_POSITION;
+	ramp.maxVelocity  = ramp64.maxVelocity  = precision / 3;
+	ramp.acceleration = ramp64.acceleration = 3000;
+
+	// Moves back and forth between 0 and 100000
+	double t0 = now();
+	for(long i = 0; i < count; i++)
+	{
+		if(ramp.state == TMC_RAMP_LINEAR_STATE_IDLE)
+			ramp.targetPosition = ramp.targetPosition ? 0 : 100000;
+		sink += tmc_ramp_linear_compute(&ramp);
+	}
+
+	double t1 = now();
+	for(long i = 0; i < count; i++)
+	{
+		if(ramp64.state == TMC_RAMP_LINEAR_STATE_IDLE)
+			ramp64.targetPosition = ramp64.targetPosition ? 0 : 100000;
+		sink += tmc_ramp_linear64_compute(&ramp64);
+	}
+	double t2 = now();
+
+	printf("%s precision: 32 bit %.2f ns/tick, 64 bit %.2f ns/tick (%.2fx)\n",
+		name, (t1 - t0) / count * 1e9, (t2 - t1) / count * 1e9, (t2 - t1) / (t1 - t0));
+}
+
+int main(void)
+{
+	checkEquivalence();
+	checkLongTravel();
+	benchmark(100000, "non power of two");
+	benchmark((uint32_t) 1 << 17, "power of two");
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
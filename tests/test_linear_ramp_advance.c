@@ -0,0 +1,184 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Checks that tmc_ramp_linear_advance(n) is identical to n calls of
+// tmc_ramp_linear_compute() for random ramps, covering power of two (shift)
+// and other (division) precisions as well as multi step mode on and off.
+// Afterwards the runtime of both is compared on a long position mode move.
+//
+// Usage: test_linear_ramp_advance [cases] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "tmc/ramp/LinearRamp1.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+static double now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static bool sameState(const TMC_LinearRamp *a, const TMC_LinearRamp *b)
+{
+	return a->rampPosition        == b->rampPosition
+		&& a->rampVelocity        == b->rampVelocity
+		&& a->accumulatorVelocity == b->accumulatorVelocity
+		&& a->accumulatorPosition == b->accumulatorPosition
+		&& a->state               == b->state
+		&& a->accelerationSteps   == b->accelerationSteps;
+}
+
+static void randomRamp(TMC_LinearRamp *ramp)
+{
+	static const uint32_t precisions[] = { (uint32_t) 1 << 17, 1000, (uint32_t) 1 << 10, 1, 7, (uint32_t) 1 << 20, 65536 };
+
+	tmc_ramp_linear_init(ramp);
+
+	uint32_t precision = precisions[randomNext() % 7];
+	if(randomNext() % 4 == 0)
+		ramp->precision = precision;  // Written directly: the stale shift must not be used
+	else
+		tmc_ramp_linear_set_precision(ramp, precision);
+
+	int64_t velocityScale = (int64_t) precision * ((randomNext() % 4 == 0) ? 5 : 1);
+
+	ramp->multiStep           = randomNext() % 2;
+	ramp->acceleration        = randomRange(0, (randomNext() % 3 == 0) ? 2 * (int64_t) precision : (int64_t) precision / 8 + 1);
+	ramp->maxVelocity         = randomRange(0, velocityScale);
+	ramp->rampMode            = randomNext() % 2;
+	ramp->rampEnabled         = randomNext() % 8 != 0;
+	ramp->targetVelocity      = randomRange(-velocityScale, velocityScale);
+	ramp->rampVelocity        = randomRange(-velocityScale, velocityScale);
+	ramp->targetPosition      = randomRange(-100000, 100000);
+	ramp->rampPosition        = randomRange(-1000, 1000);
+	ramp->accumulatorPosition = (precision > 1) ? randomRange(-(int64_t) precision + 1, precision - 1) : 0;
+	ramp->accumulatorVelocity = randomRange(0, precision - 1);
+	ramp->accelerationSteps   = randomRange(-2, 50);
+}
+
+static void checkEquivalence(long cases)
+{
+	uint64_t ticks = 0;
+	long mismatches = 0;
+
+	for(long i = 0; i < cases; i++)
+	{
+		TMC_LinearRamp loop, advance;
+		randomRamp(&loop);
+		advance = loop;
+
+		for(int segment = 0; segment < 6; segment++)
+		{
+			uint32_t n = randomRange(0, (randomNext() % 2) ? 1000 : 400000);
+
+			int32_t loopSteps = 0;
+			for(uint32_t j = 0; j < n; j++)
+				loopSteps += tmc_ramp_linear_compute(&loop);
+			ticks += n;
+
+			int32_t advanceSteps = tmc_ramp_linear_advance(&advance, n);
+
+			if(loopSteps != advanceSteps || !sameState(&loop, &advance))
+			{
+				if(mismatches++ < 5)
+					printf("case %ld segment %d (%u ticks, precision %u, multi step %d): steps %d/%d, position %d/%d, velocity %d/%d\n",
+						i, segment, n, loop.precision, loop.multiStep, loopSteps, advanceSteps,
+						loop.rampPosition, advance.rampPosition, loop.rampVelocity, advance.rampVelocity);
+				break;
+			}
+
+			// Change the targets between the segments
+			if(randomNext() % 2)
+				loop.targetVelocity = advance.targetVelocity = randomRange(-(int64_t) loop.maxVelocity, loop.maxVelocity);
+			if(randomNext() % 2)
+				loop.targetPosition = advance.targetPosition = randomRange(-100000, 100000);
+			if(randomNext() % 4 == 0)
+				loop.rampEnabled = advance.rampEnabled = !loop.rampEnabled;
+		}
+	}
+
+	printf("%ld random ramps, %llu ticks, %ld mismatches\n", cases, (unsigned long long) ticks, mismatches);
+	CHECK(mismatches == 0);
+}
+
+static void benchmarkRamp(TMC_LinearRamp *ramp, uint32_t precision)
+{
+	tmc_ramp_linear_init(ramp);
+	tmc_ramp_linear_set_precision(ramp, precision);
+	ramp->accelerationSteps = 0;
+	ramp->rampMode          = TMC_RAMP_LINEAR_MODE_POSITION;
+	ramp->maxVelocity       = 60000 * (uint64_t) precision / TMC_RAMP_LINEAR_DEFAULT_PRECISION;
+	ramp->acceleration      = 100 * (uint64_t) precision / TMC_RAMP_LINEAR_DEFAULT_PRECISION;
+	ramp->targetPosition    = 400000;
+}
+
+static void benchmark(uint32_t precision)
+{
+	static const uint32_t deltas[] = { 1, 10, 100, 1000, 10000 };
+
+	for(size_t i = 0; i < sizeof(deltas) / sizeof(deltas[0]); i++)
+	{
+		TMC_LinearRamp loop, advance;
+		benchmarkRamp(&loop, precision);
+		benchmarkRamp(&advance, precision);
+
+		long calls = 0;
+		int64_t loopSteps = 0;
+		double t0 = now();
+		while(!(loop.state == TMC_RAMP_LINEAR_STATE_IDLE && loop.rampPosition == loop.targetPosition && loop.rampVelocity == 0))
+		{
+			for(uint32_t j = 0; j < deltas[i]; j++)
+				loopSteps += tmc_ramp_linear_compute(&loop);
+			calls++;
+		}
+
+		double t1 = now();
+		int64_t advanceSteps = 0;
+		for(long j = 0; j < calls; j++)
+			advanceSteps += tmc_ramp_linear_advance(&advance, deltas[i]);
+		double t2 = now();
+
+		printf("precision %7u, %5u ticks per call: %8ld calls, compute loop %7.1f ms, advance %7.1f ms, speedup %6.1fx\n",
+			precision, deltas[i], calls, (t1 - t0) * 1e3, (t2 - t1) * 1e3, (t1 - t0) / (t2 - t1));
+		CHECK(loopSteps == advanceSteps && sameState(&loop, &advance));
+	}
+}
+
+int main(int argc, char **argv)
+{
+	long cases = (argc > 1) ? atol(argv[1]) : 2000;
+	if(argc > 2)
+		randomState = strtoull(argv[2], NULL, 10);
+
+	checkEquivalence(cases);
+	benchmark(TMC_RAMP_LINEAR_DEFAULT_PRECISION);
+	benchmark(100000);
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
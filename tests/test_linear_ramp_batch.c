@@ -0,0 +1,220 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Checks that every axis of TMC_LinearRampBatch computes the same ramp as a
+// TMC_LinearRamp with the same parameters, tick by tick, for position and velocity
+// mode, multi step mode, disabled ramps and both precision variants (shift and
+// division). Compares the runtime of one batch tick against the scalar ramps.
+
+#include <stdio.h>
+#include <time.h>
+
+#include "tmc/ramp/LinearRamp1.h"
+#include "tmc/ramp/LinearRampBatch.h"
+
+#define AXES  TMC_RAMP_LINEAR_BATCH_MAX_AXES
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static double now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static TMC_LinearRampBatch batch;
+static TMC_LinearRamp ramps[AXES];
+
+static void randomTarget(TMC_LinearRamp *ramp)
+{
+	int32_t velocityRange = ramp->multiStep ? 8 * ramp->precision : ramp->precision;
+
+	ramp->targetPosition = (int32_t) (randomNext() % 200000) - 100000;
+	if(ramp->rampMode == TMC_RAMP_LINEAR_MODE_VELOCITY)
+		ramp->targetVelocity = (int32_t) (randomNext() % (2 * velocityRange)) - velocityRange;
+}
+
+// Random ramp parameters for every axis, loaded into the batch and the scalar ramps
+static void setupAxes(uint32_t precision)
+{
+	tmc_ramp_linear_batch_init(&batch, AXES);
+	tmc_ramp_linear_batch_set_precision(&batch, precision);
+
+	for(uint32_t i = 0; i < AXES; i++)
+	{
+		TMC_LinearRamp *ramp = &ramps[i];
+
+		tmc_ramp_linear_init(ramp);
+		tmc_ramp_linear_set_precision(ramp, precision);
+
+		uint32_t limit = tmc_ramp_linear_get_acceleration_limit(ramp);
+		ramp->multiStep      = randomNext() % 2;
+		ramp->rampEnabled    = randomNext() % 8 != 0;
+		ramp->rampMode       = (randomNext() % 2) ? TMC_RAMP_LINEAR_MODE_POSITION : TMC_RAMP_LINEAR_MODE_VELOCITY;
+		ramp->acceleration   = 1 + randomNext() % ((limit / 64 < 0x7FFFFFFF) ? limit / 64 : 0x7FFFFFFF);
+		ramp->maxVelocity    = 1 + randomNext() % (ramp->multiStep ? 8 * precision : precision);
+		ramp->stopVelocity   = precision / 50;
+		ramp->homingDistance = randomNext() % 20;
+		randomTarget(ramp);
+
+		tmc_ramp_linear_batch_load(&batch, i, ramp);
+	}
+}
+
+static bool axisMatches(uint32_t i, int32_t dx)
+{
+	const TMC_LinearRamp *ramp = &ramps[i];
+
+	return batch.dx[i] == dx
+		&& batch.rampPosition[i] == ramp->rampPosition
+		&& batch.rampVelocity[i] == ramp->rampVelocity
+		&& batch.targetVelocity[i] == ramp->targetVelocity
+		&& batch.accumulatorVelocity[i] == ramp->accumulatorVelocity
+		&& batch.accumulatorPosition[i] == ramp->accumulatorPosition
+		&& batch.accelerationSteps[i] == ramp->accelerationSteps
+		&& batch.state[i] == (int32_t) ramp->state;
+}
+
+static void checkEquivalence(bool powerOfTwo)
+{
+	const int batches = 60;
+	const int ticks = 40000;
+	long mismatches = 0;
+	long moves = 0;
+
+	for(int b = 0; b < batches; b++)
+	{
+		uint32_t precision = powerOfTwo ? ((uint32_t) 1 << (10 + randomNext() % 10)) : (1000 + randomNext() % 200000);
+		setupAxes(precision);
+
+		for(int tick = 0; tick < ticks; tick++)
+		{
+			tmc_ramp_linear_batch_compute(&batch);
+
+			for(uint32_t i = 0; i < AXES; i++)
+			{
+				int32_t dx = tmc_ramp_linear_compute(&ramps[i]);
+
+				if(!axisMatches(i, dx))
+				{
+					if(mismatches++ < 5)
+						printf("precision %u, axis %u, multiStep %d, mode %d: mismatch at tick %d\n",
+							precision, i, ramps[i].multiStep, ramps[i].rampMode, tick);
+
+					// Continue with the scalar state
+					tmc_ramp_linear_batch_load(&batch, i, &ramps[i]);
+				}
+
+				// New targets for some axes, on both sides
+				if(randomNext() % 5000 == 0)
+				{
+					randomTarget(&ramps[i]);
+					batch.targetPosition[i] = ramps[i].targetPosition;
+					batch.targetVelocity[i] = ramps[i].targetVelocity;
+					moves++;
+				}
+			}
+		}
+	}
+
+	printf("%s precision: %d batches of %d axes, %d ticks, %ld retargets: %ld mismatches\n",
+		powerOfTwo ? "power of two" : "non power of two", batches, AXES, ticks, moves, mismatches);
+	CHECK(mismatches == 0);
+}
+
+// Loading and storing an axis keeps all of its state
+static void checkLoadStore(void)
+{
+	TMC_LinearRamp ramp;
+	TMC_LinearRamp stored;
+
+	setupAxes((uint32_t) 1 << 16);
+	for(int tick = 0; tick < 1000; tick++)
+		tmc_ramp_linear_batch_compute(&batch);
+
+	for(uint32_t i = 0; i < AXES; i++)
+	{
+		tmc_ramp_linear_init(&stored);
+		tmc_ramp_linear_batch_store(&batch, i, &stored);
+		tmc_ramp_linear_batch_load(&batch, i, &stored);
+
+		tmc_ramp_linear_batch_store(&batch, i, &ramp);
+		CHECK(ramp.multiStep == stored.multiStep);
+		CHECK(ramp.precision == (uint32_t) 1 << 16);
+		CHECK(ramp.rampPosition == stored.rampPosition);
+		CHECK(ramp.accumulatorPosition == stored.accumulatorPosition);
+	}
+}
+
+static void benchmark(uint32_t precision, const char *name)
+{
+	const long count = 200000;
+	volatile int32_t sink = 0;
+
+	setupAxes(precision);
+	for(uint32_t i = 0; i < AXES; i++)
+	{
+		ramps[i].rampEnabled = true;
+		ramps[i].rampMode = TMC_RAMP_LINEAR_MODE_POSITION;
+		tmc_ramp_linear_batch_load(&batch, i, &ramps[i]);
+	}
+
+	// Moves back and forth between the targets
+	double t0 = now();
+	for(long tick = 0; tick < count; tick++)
+	{
+		for(uint32_t i = 0; i < AXES; i++)
+		{
+			if(ramps[i].state == TMC_RAMP_LINEAR_STATE_IDLE)
+				ramps[i].targetPosition = -ramps[i].targetPosition;
+			sink += tmc_ramp_linear_compute(&ramps[i]);
+		}
+	}
+
+	double t1 = now();
+	for(long tick = 0; tick < count; tick++)
+	{
+		for(uint32_t i = 0; i < AXES; i++)
+		{
+			if(batch.state[i] == TMC_RAMP_LINEAR_STATE_IDLE)
+				batch.targetPosition[i] = -batch.targetPosition[i];
+		}
+		tmc_ramp_linear_batch_compute(&batch);
+		sink += batch.dx[0];
+	}
+	double t2 = now();
+
+	double scalar = (t1 - t0) / count / AXES * 1e9;
+	double batched = (t2 - t1) / count / AXES * 1e9;
+	printf("%s precision, %d axes: scalar %.2f ns/axis tick, batch %.2f ns/axis tick (%.2fx)\n",
+		name, AXES, scalar, batched, scalar / batched);
+}
+
+int main(void)
+{
+	checkEquivalence(true);
+	checkEquivalence(false);
+	checkLoadStore();
+
+	benchmark(100000, "non power of two");
+	benchmark((uint32_t) 1 << 17, "power of two");
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
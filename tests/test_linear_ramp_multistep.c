@@ -0,0 +1,326 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Compares the multi step mode of the linear ramp with the single step mode:
+// - Up to one step per tick, both modes move identically in velocity mode. In
+//   position mode both reach the target, multi step mode about as fast.
+// - Above one step per tick, multi step mode keeps every position change in
+//   velocity mode (the single step mode drops them). Position mode moves reach
+//   the target in less than half the ticks of the single step mode in total.
+//   Single short moves can take longer: Multi step mode stops up to the steps of
+//   a tick short of the target and homes from there with the stop velocity.
+// - Position mode moves passing the target or stopping short of it are counted.
+//   With accelerations of up to one step per tick^2 no move passes the target.
+//   Above that, or when started at a velocity too high to brake in time, moves
+//   can pass it.
+// - tmc_ramp_linear_compute_steps() returns the position change of the tick
+//   and ascending step times within the tick.
+//
+// Usage: test_linear_ramp_multistep [cases] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tmc/ramp/LinearRamp1.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+// Upper limit of the ticks of a position mode move
+#define MAX_TICKS  10000000
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+typedef struct
+{
+	bool reached;       // Standing still on the target
+	long ticks;         // Ticks until the target is reached
+	long stopTicks;     // Ticks until the velocity is zero for the first time
+	int32_t stopError;  // Distance to the target at the first stop: > 0 short of it, < 0 beyond it
+	int32_t overshoot;  // Farthest position beyond the target
+} Move;
+
+// Random position mode move with up to one step per tick, or 2 to 16 steps per tick if [fast].
+// The acceleration reaches the maximum velocity within [minTicks] to 2000 ticks.
+static void randomMove(TMC_LinearRamp *ramp, bool fast, uint32_t minTicks)
+{
+	tmc_ramp_linear_init(ramp);
+
+	uint32_t precision = (randomNext() % 2) ? (uint32_t) 1 << randomRange(8, 20) : (uint32_t) randomRange(100, 1000000);
+	tmc_ramp_linear_set_precision(ramp, precision);
+
+	uint32_t maxVelocity = (fast) ? randomRange(2 * (int64_t) precision, 16 * (int64_t) precision) : randomRange(precision / 64 + 1, precision);
+	int64_t acceleration = randomRange((int64_t) maxVelocity * precision / 2000, (int64_t) maxVelocity * precision / minTicks);
+
+	acceleration = MIN(acceleration, (int64_t) tmc_ramp_linear_get_acceleration_limit(ramp));
+
+	ramp->maxVelocity    = maxVelocity;
+	ramp->acceleration   = MAX(1, MIN(acceleration, INT32_MAX));
+	ramp->stopVelocity   = precision / 64 + 1;
+	ramp->rampMode       = TMC_RAMP_LINEAR_MODE_POSITION;
+	ramp->rampPosition   = randomRange(-100000, 100000);
+	ramp->targetPosition = ramp->rampPosition + randomRange(-2000, 2000) * ((fast) ? 16 : 1);
+}
+
+static Move runMove(TMC_LinearRamp ramp)
+{
+	Move move = { false, 0, -1, 0, 0 };
+	int32_t direction = (ramp.targetPosition >= ramp.rampPosition) ? 1 : -1;
+
+	for(long tick = 1; tick <= MAX_TICKS; tick++)
+	{
+		bool moving = ramp.rampVelocity != 0;
+
+		tmc_ramp_linear_compute(&ramp);
+
+		int32_t distance = direction * (ramp.targetPosition - ramp.rampPosition);
+		move.overshoot = MAX(move.overshoot, -distance);
+
+		if(moving && ramp.rampVelocity == 0 && move.stopTicks < 0)
+		{
+			move.stopTicks = tick;
+			move.stopError = distance;
+		}
+
+		if(ramp.state == TMC_RAMP_LINEAR_STATE_IDLE && distance == 0 && ramp.rampVelocity == 0)
+		{
+			move.reached = true;
+			move.ticks = tick;
+			break;
+		}
+	}
+
+	return move;
+}
+
+// Up to one step per tick both modes are identical in velocity mode and reach the target in position mode
+static void checkSlow(long cases)
+{
+	long mismatches = 0;
+	long shortStops[2] = { 0 }, beyondStops[2] = { 0 };
+	int32_t maxShort = 0;
+	int64_t ticks[2] = { 0 };
+
+	for(long i = 0; i < cases; i++)
+	{
+		TMC_LinearRamp single, multi;
+		randomMove(&single, false, 2);
+
+		// Velocity mode with changing target velocities
+		single.rampMode = TMC_RAMP_LINEAR_MODE_VELOCITY;
+		multi = single;
+		multi.multiStep = true;
+
+		for(int tick = 0; tick < 20000; tick++)
+		{
+			if(tick % 2000 == 0)
+				single.targetVelocity = multi.targetVelocity = randomRange(-(int64_t) single.maxVelocity, single.maxVelocity);
+
+			tmc_ramp_linear_compute(&single);
+			tmc_ramp_linear_compute(&multi);
+
+			if(single.rampPosition != multi.rampPosition || single.rampVelocity != multi.rampVelocity
+			|| single.accumulatorPosition != multi.accumulatorPosition)
+			{
+				mismatches++;
+				break;
+			}
+		}
+
+		// Position mode
+		randomMove(&single, false, 2);
+		multi = single;
+		multi.multiStep = true;
+
+		Move moves[2] = { runMove(single), runMove(multi) };
+
+		for(int mode = 0; mode < 2; mode++)
+		{
+			CHECK(moves[mode].reached);
+			shortStops[mode]  += moves[mode].stopError > 0;
+			beyondStops[mode] += moves[mode].stopError < 0;
+			ticks[mode]       += moves[mode].stopTicks;
+		}
+
+		maxShort = MAX(maxShort, moves[1].stopError);
+		CHECK(moves[1].overshoot == 0);
+		// Short moves may brake a few ticks earlier
+		CHECK(moves[1].stopTicks <= moves[0].stopTicks + moves[0].stopTicks / 4 + 10);
+	}
+
+	printf("up to one step per tick: %ld velocity mode mismatches\n", mismatches);
+	printf("  first stop short of the target / beyond it: single step %ld / %ld, multi step %ld / %ld (at most %d steps short)\n",
+			shortStops[0], beyondStops[0], shortStops[1], beyondStops[1], maxShort);
+	printf("  ticks until the first stop: single step %lld, multi step %lld\n", (long long) ticks[0], (long long) ticks[1]);
+
+	CHECK(mismatches == 0);
+	CHECK(maxShort <= 2);
+	CHECK(ticks[1] <= ticks[0] + ticks[0] / 100);
+}
+
+// Above one step per tick, with an acceleration of up to one step per tick^2 ([minTicks] = 16)
+// or more ([minTicks] = 2)
+static void checkFast(long cases, uint32_t minTicks)
+{
+	long lostPositions = 0;
+	long shortStops = 0, beyondStops = 0, overshoots = 0, slowerMoves = 0;
+	int32_t maxShort = 0, maxOvershoot = 0;
+	int64_t ticks[2] = { 0 };
+
+	for(long i = 0; i < cases; i++)
+	{
+		TMC_LinearRamp single, multi;
+		randomMove(&single, true, minTicks);
+
+		if(minTicks > 2)
+			single.acceleration = MIN((uint64_t) single.acceleration, (uint64_t) single.precision * single.precision);
+
+		// Velocity mode: Multi step mode moves by the sum of the velocities
+		single.rampMode = TMC_RAMP_LINEAR_MODE_VELOCITY;
+		single.targetVelocity = (randomNext() % 2) ? (int32_t) single.maxVelocity : -(int32_t) single.maxVelocity;
+		multi = single;
+		multi.multiStep = true;
+
+		int64_t start = (int64_t) multi.rampPosition * multi.precision;
+		int64_t sum = 0;
+		for(int tick = 0; tick < 5000; tick++)
+		{
+			tmc_ramp_linear_compute(&single);
+			tmc_ramp_linear_compute(&multi);
+			sum += multi.rampVelocity;
+		}
+
+		CHECK((int64_t) multi.rampPosition * multi.precision + multi.accumulatorPosition == start + sum);
+		lostPositions += llabs((int64_t) multi.rampPosition - single.rampPosition);
+
+		// Position mode
+		randomMove(&single, true, minTicks);
+		if(minTicks > 2)
+			single.acceleration = MIN((uint64_t) single.acceleration, (uint64_t) single.precision * single.precision);
+
+		multi = single;
+		multi.multiStep = true;
+
+		Move moves[2] = { runMove(single), runMove(multi) };
+
+		CHECK(moves[0].reached);
+		CHECK(moves[1].reached);
+		// Stopping short by up to the steps of a tick at maximum velocity
+		CHECK(moves[1].stopError <= (int32_t) (multi.maxVelocity / multi.precision) + 2);
+
+		slowerMoves += moves[1].ticks > moves[0].ticks;
+		shortStops  += moves[1].stopError > 0;
+		beyondStops += moves[1].stopError < 0;
+		overshoots  += moves[1].overshoot > 0;
+		maxShort     = MAX(maxShort, moves[1].stopError);
+		maxOvershoot = MAX(maxOvershoot, moves[1].overshoot);
+		ticks[0]    += moves[0].ticks;
+		ticks[1]    += moves[1].ticks;
+	}
+
+	printf("above one step per tick, acceleration %s one step per tick^2:\n", (minTicks > 2) ? "up to" : "above");
+	printf("  velocity mode: single step mode dropped %ld positions\n", lostPositions);
+	printf("  position mode: first stop short of the target %ld (at most %d steps), beyond it %ld; passed the target %ld (at most %d steps)\n",
+			shortStops, maxShort, beyondStops, overshoots, maxOvershoot);
+	printf("  ticks until the target is reached: single step %lld, multi step %lld (slower on %ld short moves)\n",
+			(long long) ticks[0], (long long) ticks[1], slowerMoves);
+
+	CHECK(lostPositions > 0);
+	CHECK(ticks[1] < ticks[0] / 2);
+	if(minTicks > 2)
+		CHECK(overshoots == 0);
+}
+
+// Moves started at a random velocity towards the target: The target is reached, passing it if the velocity
+// is too high to brake in time
+static void checkMovingStart(long cases)
+{
+	long overshoots = 0;
+	int32_t maxOvershoot = 0;
+
+	for(long i = 0; i < cases; i++)
+	{
+		TMC_LinearRamp ramp;
+		randomMove(&ramp, true, 16);
+		ramp.multiStep = true;
+		ramp.rampVelocity = randomRange(0, ramp.maxVelocity);
+		if(ramp.targetPosition < ramp.rampPosition)
+			ramp.rampVelocity = -ramp.rampVelocity;
+
+		Move move = runMove(ramp);
+
+		CHECK(move.reached);
+		overshoots  += move.overshoot > 0;
+		maxOvershoot = MAX(maxOvershoot, move.overshoot);
+	}
+
+	printf("moves started at a random velocity: %ld of %ld passed the target (at most %d steps)\n", overshoots, cases, maxOvershoot);
+}
+
+// tmc_ramp_linear_compute_steps(): Step count and step times of every tick
+static void checkComputeSteps(long cases)
+{
+	static uint32_t stepTimes[64];
+	long ticks = 0, steps = 0;
+
+	for(long i = 0; i < cases; i++)
+	{
+		TMC_LinearRamp ramp;
+		randomMove(&ramp, randomNext() % 2, 16);
+		ramp.multiStep = randomNext() % 2;
+
+		for(int tick = 0; tick < 5000; tick++)
+		{
+			int32_t position = ramp.rampPosition;
+			int32_t count = tmc_ramp_linear_compute_steps(&ramp, stepTimes, 64);
+
+			CHECK(count == ramp.rampPosition - position);
+			CHECK(ramp.multiStep || abs(count) <= 1);
+
+			for(int32_t k = 0; k < MIN(abs(count), 64); k++)
+			{
+				CHECK(stepTimes[k] >= 1 && stepTimes[k] <= TMC_RAMP_LINEAR_TICK_FRACTION);
+				CHECK(k == 0 || stepTimes[k] >= stepTimes[k-1]);
+			}
+
+			ticks++;
+			steps += abs(count);
+		}
+	}
+
+	printf("tmc_ramp_linear_compute_steps: %ld ticks, %ld steps\n", ticks, steps);
+}
+
+int main(int argc, char **argv)
+{
+	long cases = (argc > 1) ? atol(argv[1]) : 200;
+
+	if(argc > 2)
+		randomState = strtoull(argv[2], NULL, 0);
+
+	checkSlow(cases);
+	checkFast(cases, 16);
+	checkFast(cases, 2);
+	checkMovingStart(cases);
+	checkComputeSteps(cases / 4 + 1);
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
@@ -0,0 +1,139 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Checks that the shift path of tmc_ramp_linear_compute() (power of two
+// precision) gives the same results as the division path for random ramps with
+// precisions from 2^0 to 2^30, then compares the runtime of both paths.
+//
+// Usage: test_linear_ramp_shift [cases]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "tmc/ramp/LinearRamp1.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+static double now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static bool sameState(const TMC_LinearRamp *a, const TMC_LinearRamp *b)
+{
+	return a->rampPosition        == b->rampPosition
+		&& a->rampVelocity        == b->rampVelocity
+		&& a->accumulatorVelocity == b->accumulatorVelocity
+		&& a->accumulatorPosition == b->accumulatorPosition
+		&& a->state               == b->state
+		&& a->accelerationSteps   == b->accelerationSteps;
+}
+
+static void checkEquivalence(long cases)
+{
+	long ticks = 0;
+	long mismatches = 0;
+
+	for(long i = 0; i < cases; i++)
+	{
+		uint32_t precision = (uint32_t) 1 << randomRange(0, 30);
+		int64_t velocityScale = (int64_t) precision * 2;
+		if(velocityScale > 0x3FFFFFFF)
+			velocityScale = 0x3FFFFFFF;
+
+		TMC_LinearRamp shift;
+		tmc_ramp_linear_init(&shift);
+		tmc_ramp_linear_set_precision(&shift, precision);
+
+		shift.accelerationSteps   = 0;
+		shift.acceleration        = randomRange(0, (precision / 2 + 1 > 0x3FFFFFFF)? 0x3FFFFFFF : precision / 2 + 1);
+		shift.maxVelocity         = randomRange(0, velocityScale);
+		shift.rampMode            = randomNext() % 2;
+		shift.rampEnabled         = randomNext() % 8 != 0;
+		shift.targetVelocity      = randomRange(-velocityScale, velocityScale);
+		shift.rampVelocity        = randomRange(-velocityScale, velocityScale);
+		shift.targetPosition      = randomRange(-20000, 20000);
+		shift.accumulatorPosition = (precision > 1) ? randomRange(-(int64_t) precision + 1, precision - 1) : 0;
+		shift.accumulatorVelocity = randomRange(0, precision - 1);
+
+		// Same ramp, forced onto the division path
+		TMC_LinearRamp divide = shift;
+		divide.precisionShift = -1;
+
+		for(int tick = 0; tick < 100000; tick++)
+		{
+			int32_t shiftSteps  = tmc_ramp_linear_compute(&shift);
+			int32_t divideSteps = tmc_ramp_linear_compute(&divide);
+			ticks++;
+
+			if(shiftSteps != divideSteps || !sameState(&shift, &divide))
+			{
+				if(mismatches++ < 5)
+					printf("case %ld: precision %u, tick %d\n", i, precision, tick);
+				break;
+			}
+
+			if(tick % 20000 == 0)
+				shift.targetPosition = divide.targetPosition = randomRange(-20000, 20000);
+		}
+	}
+
+	printf("shift vs division: %ld ticks, %ld mismatches\n", ticks, mismatches);
+	CHECK(mismatches == 0);
+}
+
+static void benchmark(bool useShift)
+{
+	const long count = 10000000;
+	volatile int32_t sink = 0;
+	TMC_LinearRamp ramp;
+
+	tmc_ramp_linear_init(&ramp);
+	if(!useShift)
+		ramp.precisionShift = -1;
+
+	ramp.accelerationSteps = 0;
+	ramp.rampMode          = TMC_RAMP_LINEAR_MODE_VELOCITY;
+	ramp.acceleration      = 5000;
+	ramp.targetVelocity    = 100000;
+
+	double start = now();
+	for(long i = 0; i < count; i++)
+		sink += tmc_ramp_linear_compute(&ramp);
+	double seconds = now() - start;
+
+	printf("%s: %.2f ns per tmc_ramp_linear_compute()\n", useShift ? "shift   " : "division", seconds * 1e9 / count);
+}
+
+int main(int argc, char **argv)
+{
+	checkEquivalence((argc > 1) ? atol(argv[1]) : 3000);
+	benchmark(false);
+	benchmark(true);
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
@@ -0,0 +1,218 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Drives a linear ramp through random waypoint paths with the motion planner
+// (tmc_motion_planner_compute()) and checks that every waypoint is passed with
+// at most its junction velocity, that reversals and the last waypoint are real
+// stops and that the final position is reached. Afterwards the time of each
+// path is compared to stopping at every waypoint.
+//
+// Usage: test_motion_planner [paths] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tmc/ramp/MotionPlanner.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define WAYPOINTS  40
+#define MAX_TICKS  50000000
+
+typedef struct
+{
+	int32_t position[WAYPOINTS];
+	uint32_t maxVelocity[WAYPOINTS];
+	uint32_t acceleration;
+	bool multiStep;
+} Path;
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+static void randomPath(Path *path, bool multiStep, bool reversals)
+{
+	uint32_t maxVelocity = (multiStep) ? 8 * TMC_RAMP_LINEAR_DEFAULT_PRECISION : TMC_RAMP_LINEAR_DEFAULT_PRECISION;
+	int32_t position = 0;
+	int32_t direction = 1;
+
+	for(int i = 0; i < WAYPOINTS; i++)
+	{
+		if(reversals && randomRange(0, 3) == 0)
+			direction = -direction;
+
+		position += direction * (int32_t) randomRange(20, (multiStep) ? 20000 : 2000);
+		path->position[i]    = position;
+		path->maxVelocity[i] = randomRange(maxVelocity / 16, maxVelocity);
+	}
+
+	path->acceleration = randomRange(1 << 20, 1 << 26);
+	path->multiStep = multiStep;
+}
+
+static int32_t getDirection(const Path *path, int index)
+{
+	int32_t start = (index == 0) ? 0 : path->position[index - 1];
+
+	return (path->position[index] > start) ? 1 : -1;
+}
+
+// Reversals and the last waypoint have to be passed standing still
+static bool isStop(const Path *path, int index)
+{
+	return index == WAYPOINTS - 1 || getDirection(path, index) != getDirection(path, index + 1);
+}
+
+static void initRamp(TMC_LinearRamp *ramp, const Path *path)
+{
+	tmc_ramp_linear_init(ramp);
+	tmc_ramp_linear_set_mode(ramp, TMC_RAMP_LINEAR_MODE_POSITION);
+	tmc_ramp_linear_set_acceleration(ramp, path->acceleration);
+	tmc_ramp_linear_set_multiStep(ramp, path->multiStep);
+}
+
+// Planned junction velocity of waypoint [index], [added] waypoints have been queued so far
+static uint32_t getJunctionVelocity(TMC_MotionPlanner *planner, int added, int index)
+{
+	int first = added - planner->count;
+
+	if(index < first || index >= added)
+		return 0;
+
+	return planner->segments[(planner->first + index - first) % TMC_MOTION_PLANNER_QUEUE_LENGTH].junctionVelocity;
+}
+
+// Drives the path with the motion planner and returns the ticks it took
+static long driveBlended(const Path *path)
+{
+	TMC_LinearRamp ramp;
+	TMC_MotionPlanner planner;
+	int added = 0;
+	int next = 0;   // Next waypoint to pass
+	bool passedFast = false;
+	bool passedStop = false;
+	bool reversed = false;
+
+	initRamp(&ramp, path);
+	tmc_motion_planner_init(&planner, 0, path->acceleration, TMC_MOTION_PLANNER_LINEAR_RAMP_DISTANCE_SHIFT);
+
+	// The velocity limit is computed at the start of a tick, the ramp may exceed it by one velocity step
+	uint32_t tolerance = path->acceleration / TMC_RAMP_LINEAR_DEFAULT_PRECISION + 1;
+
+	long tick;
+	for(tick = 0; tick < MAX_TICKS && next < WAYPOINTS; tick++)
+	{
+		while(added < WAYPOINTS && !tmc_motion_planner_isFull(&planner))
+		{
+			tmc_motion_planner_addSegment(&planner, path->position[added], path->maxVelocity[added]);
+			added++;
+		}
+
+		uint32_t junctionVelocity = getJunctionVelocity(&planner, added, next);
+
+		tmc_motion_planner_compute(&planner, &ramp);
+
+		int32_t direction = getDirection(path, next);
+		int32_t past = direction * (ramp.rampPosition - path->position[next]);
+
+		if(direction * ramp.rampVelocity < 0)
+			reversed = true;
+
+		if(isStop(path, next))
+		{
+			if(past > 0)
+				passedStop = true;
+
+			if(past == 0 && ramp.rampVelocity == 0 && ramp.state == TMC_RAMP_LINEAR_STATE_IDLE)
+				next++;
+		}
+		else if(past >= 0)
+		{
+			if((uint32_t) abs(ramp.rampVelocity) > junctionVelocity + tolerance)
+				passedFast = true;
+
+			next++;
+		}
+	}
+
+	CHECK(next == WAYPOINTS);
+	CHECK(!passedFast);
+	CHECK(!passedStop);
+	CHECK(!reversed);
+	CHECK(ramp.rampPosition == path->position[WAYPOINTS - 1]);
+
+	return tick;
+}
+
+// Drives to every waypoint on its own, standing still at each one, and returns the ticks it took
+static long driveStopping(const Path *path)
+{
+	TMC_LinearRamp ramp;
+	long tick = 0;
+
+	initRamp(&ramp, path);
+
+	for(int i = 0; i < WAYPOINTS; i++)
+	{
+		tmc_ramp_linear_set_targetPosition(&ramp, path->position[i]);
+		tmc_ramp_linear_set_maxVelocity(&ramp, path->maxVelocity[i]);
+
+		do {
+			tmc_ramp_linear_compute(&ramp);
+			tick++;
+		} while(tick < MAX_TICKS && (ramp.state != TMC_RAMP_LINEAR_STATE_IDLE || ramp.rampPosition != path->position[i]));
+	}
+
+	CHECK(ramp.rampPosition == path->position[WAYPOINTS - 1]);
+
+	return tick;
+}
+
+int main(int argc, char **argv)
+{
+	int paths = (argc > 1) ? atoi(argv[1]) : 20;
+	if(argc > 2)
+		randomState = strtoull(argv[2], NULL, 0);
+
+	for(int scenario = 0; scenario < 4; scenario++)
+	{
+		bool multiStep = scenario >= 2;
+		bool reversals = scenario & 1;
+		long blendedTicks = 0;
+		long stoppingTicks = 0;
+
+		for(int i = 0; i < paths; i++)
+		{
+			Path path;
+			randomPath(&path, multiStep, reversals);
+
+			blendedTicks  += driveBlended(&path);
+			stoppingTicks += driveStopping(&path);
+		}
+
+		CHECK(blendedTicks < stoppingTicks);
+
+		printf("%s step, %s: %d paths of %d waypoints, %ld ticks blended, %ld ticks stopping at each waypoint, %.2fx faster\n",
+			multiStep ? "multi" : "single", reversals ? "with reversals" : "one direction",
+			paths, WAYPOINTS, blendedTicks, stoppingTicks, (double) stoppingTicks / blendedTicks);
+	}
+
+	printf("%d failures\n", failures);
+	return failures != 0;
+}
@@ -0,0 +1,78 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Checks the flag register handling of helpers/RegisterSimulator with the
+// TMC5130 register table, which has read to clear (0x21) flag registers.
+
+#include <stdio.h>
+
+#include "tmc/helpers/RegisterSimulator.h"
+#include "tmc/ic/TMC5130/TMC5130.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static TMC_RegisterSimulator simulator;
+
+// Sends one SPI read datagram and returns the status byte of the reply
+static uint8_t readSPI(uint8_t address, uint32_t *value)
+{
+	uint8_t data[5] = { address, 0, 0, 0, 0 };
+
+	tmc_simulator_readWriteSPI(&simulator, data, sizeof(data));
+	*value = ((uint32_t) data[1] << 24) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 8) | data[4];
+
+	return data[0];
+}
+
+int main(void)
+{
+	uint32_t value;
+	uint8_t status;
+
+	tmc_simulator_init(&simulator, tmc5130_registerAccess, tmc5130_sampleRegisterPreset);
+
+	// GSTAT: the reset flag is reported once, then cleared by the read
+	readSPI(TMC5130_GSTAT, &value);
+	status = readSPI(TMC5130_GCONF, &value);
+	CHECK(value == 1);
+	CHECK((status & 0x03) == 0);
+	readSPI(TMC5130_GCONF, &value);
+	CHECK(value == 0);
+	CHECK(tmc_simulator_getRegister(&simulator, TMC5130_GSTAT) == 0);
+
+	// The status byte shows the GSTAT bits until GSTAT is read
+	tmc_simulator_setFlags(&simulator, TMC5130_GSTAT, 0x02);
+	status = readSPI(TMC5130_XACTUAL, &value);
+	CHECK((status & 0x03) == 0x02);
+	status = readSPI(TMC5130_XACTUAL, &value);
+	CHECK((status & 0x03) == 0x02);
+
+	// RAMPSTAT and ENC_STATUS are cleared by every read as well
+	tmc_simulator_setFlags(&simulator, TMC5130_RAMPSTAT, 0x80);
+	tmc_simulator_setFlags(&simulator, TMC5130_ENC_STATUS, 0x01);
+	readSPI(TMC5130_RAMPSTAT, &value);
+	readSPI(TMC5130_ENC_STATUS, &value);
+	CHECK(value & 0x80);
+	readSPI(TMC5130_RAMPSTAT, &value);
+	CHECK(value == 0x01);
+	readSPI(TMC5130_ENC_STATUS, &value);
+	CHECK((value & 0x80) == 0);
+	readSPI(TMC5130_GCONF, &value);
+	CHECK(value == 0);
+
+	// Plain read registers keep their value
+	tmc_simulator_setRegister(&simulator, TMC5130_XACTUAL, 1234);
+	readSPI(TMC5130_XACTUAL, &value);
+	readSPI(TMC5130_XACTUAL, &value);
+	CHECK(value == 1234);
+	readSPI(TMC5130_XACTUAL, &value);
+	CHECK(value == 1234);
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
@@ -0,0 +1,172 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Drives random position mode moves with the S-curve ramp and checks that each
+// move ends at the target position without ever passing it and without
+// reversing the direction of movement. A move from standstill has to take a
+// single ramp, and braking has to come to a halt exactly at the target.
+// Moves whose target position changes while driving have to end at the new
+// target position.
+//
+// Usage: test_scurve_ramp [moves, default 300] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tmc/ramp/SCurveRamp.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+#define MAX_TICKS  10000000
+
+static void setRandomParameters(TMC_SCurveRamp *ramp)
+{
+	tmc_ramp_scurve_init(ramp);
+	tmc_ramp_scurve_set_mode(ramp, TMC_RAMP_SCURVE_MODE_POSITION);
+
+	// 1/2 to 4 positions per tick, a quarter of the moves without jerk limit
+	tmc_ramp_scurve_set_maxVelocity(ramp, randomRange(ramp->precision / 2, 4 * ramp->precision));
+	tmc_ramp_scurve_set_acceleration(ramp, randomRange(2000, 20000));
+	tmc_ramp_scurve_set_jerk(ramp, (randomRange(0, 3) == 0) ? 0 : randomRange(20000, 200000));
+}
+
+static void checkMoves(int moves)
+{
+	long ticks = 0;
+
+	for(int i = 0; i < moves; i++)
+	{
+		TMC_SCurveRamp ramp;
+		setRandomParameters(&ramp);
+
+		int32_t target = randomRange(1, 20000) * ((randomRange(0, 1) == 0) ? 1 : -1);
+		int32_t direction = (target >= 0) ? 1 : -1;
+
+		tmc_ramp_scurve_set_targetPosition(&ramp, target);
+
+		int32_t overshoot = 0;
+		int32_t shortfall = 0;
+		bool reversed = false;
+		bool stopped = false;
+		bool done = false;
+		int ramps = 0;
+		TMC_SCurveRamp_State previousState = ramp.state;
+
+		for(long tick = 0; tick < MAX_TICKS; tick++)
+		{
+			tmc_ramp_scurve_compute(&ramp);
+			ticks++;
+
+			int32_t past = direction * (ramp.rampPosition - target);
+			overshoot = MAX(overshoot, past);
+
+			if(direction * ramp.rampVelocity < 0)
+				reversed = true;
+
+			if(ramp.state == TMC_RAMP_SCURVE_STATE_DRIVING && previousState != TMC_RAMP_SCURVE_STATE_DRIVING)
+				ramps++;
+
+			previousState = ramp.state;
+
+			// Distance still missing when the first braking phase came to a halt
+			if(!stopped && ramp.state == TMC_RAMP_SCURVE_STATE_BRAKING && ramp.rampVelocity == 0)
+			{
+				stopped = true;
+				shortfall = -past;
+			}
+
+			if(ramp.state == TMC_RAMP_SCURVE_STATE_IDLE && ramp.rampPosition == target && ramp.rampVelocity == 0)
+			{
+				done = true;
+				break;
+			}
+		}
+
+		if(!done || overshoot > 0 || reversed || ramps != 1 || shortfall != 0)
+		{
+			printf("move %d: vmax %u A %d J %d target %d: end position %d, overshoot %d, %d ramps, %d short%s\n",
+				i, ramp.maxVelocity, ramp.acceleration, ramp.jerk, target, ramp.rampPosition, overshoot, ramps, shortfall, reversed ? ", reversed" : "");
+		}
+
+		CHECK(done);
+		CHECK(overshoot == 0);
+		CHECK(!reversed);
+		CHECK(ramps == 1);
+		CHECK(shortfall == 0);
+	}
+
+	printf("%d moves in %ld ticks\n", moves, ticks);
+}
+
+// Changes the target position at a random tick of the move. The ramp has to plan
+// the move anew from its current motion and end at the new target position.
+static void checkRetargets(int moves)
+{
+	for(int i = 0; i < moves; i++)
+	{
+		TMC_SCurveRamp ramp;
+		setRandomParameters(&ramp);
+
+		int32_t target = randomRange(-20000, 20000);
+		long change = randomRange(1, 200000);
+		bool done = false;
+
+		tmc_ramp_scurve_set_targetPosition(&ramp, randomRange(-20000, 20000));
+
+		for(long tick = 0; tick < MAX_TICKS; tick++)
+		{
+			if(tick == change)
+				tmc_ramp_scurve_set_targetPosition(&ramp, target);
+
+			tmc_ramp_scurve_compute(&ramp);
+
+			if(tick >= change && ramp.state == TMC_RAMP_SCURVE_STATE_IDLE && ramp.rampPosition == target && ramp.rampVelocity == 0)
+			{
+				done = true;
+				break;
+			}
+		}
+
+		if(!done)
+		{
+			printf("retarget %d: vmax %u A %d J %d target %d: end position %d, velocity %d\n",
+				i, ramp.maxVelocity, ramp.acceleration, ramp.jerk, target, ramp.rampPosition, ramp.rampVelocity);
+		}
+
+		CHECK(done);
+	}
+
+	printf("%d moves with a changed target position\n", moves);
+}
+
+int main(int argc, char **argv)
+{
+	int moves = (argc > 1) ? atoi(argv[1]) : 300;
+	if(argc > 2)
+		randomState = strtoull(argv[2], NULL, 0);
+
+	checkMoves(moves);
+	checkRetargets(moves / 3);
+
+	printf("%d failures\n", failures);
+	return failures != 0;
+}
@@ -0,0 +1,175 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Compares the step intervals queued by ramp/StepTiming against the analytic
+// trapezoid of a position mode move and checks that ticks with more steps than
+// the queue length are queued completely.
+
+#include <stdio.h>
+#include <math.h>
+
+#include "tmc/ramp/StepTiming.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static TMC_StepTiming stepTiming;
+
+static void initRamp(TMC_LinearRamp *ramp, double acceleration, double maxVelocity, int32_t target, bool multiStep)
+{
+	tmc_ramp_linear_init(ramp);
+
+	if(acceleration * 131072.0 * 131072.0 > 2e9)
+		tmc_ramp_linear_set_precision(ramp, 1 << 14);
+
+	double precision = ramp->precision;
+
+	ramp->stopVelocity    = precision / 20;
+	ramp->multiStep       = multiStep;
+	ramp->rampMode        = TMC_RAMP_LINEAR_MODE_POSITION;
+	ramp->acceleration    = (int32_t) (acceleration * precision * precision);
+	ramp->maxVelocity     = (uint32_t) (maxVelocity * precision);
+	ramp->targetPosition  = target;
+}
+
+// Acceleration and velocity in steps per ramp tick (squared)
+static void checkTrapezoid(double acceleration, double maxVelocity, int32_t target, uint32_t timerTicksPerRampTick, bool multiStep)
+{
+	TMC_LinearRamp ramp;
+	initRamp(&ramp, acceleration, maxVelocity, target, multiStep);
+	tmc_step_timing_init(&stepTiming, timerTicksPerRampTick);
+
+	// Quantized ramp parameters
+	double precision = ramp.precision;
+	acceleration = ramp.acceleration / (precision * precision);
+	maxVelocity  = ramp.maxVelocity / precision;
+
+	double accelerationTime = maxVelocity / acceleration;
+	double accelerationSteps = 0.5 * acceleration * accelerationTime * accelerationTime;
+	if(2 * accelerationSteps > target)
+	{
+		accelerationSteps = target / 2.0;
+		accelerationTime  = sqrt(2 * accelerationSteps / acceleration);
+		maxVelocity       = acceleration * accelerationTime;
+	}
+	double totalTime = 2 * accelerationTime + (target - 2 * accelerationSteps) / maxVelocity;
+
+	int64_t position = 0;
+	uint64_t time = 0;
+	double maxError = 0;
+	double sumError = 0;
+	long count = 0;
+	long ticks = 0;
+	int32_t interval;
+	bool directionValid = true;
+
+	while(ticks < 10000000)
+	{
+		ticks += tmc_step_timing_fill(&stepTiming, &ramp, 50);
+
+		while(tmc_step_timing_pop(&stepTiming, &interval))
+		{
+			directionValid &= interval > 0;
+			time += interval;
+			position++;
+
+			double n = position;
+			double t;
+			if(n <= accelerationSteps)
+				t = sqrt(2 * n / acceleration);
+			else if(n <= target - accelerationSteps)
+				t = accelerationTime + (n - accelerationSteps) / maxVelocity;
+			else
+				t = totalTime - sqrt(2 * (target - n) / acceleration);
+
+			// Skip the braking phase: Its final approach is driven by a short second ramp
+			// after an undershoot of up to one tick of steps
+			if(n <= target - accelerationSteps)
+			{
+				double error = fabs(time / (double) timerTicksPerRampTick - t);
+				sumError += error;
+				count++;
+				if(error > maxError)
+					maxError = error;
+			}
+		}
+
+		if(ramp.state == TMC_RAMP_LINEAR_STATE_IDLE && ramp.rampPosition == target && ramp.rampVelocity == 0)
+			break;
+	}
+
+	printf("a=%.4g v=%.4g target=%d multiStep=%d: %lld steps, step time error max %.2f mean %.3f ramp ticks\n",
+		acceleration, maxVelocity, target, multiStep, (long long) position, maxError, sumError / count);
+
+	CHECK(directionValid);
+	CHECK(position == target);
+	CHECK(tmc_step_timing_getPendingSteps(&stepTiming) == 0);
+	CHECK(maxError < 1.0);
+	CHECK(sumError / count < 0.6);
+}
+
+// A consumer that only pops a few steps per call: The fill has to wait for the queue
+// instead of dropping steps, even for ticks close to or above the queue length.
+static void checkSlowConsumer(double maxVelocity)
+{
+	TMC_LinearRamp ramp;
+	initRamp(&ramp, 5, maxVelocity, 200000, true);
+	tmc_step_timing_init(&stepTiming, 1000);
+
+	int64_t position = 0;
+	int32_t interval;
+	uint32_t maxPending = 0;
+	bool monotonic = true;
+
+	for(long i = 0; i < 10000000; i++)
+	{
+		tmc_step_timing_fill(&stepTiming, &ramp, 1);
+
+		for(int j = 0; j < 37 && tmc_step_timing_pop(&stepTiming, &interval); j++)
+		{
+			monotonic &= interval > 0;
+			position += (interval > 0) ? 1 : -1;
+		}
+
+		// The motor position lags behind the ramp by the queued and pending steps
+		CHECK(position + tmc_step_timing_getCount(&stepTiming) + tmc_step_timing_getPendingSteps(&stepTiming) == ramp.rampPosition);
+		maxPending = MAX(maxPending, tmc_step_timing_getPendingSteps(&stepTiming));
+
+		if(ramp.state == TMC_RAMP_LINEAR_STATE_IDLE && ramp.rampPosition == 200000 && ramp.rampVelocity == 0
+				&& tmc_step_timing_getCount(&stepTiming) == 0 && tmc_step_timing_getPendingSteps(&stepTiming) == 0)
+			break;
+	}
+
+	printf("v=%.0f steps/tick, slow consumer: %lld steps queued, up to %u pending\n", maxVelocity, (long long) position, maxPending);
+
+	CHECK(ramp.rampPosition == 200000);
+	CHECK(position == 200000);
+	CHECK(monotonic);
+
+	// More steps per tick than the queue holds are queued with the next fills
+	if(maxVelocity > TMC_STEP_TIMING_QUEUE_LENGTH)
+		CHECK(maxPending > 0);
+	else
+		CHECK(maxPending == 0);
+}
+
+int main(void)
+{
+	checkTrapezoid(0.05, 100, 500000, 1000, true);
+	checkTrapezoid(0.001, 0.5, 20000, 1000, false);
+	checkTrapezoid(0.001, 0.9, 20000, 1000, true);
+	checkTrapezoid(0.2, 30, 1000, 10000, true);
+	checkTrapezoid(2, 250, 300000, 1000, true);
+
+	checkSlowConsumer(250);
+	checkSlowConsumer(TMC_STEP_TIMING_QUEUE_LENGTH);
+	checkSlowConsumer(400);
+	checkSlowConsumer(3 * TMC_STEP_TIMING_QUEUE_LENGTH + 17);
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
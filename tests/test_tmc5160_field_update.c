@@ -0,0 +1,159 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Runs the coalesced field updates (tmc5160_fieldBegin(), tmc5160_fieldSet(),
+// tmc5160_fieldCommit()) against a simulated chip (helpers/RegisterSimulator)
+// and checks the SPI transfers they cost with and without the read-through cache.
+
+#include <stdio.h>
+
+#include "tmc/helpers/Macros.h"
+#include "tmc/helpers/RegisterSimulator.h"
+#include "tmc/ic/TMC5160/TMC5160.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define CHOPCONF_VALUE  0x10410153
+
+static TMC_RegisterSimulator simulator;
+
+void tmc5160_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	UNUSED(icID);
+
+	tmc_simulator_readWriteSPI(&simulator, data, dataLength);
+}
+
+bool tmc5160_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(icID);
+
+	return tmc_simulator_readWriteUART(&simulator, data, writeLength, readLength);
+}
+
+TMC5160BusType tmc5160_getBusType(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return IC_BUS_SPI;
+}
+
+uint8_t tmc5160_getNodeAddress(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return 0;
+}
+
+// Sets three CHOPCONF fields and commits them, returns the SPI transfers this took
+static uint32_t updateChopconf(uint32_t toff, uint32_t tbl, uint32_t mres)
+{
+	tmc_simulator_resetStatistics(&simulator);
+
+	TMC5160FieldUpdate update = tmc5160_fieldBegin(0, TMC5160_CHOPCONF);
+	CHECK(tmc5160_fieldSet(&update, TMC5160_TOFF_FIELD, toff));
+	CHECK(tmc5160_fieldSet(&update, TMC5160_TBL_FIELD, tbl));
+	CHECK(tmc5160_fieldSet(&update, TMC5160_MRES_FIELD, mres));
+	tmc5160_fieldCommit(&update);
+
+	uint32_t expected = CHOPCONF_VALUE;
+	expected = tmc5160_fieldUpdate(expected, TMC5160_TOFF_FIELD, toff);
+	expected = tmc5160_fieldUpdate(expected, TMC5160_TBL_FIELD, tbl);
+	expected = tmc5160_fieldUpdate(expected, TMC5160_MRES_FIELD, mres);
+	CHECK(tmc_simulator_getRegister(&simulator, TMC5160_CHOPCONF) == expected);
+	CHECK(simulator.writeCount[TMC5160_CHOPCONF] == 1);
+
+	// Restore the value the next update starts from
+	tmc_simulator_setRegister(&simulator, TMC5160_CHOPCONF, CHOPCONF_VALUE);
+
+	return simulator.spiTransfers;
+}
+
+static void checkWithoutReadThrough(void)
+{
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, false);
+	tmc_simulator_setRegister(&simulator, TMC5160_CHOPCONF, CHOPCONF_VALUE);
+
+	// One register read (2 transfers) and one write
+	CHECK(updateChopconf(3, 2, 4) == 2 + 1);
+	CHECK(updateChopconf(5, 1, 0) == 2 + 1);
+}
+
+static void checkWithReadThrough(void)
+{
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, true);
+	tmc_simulator_setRegister(&simulator, TMC5160_CHOPCONF, CHOPCONF_VALUE);
+
+	// The first access reads the register into the shadow copy
+	CHECK(updateChopconf(3, 2, 4) == 2 + 1);
+
+	// Afterwards the value comes from the shadow copy: only the write is left
+	tmc5160_writeRegister(0, TMC5160_CHOPCONF, CHOPCONF_VALUE);
+	CHECK(updateChopconf(4, 0, 8) == 1);
+	tmc5160_writeRegister(0, TMC5160_CHOPCONF, CHOPCONF_VALUE);
+	CHECK(updateChopconf(2, 3, 1) == 1);
+
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, false);
+}
+
+static void checkWriteOnlyRegister(void)
+{
+	// Write-only registers are always served from the cache
+	tmc5160_writeRegister(0, TMC5160_IHOLD_IRUN, 0x00061F0A);
+	tmc_simulator_resetStatistics(&simulator);
+
+	TMC5160FieldUpdate update = tmc5160_fieldBegin(0, TMC5160_IHOLD_IRUN);
+	CHECK(tmc5160_fieldSet(&update, TMC5160_IRUN_FIELD, 20));
+	tmc5160_fieldCommit(&update);
+
+	CHECK(simulator.spiTransfers == 1);
+	CHECK(tmc_simulator_getWrittenRegister(&simulator, TMC5160_IHOLD_IRUN)
+		== tmc5160_fieldUpdate(0x00061F0A, TMC5160_IRUN_FIELD, 20));
+}
+
+static void checkUnmodified(void)
+{
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, true);
+	tmc5160_writeRegister(0, TMC5160_CHOPCONF, CHOPCONF_VALUE);
+	tmc_simulator_resetStatistics(&simulator);
+
+	// Nothing set: the commit sends nothing
+	TMC5160FieldUpdate update = tmc5160_fieldBegin(0, TMC5160_CHOPCONF);
+	tmc5160_fieldCommit(&update);
+	CHECK(simulator.spiTransfers == 0);
+
+	// A field of another register is rejected and does not mark the update as modified
+	CHECK(!tmc5160_fieldSet(&update, TMC5160_IRUN_FIELD, 20));
+	CHECK(!tmc5160_fieldSet(&update, TMC5160_VMAX_FIELD, 1000));
+	CHECK(!update.modified);
+	CHECK(update.value == CHOPCONF_VALUE);
+	tmc5160_fieldCommit(&update);
+	CHECK(simulator.spiTransfers == 0);
+
+	// Committing twice writes once
+	CHECK(tmc5160_fieldSet(&update, TMC5160_TOFF_FIELD, 7));
+	tmc5160_fieldCommit(&update);
+	tmc5160_fieldCommit(&update);
+	CHECK(simulator.spiTransfers == 1);
+
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, false);
+}
+
+int main(void)
+{
+	tmc_simulator_init(&simulator, tmc5160_registerAccess, tmc5160_sampleRegisterPreset);
+	tmc5160_initCache();
+
+	checkWithoutReadThrough();
+	checkWithReadThrough();
+	checkWriteOnlyRegister();
+	checkUnmodified();
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
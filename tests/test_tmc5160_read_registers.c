@@ -0,0 +1,186 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Runs tmc5160_readRegisters() against a simulated chip (helpers/RegisterSimulator)
+// and checks that the pipelined SPI reads take n+1 transfers for n registers read
+// from the chip, and that every reply ends up in the slot of its address, also
+// when cache hits (write-only and read-through registers) are interleaved.
+
+#include <stdio.h>
+
+#include "tmc/helpers/Macros.h"
+#include "tmc/helpers/RegisterSimulator.h"
+#include "tmc/ic/TMC5160/TMC5160.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+static TMC_RegisterSimulator simulator;
+
+void tmc5160_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	UNUSED(icID);
+
+	tmc_simulator_readWriteSPI(&simulator, data, dataLength);
+}
+
+bool tmc5160_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(icID);
+
+	return tmc_simulator_readWriteUART(&simulator, data, writeLength, readLength);
+}
+
+TMC5160BusType tmc5160_getBusType(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return IC_BUS_SPI;
+}
+
+uint8_t tmc5160_getNodeAddress(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return 0;
+}
+
+// Gives every readable register a distinct value
+static void fillRegisters(uint32_t seed)
+{
+	for(uint8_t address = 0; address < TMC5160_REGISTER_COUNT; address++)
+		tmc_simulator_setRegister(&simulator, address, seed ^ ((uint32_t) address * 0x01010101u));
+}
+
+// Value the simulated chip returns for [address]
+static uint32_t expected(uint8_t address)
+{
+	return tmc_simulator_getRegister(&simulator, address);
+}
+
+static void checkChipReads(void)
+{
+	static const uint8_t addresses[] = {
+		TMC5160_GCONF, TMC5160_XACTUAL, TMC5160_VACTUAL, TMC5160_TSTEP, TMC5160_XTARGET,
+		TMC5160_DRV_STATUS, TMC5160_ENCMODE, TMC5160_CHOPCONF
+	};
+	int32_t values[ARRAY_SIZE(addresses)];
+
+	for(size_t n = 1; n <= ARRAY_SIZE(addresses); n++)
+	{
+		fillRegisters(0xA5000000u + n);
+		tmc_simulator_resetStatistics(&simulator);
+
+		tmc5160_readRegisters(0, addresses, values, n);
+
+		CHECK(simulator.spiTransfers == n + 1);
+		for(size_t i = 0; i < n; i++)
+			CHECK((uint32_t) values[i] == expected(addresses[i]));
+	}
+
+	// The same register twice in a row
+	static const uint8_t repeated[] = { TMC5160_XACTUAL, TMC5160_XACTUAL, TMC5160_VACTUAL };
+	int32_t repeatedValues[3];
+
+	tmc_simulator_resetStatistics(&simulator);
+	tmc5160_readRegisters(0, repeated, repeatedValues, 3);
+	CHECK(simulator.spiTransfers == 4);
+	CHECK((uint32_t) repeatedValues[0] == expected(TMC5160_XACTUAL));
+	CHECK((uint32_t) repeatedValues[1] == expected(TMC5160_XACTUAL));
+	CHECK((uint32_t) repeatedValues[2] == expected(TMC5160_VACTUAL));
+
+	// Reading nothing sends nothing
+	tmc_simulator_resetStatistics(&simulator);
+	tmc5160_readRegisters(0, addresses, values, 0);
+	CHECK(simulator.spiTransfers == 0);
+
+	// The single register read still takes two transfers
+	tmc_simulator_resetStatistics(&simulator);
+	CHECK((uint32_t) tmc5160_readRegister(0, TMC5160_XACTUAL) == expected(TMC5160_XACTUAL));
+	CHECK(simulator.spiTransfers == 2);
+}
+
+static void checkInterleavedCacheHits(void)
+{
+	// Write-only registers are always served from the cache
+	tmc5160_writeRegister(0, TMC5160_IHOLD_IRUN, 0x00061F0A);
+	tmc5160_writeRegister(0, TMC5160_VMAX, 200000);
+
+	// Read-through registers hit once their shadow copy is valid
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, true);
+	tmc5160_setCacheReadThrough(0, TMC5160_GCONF, true);
+	tmc5160_writeRegister(0, TMC5160_GCONF, 0x00000004);
+	fillRegisters(0x5A000000u);
+	tmc_simulator_setRegister(&simulator, TMC5160_GCONF, 0x00000004);
+
+	static const uint8_t addresses[] = {
+		TMC5160_IHOLD_IRUN, TMC5160_XACTUAL, TMC5160_GCONF, TMC5160_VACTUAL,
+		TMC5160_CHOPCONF, TMC5160_VMAX, TMC5160_XTARGET, TMC5160_IHOLD_IRUN
+	};
+	int32_t values[ARRAY_SIZE(addresses)];
+
+	// CHOPCONF is not valid yet: 4 chip reads (XACTUAL, VACTUAL, CHOPCONF, XTARGET) + 1 transfer
+	tmc_simulator_resetStatistics(&simulator);
+	tmc5160_readRegisters(0, addresses, values, ARRAY_SIZE(addresses));
+
+	CHECK(simulator.spiTransfers == 4 + 1);
+	CHECK(values[0] == 0x00061F0A);
+	CHECK((uint32_t) values[1] == expected(TMC5160_XACTUAL));
+	CHECK(values[2] == 0x00000004);
+	CHECK((uint32_t) values[3] == expected(TMC5160_VACTUAL));
+	CHECK((uint32_t) values[4] == expected(TMC5160_CHOPCONF));
+	CHECK(values[5] == 200000);
+	CHECK((uint32_t) values[6] == expected(TMC5160_XTARGET));
+	CHECK(values[7] == 0x00061F0A);
+
+	// Now CHOPCONF is valid and served from the shadow copy, even after the chip value changed
+	uint32_t chopconf = expected(TMC5160_CHOPCONF);
+	tmc_simulator_setRegister(&simulator, TMC5160_CHOPCONF, 0);
+	tmc_simulator_resetStatistics(&simulator);
+	tmc5160_readRegisters(0, addresses, values, ARRAY_SIZE(addresses));
+
+	CHECK(simulator.spiTransfers == 3 + 1);
+	CHECK((uint32_t) values[4] == chopconf);
+	CHECK((uint32_t) values[1] == expected(TMC5160_XACTUAL));
+	CHECK((uint32_t) values[3] == expected(TMC5160_VACTUAL));
+	CHECK((uint32_t) values[6] == expected(TMC5160_XTARGET));
+
+	// Only cache hits: no transfer at all
+	static const uint8_t cached[] = { TMC5160_VMAX, TMC5160_CHOPCONF, TMC5160_IHOLD_IRUN, TMC5160_GCONF };
+	int32_t cachedValues[ARRAY_SIZE(cached)];
+
+	tmc_simulator_resetStatistics(&simulator);
+	tmc5160_readRegisters(0, cached, cachedValues, ARRAY_SIZE(cached));
+	CHECK(simulator.spiTransfers == 0);
+	CHECK(cachedValues[0] == 200000 && (uint32_t) cachedValues[1] == chopconf);
+	CHECK(cachedValues[2] == 0x00061F0A && cachedValues[3] == 0x00000004);
+
+	// A cache hit as the last entry must not swallow the reply of the last chip read
+	static const uint8_t trailingHit[] = { TMC5160_XACTUAL, TMC5160_VMAX };
+	int32_t trailingValues[2];
+
+	tmc_simulator_resetStatistics(&simulator);
+	tmc5160_readRegisters(0, trailingHit, trailingValues, 2);
+	CHECK(simulator.spiTransfers == 2);
+	CHECK((uint32_t) trailingValues[0] == expected(TMC5160_XACTUAL));
+	CHECK(trailingValues[1] == 200000);
+
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, false);
+	tmc5160_setCacheReadThrough(0, TMC5160_GCONF, false);
+}
+
+int main(void)
+{
+	tmc_simulator_init(&simulator, tmc5160_registerAccess, tmc5160_sampleRegisterPreset);
+	tmc5160_initCache();
+
+	checkChipReads();
+	checkInterleavedCacheHits();
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
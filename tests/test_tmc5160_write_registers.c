@@ -0,0 +1,185 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Runs tmc5160_writeRegisters() against a simulated chip (helpers/RegisterSimulator)
+// and checks the register contents, the split into batches of at most
+// TMC5160_SPI_BATCH_SIZE datagrams and the shadow registers after a batch.
+// Built with TMC5160_SPI_BATCH_SUPPORT set to 0 (one transfer per register) and 1.
+
+#include <stdio.h>
+
+#include "tmc/helpers/Macros.h"
+#include "tmc/helpers/RegisterSimulator.h"
+#include "tmc/ic/TMC5160/TMC5160.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define MAX_WRITES  (3 * TMC5160_SPI_BATCH_SIZE + 5)
+
+static TMC_RegisterSimulator simulator;
+static uint32_t batchCallbacks = 0;
+static size_t largestBatch = 0;
+
+void tmc5160_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	UNUSED(icID);
+
+	tmc_simulator_readWriteSPI(&simulator, data, dataLength);
+}
+
+#if TMC5160_SPI_BATCH_SUPPORT == 1
+void tmc5160_readWriteSPIBatch(uint16_t icID, uint8_t *data, size_t datagramLength, size_t datagramCount)
+{
+	UNUSED(icID);
+
+	batchCallbacks++;
+	if(datagramCount > largestBatch)
+		largestBatch = datagramCount;
+
+	// Every datagram with its own chip select
+	for(size_t i = 0; i < datagramCount; i++)
+		tmc_simulator_readWriteSPI(&simulator, &data[i * datagramLength], datagramLength);
+}
+#endif
+
+bool tmc5160_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(icID);
+
+	return tmc_simulator_readWriteUART(&simulator, data, writeLength, readLength);
+}
+
+TMC5160BusType tmc5160_getBusType(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return IC_BUS_SPI;
+}
+
+uint8_t tmc5160_getNodeAddress(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return 0;
+}
+
+static uint32_t random32(void)
+{
+	static uint32_t state = 0x12345678;
+
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+
+	return state;
+}
+
+// Writable registers without side effects on the bus (NODECONF changes the UART address)
+static size_t getWritableRegisters(uint8_t *addresses)
+{
+	size_t count = 0;
+
+	for(uint8_t address = 0; address < TMC5160_REGISTER_COUNT; address++)
+	{
+		if((tmc5160_registerAccess[address] & 0x02) && address != TMC_SIMULATOR_NODECONF)
+			addresses[count++] = address;
+	}
+
+	return count;
+}
+
+static void checkBatch(size_t count)
+{
+	static uint8_t writable[TMC5160_REGISTER_COUNT];
+	size_t writableCount = getWritableRegisters(writable);
+
+	TMC5160RegisterWrite writes[MAX_WRITES];
+	uint32_t expected[TMC5160_REGISTER_COUNT];
+	bool written[TMC5160_REGISTER_COUNT] = { false };
+
+	// Random registers, some of them more than once: the last write has to win
+	for(size_t i = 0; i < count; i++)
+	{
+		writes[i].address = writable[random32() % writableCount];
+		writes[i].value   = (int32_t) random32();
+
+		expected[writes[i].address] = (uint32_t) writes[i].value;
+		written[writes[i].address]  = true;
+	}
+
+	tmc_simulator_resetStatistics(&simulator);
+	batchCallbacks = 0;
+	largestBatch = 0;
+
+	tmc5160_writeRegisters(0, writes, count);
+
+	CHECK(simulator.spiTransfers == count);
+	CHECK(simulator.busErrors == 0);
+
+#if TMC5160_SPI_BATCH_SUPPORT == 1
+	CHECK(batchCallbacks == (count + TMC5160_SPI_BATCH_SIZE - 1) / TMC5160_SPI_BATCH_SIZE);
+	CHECK(largestBatch == ((count < TMC5160_SPI_BATCH_SIZE) ? count : TMC5160_SPI_BATCH_SIZE));
+#else
+	CHECK(batchCallbacks == 0);
+#endif
+
+	for(uint8_t address = 0; address < TMC5160_REGISTER_COUNT; address++)
+	{
+		if(!written[address])
+			continue;
+
+		CHECK(tmc_simulator_getWrittenRegister(&simulator, address) == expected[address]);
+
+		// The shadow registers hold the batch values
+		CHECK(tmc5160_getDirtyBit(0, address));
+		CHECK((uint32_t) tmc5160_shadowRegister[0][address] == expected[address]);
+	}
+}
+
+static void checkShadowReads(void)
+{
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, true);
+
+	const TMC5160RegisterWrite writes[] = {
+		{ TMC5160_IHOLD_IRUN, 0x00061F0A },
+		{ TMC5160_VMAX,       100000 },
+		{ TMC5160_CHOPCONF,   0x10410153 },
+		{ TMC5160_AMAX,       500 },
+	};
+
+	tmc5160_writeRegisters(0, writes, ARRAY_SIZE(writes));
+
+	// Write-only and read-through registers are read back without a transfer
+	tmc_simulator_resetStatistics(&simulator);
+	CHECK(tmc5160_readRegister(0, TMC5160_IHOLD_IRUN) == 0x00061F0A);
+	CHECK(tmc5160_readRegister(0, TMC5160_VMAX) == 100000);
+	CHECK(tmc5160_readRegister(0, TMC5160_CHOPCONF) == 0x10410153);
+	CHECK(tmc5160_readRegister(0, TMC5160_AMAX) == 500);
+	CHECK(simulator.spiTransfers == 0);
+
+	tmc5160_setCacheReadThrough(0, TMC5160_CHOPCONF, false);
+}
+
+int main(void)
+{
+	static const size_t counts[] = {
+		0, 1, 2, TMC5160_SPI_BATCH_SIZE - 1, TMC5160_SPI_BATCH_SIZE, TMC5160_SPI_BATCH_SIZE + 1,
+		2 * TMC5160_SPI_BATCH_SIZE, MAX_WRITES
+	};
+
+	tmc_simulator_init(&simulator, tmc5160_registerAccess, tmc5160_sampleRegisterPreset);
+	tmc5160_initCache();
+
+	for(size_t i = 0; i < ARRAY_SIZE(counts); i++)
+		checkBatch(counts[i]);
+
+	checkShadowReads();
+
+	printf("TMC5160_SPI_BATCH_SUPPORT %d: %d failures\n", TMC5160_SPI_BATCH_SUPPORT, failures);
+
+	return failures != 0;
+}
@@ -0,0 +1,141 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Runs tmc5272_writeRegisters() against a simulated chip (helpers/RegisterSimulator)
+// and checks the register contents and the split into batches of at most
+// TMC5272_SPI_BATCH_SIZE datagrams. The TMC5272 driver has no register access
+// table, the simulated chip treats every register as plain read/write register.
+// Built with TMC5272_SPI_BATCH_SUPPORT set to 0 (one transfer per register) and 1.
+
+#include <stdio.h>
+
+#include "tmc/helpers/Macros.h"
+#include "tmc/helpers/RegisterSimulator.h"
+#include "tmc/ic/TMC5272/TMC5272.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define MAX_WRITES  (3 * TMC5272_SPI_BATCH_SIZE + 5)
+
+static TMC_RegisterSimulator simulator;
+static uint8_t registerAccess[TMC_SIMULATOR_REGISTER_COUNT];
+static uint32_t batchCallbacks = 0;
+static size_t largestBatch = 0;
+
+void tmc5272_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	UNUSED(icID);
+
+	tmc_simulator_readWriteSPI(&simulator, data, dataLength);
+}
+
+#if TMC5272_SPI_BATCH_SUPPORT == 1
+void tmc5272_readWriteSPIBatch(uint16_t icID, uint8_t *data, size_t datagramLength, size_t datagramCount)
+{
+	UNUSED(icID);
+
+	batchCallbacks++;
+	if(datagramCount > largestBatch)
+		largestBatch = datagramCount;
+
+	for(size_t i = 0; i < datagramCount; i++)
+		tmc_simulator_readWriteSPI(&simulator, &data[i * datagramLength], datagramLength);
+}
+#endif
+
+bool tmc5272_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(icID);
+
+	return tmc_simulator_readWriteUART(&simulator, data, writeLength, readLength);
+}
+
+TMC5272BusType tmc5272_getBusType(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return IC_BUS_SPI;
+}
+
+uint8_t tmc5272_getNodeAddress(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return 0;
+}
+
+static uint32_t random32(void)
+{
+	static uint32_t state = 0x9E3779B9;
+
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+
+	return state;
+}
+
+static void checkBatch(size_t count)
+{
+	TMC5272RegisterWrite writes[MAX_WRITES];
+	uint32_t expected[TMC5272_REGISTER_COUNT];
+	bool written[TMC5272_REGISTER_COUNT] = { false };
+
+	for(size_t i = 0; i < count; i++)
+	{
+		// Skip the registers the simulator gives a bus function
+		do {
+			writes[i].address = random32() % TMC5272_REGISTER_COUNT;
+		} while(writes[i].address <= TMC_SIMULATOR_NODECONF);
+		writes[i].value = (int32_t) random32();
+
+		expected[writes[i].address] = (uint32_t) writes[i].value;
+		written[writes[i].address]  = true;
+	}
+
+	tmc_simulator_resetStatistics(&simulator);
+	batchCallbacks = 0;
+	largestBatch = 0;
+
+	tmc5272_writeRegisters(0, writes, count);
+
+	CHECK(simulator.spiTransfers == count);
+	CHECK(simulator.busErrors == 0);
+
+#if TMC5272_SPI_BATCH_SUPPORT == 1
+	CHECK(batchCallbacks == (count + TMC5272_SPI_BATCH_SIZE - 1) / TMC5272_SPI_BATCH_SIZE);
+	CHECK(largestBatch == ((count < TMC5272_SPI_BATCH_SIZE) ? count : TMC5272_SPI_BATCH_SIZE));
+#else
+	CHECK(batchCallbacks == 0);
+#endif
+
+	for(uint8_t address = 0; address < TMC5272_REGISTER_COUNT; address++)
+	{
+		if(written[address])
+			CHECK((uint32_t) tmc5272_readRegister(0, address) == expected[address]);
+	}
+}
+
+int main(void)
+{
+	static const size_t counts[] = {
+		0, 1, TMC5272_SPI_BATCH_SIZE - 1, TMC5272_SPI_BATCH_SIZE, TMC5272_SPI_BATCH_SIZE + 1,
+		2 * TMC5272_SPI_BATCH_SIZE, MAX_WRITES
+	};
+
+	for(size_t i = 0; i < TMC_SIMULATOR_REGISTER_COUNT; i++)
+		registerAccess[i] = 0x03;
+
+	tmc_simulator_init(&simulator, registerAccess, NULL);
+
+	for(size_t i = 0; i < ARRAY_SIZE(counts); i++)
+		checkBatch(counts[i]);
+
+	printf("TMC5272_SPI_BATCH_SUPPORT %d: %d failures\n", TMC5272_SPI_BATCH_SUPPORT, failures);
+
+	return failures != 0;
+}
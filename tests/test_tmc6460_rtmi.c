@@ -0,0 +1,560 @@
+/*******************************************************************************
+* Copyright © 2026 Analog Devices, Inc.
+*******************************************************************************/
+
+// Parses RTMI datagram streams with tmc6460_processRTMIBuffer() from a ring buffer
+// that is filled in random chunks, with and without RTMI CRC. The datagrams are
+// built by tmc6460_writeRTMIStreamedRegister(), so the test also checks that
+// TMC6460_RTMI_STATUS_INDEX() sorts them back into the RTMI index they were written
+// with. Covered: datagrams wrapping around the end of the buffer, resynchronization
+// after invalid bytes and CRC errors, the flush of an index at TMC6460_RTMI_BATCH_SIZE
+// samples, stopping from the batch callback and incomplete datagrams at the end.
+//
+// Built a second time with TMC6460_RTMI_STATUS_INDEX overridden from the command
+// line (STATUS_INDEX_OVERRIDE), the samples have to be sorted by the override.
+//
+// Usage: test_tmc6460_rtmi [streams] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tmc/helpers/Macros.h"
+#include "tmc/ic/TMC6460/TMC6460.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#ifndef STATUS_INDEX_OVERRIDE
+#define STATUS_INDEX_OVERRIDE 0
+#endif
+
+#define MAX_SAMPLES      1024
+#define MAX_STREAM       (MAX_SAMPLES * 6 + 4096)
+#define MAX_RING_SIZE    256
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+/******************************************************************************/
+
+static bool rtmiCRC = false;
+
+// Byte stream built from streamed register writes and inserted invalid bytes
+static uint8_t stream[MAX_STREAM];
+static size_t streamLength = 0;
+
+// Expected samples per RTMI index, in the order of reception
+static uint32_t expectedValues[TMC6460_RTMI_CHANNELS][MAX_SAMPLES];
+static uint32_t expectedCount[TMC6460_RTMI_CHANNELS];
+static uint32_t expectedTotal = 0;
+
+// Samples handed to tmc6460_RTMIBatchCallback()
+static uint32_t deliveredValues[TMC6460_RTMI_CHANNELS][MAX_SAMPLES];
+static uint32_t deliveredCount[TMC6460_RTMI_CHANNELS];
+static uint32_t batchCalls = 0;
+static uint32_t fullBatches = 0;
+static bool oversizedBatch = false;
+static bool missorted = false;
+static uint32_t stopAfterCalls = 0;   // Stop parsing after this many callbacks, 0: never
+
+static TMC6460RTMIBatch batch;
+static uint8_t ringBuffer[MAX_RING_SIZE];
+
+void tmc6460_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	UNUSED(icID);
+	UNUSED(data);
+	UNUSED(dataLength);
+}
+
+// Collects the streamed register writes
+bool tmc6460_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(icID);
+	UNUSED(readLength);
+
+	for(size_t i = 0; i < writeLength && streamLength < MAX_STREAM; i++)
+		stream[streamLength++] = data[i];
+
+	return true;
+}
+
+enum TMC6460BusType tmc6460_getBusType(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return TMC6460_BUS_UART;
+}
+
+bool tmc6460_RTMIDataCallback(uint16_t icID, uint8_t status, uint32_t data)
+{
+	UNUSED(icID);
+	UNUSED(status);
+	UNUSED(data);
+
+	return false;
+}
+
+bool tmc6460_isRTMIEnabled(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return true;
+}
+
+uint32_t tmc6460_availableBytes(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return 0;
+}
+
+bool tmc6460_RTMIBatchCallback(uint16_t icID, const TMC6460RTMIBatch *rtmiBatch)
+{
+	UNUSED(icID);
+
+	batchCalls++;
+
+	for(uint8_t index = 0; index < TMC6460_RTMI_CHANNELS; index++)
+	{
+		uint32_t count = rtmiBatch->count[index];
+
+		if(count > TMC6460_RTMI_BATCH_SIZE)
+		{
+			oversizedBatch = true;
+			continue;
+		}
+
+		if(count == TMC6460_RTMI_BATCH_SIZE)
+			fullBatches++;
+
+		for(uint32_t i = 0; i < count; i++)
+		{
+			if(TMC6460_RTMI_STATUS_INDEX(rtmiBatch->status[index][i]) != index)
+				missorted = true;
+
+			if(deliveredCount[index] < MAX_SAMPLES)
+				deliveredValues[index][deliveredCount[index]++] = rtmiBatch->value[index][i];
+		}
+	}
+
+	return stopAfterCalls != 0 && batchCalls >= stopAfterCalls;
+}
+
+bool tmc6460_isNormalCRCEnabled(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return false;
+}
+
+bool tmc6460_isRTMICRCEnabled(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return rtmiCRC;
+}
+
+/******************************************************************************/
+
+static size_t getDatagramSize(void)
+{
+	return (rtmiCRC) ? 6 : 5;
+}
+
+static bool isHeader(uint8_t byte)
+{
+	return (byte & 0x81) == 0x01;
+}
+
+static void resetStream(bool crc)
+{
+	rtmiCRC = crc;
+	streamLength = 0;
+	expectedTotal = 0;
+	batchCalls = 0;
+	fullBatches = 0;
+	oversizedBatch = false;
+	missorted = false;
+	stopAfterCalls = 0;
+
+	for(uint8_t i = 0; i < TMC6460_RTMI_CHANNELS; i++)
+	{
+		expectedCount[i] = 0;
+		deliveredCount[i] = 0;
+	}
+}
+
+// Appends the datagram of a streamed register write, returns the RTMI index it is sorted into
+static uint8_t appendSample(uint8_t rtmiIndex, uint32_t value)
+{
+	size_t start = streamLength;
+
+	CHECK(tmc6460_writeRTMIStreamedRegister(0, rtmiIndex, value) == 0);
+	CHECK(streamLength == start + getDatagramSize());
+	CHECK(isHeader(stream[start]));
+
+	uint8_t index = TMC6460_RTMI_STATUS_INDEX(stream[start]);
+
+	// The status byte layout round trip: the header carries the RTMI index of the write
+#if STATUS_INDEX_OVERRIDE
+	CHECK(index == TMC6460_RTMI_CHANNELS - 1 - rtmiIndex);
+#else
+	CHECK(index == rtmiIndex);
+#endif
+
+	expectedValues[index][expectedCount[index]++] = value;
+	expectedTotal++;
+
+	return index;
+}
+
+// Appends [count] bytes that can not start an RTMI datagram
+static void appendInvalidBytes(uint32_t count)
+{
+	for(uint32_t i = 0; i < count; i++)
+	{
+		uint8_t byte;
+
+		do {
+			byte = randomNext();
+		} while(isHeader(byte));
+
+		stream[streamLength++] = byte;
+	}
+}
+
+// Value of which no byte, including the CRC of its datagram, looks like a header
+static uint32_t getNonHeaderValue(uint8_t rtmiIndex)
+{
+	for(;;)
+	{
+		uint32_t value = (uint32_t) randomNext() | 0x80808080;
+
+		if(!rtmiCRC)
+			return value;
+
+		// Let the driver calculate the CRC of this value
+		size_t start = streamLength;
+		tmc6460_writeRTMIStreamedRegister(0, rtmiIndex, value);
+		streamLength = start;
+
+		if(!isHeader(stream[start + 5]))
+			return value;
+	}
+}
+
+static bool isDeliveredAsExpected(void)
+{
+	for(uint8_t i = 0; i < TMC6460_RTMI_CHANNELS; i++)
+	{
+		if(deliveredCount[i] != expectedCount[i])
+			return false;
+
+		for(uint32_t j = 0; j < expectedCount[i]; j++)
+		{
+			if(deliveredValues[i][j] != expectedValues[i][j])
+				return false;
+		}
+	}
+
+	return true;
+}
+
+// Copies the stream into a ring buffer of [size] bytes in random chunks, starting
+// at [start], and parses the buffer after every chunk. Returns the samples delivered.
+static uint32_t feedStream(TMC6460RTMIRingBuffer *ring, size_t size, size_t start)
+{
+	size_t writeIndex = start;
+	size_t position = 0;
+	uint32_t delivered = 0;
+
+	tmc6460_initRTMIRingBuffer(ring, ringBuffer, size);
+	ring->readIndex = start;
+
+	while(position < streamLength)
+	{
+		// Keep one byte free, a full buffer would look empty
+		size_t available = (writeIndex + size - ring->readIndex) % size;
+		size_t space = size - 1 - available;
+		size_t chunk = randomRange(0, MIN(space, streamLength - position));
+
+		for(size_t i = 0; i < chunk; i++)
+		{
+			ringBuffer[writeIndex] = stream[position++];
+			writeIndex = (writeIndex + 1) % size;
+		}
+
+		delivered += tmc6460_processRTMIBuffer(0, ring, writeIndex, &batch);
+	}
+
+	delivered += tmc6460_processRTMIBuffer(0, ring, writeIndex, &batch);
+
+	// Everything has been parsed
+	CHECK(ring->readIndex == writeIndex);
+
+	return delivered;
+}
+
+/******************************************************************************/
+
+static void checkStatusIndex(bool crc)
+{
+	TMC6460RTMIRingBuffer ring;
+
+	resetStream(crc);
+
+	for(uint8_t rtmiIndex = 0; rtmiIndex < TMC6460_RTMI_CHANNELS; rtmiIndex++)
+		appendSample(rtmiIndex, 0x01000000 * rtmiIndex + 0x00123456);
+
+	CHECK(feedStream(&ring, MAX_RING_SIZE, 0) == TMC6460_RTMI_CHANNELS);
+	CHECK(isDeliveredAsExpected());
+	CHECK(!missorted);
+
+	for(uint8_t i = 0; i < TMC6460_RTMI_CHANNELS; i++)
+		CHECK(deliveredCount[i] == 1);
+}
+
+// Datagrams cross the end of small buffers at every offset
+static void checkWrapAround(bool crc)
+{
+	TMC6460RTMIRingBuffer ring;
+
+	resetStream(crc);
+
+	for(int i = 0; i < 40; i++)
+		appendSample(randomRange(0, TMC6460_RTMI_CHANNELS - 1), randomNext());
+
+	uint32_t samples = expectedTotal;
+
+	for(size_t size = getDatagramSize() + 1; size <= 23; size++)
+	{
+		for(size_t start = 0; start < size; start++)
+		{
+			for(uint8_t i = 0; i < TMC6460_RTMI_CHANNELS; i++)
+				deliveredCount[i] = 0;
+
+			CHECK(feedStream(&ring, size, start) == samples);
+			CHECK(isDeliveredAsExpected());
+			CHECK(ring.skippedBytes == 0);
+			CHECK(ring.crcErrors == 0);
+		}
+	}
+}
+
+// Invalid bytes are skipped one by one until the next header
+static void checkResync(bool crc)
+{
+	TMC6460RTMIRingBuffer ring;
+	uint32_t invalidBytes = 0;
+
+	resetStream(crc);
+
+	for(int i = 0; i < 20; i++)
+	{
+		uint32_t count = randomRange(0, 7);
+
+		appendInvalidBytes(count);
+		invalidBytes += count;
+		appendSample(i % TMC6460_RTMI_CHANNELS, randomNext());
+	}
+
+	CHECK(feedStream(&ring, 64, 0) == expectedTotal);
+	CHECK(isDeliveredAsExpected());
+	CHECK(ring.skippedBytes == invalidBytes);
+	CHECK(ring.crcErrors == 0);
+
+	if(!crc)
+		return;
+
+	// A datagram with a corrupted value byte: the header is dropped because of the CRC
+	// and the remaining bytes are skipped, the next datagram is parsed again
+	resetStream(crc);
+
+	appendSample(1, 0x11111111);
+
+	size_t corrupted = streamLength;
+	uint32_t value = getNonHeaderValue(3);
+	tmc6460_writeRTMIStreamedRegister(0, 3, value);
+	stream[corrupted + 2] ^= 0x01;
+
+	appendSample(3, 0x33333333);
+	appendSample(5, 0x55555555);
+
+	CHECK(feedStream(&ring, 64, 60) == 3);
+	CHECK(isDeliveredAsExpected());
+	CHECK(ring.crcErrors == 1);
+	CHECK(ring.skippedBytes == getDatagramSize() - 1);
+}
+
+// RTMI index 2 fills two batches and starts a third one, index 6 is sampled in between.
+// Returns the indices they are sorted into.
+static void appendBatchStream(uint8_t *batchIndex, uint8_t *otherIndex)
+{
+	for(int i = 0; i < 2 * TMC6460_RTMI_BATCH_SIZE + 3; i++)
+	{
+		*batchIndex = appendSample(2, 0x20000000 + i);
+
+		if(i % 16 == 0)
+			*otherIndex = appendSample(6, 0x60000000 + i);
+	}
+}
+
+// An index is handed over as soon as it holds TMC6460_RTMI_BATCH_SIZE samples
+static void checkBatchFlush(bool crc)
+{
+	TMC6460RTMIRingBuffer ring;
+	uint8_t batchIndex = 0, otherIndex = 0;
+
+	resetStream(crc);
+	appendBatchStream(&batchIndex, &otherIndex);
+
+	tmc6460_initRTMIRingBuffer(&ring, stream, MAX_STREAM);
+
+	CHECK(tmc6460_processRTMIBuffer(0, &ring, streamLength, &batch) == expectedTotal);
+	CHECK(isDeliveredAsExpected());
+	CHECK(batchCalls == 3);
+	CHECK(fullBatches == 2);
+	CHECK(!oversizedBatch);
+	CHECK(!missorted);
+}
+
+// Returning true from the callback stops right after the flushed datagram
+static void checkEarlyStop(bool crc)
+{
+	TMC6460RTMIRingBuffer ring;
+	uint8_t batchIndex = 0, otherIndex = 0;
+
+	resetStream(crc);
+	appendBatchStream(&batchIndex, &otherIndex);
+
+	tmc6460_initRTMIRingBuffer(&ring, stream, MAX_STREAM);
+
+	// The first flush happens at the TMC6460_RTMI_BATCH_SIZE-th sample of RTMI index 2
+	uint32_t index6Samples = (TMC6460_RTMI_BATCH_SIZE - 1) / 16 + 1;
+	uint32_t firstFlush = TMC6460_RTMI_BATCH_SIZE + index6Samples;
+
+	stopAfterCalls = 1;
+	CHECK(tmc6460_processRTMIBuffer(0, &ring, streamLength, &batch) == firstFlush);
+	CHECK(batchCalls == 1);
+	CHECK(deliveredCount[batchIndex] == TMC6460_RTMI_BATCH_SIZE);
+	CHECK(deliveredCount[otherIndex] == index6Samples);
+	CHECK(ring.readIndex == firstFlush * getDatagramSize());
+
+	// The next call continues with the following datagram
+	stopAfterCalls = 0;
+	CHECK(tmc6460_processRTMIBuffer(0, &ring, streamLength, &batch) == expectedTotal - firstFlush);
+	CHECK(isDeliveredAsExpected());
+	CHECK(ring.readIndex == streamLength);
+}
+
+// An incomplete datagram stays in the buffer until the rest has been received
+static void checkIncomplete(bool crc)
+{
+	TMC6460RTMIRingBuffer ring;
+	size_t datagramSize = getDatagramSize();
+
+	resetStream(crc);
+	appendSample(0, 0xAAAAAAAA);
+	appendSample(4, 0x44444444);
+	appendSample(7, 0x77777777);
+
+	tmc6460_initRTMIRingBuffer(&ring, stream, MAX_STREAM);
+
+	for(size_t missing = 1; missing < datagramSize; missing++)
+	{
+		ring.readIndex = 0;
+		CHECK(tmc6460_processRTMIBuffer(0, &ring, streamLength - missing, &batch) == 2);
+		CHECK(ring.readIndex == 2 * datagramSize);
+		CHECK(ring.skippedBytes == 0 && ring.crcErrors == 0);
+	}
+
+	resetStream(crc);
+	appendSample(0, 0xAAAAAAAA);
+	appendSample(4, 0x44444444);
+	appendSample(7, 0x77777777);
+
+	tmc6460_initRTMIRingBuffer(&ring, stream, MAX_STREAM);
+	CHECK(tmc6460_processRTMIBuffer(0, &ring, streamLength - 1, &batch) == 2);
+	CHECK(tmc6460_processRTMIBuffer(0, &ring, streamLength, &batch) == 1);
+	CHECK(isDeliveredAsExpected());
+	CHECK(ring.readIndex == streamLength);
+}
+
+// Random streams with invalid bytes through random buffers
+static int checkRandomStreams(bool crc, int streams)
+{
+	TMC6460RTMIRingBuffer ring;
+	int mismatches = 0;
+
+	for(int s = 0; s < streams; s++)
+	{
+		uint32_t invalidBytes = 0;
+
+		resetStream(crc);
+
+		int samples = randomRange(1, 300);
+		for(int i = 0; i < samples; i++)
+		{
+			if(randomRange(0, 3) == 0)
+			{
+				uint32_t count = randomRange(1, 9);
+				appendInvalidBytes(count);
+				invalidBytes += count;
+			}
+
+			appendSample(randomRange(0, TMC6460_RTMI_CHANNELS - 1), randomNext());
+		}
+
+		size_t size = randomRange(getDatagramSize() + 1, MAX_RING_SIZE);
+		uint32_t delivered = feedStream(&ring, size, randomRange(0, size - 1));
+
+		if(delivered != expectedTotal || !isDeliveredAsExpected() || ring.skippedBytes != invalidBytes
+			|| ring.crcErrors != 0 || oversizedBatch || missorted)
+		{
+			if(mismatches++ == 0)
+				printf("stream %d (%s CRC): %u of %u samples delivered, %u skipped bytes (expected %u)\n",
+					s, crc ? "with" : "without", delivered, expectedTotal, ring.skippedBytes, invalidBytes);
+		}
+	}
+
+	return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+	int streams = (argc > 1) ? atoi(argv[1]) : 500;
+	if(argc > 2)
+		randomState = strtoull(argv[2], NULL, 0);
+
+	for(int crc = 0; crc < 2; crc++)
+	{
+		checkStatusIndex(crc);
+		checkWrapAround(crc);
+		checkResync(crc);
+		checkBatchFlush(crc);
+		checkEarlyStop(crc);
+		checkIncomplete(crc);
+		CHECK(checkRandomStreams(crc, streams) == 0);
+	}
+
+	printf("%d random streams with and without RTMI CRC, batches of %d samples%s\n",
+		streams, TMC6460_RTMI_BATCH_SIZE, STATUS_INDEX_OVERRIDE ? ", status index overridden" : "");
+
+	printf("%d failures\n", failures);
+	return failures != 0;
+}
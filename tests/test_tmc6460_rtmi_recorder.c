@@ -0,0 +1,504 @@
+/*******************************************************************************
+* Copyright © 2026 Analog Devices, Inc.
+*******************************************************************************/
+
+// Records random RTMI samples with tmc6460_recordRTMISample() while a consumer
+// reads the records at a random rate, and compares every record and the overflow
+// counters with a reference model. The channels are configured with random
+// decimation, with and without aggregation of signed or unsigned samples, and
+// start with head and tail just below UINT32_MAX so the indices wrap around.
+// With TMC_API_TMC6460_RTMI_BUFFER_SUPPORT the samples are also recorded in
+// batches through tmc6460_recordRTMIBatch().
+//
+// Afterwards tmc6460_writeRTMIStreamedRegisters() has to send the same bytes as
+// one tmc6460_writeRTMIStreamedRegister() call per register, with and without
+// RTMI CRC and for counts around multiples of TMC6460_RTMI_WRITE_BATCH_SIZE.
+//
+// Usage: test_tmc6460_rtmi_recorder [runs] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tmc/helpers/Macros.h"
+#include "tmc/ic/TMC6460/TMC6460.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define STEPS           4000
+#define MAX_DECIMATION  5
+#define MAX_RECORDS     STEPS
+#define MAX_WRITES      (4 * TMC6460_RTMI_WRITE_BATCH_SIZE + 1)
+#define MAX_UART_CALLS  (2 * MAX_WRITES)
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+/******************************************************************************/
+
+static bool rtmiCRC = false;
+
+// Bytes sent by tmc6460_readWriteUART()
+static uint8_t uartBytes[MAX_WRITES * 6];
+static size_t uartLength = 0;
+static size_t uartCallLengths[MAX_UART_CALLS];
+static uint32_t uartCalls = 0;
+static uint32_t uartFailAtCall = 0;   // Fail this call (counted from 1), 0: never
+
+void tmc6460_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	UNUSED(icID);
+	UNUSED(data);
+	UNUSED(dataLength);
+}
+
+bool tmc6460_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	UNUSED(icID);
+	UNUSED(readLength);
+
+	if(uartCalls < MAX_UART_CALLS)
+		uartCallLengths[uartCalls] = writeLength;
+
+	if(++uartCalls == uartFailAtCall)
+		return false;
+
+	for(size_t i = 0; i < writeLength && uartLength < sizeof(uartBytes); i++)
+		uartBytes[uartLength++] = data[i];
+
+	return true;
+}
+
+enum TMC6460BusType tmc6460_getBusType(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return TMC6460_BUS_UART;
+}
+
+bool tmc6460_RTMIDataCallback(uint16_t icID, uint8_t status, uint32_t data)
+{
+	UNUSED(icID);
+	UNUSED(status);
+	UNUSED(data);
+
+	return false;
+}
+
+bool tmc6460_isRTMIEnabled(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return false;
+}
+
+uint32_t tmc6460_availableBytes(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return 0;
+}
+
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+bool tmc6460_RTMIBatchCallback(uint16_t icID, const TMC6460RTMIBatch *batch)
+{
+	UNUSED(icID);
+	UNUSED(batch);
+
+	return false;
+}
+#endif
+
+bool tmc6460_isNormalCRCEnabled(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return false;
+}
+
+bool tmc6460_isRTMICRCEnabled(uint16_t icID)
+{
+	UNUSED(icID);
+
+	return rtmiCRC;
+}
+
+/*** Recorder *****************************************************************/
+
+// Reference model of one RTMI index, keeps the samples of the current interval
+// and every record the recorder should have kept
+typedef struct
+{
+	uint16_t decimation;
+	bool aggregate;
+	bool isSigned;
+	uint32_t samples[MAX_DECIMATION];
+	uint32_t sampleCount;
+
+	TMC6460RTMIRecord records[MAX_RECORDS];
+	uint32_t written;
+	uint32_t read;
+	uint32_t overflows;
+} Model;
+
+static TMC6460RTMIRecorder recorder;
+static Model models[TMC6460_RTMI_CHANNELS];
+
+static bool isLess(const Model *model, uint32_t a, uint32_t b)
+{
+	return (model->isSigned) ? (int32_t) a < (int32_t) b : a < b;
+}
+
+static void configureChannel(uint8_t index)
+{
+	Model *model = &models[index];
+	uint16_t decimation = randomRange(0, MAX_DECIMATION);
+
+	model->decimation  = (decimation > 0) ? decimation : 1;
+	model->aggregate   = randomRange(0, 1);
+	model->isSigned    = randomRange(0, 1);
+	model->sampleCount = 0;
+
+	tmc6460_configureRTMIChannel(&recorder, index, decimation, model->aggregate, model->isSigned);
+}
+
+// Values around zero and the signed and unsigned limits, where the signed and unsigned order differ
+static uint32_t randomValue(void)
+{
+	switch(randomRange(0, 3))
+	{
+	case 0:
+		return (uint32_t) randomRange(-4, 4);
+	case 1:
+		return (uint32_t) randomRange(INT32_MAX - 4, (int64_t) INT32_MAX + 4);
+	default:
+		return (uint32_t) randomNext();
+	}
+}
+
+static uint8_t buildStatus(uint8_t index)
+{
+	// Header bit, RTMI index and random flags, TMC6460_RTMI_STATUS_INDEX() has to ignore the flags
+	return 0x01 | (index << 1) | (randomRange(0, 7) << 4);
+}
+
+static void modelSample(uint8_t status, uint32_t value)
+{
+	Model *model = &models[TMC6460_RTMI_STATUS_INDEX(status)];
+
+	model->samples[model->sampleCount++] = value;
+
+	if(model->sampleCount < model->decimation)
+		return;
+
+	if(model->written - model->read >= TMC6460_RTMI_RECORDER_LENGTH)
+	{
+		model->overflows++;
+	}
+	else
+	{
+		TMC6460RTMIRecord *record = &model->records[model->written++];
+
+		record->value  = value;
+		record->status = status;
+		record->min    = value;
+		record->max    = value;
+		record->mean   = value;
+
+		if(model->aggregate)
+		{
+			int64_t sum = 0;
+
+			for(uint32_t i = 0; i < model->sampleCount; i++)
+			{
+				if(isLess(model, model->samples[i], record->min))
+					record->min = model->samples[i];
+				if(isLess(model, record->max, model->samples[i]))
+					record->max = model->samples[i];
+
+				sum += (model->isSigned) ? (int64_t) (int32_t) model->samples[i] : (int64_t) model->samples[i];
+			}
+
+			// Rounded towards zero
+			int64_t mean = (sum < 0) ? -(-sum / model->sampleCount) : sum / model->sampleCount;
+			record->mean = (uint32_t) mean;
+		}
+	}
+
+	model->sampleCount = 0;
+}
+
+static bool isSameRecord(const TMC6460RTMIRecord *a, const TMC6460RTMIRecord *b)
+{
+	return a->value == b->value && a->min == b->min && a->max == b->max
+		&& a->mean == b->mean && a->status == b->status;
+}
+
+// Reads up to [count] records of [index] and compares them with the model, returns the mismatches
+static int consume(uint8_t index, uint32_t count)
+{
+	Model *model = &models[index];
+	TMC6460RTMIRecord record;
+	int mismatches = 0;
+
+	if(tmc6460_getRTMIRecordCount(&recorder, index) != model->written - model->read)
+		mismatches++;
+
+	for(uint32_t i = 0; i < count; i++)
+	{
+		bool available = model->read < model->written;
+
+		if(tmc6460_readRTMIRecord(&recorder, index, &record) != available)
+		{
+			mismatches++;
+			break;
+		}
+
+		if(!available)
+			break;
+
+		if(!isSameRecord(&record, &model->records[model->read]))
+		{
+			if(mismatches == 0)
+				printf("index %u record %u (decimation %u%s%s): value %08X min %08X max %08X mean %08X (reference %08X %08X %08X %08X)\n",
+					index, model->read, model->decimation, model->aggregate ? ", aggregated" : "", model->isSigned ? ", signed" : "",
+					record.value, record.min, record.max, record.mean,
+					model->records[model->read].value, model->records[model->read].min,
+					model->records[model->read].max, model->records[model->read].mean);
+
+			mismatches++;
+		}
+
+		model->read++;
+	}
+
+	return mismatches;
+}
+
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+static TMC6460RTMIBatch batch;
+
+// Records the collected batch, the model takes the samples in the order of the batch
+static void recordBatch(void)
+{
+	tmc6460_recordRTMIBatch(&recorder, &batch);
+
+	for(uint8_t index = 0; index < TMC6460_RTMI_CHANNELS; index++)
+	{
+		for(uint32_t i = 0; i < batch.count[index]; i++)
+			modelSample(batch.status[index][i], batch.value[index][i]);
+
+		batch.count[index] = 0;
+	}
+}
+#endif
+
+// Records STEPS random samples, the consumer reads a random amount of records
+// with probability 1/[readRate], returns the mismatching records and counters
+static int checkRecorder(uint32_t readRate, bool batched)
+{
+	int mismatches = 0;
+
+	tmc6460_initRTMIRecorder(&recorder);
+
+	for(uint8_t index = 0; index < TMC6460_RTMI_CHANNELS; index++)
+	{
+		// Start close to the wrap around of the 32 bit head and tail
+		uint32_t start = UINT32_MAX - (uint32_t) randomRange(0, 2 * TMC6460_RTMI_RECORDER_LENGTH);
+
+		recorder.channels[index].head = start;
+		recorder.channels[index].tail = start;
+
+		models[index].written   = 0;
+		models[index].read      = 0;
+		models[index].overflows = 0;
+
+		configureChannel(index);
+	}
+
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+	memset(&batch, 0, sizeof(batch));
+#else
+	UNUSED(batched);
+#endif
+
+	for(uint32_t step = 0; step < STEPS; step++)
+	{
+		uint8_t index = randomRange(0, TMC6460_RTMI_CHANNELS - 1);
+		uint8_t status = buildStatus(index);
+		uint32_t value = randomValue();
+
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+		if(batched)
+		{
+			batch.status[index][batch.count[index]] = status;
+			batch.value[index][batch.count[index]]  = value;
+
+			if(++batch.count[index] == TMC6460_RTMI_BATCH_SIZE || randomRange(0, 15) == 0)
+				recordBatch();
+		}
+		else
+#endif
+		{
+			tmc6460_recordRTMISample(&recorder, status, value);
+			modelSample(status, value);
+		}
+
+		if(randomRange(1, readRate) == 1)
+			mismatches += consume(randomRange(0, TMC6460_RTMI_CHANNELS - 1), randomRange(1, 2 * TMC6460_RTMI_RECORDER_LENGTH));
+
+		// A new configuration restarts the interval
+		if(randomRange(0, 999) == 0)
+		{
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+			if(batched)
+				recordBatch();
+#endif
+			configureChannel(index);
+		}
+	}
+
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+	if(batched)
+		recordBatch();
+#endif
+
+	for(uint8_t index = 0; index < TMC6460_RTMI_CHANNELS; index++)
+	{
+		if(recorder.channels[index].overflows != models[index].overflows)
+			mismatches++;
+
+		// Drains the ring buffer
+		mismatches += consume(index, TMC6460_RTMI_RECORDER_LENGTH + 1);
+	}
+
+	return mismatches;
+}
+
+/*** Streamed register writes *************************************************/
+
+static void resetUART(void)
+{
+	uartLength = 0;
+	uartCalls = 0;
+	uartFailAtCall = 0;
+}
+
+// Sends [count] random registers once per call and once batched, returns the mismatches
+static int checkStreamedWrites(size_t count)
+{
+	uint8_t indices[MAX_WRITES];
+	uint32_t values[MAX_WRITES];
+	uint8_t reference[sizeof(uartBytes)];
+	size_t datagramSize = (rtmiCRC) ? 6 : 5;
+	size_t expectedCalls = (count + TMC6460_RTMI_WRITE_BATCH_SIZE - 1) / TMC6460_RTMI_WRITE_BATCH_SIZE;
+	int mismatches = 0;
+
+	for(size_t i = 0; i < count; i++)
+	{
+		// Indices beyond the RTMI channels have to be masked the same way
+		indices[i] = randomRange(0, 15);
+		values[i]  = randomNext();
+	}
+
+	resetUART();
+	for(size_t i = 0; i < count; i++)
+		tmc6460_writeRTMIStreamedRegister(0, indices[i], values[i]);
+
+	size_t referenceLength = uartLength;
+	memcpy(reference, uartBytes, referenceLength);
+
+	if(referenceLength != count * datagramSize)
+		mismatches++;
+
+	resetUART();
+	if(tmc6460_writeRTMIStreamedRegisters(0, indices, values, count) != 0)
+		mismatches++;
+
+	if(uartLength != referenceLength || memcmp(uartBytes, reference, referenceLength) != 0)
+	{
+		printf("%zu registers, %s CRC: batched writes differ from single writes\n", count, rtmiCRC ? "with" : "without");
+		mismatches++;
+	}
+
+	// Full batches, only the last call may be shorter
+	if(uartCalls != expectedCalls)
+		mismatches++;
+
+	for(uint32_t call = 0; call < uartCalls && call < MAX_UART_CALLS; call++)
+	{
+		size_t registers = (call + 1 < uartCalls) ? TMC6460_RTMI_WRITE_BATCH_SIZE : count - call * TMC6460_RTMI_WRITE_BATCH_SIZE;
+
+		if(uartCallLengths[call] != registers * datagramSize)
+			mismatches++;
+	}
+
+	// A failing transfer is reported and stops the remaining batches
+	if(expectedCalls > 0)
+	{
+		resetUART();
+		uartFailAtCall = randomRange(1, expectedCalls);
+
+		if(tmc6460_writeRTMIStreamedRegisters(0, indices, values, count) != -2)
+			mismatches++;
+		if(uartCalls != uartFailAtCall)
+			mismatches++;
+	}
+
+	return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+	int runs = (argc > 1) ? atoi(argv[1]) : 20;
+	if(argc > 2)
+		randomState = strtoull(argv[2], NULL, 0);
+
+	uint32_t overflows = 0;
+
+	for(int run = 0; run < runs; run++)
+	{
+		// Consumers from faster than the producer to far behind it
+		uint32_t readRate = 1u << (run % 8);
+		bool batched = (run & 8) != 0;
+
+		CHECK(checkRecorder(readRate, batched) == 0);
+
+		for(uint8_t index = 0; index < TMC6460_RTMI_CHANNELS; index++)
+			overflows += models[index].overflows;
+	}
+
+	// The slow consumers have to fill the ring buffers
+	CHECK(runs < 8 || overflows > 0);
+
+	for(int crc = 0; crc <= 1; crc++)
+	{
+		rtmiCRC = crc;
+
+		for(size_t count = 0; count <= MAX_WRITES; count++)
+			CHECK(checkStreamedWrites(count) == 0);
+	}
+
+	printf("%d recorder runs of %d samples, %u records dropped, ring buffers of %d records\n",
+		runs, STEPS, overflows, TMC6460_RTMI_RECORDER_LENGTH);
+	printf("0 to %d streamed register writes with and without RTMI CRC, batches of %d datagrams\n",
+		MAX_WRITES, TMC6460_RTMI_WRITE_BATCH_SIZE);
+
+	printf("%d failures\n", failures);
+	return failures != 0;
+}
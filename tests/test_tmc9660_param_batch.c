@@ -0,0 +1,747 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Checks tmc9660_param_sendCommands() and tmc9660_param_readAxisState() against a
+// simulated TMC9660 parameter mode endpoint (TMCL over UART) and compares the bus
+// time of reading the axis state in one batch with 12 tmc9660_param_getParameter()
+// calls. Built with and without TMC9660_UART_STREAM_SUPPORT.
+//
+// The endpoint models a half-duplex UART: 9 byte datagrams of 10 bits per byte,
+// a fixed host overhead per callback and a fixed firmware processing time per
+// request. With streaming, the next request is sent while the chip processes
+// the previous one. The time is simulated, not measured.
+//
+// The same endpoint also serves the bootloader (8 byte datagrams with CRC8): Two
+// memory banks, FLASH_ERASE_SECTOR and MEM_IS_BUSY. It loses and corrupts replies at
+// random to check that the bulk transfers (tmc9660_bl_writeMemory() etc.) resume at
+// the failed word with a correct running checksum, give up after TMC9660_BL_RETRIES
+// failures without progress, and that the request pacing backs off after failures.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tmc/ic/TMC9660/TMC9660.h"
+#include "tmc/ic/TMC9660/TMC9660_PARAM_HW_Abstraction.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define PARAMETER_COUNT  512
+#define VALID_TYPES      400
+
+// Simulated endpoint state, times in µs
+static double now          = 0;
+static double baudrate     = 115200;
+static double hostOverhead = 20;
+static double processing   = 30;
+
+static int32_t parameters[PARAMETER_COUNT];
+static long callbacks = 0;
+static long served    = 0;
+
+// Index of the request whose reply is dropped, corrupted or answered for another command (-1: none)
+static long dropAt    = -1;
+static long corruptAt = -1;
+static long swapAt    = -1;
+
+// Bootloader endpoint
+#define BL_BANKS         2
+#define BL_WORDS         4096
+#define BL_SECTOR_WORDS  1024
+#define BL_STATUS_ERROR  1
+#define BL_MAX_GAPS      8192
+
+// Random faults are followed by at least three evaluated requests without fault,
+// so every resume (SET_BANK, SET_ADDRESS and the first word) makes progress
+#define BL_FAULT_SPACING  3
+
+static uint32_t blMemory[BL_BANKS][BL_WORDS];
+static uint32_t blBank      = 0;
+static uint32_t blAddress   = 0;
+static uint32_t blBusyPolls = 0;   // MEM_IS_BUSY replies with busy set after an erase
+static uint32_t blEraseTime = 0;   // Busy polls of the next erase
+static bool blBusyForever   = false;
+static long blRequests      = 0;
+static long blSetBanks      = 0;
+static long blBusyRequests  = 0;
+static long blFaults        = 0;
+
+// Lost replies: request index, every [blDropPeriod]th request and random rates in percent.
+// Half of the lost requests have been executed by the chip, corrupted replies always have.
+static long blDropAt       = -1;
+static long blDropPeriod   = 0;
+static int blDropRate      = 0;
+static int blCorruptRate   = 0;
+static int blCleanRequests = 0;   // Requests left before the next random fault
+
+// Time between the end of the last reply and each bootloader callback
+static double replyEnd = 0;
+static double blGaps[BL_MAX_GAPS];
+static long blGapCount = 0;
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+uint32_t tmc_getMicrosecondTimestamp()
+{
+	now += 0.05;
+	return (uint32_t) now;
+}
+
+static double datagramTime(size_t length)
+{
+	return length * 10 * 1e6 / baudrate;
+}
+
+static uint8_t checksum(const uint8_t *data)
+{
+	uint8_t sum = 0;
+	for(size_t i = 0; i < 8; i++)
+		sum += data[i];
+
+	return sum;
+}
+
+// Replaces the request in [data] with the reply of the endpoint
+static void processRequest(uint8_t *data)
+{
+	uint8_t command = data[1];
+	uint16_t type   = data[2] | ((data[3] >> 4) << 8);
+	uint32_t value  = ((uint32_t) data[4] << 24) | ((uint32_t) data[5] << 16) | ((uint32_t) data[6] << 8) | data[7];
+	uint8_t status  = TMC9660_PARAMSTATUS_OK;
+	uint32_t reply  = 0;
+
+	if(checksum(data) != data[8])
+		status = TMC9660_PARAMSTATUS_CHKERROR;
+	else if(type >= VALID_TYPES)
+		status = TMC9660_PARAMSTATUS_WRONG_TYPE;
+	else if(command == TMC9660_CMD_GAP || command == TMC9660_CMD_GGP)
+		reply = parameters[type];
+	else if(command == TMC9660_CMD_SAP || command == TMC9660_CMD_SGP)
+		parameters[type] = reply = value;
+	else
+		status = TMC9660_PARAMSTATUS_INVALID_CMD;
+
+	if(served == swapAt)
+		command ^= 1;
+
+	data[0] = 255;
+	data[1] = 1;
+	data[2] = status;
+	data[3] = command;
+	data[4] = reply >> 24;
+	data[5] = reply >> 16;
+	data[6] = reply >> 8;
+	data[7] = reply;
+	data[8] = checksum(data);
+
+	if(served == corruptAt)
+		data[5] ^= 4;
+
+	served++;
+}
+
+// CRC8 of the bootloader datagrams, bitwise as in the datasheet
+static uint8_t blCRC(const uint8_t *data)
+{
+	uint8_t crc = 0;
+
+	for(size_t i = 0; i < 7; i++)
+	{
+		uint8_t byte = data[i];
+
+		for(int bit = 0; bit < 8; bit++)
+		{
+			crc = (((crc >> 7) ^ (byte & 1)) != 0) ? (uint8_t) ((crc << 1) ^ 0x07) : (uint8_t) (crc << 1);
+			byte >>= 1;
+		}
+	}
+
+	return crc;
+}
+
+static uint8_t executeBlCommand(uint8_t command, uint32_t value, uint32_t *reply)
+{
+	switch(command)
+	{
+	case TMC9660_BLCMD_SET_BANK:
+		if(value >= BL_BANKS)
+			return BL_STATUS_ERROR;
+		blBank = value;
+		break;
+	case TMC9660_BLCMD_SET_ADDRESS:
+		blAddress = value;
+		break;
+	case TMC9660_BLCMD_WRITE_32_INC:
+	case TMC9660_BLCMD_READ_32_INC:
+		if(blAddress % 4 != 0 || blAddress / 4 >= BL_WORDS)
+			return BL_STATUS_ERROR;
+		// Write replies carry no value, the checksum has to use the written words
+		if(command == TMC9660_BLCMD_WRITE_32_INC)
+			blMemory[blBank][blAddress / 4] = value;
+		else
+			*reply = blMemory[blBank][blAddress / 4];
+		blAddress += 4;
+		break;
+	case TMC9660_BLCMD_FLASH_ERASE_SECTOR:
+		if(value / 4 >= BL_WORDS)
+			return BL_STATUS_ERROR;
+		for(uint32_t i = value / 4 / BL_SECTOR_WORDS * BL_SECTOR_WORDS, end = i + BL_SECTOR_WORDS; i < end; i++)
+			blMemory[blBank][i] = 0xFFFFFFFF;
+		blBusyPolls = blEraseTime;
+		break;
+	case TMC9660_BLCMD_MEM_IS_BUSY:
+		*reply = blBusyForever || blBusyPolls > 0;
+		if(blBusyPolls > 0)
+			blBusyPolls--;
+		break;
+	default:
+		return BL_STATUS_ERROR;
+	}
+
+	return 0;
+}
+
+// Replaces the bootloader request in [data] with the reply. Returns false if the reply got lost.
+// [faulted] tells whether a reply of the same stream failed before, the host ignores the replies
+// behind it. It is set if this reply gets lost or corrupted.
+static bool processBlRequest(uint8_t *data, bool *faulted)
+{
+	long request = blRequests++;
+
+	if(data[2] == TMC9660_BLCMD_SET_BANK)
+		blSetBanks++;
+	if(data[2] == TMC9660_BLCMD_MEM_IS_BUSY)
+		blBusyRequests++;
+
+	bool drop    = request == blDropAt || (blDropPeriod > 0 && request % blDropPeriod == blDropPeriod - 1);
+	bool corrupt = false;
+
+	if(!drop && !*faulted && blCleanRequests == 0)
+	{
+		drop    = randomRange(0, 99) < blDropRate;
+		corrupt = !drop && randomRange(0, 99) < blCorruptRate;
+	}
+
+	if(drop || corrupt)
+	{
+		blCleanRequests = BL_FAULT_SPACING;
+		blFaults++;
+	}
+	else if(!*faulted && blCleanRequests > 0)
+	{
+		blCleanRequests--;
+	}
+
+	*faulted |= drop || corrupt;
+
+	// The request itself got lost
+	if(drop && randomRange(0, 1) == 0)
+		return false;
+
+	uint32_t value = ((uint32_t) data[3] << 24) | ((uint32_t) data[4] << 16) | ((uint32_t) data[5] << 8) | data[6];
+	uint32_t reply = 0;
+	uint8_t status = (blCRC(data) == data[7]) ? executeBlCommand(data[2], value, &reply) : BL_STATUS_ERROR;
+
+	data[2] = status;
+	data[3] = reply >> 24;
+	data[4] = reply >> 16;
+	data[5] = reply >> 8;
+	data[6] = reply;
+	data[7] = blCRC(data);
+
+	if(corrupt)
+		data[4] ^= 0x10;
+
+	return !drop;
+}
+
+static void recordBlGap(void)
+{
+	if(blGapCount < BL_MAX_GAPS)
+		blGaps[blGapCount++] = now - replyEnd;
+}
+
+bool tmc9660_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	(void) icID;
+	(void) readLength;
+
+	if(writeLength == 8)
+	{
+		recordBlGap();
+		callbacks++;
+		now += hostOverhead + datagramTime(8);
+
+		bool faulted = false;
+		bool replied = processBlRequest(data, &faulted);
+		now += (replied) ? processing + datagramTime(8) : 5000;
+		replyEnd = now;
+
+		return replied;
+	}
+
+	callbacks++;
+	now += hostOverhead + datagramTime(9);
+
+	if(served == dropAt)
+	{
+		served++;
+		now += 5000;
+		return false;
+	}
+
+	processRequest(data);
+	now += processing + datagramTime(9);
+	replyEnd = now;
+
+	return true;
+}
+
+#if TMC9660_UART_STREAM_SUPPORT == 1
+size_t tmc9660_readWriteUARTStream(uint16_t icID, uint8_t *data, size_t datagramLength, size_t datagramCount)
+{
+	(void) icID;
+
+	bool bootloader = datagramLength == 8;
+
+	if(bootloader)
+		recordBlGap();
+
+	callbacks++;
+
+	double start    = now + hostOverhead;
+	size_t received = datagramCount;
+	bool faulted    = false;
+
+	replyEnd = start;
+
+	for(size_t i = 0; i < datagramCount; i++)
+	{
+		if(bootloader)
+		{
+			// The requests behind a lost reply still reach the chip, their replies are ignored
+			if(!processBlRequest(&data[i * datagramLength], &faulted) && received == datagramCount)
+				received = i;
+		}
+		else
+		{
+			if(served == dropAt)
+			{
+				served++;
+				now = replyEnd = replyEnd + 5000;
+				return i;
+			}
+
+			processRequest(&data[i * datagramLength]);
+		}
+
+		// Requests are sent back to back, each reply follows the processing of its request
+		double requestEnd = start + (i + 1) * datagramTime(datagramLength);
+		double replyStart = (requestEnd + processing > replyEnd)? requestEnd + processing : replyEnd;
+		replyEnd = replyStart + datagramTime(datagramLength);
+	}
+
+	if(received < datagramCount)
+		replyEnd += 5000;
+
+	now = replyEnd;
+
+	return received;
+}
+#endif
+
+TMC9660BusType tmc9660_getBusType(uint16_t icID)
+{
+	(void) icID;
+	return TMC9660_BUS_UART;
+}
+
+TMC9660BusAddresses tmc9660_getBusAddresses(uint16_t icID)
+{
+	(void) icID;
+	TMC9660BusAddresses addresses = { .device = 1, .host = 255 };
+	return addresses;
+}
+
+static void checkBatches(void)
+{
+	for(int i = 0; i < PARAMETER_COUNT; i++)
+		parameters[i] = i * 1000 + 7;
+	parameters[TMC9660_PARAM_ACTUAL_POSITION] = -123456;
+
+	TMC9660AxisState state;
+	CHECK(tmc9660_param_readAxisState(0, &state));
+	CHECK(state.actualPosition == -123456);
+	CHECK(state.actualVelocity == TMC9660_PARAM_ACTUAL_VELOCITY * 1000 + 7);
+	CHECK(state.chipTemperature == TMC9660_PARAM_CHIP_TEMPERATURE * 1000 + 7);
+	CHECK(state.adcStatusFlags == TMC9660_PARAM_ADC_STATUS_FLAGS * 1000 + 7);
+
+	// Mixed GAP/SAP with one invalid type
+	TMC9660ParamRequest requests[20];
+	for(int i = 0; i < 20; i++)
+	{
+		requests[i].cmd   = (i % 2)? TMC9660_CMD_SAP : TMC9660_CMD_GAP;
+		requests[i].type  = 10 + i;
+		requests[i].index = 0;
+		requests[i].value = 555 + i;
+	}
+	requests[3].type = VALID_TYPES + 50;
+
+	CHECK(tmc9660_param_sendCommands(0, requests, 20) == 19);
+	CHECK(requests[3].status == TMC9660_PARAMSTATUS_WRONG_TYPE);
+	CHECK(requests[0].value == 10007);
+	CHECK(parameters[11] == 556);
+	CHECK(requests[19].value == 574);
+
+	// Missing, corrupted and mismatched replies
+	served    = 0;
+	dropAt    = 5;
+	corruptAt = 2;
+	swapAt    = 8;
+	for(int i = 0; i < 12; i++)
+	{
+		requests[i].cmd  = TMC9660_CMD_GAP;
+		requests[i].type = 20 + i;
+	}
+
+	size_t replied = tmc9660_param_sendCommands(0, requests, 12);
+	CHECK(requests[2].status == -5);
+	CHECK(requests[5].status == -2);
+#if TMC9660_UART_STREAM_SUPPORT == 1
+	// The stream stops at the missing reply, the rest of the block is not sent
+	CHECK(replied == 4);
+	CHECK(requests[8].status == -2);
+#else
+	CHECK(replied == 9);
+	CHECK(requests[8].status == -6);
+	CHECK(requests[11].status == TMC9660_PARAMSTATUS_OK && requests[11].value == 31007);
+#endif
+
+	dropAt = corruptAt = swapAt = -1;
+}
+
+static void resetBlFaults(void)
+{
+	blDropAt      = -1;
+	blDropPeriod  = 0;
+	blDropRate    = 0;
+	blCorruptRate = 0;
+}
+
+static uint32_t referenceChecksum(const uint32_t *words, size_t count)
+{
+	uint32_t checksum = 0;
+
+	// Rotate left by one bit and add the word
+	for(size_t i = 0; i < count; i++)
+		checksum = ((checksum << 1) | (checksum >> 31)) + words[i];
+
+	return checksum;
+}
+
+// Transfers [count] words starting at word [first] with up to three calls sharing one running checksum
+static int32_t transferInParts(bool write, uint8_t bank, uint32_t first, uint32_t *words, size_t count, uint32_t *checksum)
+{
+	size_t done = 0;
+
+	while(done < count)
+	{
+		size_t part = randomRange(1, count - done);
+		int32_t status;
+
+		if(done == 0 && part < count)
+			part = randomRange(1, part);
+
+		if(write)
+			status = tmc9660_bl_writeMemory(0, bank, 4 * (first + done), &words[done], part, checksum);
+		else
+			status = tmc9660_bl_readMemory(0, bank, 4 * (first + done), &words[done], part, checksum);
+
+		if(status != TMC9660_BLTRANSFER_OK)
+			return status;
+
+		done += part;
+	}
+
+	return TMC9660_BLTRANSFER_OK;
+}
+
+// Writes, reads back and verifies random blocks while replies get lost and corrupted.
+// Returns false at the first mismatch.
+static bool checkBulkTransfer(void)
+{
+	static uint32_t words[BL_WORDS];
+	static uint32_t readWords[BL_WORDS];
+
+	uint8_t bank   = randomRange(0, BL_BANKS - 1);
+	size_t count   = randomRange(1, 300);
+	uint32_t first = randomRange(1, BL_WORDS - count - 1);
+
+	// Words next to the block must not be touched
+	uint32_t guardBefore = blMemory[bank][first - 1];
+	uint32_t guardAfter  = blMemory[bank][first + count];
+
+	for(size_t i = 0; i < count; i++)
+	{
+		words[i]     = randomNext();
+		readWords[i] = 0;
+	}
+
+	blDropRate    = randomRange(0, 10);
+	blCorruptRate = randomRange(0, 10);
+
+	uint32_t writeChecksum = 0;
+	uint32_t readChecksum  = 0;
+	uint32_t checksum      = referenceChecksum(words, count);
+	bool ok = true;
+
+	ok &= transferInParts(true, bank, first, words, count, &writeChecksum) == TMC9660_BLTRANSFER_OK;
+	ok &= writeChecksum == checksum;
+
+	for(size_t i = 0; i < count; i++)
+		ok &= blMemory[bank][first + i] == words[i];
+
+	ok &= blMemory[bank][first - 1] == guardBefore;
+	ok &= blMemory[bank][first + count] == guardAfter;
+
+	ok &= transferInParts(false, bank, first, readWords, count, &readChecksum) == TMC9660_BLTRANSFER_OK;
+	ok &= readChecksum == checksum;
+
+	for(size_t i = 0; i < count; i++)
+		ok &= readWords[i] == words[i];
+
+	ok &= tmc9660_bl_verifyMemory(0, bank, 4 * first, count, checksum) == TMC9660_BLTRANSFER_OK;
+	ok &= tmc9660_bl_verifyMemory(0, bank, 4 * first, count, checksum ^ 1) == TMC9660_BLTRANSFER_VERIFY_ERROR;
+
+	if(!ok)
+		printf("bank %u, words %u to %u, %d%% lost and %d%% corrupted replies\n",
+			bank, first, (uint32_t) (first + count - 1), blDropRate, blCorruptRate);
+
+	resetBlFaults();
+
+	return ok;
+}
+
+static void checkRetries(void)
+{
+	static uint32_t words[64];
+	uint32_t checksum = 0;
+
+	for(size_t i = 0; i < 64; i++)
+		words[i] = randomNext();
+
+	resetBlFaults();
+
+	// No reply at all: The first attempt and TMC9660_BL_RETRIES resumes
+	blDropPeriod = 1;
+	blSetBanks   = 0;
+	CHECK(tmc9660_bl_writeMemory(0, 0, 0, words, 64, &checksum) == TMC9660_BLTRANSFER_BUS_ERROR);
+	CHECK(blSetBanks == TMC9660_BL_RETRIES + 1);
+	CHECK(checksum == 0);
+
+	// Bank and address are set, but the first word fails every time
+	blDropPeriod = 3;
+	blRequests   = 0;
+	blSetBanks   = 0;
+	CHECK(tmc9660_bl_writeMemory(0, 0, 0, words, 64, &checksum) == TMC9660_BLTRANSFER_BUS_ERROR);
+	CHECK(blSetBanks == TMC9660_BL_RETRIES + 1);
+	CHECK(checksum == 0);
+
+	// Failures with progress in between do not count as retries
+	blDropPeriod = 5;
+	blRequests   = 0;
+	CHECK(tmc9660_bl_writeMemory(0, 0, 0, words, 64, &checksum) == TMC9660_BLTRANSFER_OK);
+	CHECK(checksum == referenceChecksum(words, 64));
+	CHECK(blMemory[0][0] == words[0] && blMemory[0][63] == words[63]);
+
+	resetBlFaults();
+
+	// Error replies are not retried
+	blSetBanks = 0;
+	CHECK(tmc9660_bl_readMemory(0, BL_BANKS, 0, words, 8, NULL) == TMC9660_BLTRANSFER_COMMAND_ERROR);
+	CHECK(blSetBanks == 1);
+
+	// Past the end of the memory
+	CHECK(tmc9660_bl_writeMemory(0, 1, 4 * (BL_WORDS - 2), words, 4, NULL) == TMC9660_BLTRANSFER_COMMAND_ERROR);
+	CHECK(blMemory[1][BL_WORDS - 1] == words[1]);
+}
+
+static void checkErase(void)
+{
+	double pollTime = hostOverhead + 2 * datagramTime(8) + processing + TMC9660_BL_PACING_GAP_DEFAULT;
+
+	resetBlFaults();
+
+	for(uint32_t i = 0; i < BL_WORDS; i++)
+		blMemory[1][i] = i;
+
+	// Sector 1, the address does not need to be aligned
+	blEraseTime    = 7;
+	blBusyRequests = 0;
+	CHECK(tmc9660_bl_eraseFlashSector(0, 1, 4 * BL_SECTOR_WORDS + 40, 1000000) == TMC9660_BLTRANSFER_OK);
+	CHECK(blBusyRequests == 8);
+	CHECK(blMemory[1][BL_SECTOR_WORDS - 1] == BL_SECTOR_WORDS - 1);
+	CHECK(blMemory[1][BL_SECTOR_WORDS] == 0xFFFFFFFF);
+	CHECK(blMemory[1][2 * BL_SECTOR_WORDS - 1] == 0xFFFFFFFF);
+	CHECK(blMemory[1][2 * BL_SECTOR_WORDS] == 2 * BL_SECTOR_WORDS);
+	CHECK(tmc9660_bl_verifyMemory(0, 1, 4 * BL_SECTOR_WORDS, 1, 0xFFFFFFFF) == TMC9660_BLTRANSFER_OK);
+
+	// Still busy after the timeout, the last poll starts before the timeout has passed
+	blBusyForever = true;
+	double start = now;
+	CHECK(tmc9660_bl_waitWhileBusy(0, 20000) == TMC9660_BLTRANSFER_TIMEOUT);
+	CHECK(now - start >= 20000);
+	CHECK(now - start < 20000 + 2 * pollTime);
+	blBusyForever = false;
+
+	// A lost MEM_IS_BUSY reply: SET_BANK, FLASH_ERASE_SECTOR, two polls, lost poll
+	blEraseTime = 5;
+	blRequests  = 0;
+	blDropAt    = 4;
+	CHECK(tmc9660_bl_eraseFlashSector(0, 1, 0, 1000000) == TMC9660_BLTRANSFER_BUS_ERROR);
+	resetBlFaults();
+	blBusyPolls = 0;
+
+	CHECK(tmc9660_bl_eraseFlashSector(0, BL_BANKS, 0, 1000000) == TMC9660_BLTRANSFER_COMMAND_ERROR);
+}
+
+static bool isGapBetween(long first, long last, double min, double max)
+{
+	for(long i = first; i <= last && i < blGapCount; i++)
+	{
+		if(blGaps[i] < min - 1 || blGaps[i] > max + 1)
+			return false;
+	}
+
+	return true;
+}
+
+static void checkPacing(void)
+{
+	static uint32_t words[BL_WORDS];
+	const size_t blockSize = (TMC9660_UART_STREAM_SUPPORT == 1) ? TMC9660_UART_STREAM_SIZE : 1;
+	const double failedMinGap = TMC9660_BL_PACING_GAP_DEFAULT + TMC9660_BL_PACING_GAP_DEFAULT / 4 + 1;
+
+	for(size_t i = 0; i < BL_WORDS; i++)
+		words[i] = randomNext();
+
+	resetBlFaults();
+
+	// Reliable line: SET_BANK and SET_ADDRESS wait the default gap, the words at least the minimum
+	tmc9660_bl_resetPacing(0);
+	blGapCount = 0;
+	CHECK(tmc9660_bl_writeMemory(0, 0, 0, words, 64, NULL) == TMC9660_BLTRANSFER_OK);
+	CHECK(isGapBetween(1, 1, TMC9660_BL_PACING_GAP_DEFAULT, TMC9660_BL_PACING_GAP_DEFAULT));
+	CHECK(isGapBetween(2, blGapCount - 1, TMC9660_BL_PACING_GAP_MIN, TMC9660_BL_PACING_GAP_DEFAULT));
+
+	// Without replies the gap doubles after each failure, up to TMC9660_BL_PACING_GAP_MAX
+	blDropPeriod = 1;
+	blGapCount   = 0;
+	for(int i = 0; i < 3; i++)
+		CHECK(tmc9660_bl_writeMemory(0, 0, 0, words, 64, NULL) == TMC9660_BLTRANSFER_BUS_ERROR);
+
+	bool doubled = true;
+	for(long i = 1; i < blGapCount; i++)
+	{
+		double expected = (2 * blGaps[i - 1] < TMC9660_BL_PACING_GAP_MAX) ? 2 * blGaps[i - 1] : TMC9660_BL_PACING_GAP_MAX;
+		doubled &= blGaps[i] >= expected - 2 && blGaps[i] <= TMC9660_BL_PACING_GAP_MAX + 1;
+	}
+	CHECK(doubled);
+	CHECK(blGaps[blGapCount - 1] >= TMC9660_BL_PACING_GAP_MAX - 1);
+
+	// The reset forgets the back-off. One lost reply of the first word doubles the gap, then it shrinks
+	// again but stays above 5/4 of the failed gap for the next 200 blocks.
+	resetBlFaults();
+	tmc9660_bl_resetPacing(0);
+	blRequests = 0;
+	blDropAt   = 2;
+	blGapCount = 0;
+	CHECK(tmc9660_bl_writeMemory(0, 0, 0, words, 200 * blockSize, NULL) == TMC9660_BLTRANSFER_OK);
+	CHECK(isGapBetween(0, 2, 0, TMC9660_BL_PACING_GAP_DEFAULT));
+	CHECK(isGapBetween(3, 3, 2 * TMC9660_BL_PACING_GAP_DEFAULT, 2 * TMC9660_BL_PACING_GAP_DEFAULT));
+	CHECK(isGapBetween(4, blGapCount - 1, failedMinGap, 2 * TMC9660_BL_PACING_GAP_DEFAULT));
+	CHECK(isGapBetween(blGapCount - 1, blGapCount - 1, failedMinGap, failedMinGap));
+	CHECK(blGapCount >= 200);
+
+	resetBlFaults();
+	tmc9660_bl_resetPacing(0);
+}
+
+static void checkBootloader(int transfers)
+{
+	int failed = 0;
+
+	for(int i = 0; i < transfers; i++)
+		failed += !checkBulkTransfer();
+
+	CHECK(failed == 0);
+
+	checkRetries();
+	checkErase();
+	checkPacing();
+
+	printf("%d bulk transfers with %ld lost or corrupted bootloader replies, %d failed\n", transfers, blFaults, failed);
+}
+
+static void benchmark(double baud)
+{
+	static const uint16_t types[] = {
+		TMC9660_PARAM_ACTUAL_POSITION, TMC9660_PARAM_ACTUAL_VELOCITY, TMC9660_PARAM_ACTUAL_TORQUE,
+		TMC9660_PARAM_ACTUAL_FLUX, TMC9660_PARAM_ACTUAL_TOTAL_MOTOR_CURRENT, TMC9660_PARAM_SUPPLY_VOLTAGE,
+		TMC9660_PARAM_CHIP_TEMPERATURE, TMC9660_PARAM_EXTERNAL_TEMPERATURE, TMC9660_PARAM_GENERAL_STATUS_FLAGS,
+		TMC9660_PARAM_GENERAL_ERROR_FLAGS, TMC9660_PARAM_GDRV_ERROR_FLAGS, TMC9660_PARAM_ADC_STATUS_FLAGS
+	};
+	const int repetitions = 100;
+	TMC9660AxisState state;
+
+	baudrate = baud;
+
+	double t0 = now;
+	long c0 = callbacks;
+	for(int n = 0; n < repetitions; n++)
+	{
+		for(size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+			tmc9660_param_getParameter(0, types[i]);
+	}
+
+	double t1 = now;
+	long c1 = callbacks;
+	for(int n = 0; n < repetitions; n++)
+		CHECK(tmc9660_param_readAxisState(0, &state));
+	double t2 = now;
+
+	printf("%7.0f baud, 12 values: getParameter %7.0f us (%ld callbacks), readAxisState %7.0f us (%ld callbacks), %.2fx\n",
+		baud, (t1 - t0) / repetitions, (c1 - c0) / repetitions, (t2 - t1) / repetitions,
+		(callbacks - c1) / repetitions, (t1 - t0) / (t2 - t1));
+}
+
+int main(void)
+{
+	printf("TMC9660_UART_STREAM_SUPPORT %d, host overhead %.0f us, processing %.0f us\n",
+		TMC9660_UART_STREAM_SUPPORT, hostOverhead, processing);
+
+	checkBatches();
+	checkBootloader(400);
+	benchmark(115200);
+	benchmark(1000000);
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
@@ -0,0 +1,647 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+// Checks the TMC9660 SPI datagrams against a simulated endpoint: Single parameter and
+// register mode commands, the special commands, batches with tmc9660_param_sendCommands()
+// and the bootloader bulk transfers. Built with TMC_API_TMC9660_SPI_SUPPORTED.
+//
+// Each datagram shifts out the reply to the previous request. The parameter mode
+// endpoint needs a fixed processing time per request. Datagrams arriving meanwhile
+// read TMC9660_SPI_REPLY_BUSY and their request is dropped. The benchmark compares
+// 12 tmc9660_param_getParameter() calls with one batch for a processing time below
+// and above the host overhead. The bootloader replies without delay. The time is simulated, not measured, and the layouts are the ones
+// documented in TMC9660.c, not checked against hardware.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tmc/ic/TMC9660/TMC9660.h"
+#include "tmc/ic/TMC9660/TMC9660_PARAM_HW_Abstraction.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if(!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+#define PARAMETER_COUNT  512
+#define VALID_TYPES      400
+
+// Register mode commands of the simulated endpoint
+#define REG_CMD_WRITE    1
+#define REG_CMD_READ     2
+#define REG_BLOCKS       4
+#define REG_OFFSETS      2048
+
+#define TMCL_MEMORY_SIZE  16
+
+// Simulated endpoint state, times in µs
+static double now          = 0;
+static double spiClock     = 1000000;
+static double hostOverhead = 5;
+static double processing   = 3;
+
+static bool bootloaderMode = false;
+static uint8_t pending[8];      // Reply shifted out with the next datagram
+static double busyUntil    = 0;
+static bool stalled        = false;
+
+static int32_t parameters[PARAMETER_COUNT];
+static uint32_t registers[REG_BLOCKS][REG_OFFSETS];
+static uint8_t tmclMemory[TMCL_MEMORY_SIZE][7];
+static long datagrams   = 0;
+static long busyReplies = 0;
+static long served      = 0;
+
+// Index of the request whose reply is corrupted, answered for another command or never
+// finished, the firmware stays busy after it (-1: none)
+static long corruptAt = -1;
+static long swapAt    = -1;
+static long stallAt   = -1;
+
+// Bootloader endpoint
+#define BL_BANKS         2
+#define BL_WORDS         4096
+#define BL_SECTOR_WORDS  1024
+#define BL_STATUS_ERROR  1
+
+static uint32_t blMemory[BL_BANKS][BL_WORDS];
+static uint8_t blPending[5];
+static uint32_t blBank      = 0;
+static uint32_t blAddress   = 0;
+static uint32_t blBusyPolls = 0;   // MEM_IS_BUSY replies with busy set after an erase
+static uint32_t blEraseTime = 0;   // Busy polls of the next erase
+static long blBusyRequests  = 0;
+
+static uint64_t randomState = 88172645463325252ull;
+
+static uint64_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static int64_t randomRange(int64_t min, int64_t max)
+{
+	return min + (int64_t) (randomNext() % (uint64_t) (max - min + 1));
+}
+
+uint32_t tmc_getMicrosecondTimestamp()
+{
+	now += 0.05;
+	return (uint32_t) now;
+}
+
+static uint8_t checksum(const uint8_t *data)
+{
+	uint8_t sum = 0;
+	for(size_t i = 0; i < 7; i++)
+		sum += data[i];
+
+	return sum;
+}
+
+// Stores the reply to [request] in [reply]. Returns false if the request has no reply.
+static bool processRequest(const uint8_t *request, uint8_t *reply)
+{
+	uint8_t command = request[0];
+	uint16_t type   = request[1] | ((request[2] >> 4) << 8);
+	uint8_t index   = request[2] & 0x0F;
+	uint16_t offset = request[1] | ((request[2] >> 5) << 8);
+	uint8_t block   = request[2] & 0x1F;
+	uint32_t value  = ((uint32_t) request[3] << 24) | ((uint32_t) request[4] << 16) | ((uint32_t) request[5] << 8) | request[6];
+	uint8_t status  = TMC9660_PARAMSTATUS_OK;
+	uint32_t result = 0;
+
+	bool valid = checksum(request) == request[7];
+
+	if(valid && command == TMC9660_CMD_GET_VERSION)
+	{
+		for(size_t i = 0; i < 8; i++)
+			reply[i] = "9660V102"[i];
+
+		served++;
+		return true;
+	}
+
+	if(valid && command == TMC9660_CMD_READ_MEM)
+	{
+		for(size_t i = 0; i < 7; i++)
+			reply[i] = tmclMemory[value % TMCL_MEMORY_SIZE][i];
+		reply[7] = checksum(reply);
+
+		served++;
+		return true;
+	}
+
+	if(valid && command == TMC9660_CMD_BOOT && type == 0x981 && index == 2 && value == 0xA3B4C5D6)
+	{
+		bootloaderMode = true;
+
+		served++;
+		return false;
+	}
+
+	if(!valid)
+		status = TMC9660_PARAMSTATUS_CHKERROR;
+	else if(command == REG_CMD_READ || command == REG_CMD_WRITE)
+	{
+		if(block >= REG_BLOCKS || offset >= REG_OFFSETS)
+			status = TMC9660_PARAMSTATUS_WRONG_TYPE;
+		else if(command == REG_CMD_READ)
+			result = registers[block][offset];
+		else
+			registers[block][offset] = result = value;
+	}
+	else if(type >= VALID_TYPES)
+		status = TMC9660_PARAMSTATUS_WRONG_TYPE;
+	else if(command == TMC9660_CMD_GAP || command == TMC9660_CMD_GGP)
+		result = parameters[type];
+	else if(command == TMC9660_CMD_SAP || command == TMC9660_CMD_SGP)
+		parameters[type] = result = value;
+	else
+		status = TMC9660_PARAMSTATUS_INVALID_CMD;
+
+	if(served == swapAt)
+		command ^= 1;
+
+	reply[0] = 0;
+	reply[1] = status;
+	reply[2] = command;
+	reply[3] = result >> 24;
+	reply[4] = result >> 16;
+	reply[5] = result >> 8;
+	reply[6] = result;
+	reply[7] = checksum(reply);
+
+	if(served == corruptAt)
+		reply[4] ^= 4;
+
+	if(served == stallAt)
+		stalled = true;
+
+	served++;
+
+	return true;
+}
+
+static uint8_t executeBlCommand(uint8_t command, uint32_t value, uint32_t *reply)
+{
+	switch(command)
+	{
+	case TMC9660_BLCMD_NO_OP:
+		break;
+	case TMC9660_BLCMD_SET_BANK:
+		if(value >= BL_BANKS)
+			return BL_STATUS_ERROR;
+		blBank = value;
+		break;
+	case TMC9660_BLCMD_GET_BANK:
+		*reply = blBank;
+		break;
+	case TMC9660_BLCMD_SET_ADDRESS:
+		blAddress = value;
+		break;
+	case TMC9660_BLCMD_WRITE_32_INC:
+	case TMC9660_BLCMD_READ_32_INC:
+		if(blAddress % 4 != 0 || blAddress / 4 >= BL_WORDS)
+			return BL_STATUS_ERROR;
+		// Write replies carry no value, the checksum has to use the written words
+		if(command == TMC9660_BLCMD_WRITE_32_INC)
+			blMemory[blBank][blAddress / 4] = value;
+		else
+			*reply = blMemory[blBank][blAddress / 4];
+		blAddress += 4;
+		break;
+	case TMC9660_BLCMD_FLASH_ERASE_SECTOR:
+		if(value / 4 >= BL_WORDS)
+			return BL_STATUS_ERROR;
+		for(uint32_t i = value / 4 / BL_SECTOR_WORDS * BL_SECTOR_WORDS, end = i + BL_SECTOR_WORDS; i < end; i++)
+			blMemory[blBank][i] = 0xFFFFFFFF;
+		blBusyPolls = blEraseTime;
+		break;
+	case TMC9660_BLCMD_MEM_IS_BUSY:
+		blBusyRequests++;
+		*reply = blBusyPolls > 0;
+		if(blBusyPolls > 0)
+			blBusyPolls--;
+		break;
+	default:
+		return BL_STATUS_ERROR;
+	}
+
+	return 0;
+}
+
+void tmc9660_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	(void) icID;
+
+	datagrams++;
+	now += hostOverhead;
+
+	double start = now;
+	now += dataLength * 8 * 1e6 / spiClock;
+
+	if(bootloaderMode)
+	{
+		CHECK(dataLength == 5);
+
+		uint32_t value = ((uint32_t) data[1] << 24) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 8) | data[4];
+		uint32_t reply = 0;
+		uint8_t status = executeBlCommand(data[0], value, &reply);
+
+		for(size_t i = 0; i < 5; i++)
+			data[i] = blPending[i];
+
+		blPending[0] = status;
+		blPending[1] = reply >> 24;
+		blPending[2] = reply >> 16;
+		blPending[3] = reply >> 8;
+		blPending[4] = reply;
+
+		return;
+	}
+
+	CHECK(dataLength == 8);
+
+	// Still processing: The request is dropped
+	if(stalled || start < busyUntil)
+	{
+		busyReplies++;
+
+		for(size_t i = 0; i < 8; i++)
+			data[i] = TMC9660_SPI_REPLY_BUSY;
+
+		return;
+	}
+
+	uint8_t request[8];
+	bool nop = true;
+
+	for(size_t i = 0; i < 8; i++)
+	{
+		request[i] = data[i];
+		data[i]    = pending[i];
+		pending[i] = 0;
+		nop &= request[i] == 0;
+	}
+
+	if(!nop && processRequest(request, pending))
+		busyUntil = now + processing;
+}
+
+bool tmc9660_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	(void) icID;
+	(void) data;
+	(void) writeLength;
+	(void) readLength;
+
+	// All datagrams have to go via SPI
+	failures++;
+	printf("FAIL: UART callback used\n");
+
+	return false;
+}
+
+TMC9660BusType tmc9660_getBusType(uint16_t icID)
+{
+	(void) icID;
+	return TMC9660_BUS_SPI;
+}
+
+TMC9660BusAddresses tmc9660_getBusAddresses(uint16_t icID)
+{
+	(void) icID;
+	TMC9660BusAddresses addresses = { .device = 1, .host = 255 };
+	return addresses;
+}
+
+static void resetFaults(void)
+{
+	corruptAt = swapAt = stallAt = -1;
+	stalled   = false;
+	busyUntil = 0;
+}
+
+static void checkSingleCommands(void)
+{
+	uint32_t value = 0;
+	long start = datagrams;
+
+	for(int i = 0; i < PARAMETER_COUNT; i++)
+		parameters[i] = i * 1000 + 7;
+
+	// Request and NOP
+	CHECK(tmc9660_param_getParameter(0, 123) == 123007);
+	CHECK(datagrams - start == 2);
+
+	CHECK(tmc9660_param_setParameter(0, 0x123, 0xDEADBEEF));
+	CHECK(parameters[0x123] == (int32_t) 0xDEADBEEF);
+	CHECK(tmc9660_param_getGlobalParameter(0, 0x123) == 0xDEADBEEF);
+	CHECK(tmc9660_param_setGlobalParameter(0, 5, 42) && parameters[5] == 42);
+
+	CHECK(tmc9660_param_sendCommand(0, TMC9660_CMD_GAP, VALID_TYPES, 0, 0, &value) == TMC9660_PARAMSTATUS_WRONG_TYPE);
+	CHECK(tmc9660_param_sendCommand(0, TMC9660_CMD_STOP, 1, 0, 0, &value) == TMC9660_PARAMSTATUS_INVALID_CMD);
+
+	// Register mode, offsets above 8 bits and the block share the second type byte
+	CHECK(tmc9660_reg_sendCommand(0, REG_CMD_WRITE, 0x5A3, 3, 0x12345678, NULL) == TMC9660_PARAMSTATUS_OK);
+	CHECK(registers[3][0x5A3] == 0x12345678);
+	CHECK(tmc9660_reg_sendCommand(0, REG_CMD_WRITE, 0x0A3, 2, 99, NULL) == TMC9660_PARAMSTATUS_OK);
+	CHECK(tmc9660_reg_sendCommand(0, REG_CMD_READ, 0x5A3, 3, 0, &value) == TMC9660_PARAMSTATUS_OK);
+	CHECK(value == 0x12345678);
+	CHECK(registers[2][0x0A3] == 99);
+
+	// Special commands reply with 8 data bytes
+	uint8_t version[8] = { 0 };
+	CHECK(tmc9660_param_getVersionASCII(0, version) == 0);
+	CHECK(version[0] == '9' && version[4] == 'V' && version[7] == '2');
+	CHECK(tmc9660_reg_getVersionASCII(0, version) == 0);
+	CHECK(version[3] == '0');
+
+	uint8_t command[7] = { 0 };
+	for(size_t i = 0; i < 7; i++)
+		tmclMemory[3][i] = 0x30 + i;
+	CHECK(tmc9660_param_readTMCLMemory(0, 3, command) == 0);
+	CHECK(command[0] == 0x30 && command[6] == 0x36);
+
+	// Corrupted and mismatched replies
+	served    = 0;
+	corruptAt = 0;
+	CHECK(tmc9660_param_sendCommand(0, TMC9660_CMD_GAP, 1, 0, 0, &value) == -5);
+	swapAt = 1;
+	CHECK(tmc9660_param_sendCommand(0, TMC9660_CMD_GAP, 1, 0, 0, &value) == -6);
+	resetFaults();
+
+	CHECK(busyReplies == 0);
+}
+
+static void checkBatches(void)
+{
+	for(int i = 0; i < PARAMETER_COUNT; i++)
+		parameters[i] = i * 1000 + 7;
+	parameters[TMC9660_PARAM_ACTUAL_POSITION] = -123456;
+
+	// 12 requests and a NOP
+	long start = datagrams;
+	TMC9660AxisState state;
+	CHECK(tmc9660_param_readAxisState(0, &state));
+	CHECK(datagrams - start == 13);
+	CHECK(state.actualPosition == -123456);
+	CHECK(state.actualVelocity == TMC9660_PARAM_ACTUAL_VELOCITY * 1000 + 7);
+	CHECK(state.chipTemperature == TMC9660_PARAM_CHIP_TEMPERATURE * 1000 + 7);
+	CHECK(state.adcStatusFlags == TMC9660_PARAM_ADC_STATUS_FLAGS * 1000 + 7);
+
+	// Mixed GAP/SAP with one invalid type
+	TMC9660ParamRequest requests[20];
+	for(int i = 0; i < 20; i++)
+	{
+		requests[i].cmd   = (i % 2)? TMC9660_CMD_SAP : TMC9660_CMD_GAP;
+		requests[i].type  = 10 + i;
+		requests[i].index = 0;
+		requests[i].value = 555 + i;
+	}
+	requests[3].type = VALID_TYPES + 50;
+
+	CHECK(tmc9660_param_sendCommands(0, requests, 20) == 19);
+	CHECK(requests[3].status == TMC9660_PARAMSTATUS_WRONG_TYPE);
+	CHECK(requests[0].value == 10007);
+	CHECK(parameters[11] == 556);
+	CHECK(requests[19].value == 574);
+	CHECK(tmc9660_param_sendCommands(0, requests, 0) == 0);
+
+	// Corrupted and mismatched replies do not affect the following requests
+	for(int i = 0; i < 12; i++)
+	{
+		requests[i].cmd  = TMC9660_CMD_GAP;
+		requests[i].type = 20 + i;
+	}
+
+	served    = 0;
+	corruptAt = 2;
+	swapAt    = 8;
+	CHECK(tmc9660_param_sendCommands(0, requests, 12) == 10);
+	CHECK(requests[2].status == -5);
+	CHECK(requests[8].status == -6);
+	CHECK(requests[11].status == TMC9660_PARAMSTATUS_OK && requests[11].value == 31007);
+	resetFaults();
+
+	CHECK(busyReplies == 0);
+
+	// The firmware hangs after request 5: Its reply and all following requests are lost
+	served  = 0;
+	stallAt = 5;
+	start   = datagrams;
+	CHECK(tmc9660_param_sendCommands(0, requests, 12) == 5);
+	CHECK(requests[4].status == TMC9660_PARAMSTATUS_OK && requests[4].value == 24007);
+	CHECK(requests[5].status == -2);
+	CHECK(requests[11].status == -2);
+	CHECK(datagrams - start == 6 + TMC9660_SPI_REPLY_POLLS);
+	resetFaults();
+}
+
+static void checkBusyPolling(void)
+{
+	uint32_t value = 0;
+
+	// Slower than a datagram: Requests sent while busy are dropped and resent
+	processing  = 300;
+	busyReplies = 0;
+	CHECK(tmc9660_param_getParameter(0, 77) == 77007);
+	CHECK(busyReplies > 0);
+
+	TMC9660AxisState state;
+	CHECK(tmc9660_param_readAxisState(0, &state));
+	CHECK(state.actualVelocity == TMC9660_PARAM_ACTUAL_VELOCITY * 1000 + 7);
+	CHECK(state.adcStatusFlags == TMC9660_PARAM_ADC_STATUS_FLAGS * 1000 + 7);
+	CHECK(tmc9660_reg_sendCommand(0, REG_CMD_READ, 0x5A3, 3, 0, &value) == TMC9660_PARAMSTATUS_OK);
+	CHECK(value == 0x12345678);
+	processing = 3;
+
+	// Never ready: The request is given up after TMC9660_SPI_REPLY_POLLS polls
+	stalled = true;
+	long start = datagrams;
+	CHECK(tmc9660_param_sendCommand(0, TMC9660_CMD_GAP, 1, 0, 0, &value) == -2);
+	CHECK(datagrams - start == 1 + TMC9660_SPI_REPLY_POLLS);
+
+	TMC9660ParamRequest requests[3] = {
+		{ .cmd = TMC9660_CMD_GAP, .type = 1 },
+		{ .cmd = TMC9660_CMD_GAP, .type = 2 },
+		{ .cmd = TMC9660_CMD_GAP, .type = 3 },
+	};
+	CHECK(tmc9660_param_sendCommands(0, requests, 3) == 0);
+	CHECK(requests[0].status == -2 && requests[2].status == -2);
+	resetFaults();
+}
+
+static uint32_t referenceChecksum(const uint32_t *words, size_t count)
+{
+	uint32_t checksum = 0;
+
+	// Rotate left by one bit and add the word
+	for(size_t i = 0; i < count; i++)
+		checksum = ((checksum << 1) | (checksum >> 31)) + words[i];
+
+	return checksum;
+}
+
+// Writes, reads back and verifies a random block. Returns false at the first mismatch.
+static bool checkBulkTransfer(void)
+{
+	static uint32_t words[BL_WORDS];
+	static uint32_t readWords[BL_WORDS];
+
+	uint8_t bank   = randomRange(0, BL_BANKS - 1);
+	size_t count   = randomRange(1, 300);
+	uint32_t first = randomRange(1, BL_WORDS - count - 1);
+
+	// Words next to the block must not be touched
+	uint32_t guardBefore = blMemory[bank][first - 1];
+	uint32_t guardAfter  = blMemory[bank][first + count];
+
+	for(size_t i = 0; i < count; i++)
+	{
+		words[i]     = randomNext();
+		readWords[i] = 0;
+	}
+
+	uint32_t writeChecksum = 0;
+	uint32_t readChecksum  = 0;
+	uint32_t checksum      = referenceChecksum(words, count);
+	bool ok = true;
+
+	// SET_BANK, SET_ADDRESS, each with a NO_OP, and all words pipelined
+	long start = datagrams;
+	ok &= tmc9660_bl_writeMemory(0, bank, 4 * first, words, count, &writeChecksum) == TMC9660_BLTRANSFER_OK;
+	ok &= datagrams - start == (long) count + 5;
+	ok &= writeChecksum == checksum;
+
+	for(size_t i = 0; i < count; i++)
+		ok &= blMemory[bank][first + i] == words[i];
+
+	ok &= blMemory[bank][first - 1] == guardBefore;
+	ok &= blMemory[bank][first + count] == guardAfter;
+
+	ok &= tmc9660_bl_readMemory(0, bank, 4 * first, readWords, count, &readChecksum) == TMC9660_BLTRANSFER_OK;
+	ok &= readChecksum == checksum;
+
+	for(size_t i = 0; i < count; i++)
+		ok &= readWords[i] == words[i];
+
+	ok &= tmc9660_bl_verifyMemory(0, bank, 4 * first, count, checksum) == TMC9660_BLTRANSFER_OK;
+	ok &= tmc9660_bl_verifyMemory(0, bank, 4 * first, count, checksum ^ 1) == TMC9660_BLTRANSFER_VERIFY_ERROR;
+
+	if(!ok)
+		printf("bank %u, words %u to %u\n", bank, first, (uint32_t) (first + count - 1));
+
+	return ok;
+}
+
+static void checkBootloader(int transfers)
+{
+	static uint32_t words[8];
+	uint32_t value = 0;
+
+	// Parameter mode to bootloader: One request without a reply
+	long start = datagrams;
+	CHECK(tmc9660_param_returnToBootloader(0) == 0);
+	CHECK(bootloaderMode);
+	CHECK(datagrams - start == 1);
+
+	start = datagrams;
+	CHECK(tmc9660_bl_sendCommand(0, TMC9660_BLCMD_SET_BANK, 1, NULL) == 0);
+	CHECK(tmc9660_bl_sendCommand(0, TMC9660_BLCMD_GET_BANK, 0, &value) == 0);
+	CHECK(value == 1);
+	CHECK(datagrams - start == 4);
+	CHECK(tmc9660_bl_sendCommand(0, TMC9660_BLCMD_SET_BANK, BL_BANKS, NULL) == BL_STATUS_ERROR);
+
+	int failed = 0;
+	for(int i = 0; i < transfers; i++)
+		failed += !checkBulkTransfer();
+
+	CHECK(failed == 0);
+
+	for(size_t i = 0; i < 8; i++)
+		words[i] = randomNext();
+
+	// Error replies, past the end of the memory the transfer stops at the first failed word
+	CHECK(tmc9660_bl_readMemory(0, BL_BANKS, 0, words, 8, NULL) == TMC9660_BLTRANSFER_COMMAND_ERROR);
+
+	uint32_t checksum = 0;
+	CHECK(tmc9660_bl_writeMemory(0, 1, 4 * (BL_WORDS - 2), words, 4, &checksum) == TMC9660_BLTRANSFER_COMMAND_ERROR);
+	CHECK(blMemory[1][BL_WORDS - 1] == words[1]);
+	CHECK(checksum == referenceChecksum(words, 2));
+
+	// Erase sector 1 and poll MEM_IS_BUSY
+	for(uint32_t i = 0; i < BL_WORDS; i++)
+		blMemory[1][i] = i;
+
+	blEraseTime    = 7;
+	blBusyRequests = 0;
+	CHECK(tmc9660_bl_eraseFlashSector(0, 1, 4 * BL_SECTOR_WORDS + 40, 1000000) == TMC9660_BLTRANSFER_OK);
+	CHECK(blBusyRequests == 8);
+	CHECK(blMemory[1][BL_SECTOR_WORDS - 1] == BL_SECTOR_WORDS - 1);
+	CHECK(blMemory[1][BL_SECTOR_WORDS] == 0xFFFFFFFF);
+	CHECK(blMemory[1][2 * BL_SECTOR_WORDS - 1] == 0xFFFFFFFF);
+	CHECK(blMemory[1][2 * BL_SECTOR_WORDS] == 2 * BL_SECTOR_WORDS);
+	CHECK(tmc9660_bl_verifyMemory(0, 1, 4 * BL_SECTOR_WORDS, 1, 0xFFFFFFFF) == TMC9660_BLTRANSFER_OK);
+	CHECK(tmc9660_bl_eraseFlashSector(0, BL_BANKS, 0, 1000000) == TMC9660_BLTRANSFER_COMMAND_ERROR);
+
+	printf("%d bulk transfers, %d failed\n", transfers, failed);
+}
+
+static void benchmark(double clock, double processingTime)
+{
+	static const uint16_t types[] = {
+		TMC9660_PARAM_ACTUAL_POSITION, TMC9660_PARAM_ACTUAL_VELOCITY, TMC9660_PARAM_ACTUAL_TORQUE,
+		TMC9660_PARAM_ACTUAL_FLUX, TMC9660_PARAM_ACTUAL_TOTAL_MOTOR_CURRENT, TMC9660_PARAM_SUPPLY_VOLTAGE,
+		TMC9660_PARAM_CHIP_TEMPERATURE, TMC9660_PARAM_EXTERNAL_TEMPERATURE, TMC9660_PARAM_GENERAL_STATUS_FLAGS,
+		TMC9660_PARAM_GENERAL_ERROR_FLAGS, TMC9660_PARAM_GDRV_ERROR_FLAGS, TMC9660_PARAM_ADC_STATUS_FLAGS
+	};
+	const int repetitions = 100;
+	TMC9660AxisState state;
+
+	spiClock   = clock;
+	processing = processingTime;
+
+	double t0 = now;
+	long d0 = datagrams;
+	for(int n = 0; n < repetitions; n++)
+	{
+		for(size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+			tmc9660_param_getParameter(0, types[i]);
+	}
+
+	double t1 = now;
+	long d1 = datagrams;
+	for(int n = 0; n < repetitions; n++)
+		CHECK(tmc9660_param_readAxisState(0, &state));
+	double t2 = now;
+
+	processing = 3;
+
+	printf("%4.1f MHz, processing %2.0f us, 12 values: getParameter %5.0f us (%ld datagrams), readAxisState %5.0f us (%ld datagrams), %.2fx\n",
+		clock / 1e6, processingTime, (t1 - t0) / repetitions, (d1 - d0) / repetitions, (t2 - t1) / repetitions,
+		(datagrams - d1) / repetitions, (t1 - t0) / (t2 - t1));
+}
+
+int main(void)
+{
+	printf("SPI host overhead %.0f us\n", hostOverhead);
+
+	checkSingleCommands();
+	checkBatches();
+	checkBusyPolling();
+	benchmark(1000000, 3);
+	benchmark(10000000, 3);
+	benchmark(1000000, 30);
+	benchmark(10000000, 30);
+	checkBootloader(200);
+
+	printf("%d failures\n", failures);
+
+	return failures != 0;
+}
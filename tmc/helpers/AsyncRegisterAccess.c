@@ -0,0 +1,371 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+#include "AsyncRegisterAccess.h"
+
+// Shared reflected CRC table of the UART datagrams, defined by helpers/CRCTables.c
+// or by a UART driver built without TMC_API_EXTERNAL_CRC_TABLE
+extern const uint8_t tmcCRCTable_Poly7Reflected[256];
+
+#define ADDRESS_MASK  0x7F
+#define WRITE_BIT     0x80
+
+#define UART_SYNC            0x05
+#define UART_MASTER_ADDRESS  0xFF
+
+#define NO_SLOT  (-1)
+
+#define HANDLE_SLOT_BITS   8
+#define HANDLE_SLOT_MASK   0xFF
+#define GENERATION_MASK    0x7FFF
+
+#if TMC_ASYNC_QUEUE_LENGTH > 256
+#error "TMC_ASYNC_QUEUE_LENGTH: handles hold the slot index in 8 bits"
+#endif
+
+static void startNext(TMCAsyncBus *bus);
+static TMCAsyncHandle submit(TMCAsyncBus *bus, uint16_t icID, uint8_t address, bool isWrite, int32_t value, tmc_async_callback callback, void *context);
+static void finish(TMCAsyncBus *bus, int16_t slot, bool success, int32_t value);
+static int32_t decodeUARTReply(TMCAsyncBus *bus, uint8_t address, bool *success);
+static uint8_t CRC8(uint8_t *data, uint32_t bytes);
+static TMCAsyncHandle makeHandle(TMCAsyncBus *bus, int16_t slot);
+static TMCAsyncRequest *getRequest(TMCAsyncBus *bus, TMCAsyncHandle handle);
+
+void tmc_async_init(TMCAsyncBus *bus, TMCAsyncBusType type, tmc_async_startTransfer startTransfer, uint8_t (*getNodeAddress)(uint16_t icID))
+{
+	bus->type            = type;
+	bus->startTransfer   = startTransfer;
+	bus->getNodeAddress  = getNodeAddress;
+	bus->head            = 0;
+	bus->tail            = 0;
+	bus->queued          = 0;
+	bus->active          = NO_SLOT;
+	bus->replyPending    = NO_SLOT;
+	bus->busy            = false;
+	bus->spiStatus       = 0;
+
+	for(uint8_t i = 0; i < TMC_ASYNC_QUEUE_LENGTH; i++)
+	{
+		bus->requests[i].status     = TMC_ASYNC_FREE;
+		bus->requests[i].generation = 0;
+	}
+}
+
+TMCAsyncHandle tmc_async_readRegister(TMCAsyncBus *bus, uint16_t icID, uint8_t address, tmc_async_callback callback, void *context)
+{
+	return submit(bus, icID, address, false, 0, callback, context);
+}
+
+TMCAsyncHandle tmc_async_writeRegister(TMCAsyncBus *bus, uint16_t icID, uint8_t address, int32_t value, tmc_async_callback callback, void *context)
+{
+	return submit(bus, icID, address, true, value, callback, context);
+}
+
+void tmc_async_transferComplete(TMCAsyncBus *bus, bool success)
+{
+	int16_t slot = bus->active;
+	TMCAsyncRequest *request = (slot == NO_SLOT) ? NULL : &bus->requests[slot];
+
+	bus->active = NO_SLOT;
+
+	if(bus->type == TMC_ASYNC_BUS_SPI)
+	{
+		bus->spiStatus = bus->buffer[0];
+
+		// Every SPI datagram carries the reply to the previous one
+		if(bus->replyPending != NO_SLOT)
+		{
+			int32_t value = ((uint32_t)bus->buffer[1] << 24) | ((uint32_t)bus->buffer[2] << 16) | (bus->buffer[3] << 8) | bus->buffer[4];
+			int16_t replySlot = bus->replyPending;
+
+			bus->replyPending = NO_SLOT;
+			finish(bus, replySlot, success, value);
+		}
+
+		if(request)
+		{
+			if(request->isWrite)
+				finish(bus, slot, success, request->value);
+			else if(success)
+				bus->replyPending = slot;
+			else
+				finish(bus, slot, false, 0);
+		}
+	}
+	else if(request)
+	{
+		if(request->isWrite)
+		{
+			finish(bus, slot, success, request->value);
+		}
+		else
+		{
+			int32_t value = decodeUARTReply(bus, request->address, &success);
+			finish(bus, slot, success, value);
+		}
+	}
+
+	startNext(bus);
+}
+
+TMCAsyncStatus tmc_async_getStatus(TMCAsyncBus *bus, TMCAsyncHandle handle)
+{
+	TMCAsyncRequest *request = getRequest(bus, handle);
+
+	if(!request)
+		return TMC_ASYNC_FREE;
+
+	return request->status;
+}
+
+bool tmc_async_getResult(TMCAsyncBus *bus, TMCAsyncHandle handle, int32_t *value, bool *success)
+{
+	TMCAsyncRequest *request = getRequest(bus, handle);
+
+	if(!request)
+		return false;
+
+	TMCAsyncStatus status = request->status;
+
+	if(status != TMC_ASYNC_DONE && status != TMC_ASYNC_ERROR)
+		return false;
+
+	if(value)
+		*value = request->value;
+
+	if(success)
+		*success = (status == TMC_ASYNC_DONE);
+
+	request->status = TMC_ASYNC_FREE;
+
+	return true;
+}
+
+bool tmc_async_isIdle(TMCAsyncBus *bus)
+{
+	return !bus->busy;
+}
+
+static TMCAsyncHandle submit(TMCAsyncBus *bus, uint16_t icID, uint8_t address, bool isWrite, int32_t value, tmc_async_callback callback, void *context)
+{
+	TMCAsyncHandle handle = TMC_ASYNC_INVALID_HANDLE;
+
+	TMC_ASYNC_CRITICAL_ENTER();
+
+	// Use any free slot, so a polled result that has not been fetched yet
+	// only occupies its own slot instead of blocking the queue
+	for(uint8_t slot = 0; slot < TMC_ASYNC_QUEUE_LENGTH; slot++)
+	{
+		TMCAsyncRequest *request = &bus->requests[slot];
+
+		if(request->status != TMC_ASYNC_FREE)
+			continue;
+
+		request->icID       = icID;
+		request->address    = address & ADDRESS_MASK;
+		request->isWrite    = isWrite;
+		request->value      = value;
+		request->callback   = callback;
+		request->context    = context;
+		request->generation = (request->generation + 1) & GENERATION_MASK;
+		request->status     = TMC_ASYNC_PENDING;
+
+		handle = makeHandle(bus, slot);
+
+		bus->queue[bus->head] = slot;
+		bus->head = (bus->head + 1) % TMC_ASYNC_QUEUE_LENGTH;
+		bus->queued++;
+
+		if(!bus->busy)
+			startNext(bus);
+
+		break;
+	}
+
+	TMC_ASYNC_CRITICAL_EXIT();
+
+	return handle;
+}
+
+static void startNext(TMCAsyncBus *bus)
+{
+	uint8_t *data = &bus->buffer[0];
+
+	while(1)
+	{
+		bool hasNext = (bus->queued > 0);
+		TMCAsyncRequest *next = hasNext ? &bus->requests[bus->queue[bus->tail]] : NULL;
+
+		if(bus->replyPending != NO_SLOT)
+		{
+			TMCAsyncRequest *pending = &bus->requests[bus->replyPending];
+
+			// The reply can only be fetched by a datagram to the same chip.
+			// If there is none queued, send the read request again.
+			if(!hasNext || next->icID != pending->icID)
+			{
+				data[0] = pending->address;
+				data[1] = 0;
+				data[2] = 0;
+				data[3] = 0;
+				data[4] = 0;
+
+				bus->active = NO_SLOT;
+				bus->busy = true;
+
+				if(bus->startTransfer(bus, pending->icID, data, 5, 0))
+					return;
+
+				int16_t replySlot = bus->replyPending;
+				bus->replyPending = NO_SLOT;
+				finish(bus, replySlot, false, 0);
+				continue;
+			}
+		}
+
+		if(!hasNext)
+		{
+			bus->busy = false;
+			return;
+		}
+
+		size_t writeLength;
+		size_t readLength;
+
+		if(bus->type == TMC_ASYNC_BUS_SPI)
+		{
+			data[0] = next->address | (next->isWrite ? WRITE_BIT : 0);
+			data[1] = next->isWrite ? 0xFF & (next->value >> 24) : 0;
+			data[2] = next->isWrite ? 0xFF & (next->value >> 16) : 0;
+			data[3] = next->isWrite ? 0xFF & (next->value >> 8)  : 0;
+			data[4] = next->isWrite ? 0xFF & (next->value)       : 0;
+			writeLength = 5;
+			readLength  = 0;
+		}
+		else
+		{
+			data[0] = UART_SYNC;
+			data[1] = bus->getNodeAddress(next->icID);
+			if(next->isWrite)
+			{
+				data[2] = next->address | WRITE_BIT;
+				data[3] = (next->value >> 24) & 0xFF;
+				data[4] = (next->value >> 16) & 0xFF;
+				data[5] = (next->value >> 8 ) & 0xFF;
+				data[6] = (next->value      ) & 0xFF;
+				data[7] = CRC8(data, 7);
+				writeLength = 8;
+				readLength  = 0;
+			}
+			else
+			{
+				data[2] = next->address;
+				data[3] = CRC8(data, 3);
+				writeLength = 4;
+				readLength  = 8;
+			}
+		}
+
+		bus->active = bus->queue[bus->tail];
+		bus->tail = (bus->tail + 1) % TMC_ASYNC_QUEUE_LENGTH;
+		bus->queued--;
+		next->status = TMC_ASYNC_ACTIVE;
+		bus->busy = true;
+
+		if(bus->startTransfer(bus, next->icID, data, writeLength, readLength))
+			return;
+
+		// Transfer could not be started - report the error and try the next request
+		int16_t slot = bus->active;
+		bus->active = NO_SLOT;
+		finish(bus, slot, false, 0);
+
+		if(bus->replyPending != NO_SLOT)
+		{
+			int16_t replySlot = bus->replyPending;
+			bus->replyPending = NO_SLOT;
+			finish(bus, replySlot, false, 0);
+		}
+	}
+}
+
+static void finish(TMCAsyncBus *bus, int16_t slot, bool success, int32_t value)
+{
+	TMCAsyncRequest *request = &bus->requests[slot];
+
+	request->value = value;
+
+	if(request->callback)
+	{
+		// Release the slot before calling back, so the callback may submit a new request
+		tmc_async_callback callback = request->callback;
+		void *context = request->context;
+		uint8_t address = request->address;
+
+		request->status = TMC_ASYNC_FREE;
+		callback(context, makeHandle(bus, slot), address, value, success);
+	}
+	else
+	{
+		request->status = success ? TMC_ASYNC_DONE : TMC_ASYNC_ERROR;
+	}
+}
+
+static TMCAsyncHandle makeHandle(TMCAsyncBus *bus, int16_t slot)
+{
+	return ((TMCAsyncHandle)bus->requests[slot].generation << HANDLE_SLOT_BITS) | slot;
+}
+
+// Returns the request of [handle], or NULL if the handle is invalid or stale
+static TMCAsyncRequest *getRequest(TMCAsyncBus *bus, TMCAsyncHandle handle)
+{
+	if(handle < 0)
+		return NULL;
+
+	uint8_t slot = handle & HANDLE_SLOT_MASK;
+	uint16_t generation = handle >> HANDLE_SLOT_BITS;
+
+	if(slot >= TMC_ASYNC_QUEUE_LENGTH || bus->requests[slot].generation != generation)
+		return NULL;
+
+	return &bus->requests[slot];
+}
+
+static int32_t decodeUARTReply(TMCAsyncBus *bus, uint8_t address, bool *success)
+{
+	uint8_t *data = &bus->buffer[0];
+
+	if(!*success)
+		return 0;
+
+	// Byte 0: Sync nibble correct?
+	// Byte 1: Master address correct?
+	// Byte 2: Address correct?
+	// Byte 7: CRC correct?
+	if(data[0] != UART_SYNC || data[1] != UART_MASTER_ADDRESS || data[2] != address || data[7] != CRC8(data, 7))
+	{
+		*success = false;
+		return 0;
+	}
+
+	return ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+}
+
+static uint8_t CRC8(uint8_t *data, uint32_t bytes)
+{
+	uint8_t result = 0;
+
+	while(bytes--)
+		result = tmcCRCTable_Poly7Reflected[result ^ *data++];
+
+	// Flip the result around
+	// swap odd and even bits
+	result = ((result >> 1) & 0x55) | ((result & 0x55) << 1);
+	// swap consecutive pairs
+	result = ((result >> 2) & 0x33) | ((result & 0x33) << 2);
+	// swap nibbles ...
+	result = ((result >> 4) & 0x0F) | ((result & 0x0F) << 4);
+
+	return result;
+}
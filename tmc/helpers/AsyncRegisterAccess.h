@@ -0,0 +1,142 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+/*
+ *  Non-blocking register access for the SPI and UART datagram formats shared by
+ *  the TMC5xxx/TMC2xxx drivers (5 byte SPI datagrams, 8 byte UART datagrams with CRC8).
+ *
+ *  Register requests are queued per bus with tmc_async_readRegister() and
+ *  tmc_async_writeRegister(), which return immediately with a handle. The bus
+ *  transfers are started through the startTransfer callback, which is expected
+ *  to hand the datagram to a DMA engine (or an interrupt driven driver) and return.
+ *  Once the transfer has finished, tmc_async_transferComplete() has to be called,
+ *  usually from the DMA/UART interrupt. It decodes the reply, reports the result
+ *  and starts the next transfer.
+ *
+ *  The result of a request is either delivered through the completion callback
+ *  given on submission, or polled with tmc_async_getStatus()/tmc_async_getResult().
+ *  A slot of a request without callback stays occupied until its result has been
+ *  fetched with tmc_async_getResult(). Other requests can still be submitted into
+ *  the remaining free slots meanwhile, and are transferred in submission order.
+ *
+ *  A handle contains the slot index and a generation counter of that slot, which is
+ *  incremented on every submission into the slot. Once the slot has been reused, the
+ *  old handle is stale: tmc_async_getStatus() reports TMC_ASYNC_FREE for it and
+ *  tmc_async_getResult() fails, so it cannot consume the result of the newer request.
+ *  The generation wraps after 32768 submissions into the same slot.
+ *
+ *  SPI reads are pipelined: the reply to a read request is carried by the next
+ *  datagram to the same chip. If the following queued request targets the same
+ *  chip, its datagram is used for that, otherwise an additional read datagram is sent.
+ *
+ *  The UART CRC uses the shared table tmcCRCTable_Poly7Reflected. It is defined by
+ *  helpers/CRCTables.c or by a UART driver built without TMC_API_EXTERNAL_CRC_TABLE.
+ *
+ *  Note: This layer works on the raw datagrams. The shadow register caches of the
+ *  drivers (tmcXXXX_cache) are not updated, so write-only registers should be
+ *  accessed through the blocking driver functions.
+ */
+
+#ifndef TMC_HELPERS_ASYNCREGISTERACCESS_H_
+#define TMC_HELPERS_ASYNCREGISTERACCESS_H_
+
+#include "Types.h"
+
+// Amount of requests that can be queued per bus
+#ifndef TMC_ASYNC_QUEUE_LENGTH
+#define TMC_ASYNC_QUEUE_LENGTH   8
+#endif
+
+// Submitting requests and completing transfers may happen in different contexts
+// (main loop vs. DMA interrupt). Override these to mask the bus interrupt
+// while the queue state is modified from the main loop.
+#ifndef TMC_ASYNC_CRITICAL_ENTER
+#define TMC_ASYNC_CRITICAL_ENTER()
+#endif
+
+#ifndef TMC_ASYNC_CRITICAL_EXIT
+#define TMC_ASYNC_CRITICAL_EXIT()
+#endif
+
+#define TMC_ASYNC_INVALID_HANDLE   (-1)
+
+// Bits 0..7: slot index, bits 8..22: generation of the slot
+typedef int32_t TMCAsyncHandle;
+
+typedef enum {
+	TMC_ASYNC_BUS_SPI,
+	TMC_ASYNC_BUS_UART
+} TMCAsyncBusType;
+
+typedef enum {
+	TMC_ASYNC_FREE,
+	TMC_ASYNC_PENDING,  // Queued, not yet started
+	TMC_ASYNC_ACTIVE,   // Transfer in progress (SPI reads: waiting for the reply datagram)
+	TMC_ASYNC_DONE,
+	TMC_ASYNC_ERROR
+} TMCAsyncStatus;
+
+typedef struct TMCAsyncBus TMCAsyncBus;
+
+// Completion callback, called from the context of tmc_async_transferComplete().
+// [value] holds the decoded register value for reads and the written value for writes.
+typedef void (*tmc_async_callback)(void *context, TMCAsyncHandle handle, uint8_t address, int32_t value, bool success);
+
+// Starts a non-blocking transfer of [data] and returns without waiting for it.
+// SPI: Full duplex transfer of [writeLength] bytes, the received bytes are stored in [data].
+//      [readLength] is 0.
+// UART: Sends [writeLength] bytes, then receives [readLength] bytes into [data].
+// When the transfer has finished, tmc_async_transferComplete() needs to be called.
+// Returning false aborts the request with an error.
+typedef bool (*tmc_async_startTransfer)(TMCAsyncBus *bus, uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength);
+
+typedef struct
+{
+	volatile TMCAsyncStatus status;
+	uint16_t icID;
+	uint8_t address;
+	bool isWrite;
+	int32_t value;
+	tmc_async_callback callback;
+	void *context;
+	uint16_t generation;  // Incremented on every submission into this slot
+} TMCAsyncRequest;
+
+struct TMCAsyncBus
+{
+	TMCAsyncBusType type;
+	tmc_async_startTransfer startTransfer;
+	uint8_t (*getNodeAddress)(uint16_t icID);  // UART only
+	void *userData;                            // Free to use by the HAL, e.g. to store the peripheral handle
+
+	TMCAsyncRequest requests[TMC_ASYNC_QUEUE_LENGTH];
+	uint8_t queue[TMC_ASYNC_QUEUE_LENGTH];  // Slots of the pending requests in submission order
+	uint8_t head;          // Next queue entry to be written
+	uint8_t tail;          // Next queue entry to be started
+	uint8_t queued;        // Number of queue entries
+	int16_t active;        // Slot of the running transfer, -1 for a reply-only datagram
+	int16_t replyPending;  // SPI: slot of the read waiting for its reply, -1 if none
+	volatile bool busy;
+	uint8_t spiStatus;     // SPI status byte of the last received datagram
+	uint8_t buffer[8];
+};
+
+void tmc_async_init(TMCAsyncBus *bus, TMCAsyncBusType type, tmc_async_startTransfer startTransfer, uint8_t (*getNodeAddress)(uint16_t icID));
+
+TMCAsyncHandle tmc_async_readRegister(TMCAsyncBus *bus, uint16_t icID, uint8_t address, tmc_async_callback callback, void *context);
+TMCAsyncHandle tmc_async_writeRegister(TMCAsyncBus *bus, uint16_t icID, uint8_t address, int32_t value, tmc_async_callback callback, void *context);
+
+// To be called by the HAL when the transfer started by startTransfer has finished.
+// [success] is false if the transfer failed (e.g. UART timeout).
+void tmc_async_transferComplete(TMCAsyncBus *bus, bool success);
+
+// Returns TMC_ASYNC_FREE for invalid and stale handles
+TMCAsyncStatus tmc_async_getStatus(TMCAsyncBus *bus, TMCAsyncHandle handle);
+// Returns true once the request has finished. The result is written to [value] and
+// [success] (both may be NULL) and the slot is released. Returns false while the request
+// is still running, and for invalid or stale handles.
+bool tmc_async_getResult(TMCAsyncBus *bus, TMCAsyncHandle handle, int32_t *value, bool *success);
+bool tmc_async_isIdle(TMCAsyncBus *bus);
+
+#endif /* TMC_HELPERS_ASYNCREGISTERACCESS_H_ */
@@ -0,0 +1,110 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+#include "BusStatistics.h"
+#include "Macros.h"
+
+#define ADDRESS_MASK  0x7F
+#define WRITE_BIT     0x80
+
+void tmc_bus_statistics_reset(TMC_BusStatistics *statistics)
+{
+	statistics->transfers      = 0;
+	statistics->datagrams      = 0;
+	statistics->bytesSent      = 0;
+	statistics->bytesReceived  = 0;
+	statistics->crcErrors      = 0;
+	statistics->replyErrors    = 0;
+	statistics->latencyMax     = 0;
+	statistics->latencySum     = 0;
+
+	for(size_t i = 0; i < TMC_BUS_STATISTICS_HISTOGRAM_BINS; i++)
+		statistics->latencyHistogram[i] = 0;
+
+	for(size_t i = 0; i < TMC_BUS_STATISTICS_REGISTER_COUNT; i++)
+	{
+		statistics->registers[i].reads        = 0;
+		statistics->registers[i].writes       = 0;
+		statistics->registers[i].cacheHits    = 0;
+		statistics->registers[i].cacheMisses  = 0;
+	}
+}
+
+void tmc_bus_statistics_recordTransfer(TMC_BusStatistics *statistics, uint32_t latency)
+{
+	statistics->transfers++;
+	statistics->latencySum += latency;
+	statistics->latencyHistogram[tmc_bus_statistics_getBin(latency)]++;
+
+	if(latency > statistics->latencyMax)
+		statistics->latencyMax = latency;
+}
+
+void tmc_bus_statistics_recordDatagram(TMC_BusStatistics *statistics, uint8_t address, size_t bytesSent, size_t bytesReceived)
+{
+	TMC_RegisterStatistics *registerStatistics = &statistics->registers[address & ADDRESS_MASK];
+
+	if(address & WRITE_BIT)
+		registerStatistics->writes++;
+	else
+		registerStatistics->reads++;
+
+	statistics->datagrams++;
+	statistics->bytesSent += bytesSent;
+	statistics->bytesReceived += bytesReceived;
+}
+
+void tmc_bus_statistics_recordCache(TMC_BusStatistics *statistics, uint8_t address, bool hit)
+{
+	TMC_RegisterStatistics *registerStatistics = &statistics->registers[address & ADDRESS_MASK];
+
+	if(hit)
+		registerStatistics->cacheHits++;
+	else
+		registerStatistics->cacheMisses++;
+}
+
+void tmc_bus_statistics_recordCRCError(TMC_BusStatistics *statistics)
+{
+	statistics->crcErrors++;
+}
+
+void tmc_bus_statistics_recordReplyError(TMC_BusStatistics *statistics)
+{
+	statistics->replyErrors++;
+}
+
+uint8_t tmc_bus_statistics_getBin(uint32_t latency)
+{
+	uint8_t bin = 0;
+
+	// Bin = amount of significant bits of the latency
+	while(latency && bin < TMC_BUS_STATISTICS_HISTOGRAM_BINS - 1)
+	{
+		latency >>= 1;
+		bin++;
+	}
+
+	return bin;
+}
+
+uint32_t tmc_bus_statistics_getLatencyPercentile(const TMC_BusStatistics *statistics, uint8_t percent)
+{
+	if(statistics->transfers == 0)
+		return 0;
+
+	// Amount of transfers at or below the percentile, rounded up
+	uint64_t threshold = ((uint64_t) statistics->transfers * MIN(percent, 100) + 99) / 100;
+	uint64_t count = 0;
+
+	for(uint8_t bin = 0; bin < TMC_BUS_STATISTICS_HISTOGRAM_BINS - 1; bin++)
+	{
+		count += statistics->latencyHistogram[bin];
+
+		if(count >= threshold)
+			return (bin < 32) ? (uint32_t) ((1ULL << bin) - 1) : UINT32_MAX;
+	}
+
+	return UINT32_MAX;
+}
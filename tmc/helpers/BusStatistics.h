@@ -0,0 +1,85 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+/*
+ *  Bus transaction statistics for the register access layer of the drivers.
+ *
+ *  The TMC5160, TMC2240, TMC2209, TMC7300 and TMC4361A drivers support statistics
+ *  (<IC>_BUS_STATISTICS set to '1'). They wrap their readWriteSPI/readWriteUART
+ *  callbacks and record per icID:
+ *  - transfers (callback invocations) with a latency histogram
+ *  - datagrams and bytes sent/received
+ *  - per register address: read and write datagrams, cache hits and misses
+ *  - CRC errors and missing or invalid replies
+ *
+ *  This shows which API calls use up the bus bandwidth, e.g. a field write that
+ *  reads its register from the chip every time.
+ *
+ *  Latencies are measured with tmc_bus_statistics_getTime(), which has to be
+ *  implemented by the application when statistics are enabled. Its unit is up to
+ *  the application (e.g. µs timer or CPU cycle counter), it only needs to count
+ *  up and may wrap around. Bin 0 of the histogram counts latencies of 0, bin k
+ *  latencies from 2^(k-1) to 2^k - 1. The last bin also holds all longer latencies.
+ *
+ *  Other drivers can be extended the same way, see the "Bus statistics" section
+ *  of TMC5160.c.
+ *
+ *  The counters are not protected against concurrent access. Bus accesses of one
+ *  icID from different contexts (main loop and interrupts) can lose counts.
+ */
+
+#ifndef TMC_HELPERS_BUSSTATISTICS_H_
+#define TMC_HELPERS_BUSSTATISTICS_H_
+
+#include "Types.h"
+
+#define TMC_BUS_STATISTICS_REGISTER_COUNT   128
+
+#ifndef TMC_BUS_STATISTICS_HISTOGRAM_BINS
+#define TMC_BUS_STATISTICS_HISTOGRAM_BINS   16
+#endif
+
+typedef struct
+{
+	uint32_t reads;        // Read datagrams sent
+	uint32_t writes;       // Write datagrams sent
+	uint32_t cacheHits;    // Reads served from the shadow register cache
+	uint32_t cacheMisses;  // Reads that needed a bus transfer
+} TMC_RegisterStatistics;
+
+typedef struct
+{
+	uint32_t transfers;      // Calls of the bus callbacks
+	uint32_t datagrams;
+	uint32_t bytesSent;
+	uint32_t bytesReceived;
+	uint32_t crcErrors;      // Replies with a wrong CRC
+	uint32_t replyErrors;    // Missing replies or replies with wrong sync, master or register address
+	uint32_t latencyMax;
+	uint64_t latencySum;
+	uint32_t latencyHistogram[TMC_BUS_STATISTICS_HISTOGRAM_BINS];
+	TMC_RegisterStatistics registers[TMC_BUS_STATISTICS_REGISTER_COUNT];
+} TMC_BusStatistics;
+
+// => Time source
+extern uint32_t tmc_bus_statistics_getTime(void);
+// <= Time source
+
+void tmc_bus_statistics_reset(TMC_BusStatistics *statistics);
+
+// One call of a bus callback, which took [latency] time units
+void tmc_bus_statistics_recordTransfer(TMC_BusStatistics *statistics, uint32_t latency);
+// One datagram within a transfer. [address] is the address byte including the write bit (0x80).
+void tmc_bus_statistics_recordDatagram(TMC_BusStatistics *statistics, uint8_t address, size_t bytesSent, size_t bytesReceived);
+void tmc_bus_statistics_recordCache(TMC_BusStatistics *statistics, uint8_t address, bool hit);
+void tmc_bus_statistics_recordCRCError(TMC_BusStatistics *statistics);
+void tmc_bus_statistics_recordReplyError(TMC_BusStatistics *statistics);
+
+// Histogram bin of [latency]
+uint8_t tmc_bus_statistics_getBin(uint32_t latency);
+// Upper bound of the histogram bin containing the [percent] percentile of the latencies.
+// Returns 0 if no transfer has been recorded and UINT32_MAX if the percentile is in the last bin.
+uint32_t tmc_bus_statistics_getLatencyPercentile(const TMC_BusStatistics *statistics, uint8_t percent);
+
+#endif /* TMC_HELPERS_BUSSTATISTICS_H_ */
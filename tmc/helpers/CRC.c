@@ -24,14 +24,31 @@
  *  this algorithm could probably be speed up by preparing a 2- or 4-bit lookup table
  *  to speed up the actual table generation.
  *
+ *  For long buffers, TMC_CRC_SLICE_COUNT (see CRC.h) enables slice-by-4 or slice-by-8
+ *  processing with additional per-byte-offset tables. For reflected CRCs,
+ *  TMC_CRC_FLIPPED_TABLE replaces the final bit reversal with a lookup in a
+ *  pre-reflected table for the last byte.
+ *
  *  (1): For compile-time CRC tables, just fill the table(s) by initializing CRCTables[] to the proper values.
  *  (2): Tested by toggling a GPIO pin, generating a table in-between and measuring the GPIO pulse width.
  */
 
 #include "CRC.h"
 
+#if (TMC_CRC_SLICE_COUNT != 1) && (TMC_CRC_SLICE_COUNT != 4) && (TMC_CRC_SLICE_COUNT != 8)
+#error "TMC_CRC_SLICE_COUNT has to be 1, 4 or 8"
+#endif
+
 typedef struct {
 	uint8_t table[256];
+#if TMC_CRC_SLICE_COUNT > 1
+	// slices[k][x]: CRC state after byte x followed by k+1 zero bytes
+	uint8_t slices[TMC_CRC_SLICE_COUNT - 1][256];
+#endif
+#if TMC_CRC_FLIPPED_TABLE == 1
+	// flippedTable[x] == flipByte(table[x]), only filled for reflected CRCs
+	uint8_t flippedTable[256];
+#endif
 	uint8_t polynomial;
 	bool isReflected;
 } CRCTypeDef;
@@ -137,6 +154,29 @@ uint8_t tmc_fillCRC8Table(uint8_t polynomial, bool isReflected, uint8_t index)
 		*table++ = (uint8_t) CRCdata;
 	}
 
+#if TMC_CRC_SLICE_COUNT > 1
+	// The CRC is linear, so the contribution of every byte of an N byte block can be
+	// looked up separately and XOR-ed together. The byte at offset i is followed by
+	// N-1-i more bytes, which is equal to feeding zero bytes through the base table.
+	table = &CRCTables[index].table[0];
+	uint8_t *previous = table;
+	for(int k = 0; k < TMC_CRC_SLICE_COUNT - 1; k++)
+	{
+		for(int x = 0; x < 256; x++)
+			CRCTables[index].slices[k][x] = table[previous[x]];
+
+		previous = &CRCTables[index].slices[k][0];
+	}
+#endif
+
+#if TMC_CRC_FLIPPED_TABLE == 1
+	if(isReflected)
+	{
+		for(int x = 0; x < 256; x++)
+			CRCTables[index].flippedTable[x] = flipByte(CRCTables[index].table[x]);
+	}
+#endif
+
 	return 1;
 }
 
@@ -157,9 +197,36 @@ uint8_t tmc_CRC8(uint8_t *data, uint32_t bytes, uint8_t index)
 
 	table = &CRCTables[index].table[0];
 
+#if TMC_CRC_FLIPPED_TABLE == 1
+	// Hold back the last byte for the pre-reflected table
+	bool useFlippedTable = CRCTables[index].isReflected && (bytes > 0);
+	if(useFlippedTable)
+		bytes--;
+#endif
+
+#if TMC_CRC_SLICE_COUNT == 4
+	uint8_t (*slices)[256] = CRCTables[index].slices;
+	for(; bytes >= 4; bytes -= 4, data += 4)
+	{
+		result = slices[2][result ^ data[0]] ^ slices[1][data[1]] ^ slices[0][data[2]] ^ table[data[3]];
+	}
+#elif TMC_CRC_SLICE_COUNT == 8
+	uint8_t (*slices)[256] = CRCTables[index].slices;
+	for(; bytes >= 8; bytes -= 8, data += 8)
+	{
+		result = slices[6][result ^ data[0]] ^ slices[5][data[1]] ^ slices[4][data[2]] ^ slices[3][data[3]]
+		       ^ slices[2][data[4]] ^ slices[1][data[5]] ^ slices[0][data[6]] ^ table[data[7]];
+	}
+#endif
+
 	while(bytes--)
 		result = table[result ^ *data++];
 
+#if TMC_CRC_FLIPPED_TABLE == 1
+	if(useFlippedTable)
+		return CRCTables[index].flippedTable[result ^ *data];
+#endif
+
 	return (CRCTables[index].isReflected)? flipByte(result) : result;
 }
 
@@ -179,6 +246,11 @@ bool tmc_tableIsReflected(uint8_t index)
 	return CRCTables[index].isReflected;
 }
 
+uint32_t tmc_CRC8RAMSize(void)
+{
+	return sizeof(CRCTables);
+}
+
 // Helper functions
 static uint8_t flipByte(uint8_t value)
 {
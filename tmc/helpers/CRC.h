@@ -13,12 +13,28 @@
 
 	// Amount of CRC tables available
 	// Each table takes ~260 bytes (257 bytes, one bool and structure padding)
+	// plus the optional tables below.
 	#define CRC_TABLE_COUNT 2
 
+	// Bytes processed per loop iteration of tmc_CRC8 (1, 4 or 8).
+	// Slicing by N requires N-1 additional 256 byte tables per CRC table.
+	#ifndef TMC_CRC_SLICE_COUNT
+	#define TMC_CRC_SLICE_COUNT 1
+	#endif
+
+	// For reflected CRCs, use an additional 256 byte table with pre-reflected
+	// entries for the last byte instead of flipping the result of every calculation.
+	#ifndef TMC_CRC_FLIPPED_TABLE
+	#define TMC_CRC_FLIPPED_TABLE 0
+	#endif
+
 	uint8_t tmc_fillCRC8Table(uint8_t polynomial, bool isReflected, uint8_t index);
 	uint8_t tmc_CRC8(uint8_t *data, uint32_t bytes, uint8_t index);
 
 	uint8_t tmc_tableGetPolynomial(uint8_t index);
 	bool  tmc_tableIsReflected(uint8_t index);
 
+	// RAM used by the runtime generated tables in bytes (all slices and the flipped table included)
+	uint32_t tmc_CRC8RAMSize(void);
+
 #endif /* TMC_HELPERS_CRC_H_ */
@@ -0,0 +1,54 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+/*
+ *  The table entries are generated by the preprocessor: Each entry is the CRC
+ *  state after shifting one byte through the CRC register, which is done by
+ *  eight nested single bit steps.
+ */
+
+#include "CRCTables.h"
+
+// One bit step of a reflected CRC (shifting LSB first, reversed polynomial)
+#define CRC_STEP_REFLECTED(c, p)   (((c) >> 1) ^ (((c) & 0x01) ? (p) : 0))
+#define CRC_ENTRY_REFLECTED(x, p) \
+	CRC_STEP_REFLECTED(CRC_STEP_REFLECTED(CRC_STEP_REFLECTED(CRC_STEP_REFLECTED( \
+	CRC_STEP_REFLECTED(CRC_STEP_REFLECTED(CRC_STEP_REFLECTED(CRC_STEP_REFLECTED(x, p), p), p), p), p), p), p), p)
+
+// MAX22216: 5 bit CRC, the table index is shifted through seven bit steps
+#define CRC_ENTRY_REFLECTED_7BIT(x, p) \
+	CRC_STEP_REFLECTED(CRC_STEP_REFLECTED(CRC_STEP_REFLECTED( \
+	CRC_STEP_REFLECTED(CRC_STEP_REFLECTED(CRC_STEP_REFLECTED(CRC_STEP_REFLECTED(x, p), p), p), p), p), p), p)
+
+#define CRC_ROW(entry, p, row) \
+	entry((row) + 0x0, p), entry((row) + 0x1, p), entry((row) + 0x2, p), entry((row) + 0x3, p), \
+	entry((row) + 0x4, p), entry((row) + 0x5, p), entry((row) + 0x6, p), entry((row) + 0x7, p), \
+	entry((row) + 0x8, p), entry((row) + 0x9, p), entry((row) + 0xA, p), entry((row) + 0xB, p), \
+	entry((row) + 0xC, p), entry((row) + 0xD, p), entry((row) + 0xE, p), entry((row) + 0xF, p)
+
+#define CRC_TABLE(entry, p) { \
+	CRC_ROW(entry, p, 0x00), CRC_ROW(entry, p, 0x10), CRC_ROW(entry, p, 0x20), CRC_ROW(entry, p, 0x30), \
+	CRC_ROW(entry, p, 0x40), CRC_ROW(entry, p, 0x50), CRC_ROW(entry, p, 0x60), CRC_ROW(entry, p, 0x70), \
+	CRC_ROW(entry, p, 0x80), CRC_ROW(entry, p, 0x90), CRC_ROW(entry, p, 0xA0), CRC_ROW(entry, p, 0xB0), \
+	CRC_ROW(entry, p, 0xC0), CRC_ROW(entry, p, 0xD0), CRC_ROW(entry, p, 0xE0), CRC_ROW(entry, p, 0xF0) }
+
+#if TMC_CRC_TABLE_POLY7_REFLECTED == 1
+// 0x07 reflected: 0xE0
+const uint8_t tmcCRCTable_Poly7Reflected[256] = CRC_TABLE(CRC_ENTRY_REFLECTED, 0xE0);
+#endif
+
+#if TMC_CRC_TABLE_POLY100011011_REFLECTED == 1
+// Reversed polynomial 0xB8, matching the table of the TMC6460 driver
+const uint8_t tmcCRCTable_Poly100011011Reflected[256] = CRC_TABLE(CRC_ENTRY_REFLECTED, 0xB8);
+#endif
+
+#if TMC_CRC_TABLE_POLY110101 == 1
+// 0x35 without the shifted-in x^0 term: 0x1A
+const uint8_t tmcCRCTable_Poly110101[256] = CRC_TABLE(CRC_ENTRY_REFLECTED_7BIT, 0x1A);
+#endif
+
+uint32_t tmc_CRCTablesFlashSize(void)
+{
+	return TMC_CRC_TABLES_FLASH_SIZE;
+}
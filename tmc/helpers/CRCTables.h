@@ -0,0 +1,60 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+/*
+ *  Shared CRC8 lookup tables for the TMC-API drivers.
+ *
+ *  Every driver with a CRC protected interface carries its own copy of the
+ *  CRC table it needs, so each driver folder can be used on its own. When
+ *  multiple drivers are linked into one project, define TMC_API_EXTERNAL_CRC_TABLE
+ *  for the whole project and add CRCTables.c to the build. The drivers then
+ *  reference the single definition per polynomial from this module instead of
+ *  their own copies.
+ *
+ *  The tables are generated by the preprocessor from the polynomial and are
+ *  stored as constants (flash). Tables not needed by any driver in the project
+ *  can be disabled below.
+ */
+
+#ifndef TMC_HELPERS_CRCTABLES_H_
+#define TMC_HELPERS_CRCTABLES_H_
+
+#include "Types.h"
+
+// Polynomial 0x07 (x^8 + x^2 + x + 1), reflected
+// Used by the UART interface of e.g. TMC2209, TMC2240, TMC5160, TMC7300, TMC9660
+#ifndef TMC_CRC_TABLE_POLY7_REFLECTED
+#define TMC_CRC_TABLE_POLY7_REFLECTED   1
+#endif
+
+// Reflected table used by TMC6460
+#ifndef TMC_CRC_TABLE_POLY100011011_REFLECTED
+#define TMC_CRC_TABLE_POLY100011011_REFLECTED   1
+#endif
+
+// 5 bit CRC table used by MAX22216
+#ifndef TMC_CRC_TABLE_POLY110101
+#define TMC_CRC_TABLE_POLY110101   1
+#endif
+
+// Flash used by the shared tables of the current configuration (in bytes)
+#define TMC_CRC_TABLES_FLASH_SIZE   (256 * (TMC_CRC_TABLE_POLY7_REFLECTED + TMC_CRC_TABLE_POLY100011011_REFLECTED + TMC_CRC_TABLE_POLY110101))
+
+#if TMC_CRC_TABLE_POLY7_REFLECTED == 1
+extern const uint8_t tmcCRCTable_Poly7Reflected[256];
+#endif
+
+#if TMC_CRC_TABLE_POLY100011011_REFLECTED == 1
+extern const uint8_t tmcCRCTable_Poly100011011Reflected[256];
+#endif
+
+#if TMC_CRC_TABLE_POLY110101 == 1
+extern const uint8_t tmcCRCTable_Poly110101[256];
+#endif
+
+// Flash used by the shared tables in bytes. See tmc_CRC8RAMSize() in CRC.h for
+// the RAM used by the runtime generated tables.
+uint32_t tmc_CRCTablesFlashSize(void);
+
+#endif /* TMC_HELPERS_CRCTABLES_H_ */
@@ -0,0 +1,147 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+#include "DaisyChain.h"
+#include "RegisterAccess.h"
+
+#define ADDRESS_MASK  0x7F
+#define WRITE_BIT     0x80
+
+// Address of the last read request per chip. Used as padding datagram for chips
+// that are not accessed, so their next reply still belongs to their last request.
+static uint8_t lastReadAddress[TMC_DAISYCHAIN_MAX_CHAINS][TMC_DAISYCHAIN_MAX_LENGTH] = { 0 };
+
+// Register access table per chain, decides which reads can be repeated by the padding
+static const uint8_t *registerAccess[TMC_DAISYCHAIN_MAX_CHAINS] = { 0 };
+
+static uint8_t getLength(uint8_t chain);
+static uint8_t *getDatagram(uint8_t *frame, uint8_t length, uint8_t position);
+static void setDatagram(uint8_t *datagram, uint8_t address, int32_t value);
+static void trackAddress(uint8_t chain, uint8_t position, uint8_t address);
+
+void tmc_daisychain_setRegisterAccess(uint8_t chain, const uint8_t *access)
+{
+	if(chain >= TMC_DAISYCHAIN_MAX_CHAINS)
+		return;
+
+	registerAccess[chain] = access;
+}
+
+void tmc_daisychain_readWriteDatagram(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+	uint8_t frame[TMC_DAISYCHAIN_MAX_LENGTH * TMC_DAISYCHAIN_DATAGRAM_LENGTH];
+	uint8_t chain;
+	uint8_t position;
+
+	if(dataLength != TMC_DAISYCHAIN_DATAGRAM_LENGTH)
+		return;
+
+	if(!tmc_daisychain_getChainPosition(icID, &chain, &position) || chain >= TMC_DAISYCHAIN_MAX_CHAINS)
+		return;
+
+	uint8_t length = getLength(chain);
+	if(position >= length)
+		return;
+
+	for(uint8_t i = 0; i < length; i++)
+	{
+		uint8_t *datagram = getDatagram(frame, length, i);
+
+		if(i == position)
+		{
+			for(uint8_t j = 0; j < TMC_DAISYCHAIN_DATAGRAM_LENGTH; j++)
+				datagram[j] = data[j];
+		}
+		else
+		{
+			setDatagram(datagram, lastReadAddress[chain][i], 0);
+		}
+	}
+
+	trackAddress(chain, position, data[0]);
+
+	tmc_daisychain_readWriteSPI(chain, &frame[0], length * TMC_DAISYCHAIN_DATAGRAM_LENGTH);
+
+	uint8_t *reply = getDatagram(frame, length, position);
+	for(uint8_t j = 0; j < TMC_DAISYCHAIN_DATAGRAM_LENGTH; j++)
+		data[j] = reply[j];
+}
+
+void tmc_daisychain_readRegisterAll(uint8_t chain, uint8_t address, int32_t *values, uint8_t *status)
+{
+	uint8_t frame[TMC_DAISYCHAIN_MAX_LENGTH * TMC_DAISYCHAIN_DATAGRAM_LENGTH];
+	uint8_t length = getLength(chain);
+
+	address &= ADDRESS_MASK;
+
+	// Send the read request to all chips, then send it again to receive the replies
+	for(uint8_t k = 0; k < 2; k++)
+	{
+		for(uint8_t i = 0; i < length; i++)
+			setDatagram(getDatagram(frame, length, i), address, 0);
+
+		tmc_daisychain_readWriteSPI(chain, &frame[0], length * TMC_DAISYCHAIN_DATAGRAM_LENGTH);
+	}
+
+	for(uint8_t i = 0; i < length; i++)
+	{
+		uint8_t *reply = getDatagram(frame, length, i);
+
+		values[i] = ((uint32_t)reply[1] << 24) | ((uint32_t)reply[2] << 16) | (reply[3] << 8) | reply[4];
+		if(status)
+			status[i] = reply[0];
+
+		trackAddress(chain, i, address);
+	}
+}
+
+void tmc_daisychain_writeRegisterAll(uint8_t chain, uint8_t address, const int32_t *values)
+{
+	uint8_t frame[TMC_DAISYCHAIN_MAX_LENGTH * TMC_DAISYCHAIN_DATAGRAM_LENGTH];
+	uint8_t length = getLength(chain);
+
+	for(uint8_t i = 0; i < length; i++)
+		setDatagram(getDatagram(frame, length, i), address | WRITE_BIT, values[i]);
+
+	tmc_daisychain_readWriteSPI(chain, &frame[0], length * TMC_DAISYCHAIN_DATAGRAM_LENGTH);
+}
+
+static uint8_t getLength(uint8_t chain)
+{
+	uint8_t length = tmc_daisychain_getChainLength(chain);
+
+	return (length > TMC_DAISYCHAIN_MAX_LENGTH) ? TMC_DAISYCHAIN_MAX_LENGTH : length;
+}
+
+// The datagram of the last chip in the chain is shifted first
+static uint8_t *getDatagram(uint8_t *frame, uint8_t length, uint8_t position)
+{
+	return &frame[(length - 1 - position) * TMC_DAISYCHAIN_DATAGRAM_LENGTH];
+}
+
+static void setDatagram(uint8_t *datagram, uint8_t address, int32_t value)
+{
+	datagram[0] = address;
+	datagram[1] = 0xFF & (value>>24);
+	datagram[2] = 0xFF & (value>>16);
+	datagram[3] = 0xFF & (value>>8);
+	datagram[4] = 0xFF & (value>>0);
+}
+
+static void trackAddress(uint8_t chain, uint8_t position, uint8_t address)
+{
+	if(chain >= TMC_DAISYCHAIN_MAX_CHAINS)
+		return;
+
+	// Padding datagrams only repeat read requests
+	if(address & WRITE_BIT)
+		return;
+
+	// Repeating a read of a flag register would clear the flags of that chip
+	address &= ADDRESS_MASK;
+	if(!registerAccess[chain] || (registerAccess[chain][address] & TMC_ACCESS_FLAGS))
+		address = TMC_DAISYCHAIN_PADDING_ADDRESS;
+
+	lastReadAddress[chain][position] = address;
+}
@@ -0,0 +1,85 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+/*
+ *  SPI daisy chain transport for TMC chips using 5 byte (40 bit) datagrams,
+ *  e.g. TMC5160, TMC2130 and TMC2160.
+ *
+ *  In a daisy chain all chips share one chip select. The SDO of each chip is
+ *  connected to the SDI of the next one, so every transaction has to shift one
+ *  datagram per chip (N x 40 bit). Position 0 is the chip connected to the MCU's
+ *  MOSI. Its datagram is shifted in last, the datagram of the last chip in the
+ *  chain is shifted in first.
+ *
+ *  Single chip access:
+ *  Implement the driver callback (e.g. tmc5160_readWriteSPI) by forwarding it to
+ *  tmc_daisychain_readWriteDatagram(). The other chips in the chain receive a read
+ *  request for the register they were read from last, so a pending read reply of
+ *  another chip is not lost. Repeating a read of a read to clear register (e.g.
+ *  GSTAT, RAMP_STAT or ENC_STATUS) would clear the flags of that chip, so only
+ *  registers without read side effects are repeated: Register the access table
+ *  of the driver with tmc_daisychain_setRegisterAccess(). Flag registers (0x21,
+ *  0x23) and all registers of chains without an access table are padded with a
+ *  read of TMC_DAISYCHAIN_PADDING_ADDRESS instead. A pending reply of such a chip
+ *  is lost if another chip of the chain is accessed before it is fetched.
+ *
+ *  Chain-wide access:
+ *  tmc_daisychain_readRegisterAll() and tmc_daisychain_writeRegisterAll() access the
+ *  same register on every chip of a chain with one transaction (two for reads),
+ *  instead of one transaction per chip. These bypass the drivers, so the shadow
+ *  register caches of the drivers are not updated.
+ *
+ *  The following callbacks need to be implemented:
+ *  - tmc_daisychain_readWriteSPI(): Full duplex transfer of [dataLength] bytes within
+ *    one chip select assertion. The received bytes are written back to [data].
+ *  - tmc_daisychain_getChainPosition(): Maps an icID to its chain and position.
+ *  - tmc_daisychain_getChainLength(): Amount of chips in a chain.
+ */
+
+#ifndef TMC_HELPERS_DAISYCHAIN_H_
+#define TMC_HELPERS_DAISYCHAIN_H_
+
+#include "Types.h"
+
+// Maximum amount of chips in one chain. The frame buffer is allocated on the
+// stack with TMC_DAISYCHAIN_DATAGRAM_LENGTH bytes per chip.
+#ifndef TMC_DAISYCHAIN_MAX_LENGTH
+#define TMC_DAISYCHAIN_MAX_LENGTH   8
+#endif
+
+// Amount of separate chains (chip selects) used with the daisy chain transport
+#ifndef TMC_DAISYCHAIN_MAX_CHAINS
+#define TMC_DAISYCHAIN_MAX_CHAINS   1
+#endif
+
+#define TMC_DAISYCHAIN_DATAGRAM_LENGTH   5
+
+// Register read by the padding datagrams if the last read register of a chip
+// can't be repeated. Has to be readable without side effects on all chips (GCONF).
+#ifndef TMC_DAISYCHAIN_PADDING_ADDRESS
+#define TMC_DAISYCHAIN_PADDING_ADDRESS   0x00
+#endif
+
+// => SPI wrapper
+extern void tmc_daisychain_readWriteSPI(uint8_t chain, uint8_t *data, size_t dataLength);
+// <= SPI wrapper
+
+extern bool tmc_daisychain_getChainPosition(uint16_t icID, uint8_t *chain, uint8_t *position);
+extern uint8_t tmc_daisychain_getChainLength(uint8_t chain);
+
+// Sets the register access table (128 entries, e.g. tmc5160_registerAccess) of the
+// chips in [chain]. The table has to stay valid while the chain is used.
+void tmc_daisychain_setRegisterAccess(uint8_t chain, const uint8_t *registerAccess);
+
+// Sends one datagram to the chip [icID] and receives its reply into [data].
+// Can be used as implementation of the driver SPI callbacks.
+void tmc_daisychain_readWriteDatagram(uint16_t icID, uint8_t *data, size_t dataLength);
+
+// Reads [address] from every chip in [chain]. [values] needs space for one value per chip.
+// [status] receives the SPI status byte of each chip and may be NULL.
+void tmc_daisychain_readRegisterAll(uint8_t chain, uint8_t address, int32_t *values, uint8_t *status);
+// Writes values[position] to [address] of every chip in [chain] with one transaction.
+void tmc_daisychain_writeRegisterAll(uint8_t chain, uint8_t address, const int32_t *values);
+
+#endif /* TMC_HELPERS_DAISYCHAIN_H_ */
@@ -28,6 +28,18 @@ int64_t tmc_limitS64(int64_t value, int64_t min, int64_t max)
 		return value;
 }
 
+int32_t tmc_sqrti(int32_t x)
+{
+	// Negative parameter?
+	if (x < 0)
+		return -1;
+
+	return tmc_sqrti32(x);
+}
+
+// Integer square roots. The results are floored: tmc_sqrti32(x)^2 <= x < (tmc_sqrti32(x) + 1)^2
+#if TMC_SQRTI_HARDWARE_DIVISION == 1
+
 /* lookup table for square root function */
 static const unsigned char sqrttable[256] =
 {
@@ -49,120 +61,125 @@ static const unsigned char sqrttable[256] =
 	247, 248, 248, 249, 249, 250, 250, 251, 251, 252, 252, 253, 253, 254, 254, 255
 };
 
-int32_t tmc_sqrti(int32_t x)
+// Table lookup of the upper 8 bits, refined with the babylonian method
+uint32_t tmc_sqrti32(uint32_t x)
 {
-	int32_t xn;
+	if (x < 0x0100)
+		return sqrttable[x] >> 4;
 
-	// Negative parameter?
-	if (x < 0)
-		return -1;
+	// Shift x into the table range by the smallest even amount (binary search)
+	uint8_t shift = 0;
+	if ((x >> 14) >= 0x0100)
+		shift += 16;
+	if ((x >> (shift + 6)) >= 0x0100)
+		shift += 8;
+	if ((x >> (shift + 2)) >= 0x0100)
+		shift += 4;
+	if ((x >> shift) >= 0x0100)
+		shift += 2;
 
-	if (x < 0x0100)
-		return (int32_t) sqrttable[x] >> 4;
+	uint32_t xn = (((uint32_t) sqrttable[x >> shift] << (shift >> 1)) >> 4) + 1;
 
+	// Below 0x10000 the table is at most one too high, above the babylonian
+	// steps refine it (they never end below the floored result)
 	if (x >= 0x00010000)
+		xn = (xn + x / xn) >> 1;
+	if (x >= 0x01000000)
+		xn = (xn + x / xn) >> 1;
+
+	// Make sure that our result is floored (65535^2 is the largest square below 2^32)
+	xn = MIN(xn, 0xFFFF);
+	while (xn * xn > x)
+		xn--;
+
+	return xn;
+}
+
+#else
+
+// Digit by digit without divisions, two bits of x per result bit
+uint32_t tmc_sqrti32(uint32_t x)
+{
+	uint32_t result = 0;
+	uint32_t bit = (uint32_t)1 << 30;
+
+	// Skip the leading zeros
+	if (x < ((uint32_t)1 << 16))
+		bit >>= 16;
+	if (x < (bit >> 6))
+		bit >>= 8;
+	if (x < (bit >> 2))
+		bit >>= 4;
+	if (x < bit)
+		bit >>= 2;
+
+	// Branchless: mask is all ones if the trial value fits
+	while (bit != 0)
 	{
-		if (x >= 0x01000000)
-		{
-			if (x >= 0x10000000)
-			{
-				if (x >= 0x40000000)
-				{
-					// 0x40000000 <= x < 0x7FFFFFFF
-					xn = (int32_t) sqrttable[x >> 24] << 8;
-				}
-				else
-				{
-					// 0x10000000 <= x < 0x40000000
-					xn = (int32_t) sqrttable[x >> 22] << 7;
-				}
-			}
-			else
-			{
-				if (x >= 0x04000000)
-				{
-					// 0x04000000 <= x < 0x10000000
-					xn = (int32_t) sqrttable[x >> 20] << 6;
-				}
-				else
-				{
-					// 0x01000000 <= x < 0x04000000
-					xn = (int32_t) sqrttable[x >> 18] << 5;
-				}
-			}
-
-			// Two steps of the babylonian method
-			xn = (xn + 1 + (x / xn)) >> 1;
-			xn = (xn + 1 + (x / xn)) >> 1;
-		}
-		else
-		{
-			if (x >= 0x00100000)
-			{
-				if (x >= 0x00400000)
-				{
-					// 0x00400000 <= x < 0x01000000
-					xn = (int32_t) sqrttable[x >> 16] << 4;
-				}
-				else
-				{
-					// 0x00100000 <= x < 0x00400000
-					xn = (int32_t) sqrttable[x >> 14] << 3;
-				}
-			}
-			else
-			{
-				if (x >= 0x00040000)
-				{
-					// 0x00040000 <= x < 0x00100000
-					xn = (int32_t) sqrttable[x >> 12] << 2;
-				}
-				else
-				{
-					// 0x00010000 <= x < 0x00040000
-					xn = (int32_t) sqrttable[x >> 10] << 1;
-				}
-			}
-
-			// One step of the babylonian method
-			xn = (xn + 1 + (x / xn)) >> 1;
-		}
+		uint32_t trial = result + bit;
+		uint32_t mask = -(uint32_t)(x >= trial);
+		x -= trial & mask;
+		result = (result >> 1) + (bit & mask);
+		bit >>= 2;
 	}
-	else
+
+	return result;
+}
+
+#endif
+
+uint32_t tmc_sqrti64(uint64_t x)
+{
+	// The 32 bit version avoids the 64 bit arithmetic for small values
+	if (x <= 0xFFFFFFFFu)
+		return tmc_sqrti32((uint32_t)x);
+
+	uint64_t result = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	if (x < ((uint64_t)1 << 48))
+		bit >>= 16;
+	while (bit > x)
+		bit >>= 2;
+
+	while (bit != 0)
 	{
-		if (x >= 0x1000)
-		{
-			if (x >= 0x4000)
-			{
-				// 0x4000 <= x < 0x00010000
-				xn = (int32_t) (sqrttable[x >> 8] ) + 1;
-			}
-			else
-			{
-				// 0x1000 <= x < 0x4000
-				xn = (int32_t) (sqrttable[x >> 6] >> 1) + 1;
-			}
-		}
-		else
-		{
-			if (x >= 0x0400)
-			{
-				// 0x0400 <= x < 0x1000
-				xn = (int32_t) (sqrttable[x >> 4] >> 2) + 1;
-			}
-			else
-			{
-				// 0x0100 <= x < 0x0400
-				xn = (int32_t) (sqrttable[x >> 2] >> 3) + 1;
-			}
-		}
+		uint64_t trial = result + bit;
+		uint64_t mask = -(uint64_t)(x >= trial);
+		x -= trial & mask;
+		result = (result >> 1) + (bit & mask);
+		bit >>= 2;
 	}
 
-	// Make sure that our result is floored
-	if ((xn * xn) > x)
-		xn--;
+	return result;
+}
 
-	return xn;
+// Reciprocal square root: floor(2^32 / sqrt(x)), saturated to 0xFFFFFFFF for x <= 1.
+// Determined bit by bit, a bit is kept while result^2 * x <= 2^64.
+uint32_t tmc_rsqrti32(uint32_t x)
+{
+	if (x <= 1)
+		return 0xFFFFFFFFu;
+
+	// Start with the highest possible bit: 4^k <= x < 4^(k+1) results in at most 2^(32-k)
+	uint32_t bit = (uint32_t)1 << 31;
+	for (uint32_t y = x; y >= 16; y >>= 2)
+		bit >>= 1;
+
+	uint32_t result = 0;
+	for (; bit != 0; bit >>= 1)
+	{
+		uint64_t square = (uint64_t)(result | bit) * (result | bit);
+
+		// square * x <= 2^64, with a 64 x 32 bit multiplication split into two halves
+		uint64_t low = (square & 0xFFFFFFFFu) * x;
+		uint64_t high = (square >> 32) * x + (low >> 32);
+
+		if (high < ((uint64_t)1 << 32) || (high == ((uint64_t)1 << 32) && (uint32_t)low == 0))
+			result |= bit;
+	}
+
+	return result;
 }
 
 int32_t tmc_filterPT1(int64_t *akku, int32_t newValue, int32_t lastValue, uint8_t actualFilter, uint8_t maxFilter)
@@ -170,3 +187,12 @@ int32_t tmc_filterPT1(int64_t *akku, int32_t newValue, int32_t lastValue, uint8_
 	*akku += (newValue-lastValue) << (maxFilter-actualFilter);
 	return *akku >> maxFilter;
 }
+
+void tmc_filterPT1Bank(int64_t *akku, int32_t *values, const int32_t *newValues, const uint8_t *actualFilter, uint8_t maxFilter, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		akku[i] += ((int64_t) newValues[i] - values[i]) << (maxFilter - actualFilter[i]);
+		values[i] = akku[i] >> maxFilter;
+	}
+}
@@ -11,9 +11,28 @@
 
 #include "API_Header.h"
 
+// tmc_sqrti32() uses a table and divisions by default. Set to 0 on cores without hardware
+// division (e.g. Cortex-M0) for the division-free digit by digit calculation instead.
+#ifndef TMC_SQRTI_HARDWARE_DIVISION
+#define TMC_SQRTI_HARDWARE_DIVISION 1
+#endif
+
 int32_t tmc_limitInt(int32_t value, int32_t min, int32_t max);
 int64_t tmc_limitS64(int64_t value, int64_t min, int64_t max);
 int32_t tmc_sqrti(int32_t x);
+uint32_t tmc_sqrti32(uint32_t x);
+uint32_t tmc_sqrti64(uint64_t x);
+uint32_t tmc_rsqrti32(uint32_t x);
 int32_t tmc_filterPT1(int64_t *akku, int32_t newValue, int32_t lastValue, uint8_t actualFilter, uint8_t maxFilter);
 
+// Filter bank: Filters [count] channels stored in contiguous arrays in one call.
+// Channel i computes
+//     values[i] = tmc_filterPT1(&akku[i], newValues[i], values[i], actualFilter[i], maxFilter);
+// (values holds the last filter outputs and is updated in place). The bank widens the
+// input difference to 64 bit before shifting it by (maxFilter - actualFilter), while
+// tmc_filterPT1() shifts in 32 bit. The results are equal as long as the shifted
+// difference fits into 32 bit, beyond that tmc_filterPT1() overflows. The loop has no
+// branches or calls, so the compiler can vectorize it.
+void tmc_filterPT1Bank(int64_t *akku, int32_t *values, const int32_t *newValues, const uint8_t *actualFilter, uint8_t maxFilter, uint32_t count);
+
 #endif /* TMC_FUNCTIONS_H_ */
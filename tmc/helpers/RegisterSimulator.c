@@ -0,0 +1,241 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+#include "RegisterSimulator.h"
+
+#define ADDRESS_MASK  0x7F
+#define WRITE_BIT     0x80
+
+#define UART_SYNC          0x05
+#define UART_MASTER        0xFF
+#define UART_READ_LENGTH   4
+#define UART_WRITE_LENGTH  8
+
+// Register access permissions, see the access tables of the drivers
+#define ACCESS_READ        0x01
+#define ACCESS_WRITE       0x02
+#define ACCESS_SEPARATE    0x10  // Separate values for reading and writing
+#define ACCESS_FLAGS       0x20  // Flag register: write 1 to clear (0x23) or read to clear (0x21)
+
+static uint32_t readRegister(TMC_RegisterSimulator *simulator, uint8_t address);
+static void writeRegister(TMC_RegisterSimulator *simulator, uint8_t address, uint32_t value);
+static uint32_t getValue(uint8_t *data);
+static void setValue(uint8_t *data, uint32_t value);
+static uint8_t uartCRC(uint8_t *data, size_t length);
+
+void tmc_simulator_init(TMC_RegisterSimulator *simulator, const uint8_t *registerAccess, const int32_t *resetValues)
+{
+	simulator->registerAccess = registerAccess;
+
+	for(size_t i = 0; i < TMC_SIMULATOR_REGISTER_COUNT; i++)
+	{
+		uint32_t value = (resetValues) ? (uint32_t) resetValues[i] : 0;
+
+		simulator->registers[i]      = (registerAccess[i] & ACCESS_READ) ? value : 0;
+		simulator->writeRegisters[i] = value;
+	}
+
+	// Reset flag
+	simulator->registers[TMC_SIMULATOR_GSTAT] |= 0x01;
+
+	simulator->spiReply          = 0;
+	simulator->spiStatus         = 0;
+	simulator->nodeAddress       = 0;
+	simulator->uartReplyDelay    = 8;
+
+	simulator->spiBitTime        = TMC_SIMULATOR_DEFAULT_SPI_BIT_TIME;
+	simulator->spiTransferTime   = TMC_SIMULATOR_DEFAULT_SPI_TRANSFER_TIME;
+	simulator->uartBitTime       = TMC_SIMULATOR_DEFAULT_UART_BIT_TIME;
+	simulator->uartTransferTime  = 0;
+
+	tmc_simulator_resetStatistics(simulator);
+}
+
+void tmc_simulator_readWriteSPI(TMC_RegisterSimulator *simulator, uint8_t *data, size_t dataLength)
+{
+	simulator->spiTransfers++;
+	simulator->busTime += simulator->spiTransferTime + (uint64_t) dataLength * 8 * simulator->spiBitTime;
+
+	if(dataLength != TMC_SIMULATOR_DATAGRAM_LENGTH)
+	{
+		simulator->busErrors++;
+		return;
+	}
+
+	bool isWrite = data[0] & WRITE_BIT;
+	uint8_t address = data[0] & ADDRESS_MASK;
+	uint32_t value = getValue(&data[1]);
+
+	// Shift out the status and the reply to the previous datagram
+	data[0] = (simulator->spiStatus & 0xFC) | (simulator->registers[TMC_SIMULATOR_GSTAT] & 0x03);
+	setValue(&data[1], simulator->spiReply);
+
+	if(isWrite)
+	{
+		writeRegister(simulator, address, value);
+		simulator->spiReply = value;
+	}
+	else
+	{
+		simulator->spiReply = readRegister(simulator, address);
+	}
+}
+
+bool tmc_simulator_readWriteUART(TMC_RegisterSimulator *simulator, uint8_t *data, size_t writeLength, size_t readLength)
+{
+	simulator->uartTransfers++;
+	simulator->busTime += simulator->uartTransferTime + (uint64_t) writeLength * 10 * simulator->uartBitTime;
+
+	bool isWrite = writeLength == UART_WRITE_LENGTH && (data[2] & WRITE_BIT);
+	bool isRead = writeLength == UART_READ_LENGTH && !(data[2] & WRITE_BIT);
+
+	if((!isWrite && !isRead) || (data[0] & 0x0F) != UART_SYNC || data[1] != simulator->nodeAddress || data[writeLength-1] != uartCRC(data, writeLength-1))
+	{
+		// No reply to invalid requests
+		simulator->busErrors++;
+		simulator->busTime += (uint64_t) readLength * 10 * simulator->uartBitTime;
+		return readLength == 0;
+	}
+
+	uint8_t address = data[2] & ADDRESS_MASK;
+
+	if(isWrite)
+	{
+		writeRegister(simulator, address, getValue(&data[3]));
+		simulator->registers[TMC_SIMULATOR_IFCNT] = (simulator->registers[TMC_SIMULATOR_IFCNT] + 1) & 0xFF;
+		return true;
+	}
+
+	if(readLength < UART_WRITE_LENGTH)
+		return false;
+
+	// Reply after the send delay
+	simulator->busTime += (uint64_t) (simulator->uartReplyDelay + UART_WRITE_LENGTH * 10) * simulator->uartBitTime;
+
+	data[0] = UART_SYNC;
+	data[1] = UART_MASTER;
+	data[2] = address;
+	setValue(&data[3], readRegister(simulator, address));
+	data[7] = uartCRC(data, 7);
+
+	return true;
+}
+
+void tmc_simulator_setRegister(TMC_RegisterSimulator *simulator, uint8_t address, uint32_t value)
+{
+	simulator->registers[address & ADDRESS_MASK] = value;
+}
+
+void tmc_simulator_setFlags(TMC_RegisterSimulator *simulator, uint8_t address, uint32_t mask)
+{
+	simulator->registers[address & ADDRESS_MASK] |= mask;
+}
+
+uint32_t tmc_simulator_getRegister(TMC_RegisterSimulator *simulator, uint8_t address)
+{
+	return simulator->registers[address & ADDRESS_MASK];
+}
+
+uint32_t tmc_simulator_getWrittenRegister(TMC_RegisterSimulator *simulator, uint8_t address)
+{
+	return simulator->writeRegisters[address & ADDRESS_MASK];
+}
+
+void tmc_simulator_resetStatistics(TMC_RegisterSimulator *simulator)
+{
+	simulator->busTime        = 0;
+	simulator->spiTransfers   = 0;
+	simulator->uartTransfers  = 0;
+	simulator->busErrors      = 0;
+
+	for(size_t i = 0; i < TMC_SIMULATOR_REGISTER_COUNT; i++)
+	{
+		simulator->readCount[i]  = 0;
+		simulator->writeCount[i] = 0;
+	}
+}
+
+static uint32_t readRegister(TMC_RegisterSimulator *simulator, uint8_t address)
+{
+	simulator->readCount[address]++;
+
+	uint8_t access = simulator->registerAccess[address];
+
+	// Write only and reserved registers read as 0
+	if(!(access & ACCESS_READ))
+		return 0;
+
+	uint32_t value = simulator->registers[address];
+
+	// Flag registers without write access are cleared by reading them
+	if((access & (ACCESS_FLAGS | ACCESS_WRITE)) == ACCESS_FLAGS)
+		simulator->registers[address] = 0;
+
+	return value;
+}
+
+static void writeRegister(TMC_RegisterSimulator *simulator, uint8_t address, uint32_t value)
+{
+	uint8_t access = simulator->registerAccess[address];
+
+	simulator->writeCount[address]++;
+
+	if(!(access & ACCESS_WRITE))
+		return;
+
+	simulator->writeRegisters[address] = value;
+
+	if(access & ACCESS_FLAGS)
+	{
+		simulator->registers[address] &= ~value;
+	}
+	else if((access & ACCESS_READ) && !(access & ACCESS_SEPARATE))
+	{
+		simulator->registers[address] = value;
+	}
+
+	if(address == TMC_SIMULATOR_NODECONF)
+	{
+		// NODEADDR and SENDDELAY (0, 1: 8 bit times, 2, 3: 3*8 bit times, ...)
+		simulator->nodeAddress = value & 0xFF;
+		simulator->uartReplyDelay = ((((value >> 8) & 0x0F) >> 1) * 2 + 1) * 8;
+	}
+}
+
+static uint32_t getValue(uint8_t *data)
+{
+	return ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | data[3];
+}
+
+static void setValue(uint8_t *data, uint32_t value)
+{
+	data[0] = (value >> 24) & 0xFF;
+	data[1] = (value >> 16) & 0xFF;
+	data[2] = (value >> 8) & 0xFF;
+	data[3] = value & 0xFF;
+}
+
+// CRC8 of the UART datagrams (polynomial x^8 + x^2 + x + 1, LSB first), calculated bitwise
+// as described in the datasheets. Independent of the table based CRC of the drivers.
+static uint8_t uartCRC(uint8_t *data, size_t length)
+{
+	uint8_t crc = 0;
+
+	for(size_t i = 0; i < length; i++)
+	{
+		uint8_t byte = data[i];
+
+		for(uint8_t j = 0; j < 8; j++)
+		{
+			if((crc >> 7) ^ (byte & 0x01))
+				crc = (crc << 1) ^ 0x07;
+			else
+				crc = crc << 1;
+
+			byte >>= 1;
+		}
+	}
+
+	return crc;
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+/*
+ *  Host-side register simulator for TMC chips with 40 bit SPI datagrams and the
+ *  single wire UART interface, e.g. TMC5160 and TMC5130.
+ *
+ *  The simulated chip implements the bus side of the driver callbacks, so the
+ *  register access layer (tmc5160_readRegister(), tmc5160_writeRegister(), the
+ *  caches, pipelined reads, ...) can be run and benchmarked without hardware:
+ *
+ *      static TMC_RegisterSimulator simulator;
+ *
+ *      tmc_simulator_init(&simulator, tmc5160_registerAccess, tmc5160_sampleRegisterPreset);
+ *
+ *      void tmc5160_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+ *      {
+ *          tmc_simulator_readWriteSPI(&simulator, data, dataLength);
+ *      }
+ *
+ *      bool tmc5160_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+ *      {
+ *          return tmc_simulator_readWriteUART(&simulator, data, writeLength, readLength);
+ *      }
+ *
+ *  Modelled behaviour:
+ *  - SPI: The reply to a read request is returned with the next datagram (delayed
+ *    reply pipeline). After a write, the next datagram returns the written value.
+ *    The status byte contains the reset and driver error flags of GSTAT and the
+ *    bits 2..7 of spiStatus.
+ *  - The register access table of the driver decides what happens with each register:
+ *    - Read only registers ignore writes.
+ *    - Write only registers read back as 0.
+ *    - Registers with separate read and write values keep both.
+ *    - For flag registers (0x23), writing a 1 clears the flag.
+ *    - Read to clear flag registers (0x21, e.g. GSTAT, RAMP_STAT and ENC_STATUS of
+ *      the TMC5130) are cleared by every read. This also clears the GSTAT bits of
+ *      the SPI status byte.
+ *    - Reserved addresses read as 0 and ignore writes.
+ *  - UART: Sync nibble, node address and CRC of the requests are checked. Invalid
+ *    requests are ignored (no reply, no register change). Successful writes increment
+ *    IFCNT, writes to NODECONF change the node address and the send delay.
+ *  - Bus timing: Every transfer advances the simulated bus time (in ns) by its
+ *    duration, calculated from the configurable bit times and latencies.
+ *  - After tmc_simulator_init() the reset flag of GSTAT is set.
+ *
+ *  The chip itself (motion, sensors, ...) is not simulated. Test code can change
+ *  the values seen by the driver with tmc_simulator_setRegister() and
+ *  tmc_simulator_setFlags().
+ */
+
+#ifndef TMC_HELPERS_REGISTERSIMULATOR_H_
+#define TMC_HELPERS_REGISTERSIMULATOR_H_
+
+#include "Types.h"
+
+#define TMC_SIMULATOR_REGISTER_COUNT     128
+#define TMC_SIMULATOR_DATAGRAM_LENGTH    5
+
+// Registers with a special function on the bus
+#define TMC_SIMULATOR_GSTAT      0x01
+#define TMC_SIMULATOR_IFCNT      0x02
+#define TMC_SIMULATOR_NODECONF   0x03
+
+// Default timing: 4 MHz SPI with 1 µs chip select overhead, 115200 baud UART
+#define TMC_SIMULATOR_DEFAULT_SPI_BIT_TIME         250
+#define TMC_SIMULATOR_DEFAULT_SPI_TRANSFER_TIME    1000
+#define TMC_SIMULATOR_DEFAULT_UART_BIT_TIME        8681
+
+typedef struct
+{
+	const uint8_t *registerAccess;  // Access table of the driver (e.g. tmc5160_registerAccess)
+
+	uint32_t registers[TMC_SIMULATOR_REGISTER_COUNT];       // Values returned by reads
+	uint32_t writeRegisters[TMC_SIMULATOR_REGISTER_COUNT];  // Last written values
+
+	// Bus state
+	uint32_t spiReply;       // Data returned with the next SPI datagram
+	uint8_t spiStatus;       // Status bits 2..7 of the SPI replies
+	uint8_t nodeAddress;     // UART node address
+	uint32_t uartReplyDelay; // Delay before a UART reply in bit times (NODECONF.SENDDELAY)
+
+	// Timing in ns, may be changed after tmc_simulator_init()
+	uint32_t spiBitTime;
+	uint32_t spiTransferTime;  // Additional time per SPI datagram (chip select, driver latency)
+	uint32_t uartBitTime;
+	uint32_t uartTransferTime; // Additional time per UART transfer (driver latency)
+	uint64_t busTime;          // Simulated time spent on the bus
+
+	// Statistics
+	uint32_t spiTransfers;
+	uint32_t uartTransfers;
+	uint32_t busErrors;        // Malformed SPI datagrams, UART sync, node address and CRC errors
+	uint32_t readCount[TMC_SIMULATOR_REGISTER_COUNT];
+	uint32_t writeCount[TMC_SIMULATOR_REGISTER_COUNT];
+} TMC_RegisterSimulator;
+
+// [registerAccess] and [resetValues] (may be NULL) have TMC_SIMULATOR_REGISTER_COUNT entries.
+// The access table has to stay valid while the simulator is used.
+void tmc_simulator_init(TMC_RegisterSimulator *simulator, const uint8_t *registerAccess, const int32_t *resetValues);
+
+// Bus side of the driver callbacks
+void tmc_simulator_readWriteSPI(TMC_RegisterSimulator *simulator, uint8_t *data, size_t dataLength);
+bool tmc_simulator_readWriteUART(TMC_RegisterSimulator *simulator, uint8_t *data, size_t writeLength, size_t readLength);
+
+// Chip side: Changes the value returned by reads of [address], e.g. to simulate sensor readings
+void tmc_simulator_setRegister(TMC_RegisterSimulator *simulator, uint8_t address, uint32_t value);
+// Chip side: Sets flags of [address], which the driver can clear by writing 1 to them
+void tmc_simulator_setFlags(TMC_RegisterSimulator *simulator, uint8_t address, uint32_t mask);
+
+uint32_t tmc_simulator_getRegister(TMC_RegisterSimulator *simulator, uint8_t address);
+uint32_t tmc_simulator_getWrittenRegister(TMC_RegisterSimulator *simulator, uint8_t address);
+
+// Resets the bus time and the statistics
+void tmc_simulator_resetStatistics(TMC_RegisterSimulator *simulator);
+
+#endif /* TMC_HELPERS_REGISTERSIMULATOR_H_ */
@@ -38,6 +38,37 @@
 //#define TMC2209_ENABLE_TMC_CACHE   0
 #endif
 
+// To serve reads of stable read/write configuration registers from the cache, set TMC2209_CACHE_READ_THROUGH to '1'.
+// The registers listed in TMC2209_CACHE_READ_THROUGH_REGISTERS are then read from the chip once (or written)
+// and afterwards read from their shadow copies. The policy is applied by tmc2209_initCache() and can
+// also be changed per register at runtime with tmc2209_setCacheReadThrough().
+// Call tmc2209_invalidateCache() if the chip might have lost its configuration (e.g. after a reset).
+#ifndef TMC2209_CACHE_READ_THROUGH
+#define TMC2209_CACHE_READ_THROUGH   0
+//#define TMC2209_CACHE_READ_THROUGH   1
+#endif
+
+#ifndef TMC2209_CACHE_READ_THROUGH_REGISTERS
+#define TMC2209_CACHE_READ_THROUGH_REGISTERS   { TMC2209_GCONF, TMC2209_CHOPCONF, TMC2209_PWMCONF }
+#endif
+
+// To record bus transaction statistics (transfers, bytes, cache hits/misses, CRC errors and
+// latency histograms per register) set TMC2209_BUS_STATISTICS to '1'. The statistics are kept for
+// the first TMC2209_BUS_STATISTICS_COUNT ICs, see tmc/helpers/BusStatistics.h. The application
+// has to implement tmc_bus_statistics_getTime() and link tmc/helpers/BusStatistics.c.
+#ifndef TMC2209_BUS_STATISTICS
+#define TMC2209_BUS_STATISTICS   0
+//#define TMC2209_BUS_STATISTICS   1
+#endif
+
+#ifndef TMC2209_BUS_STATISTICS_COUNT
+#define TMC2209_BUS_STATISTICS_COUNT   1
+#endif
+
+#if TMC2209_BUS_STATISTICS == 1
+#include "tmc/helpers/BusStatistics.h"
+#endif
+
 /******************************************************************************/
 
 // => TMC-API wrapper
@@ -48,6 +79,11 @@ extern uint8_t tmc2209_getNodeAddress(uint16_t icID);
 int32_t tmc2209_readRegister(uint16_t icID, uint8_t address);
 void tmc2209_writeRegister(uint16_t icID, uint8_t address, int32_t value);
 
+#if TMC2209_BUS_STATISTICS == 1
+// Returns the bus statistics of [icID] or NULL if [icID] >= TMC2209_BUS_STATISTICS_COUNT
+TMC_BusStatistics *tmc2209_getBusStatistics(uint16_t icID);
+#endif
+
 typedef struct
 {
     uint32_t mask;
@@ -92,6 +128,56 @@ static inline void tmc2209_fieldWrite(uint16_t icID, RegisterField field, uint32
     tmc2209_writeRegister(icID, field.address, regValue);
 }
 
+// Coalesced field updates: Several fields of one register are changed with a single write.
+// The register value is taken from the cache if possible (write-only registers or valid
+// read-through registers), otherwise it is read from the chip once in tmc2209_fieldBegin().
+// Example:
+//     TMC2209FieldUpdate update = tmc2209_fieldBegin(icID, field1.address);
+//     tmc2209_fieldSet(&update, field1, value1);
+//     tmc2209_fieldSet(&update, field2, value2);
+//     tmc2209_fieldCommit(&update);
+typedef struct
+{
+    uint16_t icID;
+    uint8_t address;
+    bool modified;
+    uint32_t value;
+} TMC2209FieldUpdate;
+
+static inline TMC2209FieldUpdate tmc2209_fieldBegin(uint16_t icID, uint8_t address)
+{
+    TMC2209FieldUpdate update;
+
+    update.icID     = icID;
+    update.address  = address;
+    update.modified = false;
+    update.value    = tmc2209_readRegister(icID, address);
+
+    return update;
+}
+
+// Returns false if the field belongs to a different register than the one passed to tmc2209_fieldBegin()
+static inline bool tmc2209_fieldSet(TMC2209FieldUpdate *update, RegisterField field, uint32_t value)
+{
+    if (field.address != update->address)
+        return false;
+
+    update->value    = tmc2209_fieldUpdate(update->value, field, value);
+    update->modified = true;
+
+    return true;
+}
+
+// Writes the register if any field has been set
+static inline void tmc2209_fieldCommit(TMC2209FieldUpdate *update)
+{
+    if (!update->modified)
+        return;
+
+    tmc2209_writeRegister(update->icID, update->address, update->value);
+    update->modified = false;
+}
+
 /**************************************************************** Cache Implementation *************************************************************************/
 #if TMC2209_CACHE == 1
 #if TMC2209_ENABLE_TMC_CACHE == 1
@@ -111,10 +197,20 @@ typedef enum {
 	// from write-only registers that have a value inside them on reset. When using this
 	// operation, a restore will *not* rewrite that filled register!
 	TMC2209_CACHE_FILL_DEFAULT,
+
+	// Special operation: Put a value read from the chip into the cache without marking the
+	// entry as dirty. Only stored for registers using the read-through policy.
+	TMC2209_CACHE_FILL_READ
 } TMC2209CacheOp;
 
 #define TMC2209_ACCESS_READ        0x01
 #define TMC2209_IS_READABLE(x)    ((x) & TMC2209_ACCESS_READ)
+#define ARRAY_SIZE(x)              (sizeof(x)/sizeof(x[0]))
+
+// Registers that may use the read-through cache policy: configuration registers that are only
+// changed by the application, not values the chip updates itself.
+#define TMC2209_READ_THROUGH_CAPABLE_REGISTERS { \
+    TMC2209_GCONF, TMC2209_FACTORY_CONF, TMC2209_CHOPCONF, TMC2209_PWMCONF }
 
 // Default Register values
 #define R00 0x00000040  // GCONF
@@ -167,9 +263,15 @@ static const int32_t tmc2209_sampleRegisterPreset[TMC2209_REGISTER_COUNT] =
 
 extern uint8_t tmc2209_dirtyBits[TMC2209_IC_CACHE_COUNT][TMC2209_REGISTER_COUNT/8];
 extern int32_t tmc2209_shadowRegister[TMC2209_IC_CACHE_COUNT][TMC2209_REGISTER_COUNT];
+extern uint8_t tmc2209_validBits[TMC2209_IC_CACHE_COUNT][TMC2209_REGISTER_COUNT/8];
+extern uint8_t tmc2209_readThroughBits[TMC2209_IC_CACHE_COUNT][TMC2209_REGISTER_COUNT/8];
+bool tmc2209_setCacheReadThrough(uint16_t icID, uint8_t address, bool enable);
+bool tmc2209_getCacheReadThrough(uint16_t icID, uint8_t address);
+void tmc2209_invalidateCache(uint16_t icID);
 void tmc2209_setDirtyBit(uint16_t icID, uint8_t index, bool value);
 bool tmc2209_getDirtyBit(uint16_t icID, uint8_t index);
 extern bool tmc2209_cache(uint16_t icID, TMC2209CacheOp operation, uint8_t address, uint32_t *value);
+void tmc2209_initCache(void);
 #endif
 #endif
 
@@ -13,6 +13,7 @@ extern const uint8_t tmcCRCTable_Poly7Reflected[256];
 #else
 const uint8_t tmcCRCTable_Poly7Reflected[256] = {
         0x00, 0x91, 0xE3, 0x72, 0x07, 0x96, 0xE4, 0x75, 0x0E, 0x9F, 0xED, 0x7C, 0x09, 0x98, 0xEA, 0x7B,
+        0x1C, 0x8D, 0xFF, 0x6E, 0x1B, 0x8A, 0xF8, 0x69, 0x12, 0x83, 0xF1, 0x60, 0x15, 0x84, 0xF6, 0x67,
         0x38, 0xA9, 0xDB, 0x4A, 0x3F, 0xAE, 0xDC, 0x4D, 0x36, 0xA7, 0xD5, 0x44, 0x31, 0xA0, 0xD2, 0x43,
         0x24, 0xB5, 0xC7, 0x56, 0x23, 0xB2, 0xC0, 0x51, 0x2A, 0xBB, 0xC9, 0x58, 0x2D, 0xBC, 0xCE, 0x5F,
         0x70, 0xE1, 0x93, 0x02, 0x77, 0xE6, 0x94, 0x05, 0x7E, 0xEF, 0x9D, 0x0C, 0x79, 0xE8, 0x9A, 0x0B,
@@ -45,6 +46,8 @@ static inline bool tmc2240_cache(uint16_t icID, TMC2240CacheOp operation, uint8_
 
 uint8_t tmc2240_dirtyBits[TMC2240_IC_CACHE_COUNT][TMC2240_REGISTER_COUNT/8]= {0};
 int32_t tmc2240_shadowRegister[TMC2240_IC_CACHE_COUNT][TMC2240_REGISTER_COUNT];
+uint8_t tmc2240_validBits[TMC2240_IC_CACHE_COUNT][TMC2240_REGISTER_COUNT/8] = {0};
+uint8_t tmc2240_readThroughBits[TMC2240_IC_CACHE_COUNT][TMC2240_REGISTER_COUNT/8] = {0};
 
 void tmc2240_setDirtyBit(uint16_t icID, uint8_t index, bool value)
 {
@@ -66,6 +69,75 @@ bool tmc2240_getDirtyBit(uint16_t icID, uint8_t index)
     uint8_t shift = (index % 8);
     return ((*tmp) >> shift) & 1;
 }
+
+static void setCacheBit(uint8_t *bits, uint8_t index, bool value)
+{
+    if(index >= TMC2240_REGISTER_COUNT)
+        return;
+
+    uint8_t mask = 1 << (index % 8);
+    bits[index / 8] = value ? (bits[index / 8] | mask) : (bits[index / 8] & ~mask);
+}
+
+static bool getCacheBit(uint8_t *bits, uint8_t index)
+{
+    if(index >= TMC2240_REGISTER_COUNT)
+        return false;
+
+    return (bits[index / 8] >> (index % 8)) & 1;
+}
+
+static bool isReadThroughCapable(uint8_t address)
+{
+    static const uint8_t capableRegisters[] = TMC2240_READ_THROUGH_CAPABLE_REGISTERS;
+
+    for (size_t i = 0; i < ARRAY_SIZE(capableRegisters); i++)
+    {
+        if (capableRegisters[i] == address)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * Sets the cache policy of a readable register. With read-through enabled, reads are served from the
+ * shadow copy once it holds a valid value (after the first read from or write to the chip).
+ * Only the configuration registers listed in TMC2240_READ_THROUGH_CAPABLE_REGISTERS support this.
+ */
+bool tmc2240_setCacheReadThrough(uint16_t icID, uint8_t address, bool enable)
+{
+    if (icID >= TMC2240_IC_CACHE_COUNT || address >= TMC2240_REGISTER_COUNT)
+        return false;
+
+    if (enable && !isReadThroughCapable(address))
+        return false;
+
+    setCacheBit(tmc2240_readThroughBits[icID], address, enable);
+    setCacheBit(tmc2240_validBits[icID], address, false);
+    return true;
+}
+
+bool tmc2240_getCacheReadThrough(uint16_t icID, uint8_t address)
+{
+    if (icID >= TMC2240_IC_CACHE_COUNT)
+        return false;
+
+    return getCacheBit(tmc2240_readThroughBits[icID], address);
+}
+
+/*
+ * Marks the shadow copies of all read-through registers as invalid,
+ * so they are read from the chip again on the next access.
+ */
+void tmc2240_invalidateCache(uint16_t icID)
+{
+    if (icID >= TMC2240_IC_CACHE_COUNT)
+        return;
+
+    for (size_t i = 0; i < TMC2240_REGISTER_COUNT/8; i++)
+        tmc2240_validBits[icID][i] = 0;
+}
 /*
  * This function is used to cache the value written to the Write-Only registers in the form of shadow array.
  * The shadow copy is then used to read these kinds of registers.
@@ -81,9 +153,10 @@ bool tmc2240_cache(uint16_t icID, TMC2240CacheOp operation, uint8_t address, uin
         if (icID >= TMC2240_IC_CACHE_COUNT)
             return false;
 
-        // Only non-readable registers care about caching
-        // Note: This could also be used to cache i.e. RW config registers to reduce bus accesses
-        if (TMC2240_IS_READABLE(tmc2240_registerAccess[address]))
+        // Non-readable registers are always served from the cache. Readable registers only
+        // if they use the read-through policy and their shadow copy holds a valid value.
+        if (TMC2240_IS_READABLE(tmc2240_registerAccess[address])
+            && !(getCacheBit(tmc2240_readThroughBits[icID], address) && getCacheBit(tmc2240_validBits[icID], address)))
             return false;
 
         // Grab the value from the cache
@@ -104,15 +177,45 @@ bool tmc2240_cache(uint16_t icID, TMC2240CacheOp operation, uint8_t address, uin
         if (operation == TMC2240_CACHE_WRITE)
         {
             tmc2240_setDirtyBit(icID, address, true);
+
+            // Writing a read-through register makes its shadow copy valid
+            if (getCacheBit(tmc2240_readThroughBits[icID], address))
+                setCacheBit(tmc2240_validBits[icID], address, true);
         }
 
         return true;
     }
+    else if (operation == TMC2240_CACHE_FILL_READ)
+    {
+        // Store values read from the chip for read-through registers
+
+        // only supported chips have a cache
+        if (icID >= TMC2240_IC_CACHE_COUNT)
+            return false;
+
+        if (!getCacheBit(tmc2240_readThroughBits[icID], address))
+            return false;
+
+        tmc2240_shadowRegister[icID][address] = *value;
+        setCacheBit(tmc2240_validBits[icID], address, true);
+        return true;
+    }
     return false;
 }
 
 void tmc2240_initCache()
 {
+#if TMC2240_CACHE_READ_THROUGH == 1
+    // Apply the default read-through policy
+    static const uint8_t readThroughRegisters[] = TMC2240_CACHE_READ_THROUGH_REGISTERS;
+
+    for (size_t id = 0; id < TMC2240_IC_CACHE_COUNT; id++)
+    {
+        for (size_t k = 0; k < ARRAY_SIZE(readThroughRegisters); k++)
+            tmc2240_setCacheReadThrough(id, readThroughRegisters[k], true);
+    }
+#endif
+
     // Check if we have constants defined
     if(ARRAY_SIZE(tmc2240_RegisterConstants) == 0)
         return;
@@ -157,19 +260,105 @@ extern bool tmc2240_cache(uint16_t icID, TMC2240CacheOp operation, uint8_t addre
 
 
 static int32_t readRegisterSPI(uint16_t icID, uint8_t address);
+static void readRegistersSPI(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count);
 static void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value);
 static int32_t readRegisterUART(uint16_t icID, uint8_t registerAddress);
 static void writeRegisterUART(uint16_t icID, uint8_t registerAddress, int32_t value);
 static uint8_t CRC8(uint8_t *data, uint32_t bytes);
 
+/************************************************************** Bus statistics ******************************************************************/
+#if TMC2240_BUS_STATISTICS == 1
+static TMC_BusStatistics busStatistics[TMC2240_BUS_STATISTICS_COUNT];
+
+TMC_BusStatistics *tmc2240_getBusStatistics(uint16_t icID)
+{
+    if (icID >= TMC2240_BUS_STATISTICS_COUNT)
+        return NULL;
+
+    return &busStatistics[icID];
+}
+
+static void readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+    TMC_BusStatistics *statistics = tmc2240_getBusStatistics(icID);
+
+    if (!statistics)
+    {
+        tmc2240_readWriteSPI(icID, data, dataLength);
+        return;
+    }
+
+    // The datagram is overwritten with the reply, keep the address byte
+    uint8_t address = data[0];
+    uint32_t startTime = tmc_bus_statistics_getTime();
+
+    tmc2240_readWriteSPI(icID, data, dataLength);
+
+    tmc_bus_statistics_recordTransfer(statistics, tmc_bus_statistics_getTime() - startTime);
+    tmc_bus_statistics_recordDatagram(statistics, address, dataLength, dataLength);
+}
+
+static bool readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+    TMC_BusStatistics *statistics = tmc2240_getBusStatistics(icID);
+
+    if (!statistics)
+        return tmc2240_readWriteUART(icID, data, writeLength, readLength);
+
+    uint8_t address = data[2];
+    uint32_t startTime = tmc_bus_statistics_getTime();
+
+    bool success = tmc2240_readWriteUART(icID, data, writeLength, readLength);
+
+    tmc_bus_statistics_recordTransfer(statistics, tmc_bus_statistics_getTime() - startTime);
+    tmc_bus_statistics_recordDatagram(statistics, address, writeLength, success ? readLength : 0);
+
+    if (!success)
+        tmc_bus_statistics_recordReplyError(statistics);
+
+    return success;
+}
+
+static void recordCache(uint16_t icID, uint8_t address, bool hit)
+{
+    TMC_BusStatistics *statistics = tmc2240_getBusStatistics(icID);
+
+    if (statistics)
+        tmc_bus_statistics_recordCache(statistics, address, hit);
+}
+
+static void recordReplyError(uint16_t icID, bool crcError)
+{
+    TMC_BusStatistics *statistics = tmc2240_getBusStatistics(icID);
+
+    if (!statistics)
+        return;
+
+    if (crcError)
+        tmc_bus_statistics_recordCRCError(statistics);
+    else
+        tmc_bus_statistics_recordReplyError(statistics);
+}
+#else
+// Statistics disabled: Call the callbacks directly
+#define readWriteSPI         tmc2240_readWriteSPI
+#define readWriteUART        tmc2240_readWriteUART
+#define recordCache(icID, address, hit)
+#define recordReplyError(icID, crcError)
+#endif
+/*************************************************************************************************************************************************/
+
 
 
 int32_t tmc2240_readRegister(uint16_t icID, uint8_t address)
 {
     uint32_t value;
 
-    // Read from cache for registers with write-only access
-    if (tmc2240_cache(icID, TMC2240_CACHE_READ, address, &value))
+    // Read from cache for write-only registers and valid read-through registers
+    bool cacheHit = tmc2240_cache(icID, TMC2240_CACHE_READ, address, &value);
+    recordCache(icID, address, cacheHit);
+
+    if (cacheHit)
         return value;
 
     TMC2240BusType bus = tmc2240_getBusType(icID);
@@ -186,6 +375,23 @@ int32_t tmc2240_readRegister(uint16_t icID, uint8_t address)
     // ToDo: Error handling
     return -1;
 }
+void tmc2240_readRegisters(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count)
+{
+    TMC2240BusType bus = tmc2240_getBusType(icID);
+
+    if(bus == IC_BUS_SPI)
+    {
+        readRegistersSPI(icID, addresses, values, count);
+        return;
+    }
+
+    // UART replies arrive immediately, there is nothing to pipeline
+    for(size_t i = 0; i < count; i++)
+    {
+        values[i] = tmc2240_readRegister(icID, addresses[i]);
+    }
+}
+
 void tmc2240_writeRegister(uint16_t icID, uint8_t address, int32_t value)
 {
     TMC2240BusType bus = tmc2240_getBusType(icID);
@@ -210,15 +416,72 @@ int32_t readRegisterSPI(uint16_t icID, uint8_t address)
     data[0] = address & TMC2240_ADDRESS_MASK;
 
     // Send the read request
-    tmc2240_readWriteSPI(icID, &data[0], sizeof(data));
+    readWriteSPI(icID, &data[0], sizeof(data));
 
     // Rewrite address and clear write bit
     data[0] = address & TMC2240_ADDRESS_MASK;
 
     // Send another request to receive the read reply
-    tmc2240_readWriteSPI(icID, &data[0], sizeof(data));
+    readWriteSPI(icID, &data[0], sizeof(data));
+
+    uint32_t result = ((int32_t)data[1] << 24) | ((int32_t) data[2] << 16) | ((int32_t) data[3] <<  8) | ((int32_t) data[4]);
 
-    return ((int32_t)data[1] << 24) | ((int32_t) data[2] << 16) | ((int32_t) data[3] <<  8) | ((int32_t) data[4]);
+    // Keep the shadow copy of read-through registers up to date
+    tmc2240_cache(icID, TMC2240_CACHE_FILL_READ, address, &result);
+
+    return result;
+}
+
+void readRegistersSPI(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count)
+{
+    uint8_t data[5] = { 0 };
+    uint8_t address = 0;
+    int32_t *pendingValue = NULL;
+    uint8_t pendingAddress = 0;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        uint32_t value;
+
+        // Read from cache for write-only registers and valid read-through registers
+        bool cacheHit = tmc2240_cache(icID, TMC2240_CACHE_READ, addresses[i], &value);
+        recordCache(icID, addresses[i], cacheHit);
+
+        if (cacheHit)
+        {
+            values[i] = value;
+            continue;
+        }
+
+        address = addresses[i] & TMC2240_ADDRESS_MASK;
+
+        // Send the read request. The reply belongs to the previous request.
+        data[0] = address;
+        data[1] = 0;
+        data[2] = 0;
+        data[3] = 0;
+        data[4] = 0;
+        readWriteSPI(icID, &data[0], sizeof(data));
+
+        if (pendingValue)
+        {
+            *pendingValue = ((uint32_t)data[1] << 24) | ((uint32_t) data[2] << 16) | ( data[3] <<  8) | ( data[4]);
+            tmc2240_cache(icID, TMC2240_CACHE_FILL_READ, pendingAddress, (uint32_t *)pendingValue);
+        }
+
+        pendingValue = &values[i];
+        pendingAddress = address;
+    }
+
+    if (!pendingValue)
+        return;
+
+    // Rewrite the last address to receive the last read reply
+    data[0] = address;
+    readWriteSPI(icID, &data[0], sizeof(data));
+
+    *pendingValue = ((uint32_t)data[1] << 24) | ((uint32_t) data[2] << 16) | ( data[3] <<  8) | ( data[4]);
+    tmc2240_cache(icID, TMC2240_CACHE_FILL_READ, pendingAddress, (uint32_t *)pendingValue);
 }
 
 void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value)
@@ -232,7 +495,7 @@ void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value)
     data[4] = 0xFF & (value>>0);
 
     // Send the write request
-    tmc2240_readWriteSPI(icID, &data[0], sizeof(data));
+    readWriteSPI(icID, &data[0], sizeof(data));
 }
 
 int32_t readRegisterUART(uint16_t icID, uint8_t registerAddress)
@@ -246,26 +509,31 @@ int32_t readRegisterUART(uint16_t icID, uint8_t registerAddress)
     data[2] = registerAddress;
     data[3] = CRC8(data, 3);
 
-    if (!tmc2240_readWriteUART(icID, &data[0], 4, 8))
+    if (!readWriteUART(icID, &data[0], 4, 8))
         return 0;
 
     // Byte 0: Sync nibble correct?
-    if (data[0] != 0x05)
-        return 0;
-
     // Byte 1: Master address correct?
-    if (data[1] != 0xFF)
-        return 0;
-
     // Byte 2: Address correct?
-    if (data[2] != registerAddress)
+    if (data[0] != 0x05 || data[1] != 0xFF || data[2] != registerAddress)
+    {
+        recordReplyError(icID, false);
         return 0;
+    }
 
     // Byte 7: CRC correct?
     if (data[7] != CRC8(data, 7))
+    {
+        recordReplyError(icID, true);
         return 0;
+    }
+
+    uint32_t result = ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
 
-    return ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+    // Keep the shadow copy of read-through registers up to date
+    tmc2240_cache(icID, TMC2240_CACHE_FILL_READ, registerAddress, &result);
+
+    return result;
 }
 
 void writeRegisterUART(uint16_t icID, uint8_t registerAddress, int32_t value)
@@ -281,7 +549,7 @@ void writeRegisterUART(uint16_t icID, uint8_t registerAddress, int32_t value)
     data[6] = (value      ) & 0xFF;
     data[7] = CRC8(data, 7);
 
-    tmc2240_readWriteUART(icID, &data[0], 8, 0);
+    readWriteUART(icID, &data[0], 8, 0);
 }
 
 static uint8_t CRC8(uint8_t *data, uint32_t bytes)
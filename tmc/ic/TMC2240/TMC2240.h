@@ -38,6 +38,37 @@
 //#define TMC2240_ENABLE_TMC_CACHE   0
 #endif
 
+// To serve reads of stable read/write configuration registers from the cache, set TMC2240_CACHE_READ_THROUGH to '1'.
+// The registers listed in TMC2240_CACHE_READ_THROUGH_REGISTERS are then read from the chip once (or written)
+// and afterwards read from their shadow copies. The policy is applied by tmc2240_initCache() and can
+// also be changed per register at runtime with tmc2240_setCacheReadThrough().
+// Call tmc2240_invalidateCache() if the chip might have lost its configuration (e.g. after a reset).
+#ifndef TMC2240_CACHE_READ_THROUGH
+#define TMC2240_CACHE_READ_THROUGH   0
+//#define TMC2240_CACHE_READ_THROUGH   1
+#endif
+
+#ifndef TMC2240_CACHE_READ_THROUGH_REGISTERS
+#define TMC2240_CACHE_READ_THROUGH_REGISTERS   { TMC2240_GCONF, TMC2240_DRV_CONF, TMC2240_GLOBAL_SCALER, TMC2240_IHOLD_IRUN, TMC2240_TPOWERDOWN, TMC2240_CHOPCONF, TMC2240_PWMCONF }
+#endif
+
+// To record bus transaction statistics (transfers, bytes, cache hits/misses, CRC errors and
+// latency histograms per register) set TMC2240_BUS_STATISTICS to '1'. The statistics are kept for
+// the first TMC2240_BUS_STATISTICS_COUNT ICs, see tmc/helpers/BusStatistics.h. The application
+// has to implement tmc_bus_statistics_getTime() and link tmc/helpers/BusStatistics.c.
+#ifndef TMC2240_BUS_STATISTICS
+#define TMC2240_BUS_STATISTICS   0
+//#define TMC2240_BUS_STATISTICS   1
+#endif
+
+#ifndef TMC2240_BUS_STATISTICS_COUNT
+#define TMC2240_BUS_STATISTICS_COUNT   1
+#endif
+
+#if TMC2240_BUS_STATISTICS == 1
+#include "tmc/helpers/BusStatistics.h"
+#endif
+
 /******************************************************************************/
 
 
@@ -55,8 +86,17 @@ extern uint8_t tmc2240_getNodeAddress(uint16_t icID);
 // => TMC-API wrapper
 
 int32_t tmc2240_readRegister(uint16_t icID, uint8_t address);
+// Reads multiple registers at once. Over SPI the read requests are pipelined:
+// each transfer sends the next request and receives the reply to the previous one,
+// so reading n registers takes n+1 transfers instead of 2n.
+void tmc2240_readRegisters(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count);
 void tmc2240_writeRegister(uint16_t icID, uint8_t address, int32_t value);
 
+#if TMC2240_BUS_STATISTICS == 1
+// Returns the bus statistics of [icID] or NULL if [icID] >= TMC2240_BUS_STATISTICS_COUNT
+TMC_BusStatistics *tmc2240_getBusStatistics(uint16_t icID);
+#endif
+
 typedef struct
 {
     uint32_t mask;
@@ -102,6 +142,56 @@ static inline void tmc2240_fieldWrite(uint16_t icID, RegisterField field, uint32
     tmc2240_writeRegister(icID, field.address, regValue);
 }
 
+// Coalesced field updates: Several fields of one register are changed with a single write.
+// The register value is taken from the cache if possible (write-only registers or valid
+// read-through registers), otherwise it is read from the chip once in tmc2240_fieldBegin().
+// Example:
+//     TMC2240FieldUpdate update = tmc2240_fieldBegin(icID, field1.address);
+//     tmc2240_fieldSet(&update, field1, value1);
+//     tmc2240_fieldSet(&update, field2, value2);
+//     tmc2240_fieldCommit(&update);
+typedef struct
+{
+    uint16_t icID;
+    uint8_t address;
+    bool modified;
+    uint32_t value;
+} TMC2240FieldUpdate;
+
+static inline TMC2240FieldUpdate tmc2240_fieldBegin(uint16_t icID, uint8_t address)
+{
+    TMC2240FieldUpdate update;
+
+    update.icID     = icID;
+    update.address  = address;
+    update.modified = false;
+    update.value    = tmc2240_readRegister(icID, address);
+
+    return update;
+}
+
+// Returns false if the field belongs to a different register than the one passed to tmc2240_fieldBegin()
+static inline bool tmc2240_fieldSet(TMC2240FieldUpdate *update, RegisterField field, uint32_t value)
+{
+    if (field.address != update->address)
+        return false;
+
+    update->value    = tmc2240_fieldUpdate(update->value, field, value);
+    update->modified = true;
+
+    return true;
+}
+
+// Writes the register if any field has been set
+static inline void tmc2240_fieldCommit(TMC2240FieldUpdate *update)
+{
+    if (!update->modified)
+        return;
+
+    tmc2240_writeRegister(update->icID, update->address, update->value);
+    update->modified = false;
+}
+
 /**************************************************************** Cache Implementation *************************************************************************/
 #if TMC2240_CACHE == 1
 #ifdef TMC2240_ENABLE_TMC_CACHE
@@ -119,6 +209,10 @@ typedef enum {
     // from write-only registers that have a value inside them on reset. When using this
     // operation, a restore will *not* rewrite that filled register!
     TMC2240_CACHE_FILL_DEFAULT,
+
+    // Special operation: Put a value read from the chip into the cache without marking the
+    // entry as dirty. Only stored for registers using the read-through policy.
+    TMC2240_CACHE_FILL_READ
 } TMC2240CacheOp;
 
 typedef struct{
@@ -132,6 +226,14 @@ typedef struct{
 #define TMC2240_IS_READABLE(x)     ((x) & TMC2240_ACCESS_READ)
 #define ARRAY_SIZE(x)             (sizeof(x)/sizeof(x[0]))
 
+// Registers that may use the read-through cache policy: configuration registers that are only
+// changed by the application, not values the chip updates itself. Not included: IOIN and X_ENC.
+#define TMC2240_READ_THROUGH_CAPABLE_REGISTERS { \
+    TMC2240_GCONF, TMC2240_SLAVECONF, TMC2240_DRV_CONF, TMC2240_GLOBAL_SCALER, TMC2240_IHOLD_IRUN, \
+    TMC2240_TPOWERDOWN, TMC2240_TPWMTHRS, TMC2240_TCOOLTHRS, TMC2240_THIGH, TMC2240_DIRECT_MODE, \
+    TMC2240_ENCMODE, TMC2240_ENC_CONST, TMC2240_OTW_OV_VTH, TMC2240_CHOPCONF, TMC2240_COOLCONF, \
+    TMC2240_PWMCONF, TMC2240_SG4_THRS }
+
 // Helper define:
 // Most register permission arrays are initialized with 128 values.
 // In those fields its quite hard to have an easy overview of available
@@ -213,6 +315,11 @@ static const TMC2240RegisterConstants tmc2240_RegisterConstants[] =
 
 extern uint8_t tmc2240_dirtyBits[TMC2240_IC_CACHE_COUNT][TMC2240_REGISTER_COUNT/8];
 extern int32_t tmc2240_shadowRegister[TMC2240_IC_CACHE_COUNT][TMC2240_REGISTER_COUNT];
+extern uint8_t tmc2240_validBits[TMC2240_IC_CACHE_COUNT][TMC2240_REGISTER_COUNT/8];
+extern uint8_t tmc2240_readThroughBits[TMC2240_IC_CACHE_COUNT][TMC2240_REGISTER_COUNT/8];
+bool tmc2240_setCacheReadThrough(uint16_t icID, uint8_t address, bool enable);
+bool tmc2240_getCacheReadThrough(uint16_t icID, uint8_t address);
+void tmc2240_invalidateCache(uint16_t icID);
 bool tmc2240_cache(uint16_t icID, TMC2240CacheOp operation, uint8_t address, uint32_t *value);
 void tmc2240_initCache(void);
 void tmc2240_setDirtyBit(uint16_t icID, uint8_t index, bool value);
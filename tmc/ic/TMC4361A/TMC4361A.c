@@ -20,6 +20,8 @@ static inline bool tmc4361A_cache(uint16_t icID, TMC4361ACacheOp operation, uint
 #if TMC4361A_ENABLE_TMC_CACHE == 1
 uint8_t tmc4361A_dirtyBits[TMC4361A_IC_CACHE_COUNT][TMC4361A_REGISTER_COUNT / 8] = {0};
 int32_t tmc4361A_shadowRegister[TMC4361A_IC_CACHE_COUNT][TMC4361A_REGISTER_COUNT];
+uint8_t tmc4361A_validBits[TMC4361A_IC_CACHE_COUNT][TMC4361A_REGISTER_COUNT/8] = {0};
+uint8_t tmc4361A_readThroughBits[TMC4361A_IC_CACHE_COUNT][TMC4361A_REGISTER_COUNT/8] = {0};
 
 void tmc4361A_setDirtyBit(uint16_t icID, uint8_t index, bool value)
 {
@@ -42,6 +44,75 @@ bool tmc4361A_getDirtyBit(uint16_t icID, uint8_t index)
     return ((*tmp) >> shift) & 1;
 }
 
+static void setCacheBit(uint8_t *bits, uint8_t index, bool value)
+{
+    if(index >= TMC4361A_REGISTER_COUNT)
+        return;
+
+    uint8_t mask = 1 << (index % 8);
+    bits[index / 8] = value ? (bits[index / 8] | mask) : (bits[index / 8] & ~mask);
+}
+
+static bool getCacheBit(uint8_t *bits, uint8_t index)
+{
+    if(index >= TMC4361A_REGISTER_COUNT)
+        return false;
+
+    return (bits[index / 8] >> (index % 8)) & 1;
+}
+
+static bool isReadThroughCapable(uint8_t address)
+{
+    static const uint8_t capableRegisters[] = TMC4361A_READ_THROUGH_CAPABLE_REGISTERS;
+
+    for (size_t i = 0; i < ARRAY_SIZE(capableRegisters); i++)
+    {
+        if (capableRegisters[i] == address)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * Sets the cache policy of a readable register. With read-through enabled, reads are served from the
+ * shadow copy once it holds a valid value (after the first read from or write to the chip).
+ * Only the configuration registers listed in TMC4361A_READ_THROUGH_CAPABLE_REGISTERS support this.
+ */
+bool tmc4361A_setCacheReadThrough(uint16_t icID, uint8_t address, bool enable)
+{
+    if (icID >= TMC4361A_IC_CACHE_COUNT || address >= TMC4361A_REGISTER_COUNT)
+        return false;
+
+    if (enable && !isReadThroughCapable(address))
+        return false;
+
+    setCacheBit(tmc4361A_readThroughBits[icID], address, enable);
+    setCacheBit(tmc4361A_validBits[icID], address, false);
+    return true;
+}
+
+bool tmc4361A_getCacheReadThrough(uint16_t icID, uint8_t address)
+{
+    if (icID >= TMC4361A_IC_CACHE_COUNT)
+        return false;
+
+    return getCacheBit(tmc4361A_readThroughBits[icID], address);
+}
+
+/*
+ * Marks the shadow copies of all read-through registers as invalid,
+ * so they are read from the chip again on the next access.
+ */
+void tmc4361A_invalidateCache(uint16_t icID)
+{
+    if (icID >= TMC4361A_IC_CACHE_COUNT)
+        return;
+
+    for (size_t i = 0; i < TMC4361A_REGISTER_COUNT/8; i++)
+        tmc4361A_validBits[icID][i] = 0;
+}
+
 /*
  * This function is used to cache the value written to the Write-Only registers in the form of shadow array.
  * The shadow copy is then used to read these kinds of registers.
@@ -56,9 +127,10 @@ bool tmc4361A_cache(uint16_t icID, TMC4361ACacheOp operation, uint8_t address, u
         if (icID >= TMC4361A_IC_CACHE_COUNT)
             return false;
 
-        // Only non-readable registers care about caching
-        // Note: This could also be used to cache i.e. RW config registers to reduce bus accesses
-        if (TMC4361A_IS_READABLE(tmc4361A_registerAccess[address]))
+        // Non-readable registers are always served from the cache. Readable registers only
+        // if they use the read-through policy and their shadow copy holds a valid value.
+        if (TMC4361A_IS_READABLE(tmc4361A_registerAccess[address])
+            && !(getCacheBit(tmc4361A_readThroughBits[icID], address) && getCacheBit(tmc4361A_validBits[icID], address)))
             return false;
 
         // Grab the value from the cache
@@ -78,13 +150,43 @@ bool tmc4361A_cache(uint16_t icID, TMC4361ACacheOp operation, uint8_t address, u
         if (operation == TMC4361A_CACHE_WRITE)
         {
             tmc4361A_setDirtyBit(icID, address, true);
+
+            // Writing a read-through register makes its shadow copy valid
+            if (getCacheBit(tmc4361A_readThroughBits[icID], address))
+                setCacheBit(tmc4361A_validBits[icID], address, true);
         }
         return true;
     }
+    else if (operation == TMC4361A_CACHE_FILL_READ)
+    {
+        // Store values read from the chip for read-through registers
+
+        // only supported chips have a cache
+        if (icID >= TMC4361A_IC_CACHE_COUNT)
+            return false;
+
+        if (!getCacheBit(tmc4361A_readThroughBits[icID], address))
+            return false;
+
+        tmc4361A_shadowRegister[icID][address] = *value;
+        setCacheBit(tmc4361A_validBits[icID], address, true);
+        return true;
+    }
     return false;
 }
 void tmc4361A_initCache()
 {
+#if TMC4361A_CACHE_READ_THROUGH == 1
+    // Apply the default read-through policy
+    static const uint8_t readThroughRegisters[] = TMC4361A_CACHE_READ_THROUGH_REGISTERS;
+
+    for (size_t id = 0; id < TMC4361A_IC_CACHE_COUNT; id++)
+    {
+        for (size_t k = 0; k < ARRAY_SIZE(readThroughRegisters); k++)
+            tmc4361A_setCacheReadThrough(id, readThroughRegisters[k], true);
+    }
+#endif
+
     // Check if we have constants defined
     if (ARRAY_SIZE(tmc4361A_RegisterConstants) == 0)
         return;
@@ -127,14 +229,64 @@ extern bool tmc4361A_cache(uint16_t icID, TMC4361ACacheOp operation, uint8_t add
 /************************************************************** Register read / write Implementation ******************************************************************/
 
 static int32_t readRegisterSPI(uint16_t icID, uint8_t address);
+static void readRegistersSPI(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count);
 static void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value);
 
+/************************************************************** Bus statistics ******************************************************************/
+#if TMC4361A_BUS_STATISTICS == 1
+static TMC_BusStatistics busStatistics[TMC4361A_BUS_STATISTICS_COUNT];
+
+TMC_BusStatistics *tmc4361A_getBusStatistics(uint16_t icID)
+{
+    if (icID >= TMC4361A_BUS_STATISTICS_COUNT)
+        return NULL;
+
+    return &busStatistics[icID];
+}
+
+static void readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+    TMC_BusStatistics *statistics = tmc4361A_getBusStatistics(icID);
+
+    if (!statistics)
+    {
+        tmc4361A_readWriteSPI(icID, data, dataLength);
+        return;
+    }
+
+    // The datagram is overwritten with the reply, keep the address byte
+    uint8_t address = data[0];
+    uint32_t startTime = tmc_bus_statistics_getTime();
+
+    tmc4361A_readWriteSPI(icID, data, dataLength);
+
+    tmc_bus_statistics_recordTransfer(statistics, tmc_bus_statistics_getTime() - startTime);
+    tmc_bus_statistics_recordDatagram(statistics, address, dataLength, dataLength);
+}
+
+static void recordCache(uint16_t icID, uint8_t address, bool hit)
+{
+    TMC_BusStatistics *statistics = tmc4361A_getBusStatistics(icID);
+
+    if (statistics)
+        tmc_bus_statistics_recordCache(statistics, address, hit);
+}
+#else
+// Statistics disabled: Call the callbacks directly
+#define readWriteSPI         tmc4361A_readWriteSPI
+#define recordCache(icID, address, hit)
+#endif
+/*************************************************************************************************************************************************/
+
 int32_t tmc4361A_readRegister(uint16_t icID, uint8_t address)
 {
     uint32_t value;
 
-    // Read from cache for registers with write-only access
-    if (tmc4361A_cache(icID, TMC4361A_CACHE_READ, address, &value))
+    // Read from cache for write-only registers and valid read-through registers
+    bool cacheHit = tmc4361A_cache(icID, TMC4361A_CACHE_READ, address, &value);
+    recordCache(icID, address, cacheHit);
+
+    if (cacheHit)
         return value;
 
     return readRegisterSPI(icID, address);
@@ -143,11 +295,72 @@ int32_t tmc4361A_readRegister(uint16_t icID, uint8_t address)
     return -1;
 }
 
+void tmc4361A_readRegisters(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count)
+{
+    readRegistersSPI(icID, addresses, values, count);
+}
+
 void tmc4361A_writeRegister(uint16_t icID, uint8_t address, int32_t value)
 {
     writeRegisterSPI(icID, address, value);
 }
 
+void readRegistersSPI(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count)
+{
+    uint8_t data[5] = { 0 };
+    uint8_t address = 0;
+    int32_t *pendingValue = NULL;
+    uint8_t pendingAddress = 0;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        uint32_t value;
+
+        // Read from cache for write-only registers and valid read-through registers
+        bool cacheHit = tmc4361A_cache(icID, TMC4361A_CACHE_READ, addresses[i], &value);
+        recordCache(icID, addresses[i], cacheHit);
+
+        if (cacheHit)
+        {
+            values[i] = value;
+            continue;
+        }
+
+        address = addresses[i] & TMC4361A_ADDRESS_MASK;
+
+        // Send the read request. The reply belongs to the previous request.
+        data[0] = address;
+        data[1] = 0;
+        data[2] = 0;
+        data[3] = 0;
+        data[4] = 0;
+        readWriteSPI(icID, &data[0], sizeof(data));
+
+        tmc4361A_setStatus(icID, &data[0]);
+
+        if (pendingValue)
+        {
+            *pendingValue = ((uint32_t)data[1] << 24) | ((uint32_t) data[2] << 16) | ( data[3] <<  8) | ( data[4]);
+            tmc4361A_cache(icID, TMC4361A_CACHE_FILL_READ, pendingAddress, (uint32_t *)pendingValue);
+        }
+
+        pendingValue = &values[i];
+        pendingAddress = address;
+    }
+
+    if (!pendingValue)
+        return;
+
+    // Rewrite the last address to receive the last read reply
+    data[0] = address;
+    readWriteSPI(icID, &data[0], sizeof(data));
+
+    tmc4361A_setStatus(icID, &data[0]);
+
+    *pendingValue = ((uint32_t)data[1] << 24) | ((uint32_t) data[2] << 16) | ( data[3] <<  8) | ( data[4]);
+    tmc4361A_cache(icID, TMC4361A_CACHE_FILL_READ, pendingAddress, (uint32_t *)pendingValue);
+}
+
 void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value)
 {
     uint8_t data[5] = {0};
@@ -159,7 +372,7 @@ void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value)
     data[4] = 0xFF & (value >> 0);
 
     // Send the write request
-    tmc4361A_readWriteSPI(icID, &data[0], sizeof(data));
+    readWriteSPI(icID, &data[0], sizeof(data));
 
     tmc4361A_setStatus(icID, &data[0]);
 
@@ -176,13 +389,18 @@ int32_t readRegisterSPI(uint16_t icID, uint8_t address)
 
     data[0] = address;
     // Send the read request
-    tmc4361A_readWriteSPI(icID, &data[0], sizeof(data));
+    readWriteSPI(icID, &data[0], sizeof(data));
 
     data[0] = address;
     // Send another request to receive the read reply
-    tmc4361A_readWriteSPI(icID, &data[0], sizeof(data));
+    readWriteSPI(icID, &data[0], sizeof(data));
 
     tmc4361A_setStatus(icID, &data[0]);
 
-    return ((int32_t) data[1] << 24) | ((int32_t) data[2] << 16) | ((int32_t) data[3] << 8) | ((int32_t) data[4]);
+    uint32_t result = ((int32_t) data[1] << 24) | ((int32_t) data[2] << 16) | ((int32_t) data[3] << 8) | ((int32_t) data[4]);
+
+    // Keep the shadow copy of read-through registers up to date
+    tmc4361A_cache(icID, TMC4361A_CACHE_FILL_READ, address, &result);
+
+    return result;
 }
@@ -36,6 +36,37 @@
 //#define TMC4361A_ENABLE_TMC_CACHE   0
 #endif
 
+// To serve reads of stable read/write configuration registers from the cache, set TMC4361A_CACHE_READ_THROUGH to '1'.
+// The registers listed in TMC4361A_CACHE_READ_THROUGH_REGISTERS are then read from the chip once (or written)
+// and afterwards read from their shadow copies. The policy is applied by tmc4361A_initCache() and can
+// also be changed per register at runtime with tmc4361A_setCacheReadThrough().
+// Call tmc4361A_invalidateCache() if the chip might have lost its configuration (e.g. after a reset).
+#ifndef TMC4361A_CACHE_READ_THROUGH
+#define TMC4361A_CACHE_READ_THROUGH   0
+//#define TMC4361A_CACHE_READ_THROUGH   1
+#endif
+
+#ifndef TMC4361A_CACHE_READ_THROUGH_REGISTERS
+#define TMC4361A_CACHE_READ_THROUGH_REGISTERS   { TMC4361A_GENERAL_CONF, TMC4361A_REFERENCE_CONF, TMC4361A_INPUT_FILT_CONF, TMC4361A_SPI_OUT_CONF, TMC4361A_ENC_IN_CONF, TMC4361A_STEP_CONF, TMC4361A_RAMPMODE }
+#endif
+
+// To record bus transaction statistics (transfers, bytes, cache hits/misses and latency
+// histograms per register) set TMC4361A_BUS_STATISTICS to '1'. The statistics are kept for
+// the first TMC4361A_BUS_STATISTICS_COUNT ICs, see tmc/helpers/BusStatistics.h. The application
+// has to implement tmc_bus_statistics_getTime() and link tmc/helpers/BusStatistics.c.
+#ifndef TMC4361A_BUS_STATISTICS
+#define TMC4361A_BUS_STATISTICS   0
+//#define TMC4361A_BUS_STATISTICS   1
+#endif
+
+#ifndef TMC4361A_BUS_STATISTICS_COUNT
+#define TMC4361A_BUS_STATISTICS_COUNT   1
+#endif
+
+#if TMC4361A_BUS_STATISTICS == 1
+#include "tmc/helpers/BusStatistics.h"
+#endif
+
 /******************************************************************************/
 
 typedef struct
@@ -52,7 +83,16 @@ extern void tmc4361A_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLengt
 // => TMC-API wrapper
 
 int32_t tmc4361A_readRegister(uint16_t icID, uint8_t address);
+// Reads multiple registers at once. Over SPI the read requests are pipelined:
+// each transfer sends the next request and receives the reply to the previous one,
+// so reading n registers takes n+1 transfers instead of 2n.
+void tmc4361A_readRegisters(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count);
 void tmc4361A_writeRegister(uint16_t icID, uint8_t address, int32_t value);
+
+#if TMC4361A_BUS_STATISTICS == 1
+// Returns the bus statistics of [icID] or NULL if [icID] >= TMC4361A_BUS_STATISTICS_COUNT
+TMC_BusStatistics *tmc4361A_getBusStatistics(uint16_t icID);
+#endif
 void tmc4361A_readWriteCover(uint16_t icID, uint8_t *data, size_t length);
 
 
@@ -92,6 +132,56 @@ static inline void tmc4361A_fieldWrite(uint16_t icID, RegisterField field, uint3
     tmc4361A_writeRegister(icID, field.address, regValue);
 }
 
+// Coalesced field updates: Several fields of one register are changed with a single write.
+// The register value is taken from the cache if possible (write-only registers or valid
+// read-through registers), otherwise it is read from the chip once in tmc4361A_fieldBegin().
+// Example:
+//     TMC4361AFieldUpdate update = tmc4361A_fieldBegin(icID, field1.address);
+//     tmc4361A_fieldSet(&update, field1, value1);
+//     tmc4361A_fieldSet(&update, field2, value2);
+//     tmc4361A_fieldCommit(&update);
+typedef struct
+{
+    uint16_t icID;
+    uint8_t address;
+    bool modified;
+    uint32_t value;
+} TMC4361AFieldUpdate;
+
+static inline TMC4361AFieldUpdate tmc4361A_fieldBegin(uint16_t icID, uint8_t address)
+{
+    TMC4361AFieldUpdate update;
+
+    update.icID     = icID;
+    update.address  = address;
+    update.modified = false;
+    update.value    = tmc4361A_readRegister(icID, address);
+
+    return update;
+}
+
+// Returns false if the field belongs to a different register than the one passed to tmc4361A_fieldBegin()
+static inline bool tmc4361A_fieldSet(TMC4361AFieldUpdate *update, RegisterField field, uint32_t value)
+{
+    if (field.address != update->address)
+        return false;
+
+    update->value    = field_update(update->value, field, value);
+    update->modified = true;
+
+    return true;
+}
+
+// Writes the register if any field has been set
+static inline void tmc4361A_fieldCommit(TMC4361AFieldUpdate *update)
+{
+    if (!update->modified)
+        return;
+
+    tmc4361A_writeRegister(update->icID, update->address, update->value);
+    update->modified = false;
+}
+
 /**************************************************************** Cache Implementation *************************************************************************/
 
 #if TMC4361A_CACHE == 1
@@ -110,7 +200,11 @@ typedef enum {
    // Only used to initialize the cache with hardware defaults. This will allow reading
    // from write-only registers that have a value inside them on reset. When using this
    // operation, a restore will *not* rewrite that filled register!
-   TMC4361A_CACHE_FILL_DEFAULT
+   TMC4361A_CACHE_FILL_DEFAULT,
+
+   // Special operation: Put a value read from the chip into the cache without marking the
+   // entry as dirty. Only stored for registers using the read-through policy.
+   TMC4361A_CACHE_FILL_READ
 
 } TMC4361ACacheOp;
 
@@ -128,6 +222,23 @@ typedef struct
 #define TMC4361A_IS_READABLE(x)     ((x) & TMC4361A_ACCESS_READ)
 #define TMC_IS_WRITABLE(x)          ((x) & TMC_ACCESS_WRITE)
 #define ARRAY_SIZE(x)               (sizeof(x)/sizeof(x[0]))
+
+// Registers that may use the read-through cache policy: configuration registers that are only
+// changed by the application. Not included: positions and registers the chip reloads itself (XACTUAL, XTARGET, X_HOME, ENC_POS,
+// CL_OFFSET, the ramp parameters and POS_COMP/GEAR_RATIO via shadow registers or the X_PIPE pipeline,
+// the pipeline and shadow registers themselves). If GENERAL_CONF is a pipeline target, do not use
+// read-through for it.
+#define TMC4361A_READ_THROUGH_CAPABLE_REGISTERS { \
+    TMC4361A_GENERAL_CONF, TMC4361A_REFERENCE_CONF, TMC4361A_START_CONF, TMC4361A_INPUT_FILT_CONF, \
+    TMC4361A_SPI_OUT_CONF, TMC4361A_CURRENT_CONF, TMC4361A_SCALE_VALUES, TMC4361A_ENC_IN_CONF, \
+    TMC4361A_ENC_IN_DATA, TMC4361A_ENC_OUT_DATA, TMC4361A_STEP_CONF, TMC4361A_SPI_STATUS_SELECTION, \
+    TMC4361A_EVENT_CLEAR_CONF, TMC4361A_INTR_CONF, TMC4361A_STP_LENGTH_ADD, TMC4361A_START_OUT_ADD, \
+    TMC4361A_START_DELAY, TMC4361A_CLK_GATING_DELAY, TMC4361A_STDBY_DELAY, \
+    TMC4361A_FREEWHEEL_DELAY, TMC4361A_VDRV_SCALE_LIMIT, TMC4361A_UP_SCALE_DELAY, \
+    TMC4361A_HOLD_SCALE_DELAY, TMC4361A_DRV_SCALE_DELAY, TMC4361A_BOOST_TIME, TMC4361A_CL_ANGLES, \
+    TMC4361A_SPI_SWITCH_VEL, TMC4361A_HOME_SAFETY_MARGIN, TMC4361A_PWM_FREQ, TMC4361A_RAMPMODE, \
+    TMC4361A_CLK_FREQ, TMC4361A_VIRT_STOP_LEFT, TMC4361A_VIRT_STOP_RIGHT, TMC4361A_FREEZE_REGISTERS }
+
 // Memory access helpers
 // Force the compiler to access a location exactly once
 #define ACCESS_ONCE(x) *((volatile typeof(x) *) (&x))
@@ -230,6 +341,11 @@ static const TMC4361ARegisterConstant tmc4361A_RegisterConstants[] =
 
 extern uint8_t tmc4361A_dirtyBits[TMC4361A_IC_CACHE_COUNT][TMC4361A_REGISTER_COUNT/8];
 extern int32_t tmc4361A_shadowRegister[TMC4361A_IC_CACHE_COUNT][TMC4361A_REGISTER_COUNT];
+extern uint8_t tmc4361A_validBits[TMC4361A_IC_CACHE_COUNT][TMC4361A_REGISTER_COUNT/8];
+extern uint8_t tmc4361A_readThroughBits[TMC4361A_IC_CACHE_COUNT][TMC4361A_REGISTER_COUNT/8];
+bool tmc4361A_setCacheReadThrough(uint16_t icID, uint8_t address, bool enable);
+bool tmc4361A_getCacheReadThrough(uint16_t icID, uint8_t address);
+void tmc4361A_invalidateCache(uint16_t icID);
 void tmc4361A_setDirtyBit(uint16_t icID, uint8_t index, bool value);
 bool tmc4361A_getDirtyBit(uint16_t icID, uint8_t index);
 extern bool tmc4361A_cache(uint16_t icID, TMC4361ACacheOp operation, uint8_t address, uint32_t *value);
@@ -157,6 +157,7 @@ extern bool tmc5130_cache(uint16_t icID, TMC5130CacheOp operation, uint8_t addre
 /************************************************************** read / write Implementation ******************************************************************/
 
 static int32_t readRegisterSPI(uint16_t icID, uint8_t address);
+static void readRegistersSPI(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count);
 static void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value);
 static int32_t readRegisterUART(uint16_t icID, uint8_t registerAddress);
 static void writeRegisterUART(uint16_t icID, uint8_t registerAddress, int32_t value);
@@ -187,6 +188,23 @@ int32_t tmc5130_readRegister(uint16_t icID, uint8_t address)
 	return -1;
 }
 
+void tmc5130_readRegisters(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	TMC5130BusType bus = tmc5130_getBusType(icID);
+
+	if(bus == IC_BUS_SPI)
+	{
+		readRegistersSPI(icID, addresses, values, count);
+		return;
+	}
+
+	// UART replies arrive immediately, there is nothing to pipeline
+	for(size_t i = 0; i < count; i++)
+	{
+		values[i] = tmc5130_readRegister(icID, addresses[i]);
+	}
+}
+
 // Checks which BUS type is use and then forwards it to the corresponding write function.
 void tmc5130_writeRegister(uint16_t icID, uint8_t address, int32_t value)
 {
@@ -221,6 +239,49 @@ int32_t readRegisterSPI(uint16_t icID, uint8_t address)
 	return ((int32_t)data[1] << 24) | ((int32_t) data[2] << 16) | ((int32_t) data[3] <<  8) | ((int32_t) data[4]);
 }
 
+void readRegistersSPI(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	uint8_t data[5] = { 0 };
+	uint8_t address = 0;
+	int32_t *pendingValue = NULL;
+
+	for(size_t i = 0; i < count; i++)
+	{
+		uint32_t value;
+
+		// Read from cache for registers with write-only access
+		if (tmc5130_cache(icID, TMC5130_CACHE_READ, addresses[i], &value))
+		{
+			values[i] = value;
+			continue;
+		}
+
+		address = addresses[i] & TMC5130_ADDRESS_MASK;
+
+		// Send the read request. The reply belongs to the previous request.
+		data[0] = address;
+		data[1] = 0;
+		data[2] = 0;
+		data[3] = 0;
+		data[4] = 0;
+		tmc5130_readWriteSPI(icID, &data[0], sizeof(data));
+
+		if (pendingValue)
+			*pendingValue = ((uint32_t)data[1] << 24) | ((uint32_t) data[2] << 16) | ( data[3] <<  8) | ( data[4]);
+
+		pendingValue = &values[i];
+	}
+
+	if (!pendingValue)
+		return;
+
+	// Rewrite the last address to receive the last read reply
+	data[0] = address;
+	tmc5130_readWriteSPI(icID, &data[0], sizeof(data));
+
+	*pendingValue = ((uint32_t)data[1] << 24) | ((uint32_t) data[2] << 16) | ( data[3] <<  8) | ( data[4]);
+}
+
 void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value)
 {
 	uint8_t data[5] = { 0 };
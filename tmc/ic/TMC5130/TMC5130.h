@@ -61,6 +61,10 @@ extern uint8_t tmc5130_getNodeAddress(uint16_t icID);
 // => TMC-API wrapper
 
 int32_t tmc5130_readRegister(uint16_t icID, uint8_t address);
+// Reads multiple registers at once. Over SPI the read requests are pipelined:
+// each transfer sends the next request and receives the reply to the previous one,
+// so reading n registers takes n+1 transfers instead of 2n.
+void tmc5130_readRegisters(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count);
 void tmc5130_writeRegister(uint16_t icID, uint8_t address, int32_t value);
 void tmc5130_rotateMotor(uint16_t icID, uint8_t motor, int32_t velocity);
 
@@ -44,6 +44,8 @@ static inline bool tmc5160_cache(uint16_t icID, TMC5160CacheOp operation, uint8_
 #if TMC5160_ENABLE_TMC_CACHE == 1
 uint8_t tmc5160_dirtyBits[TMC5160_IC_CACHE_COUNT][TMC5160_REGISTER_COUNT/8]= {0};
 int32_t tmc5160_shadowRegister[TMC5160_IC_CACHE_COUNT][TMC5160_REGISTER_COUNT];
+uint8_t tmc5160_validBits[TMC5160_IC_CACHE_COUNT][TMC5160_REGISTER_COUNT/8] = {0};
+uint8_t tmc5160_readThroughBits[TMC5160_IC_CACHE_COUNT][TMC5160_REGISTER_COUNT/8] = {0};
 
 void tmc5160_setDirtyBit(uint16_t icID, uint8_t index, bool value)
 {
@@ -66,6 +68,75 @@ bool tmc5160_getDirtyBit(uint16_t icID, uint8_t index)
     return ((*tmp) >> shift) & 1;
 }
 
+static void setCacheBit(uint8_t *bits, uint8_t index, bool value)
+{
+    if(index >= TMC5160_REGISTER_COUNT)
+        return;
+
+    uint8_t mask = 1 << (index % 8);
+    bits[index / 8] = value ? (bits[index / 8] | mask) : (bits[index / 8] & ~mask);
+}
+
+static bool getCacheBit(uint8_t *bits, uint8_t index)
+{
+    if(index >= TMC5160_REGISTER_COUNT)
+        return false;
+
+    return (bits[index / 8] >> (index % 8)) & 1;
+}
+
+static bool isReadThroughCapable(uint8_t address)
+{
+    static const uint8_t capableRegisters[] = TMC5160_READ_THROUGH_CAPABLE_REGISTERS;
+
+    for (size_t i = 0; i < ARRAY_SIZE(capableRegisters); i++)
+    {
+        if (capableRegisters[i] == address)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * Sets the cache policy of a readable register. With read-through enabled, reads are served from the
+ * shadow copy once it holds a valid value (after the first read from or write to the chip).
+ * Only the configuration registers listed in TMC5160_READ_THROUGH_CAPABLE_REGISTERS support this.
+ */
+bool tmc5160_setCacheReadThrough(uint16_t icID, uint8_t address, bool enable)
+{
+    if (icID >= TMC5160_IC_CACHE_COUNT || address >= TMC5160_REGISTER_COUNT)
+        return false;
+
+    if (enable && !isReadThroughCapable(address))
+        return false;
+
+    setCacheBit(tmc5160_readThroughBits[icID], address, enable);
+    setCacheBit(tmc5160_validBits[icID], address, false);
+    return true;
+}
+
+bool tmc5160_getCacheReadThrough(uint16_t icID, uint8_t address)
+{
+    if (icID >= TMC5160_IC_CACHE_COUNT)
+        return false;
+
+    return getCacheBit(tmc5160_readThroughBits[icID], address);
+}
+
+/*
+ * Marks the shadow copies of all read-through registers as invalid,
+ * so they are read from the chip again on the next access.
+ */
+void tmc5160_invalidateCache(uint16_t icID)
+{
+    if (icID >= TMC5160_IC_CACHE_COUNT)
+        return;
+
+    for (size_t i = 0; i < TMC5160_REGISTER_COUNT/8; i++)
+        tmc5160_validBits[icID][i] = 0;
+}
+
 /*
  * This function is used to cache the value written to the Write-Only registers in the form of shadow array.
  * The shadow copy is then used to read these kinds of registers.
@@ -80,9 +151,10 @@ bool tmc5160_cache(uint16_t icID, TMC5160CacheOp operation, uint8_t address, uin
         if (icID >= TMC5160_IC_CACHE_COUNT)
             return false;
 
-        // Only non-readable registers care about caching
-        // Note: This could also be used to cache i.e. RW config registers to reduce bus accesses
-        if (TMC5160_IS_READABLE(tmc5160_registerAccess[address]))
+        // Non-readable registers are always served from the cache. Readable registers only
+        // if they use the read-through policy and their shadow copy holds a valid value.
+        if (TMC5160_IS_READABLE(tmc5160_registerAccess[address])
+            && !(getCacheBit(tmc5160_readThroughBits[icID], address) && getCacheBit(tmc5160_validBits[icID], address)))
             return false;
 
         // Grab the value from the cache
@@ -102,13 +174,43 @@ bool tmc5160_cache(uint16_t icID, TMC5160CacheOp operation, uint8_t address, uin
         if (operation == TMC5160_CACHE_WRITE)
         {
             tmc5160_setDirtyBit(icID, address, true);
+
+            // Writing a read-through register makes its shadow copy valid
+            if (getCacheBit(tmc5160_readThroughBits[icID], address))
+                setCacheBit(tmc5160_validBits[icID], address, true);
         }
         return true;
     }
+    else if (operation == TMC5160_CACHE_FILL_READ)
+    {
+        // Store values read from the chip for read-through registers
+
+        // only supported chips have a cache
+        if (icID >= TMC5160_IC_CACHE_COUNT)
+            return false;
+
+        if (!getCacheBit(tmc5160_readThroughBits[icID], address))
+            return false;
+
+        tmc5160_shadowRegister[icID][address] = *value;
+        setCacheBit(tmc5160_validBits[icID], address, true);
+        return true;
+    }
     return false;
 }
 void tmc5160_initCache()
 {
+#if TMC5160_CACHE_READ_THROUGH == 1
+    // Apply the default read-through policy
+    static const uint8_t readThroughRegisters[] = TMC5160_CACHE_READ_THROUGH_REGISTERS;
+
+    for (size_t id = 0; id < TMC5160_IC_CACHE_COUNT; id++)
+    {
+        for (size_t k = 0; k < ARRAY_SIZE(readThroughRegisters); k++)
+            tmc5160_setCacheReadThrough(id, readThroughRegisters[k], true);
+    }
+#endif
+
     // Check if we have constants defined
     if(ARRAY_SIZE(tmc5160_RegisterConstants) == 0)
         return;
@@ -150,17 +252,128 @@ extern bool tmc5160_cache(uint16_t icID, TMC5160CacheOp operation, uint8_t addre
 #endif
 /************************************************************** Register read / write Implementation ******************************************************************/
 static int32_t readRegisterSPI(uint16_t icID, uint8_t address);
+static void readRegistersSPI(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count);
 static void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value);
+static void writeRegistersSPI(uint16_t icID, const TMC5160RegisterWrite *writes, size_t count);
 static int32_t readRegisterUART(uint16_t icID, uint8_t registerAddress);
 static void writeRegisterUART(uint16_t icID, uint8_t registerAddress, int32_t value);
 static uint8_t CRC8(uint8_t *data, uint32_t bytes);
 
+/************************************************************** Bus statistics ******************************************************************/
+#if TMC5160_BUS_STATISTICS == 1
+static TMC_BusStatistics busStatistics[TMC5160_BUS_STATISTICS_COUNT];
+
+TMC_BusStatistics *tmc5160_getBusStatistics(uint16_t icID)
+{
+    if (icID >= TMC5160_BUS_STATISTICS_COUNT)
+        return NULL;
+
+    return &busStatistics[icID];
+}
+
+static void readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength)
+{
+    TMC_BusStatistics *statistics = tmc5160_getBusStatistics(icID);
+
+    if (!statistics)
+    {
+        tmc5160_readWriteSPI(icID, data, dataLength);
+        return;
+    }
+
+    // The datagram is overwritten with the reply, keep the address byte
+    uint8_t address = data[0];
+    uint32_t startTime = tmc_bus_statistics_getTime();
+
+    tmc5160_readWriteSPI(icID, data, dataLength);
+
+    tmc_bus_statistics_recordTransfer(statistics, tmc_bus_statistics_getTime() - startTime);
+    tmc_bus_statistics_recordDatagram(statistics, address, dataLength, dataLength);
+}
+
+#if TMC5160_SPI_BATCH_SUPPORT == 1
+static void readWriteSPIBatch(uint16_t icID, uint8_t *data, size_t datagramLength, size_t datagramCount)
+{
+    TMC_BusStatistics *statistics = tmc5160_getBusStatistics(icID);
+
+    if (!statistics)
+    {
+        tmc5160_readWriteSPIBatch(icID, data, datagramLength, datagramCount);
+        return;
+    }
+
+    // Record the datagrams before the buffer may be overwritten with the received bytes
+    for (size_t i = 0; i < datagramCount; i++)
+        tmc_bus_statistics_recordDatagram(statistics, data[i * datagramLength], datagramLength, datagramLength);
+
+    uint32_t startTime = tmc_bus_statistics_getTime();
+
+    tmc5160_readWriteSPIBatch(icID, data, datagramLength, datagramCount);
+
+    tmc_bus_statistics_recordTransfer(statistics, tmc_bus_statistics_getTime() - startTime);
+}
+#endif
+
+static bool readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+    TMC_BusStatistics *statistics = tmc5160_getBusStatistics(icID);
+
+    if (!statistics)
+        return tmc5160_readWriteUART(icID, data, writeLength, readLength);
+
+    uint8_t address = data[2];
+    uint32_t startTime = tmc_bus_statistics_getTime();
+
+    bool success = tmc5160_readWriteUART(icID, data, writeLength, readLength);
+
+    tmc_bus_statistics_recordTransfer(statistics, tmc_bus_statistics_getTime() - startTime);
+    tmc_bus_statistics_recordDatagram(statistics, address, writeLength, success ? readLength : 0);
+
+    if (!success)
+        tmc_bus_statistics_recordReplyError(statistics);
+
+    return success;
+}
+
+static void recordCache(uint16_t icID, uint8_t address, bool hit)
+{
+    TMC_BusStatistics *statistics = tmc5160_getBusStatistics(icID);
+
+    if (statistics)
+        tmc_bus_statistics_recordCache(statistics, address, hit);
+}
+
+static void recordReplyError(uint16_t icID, bool crcError)
+{
+    TMC_BusStatistics *statistics = tmc5160_getBusStatistics(icID);
+
+    if (!statistics)
+        return;
+
+    if (crcError)
+        tmc_bus_statistics_recordCRCError(statistics);
+    else
+        tmc_bus_statistics_recordReplyError(statistics);
+}
+#else
+// Statistics disabled: Call the callbacks directly
+#define readWriteSPI         tmc5160_readWriteSPI
+#define readWriteSPIBatch    tmc5160_readWriteSPIBatch
+#define readWriteUART        tmc5160_readWriteUART
+#define recordCache(icID, address, hit)
+#define recordReplyError(icID, crcError)
+#endif
+/*************************************************************************************************************************************************/
+
 int32_t tmc5160_readRegister(uint16_t icID, uint8_t address)
 {
     uint32_t value;
 
-    // Read from cache for registers with write-only access
-    if (tmc5160_cache(icID, TMC5160_CACHE_READ, address, &value))
+    // Read from cache for write-only registers and valid read-through registers
+    bool cacheHit = tmc5160_cache(icID, TMC5160_CACHE_READ, address, &value);
+    recordCache(icID, address, cacheHit);
+
+    if (cacheHit)
         return value;
 
     TMC5160BusType bus = tmc5160_getBusType(icID);
@@ -178,6 +391,23 @@ int32_t tmc5160_readRegister(uint16_t icID, uint8_t address)
     return -1;
 }
 
+void tmc5160_readRegisters(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count)
+{
+    TMC5160BusType bus = tmc5160_getBusType(icID);
+
+    if(bus == IC_BUS_SPI)
+    {
+        readRegistersSPI(icID, addresses, values, count);
+        return;
+    }
+
+    // UART replies arrive immediately, there is nothing to pipeline
+    for(size_t i = 0; i < count; i++)
+    {
+        values[i] = tmc5160_readRegister(icID, addresses[i]);
+    }
+}
+
 void tmc5160_writeRegister(uint16_t icID, uint8_t address, int32_t value)
 {
     TMC5160BusType bus = tmc5160_getBusType(icID);
@@ -193,6 +423,23 @@ void tmc5160_writeRegister(uint16_t icID, uint8_t address, int32_t value)
     }
 }
 
+void tmc5160_writeRegisters(uint16_t icID, const TMC5160RegisterWrite *writes, size_t count)
+{
+    TMC5160BusType bus = tmc5160_getBusType(icID);
+
+    if(bus == IC_BUS_SPI)
+    {
+        writeRegistersSPI(icID, writes, count);
+    }
+    else if(bus == IC_BUS_UART)
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            writeRegisterUART(icID, writes[i].address, writes[i].value);
+        }
+    }
+}
+
 int32_t readRegisterSPI(uint16_t icID, uint8_t address)
 {
     uint8_t data[5] = { 0 };
@@ -203,15 +450,72 @@ int32_t readRegisterSPI(uint16_t icID, uint8_t address)
     data[0] = address;
 
     // Send the read request
-    tmc5160_readWriteSPI(icID, &data[0], sizeof(data));
+    readWriteSPI(icID, &data[0], sizeof(data));
 
     // Rewrite address and clear write bit
     data[0] = address;
 
     // Send another request to receive the read reply
-    tmc5160_readWriteSPI(icID, &data[0], sizeof(data));
+    readWriteSPI(icID, &data[0], sizeof(data));
+
+    uint32_t result = ((uint32_t)data[1] << 24) | ((uint32_t) data[2] << 16) | ( data[3] <<  8) | ( data[4]);
+
+    // Keep the shadow copy of read-through registers up to date
+    tmc5160_cache(icID, TMC5160_CACHE_FILL_READ, address, &result);
 
-    return ((uint32_t)data[1] << 24) | ((uint32_t) data[2] << 16) | ( data[3] <<  8) | ( data[4]);
+    return result;
+}
+
+void readRegistersSPI(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count)
+{
+    uint8_t data[5] = { 0 };
+    uint8_t address = 0;
+    int32_t *pendingValue = NULL;
+    uint8_t pendingAddress = 0;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        uint32_t value;
+
+        // Read from cache for write-only registers and valid read-through registers
+        bool cacheHit = tmc5160_cache(icID, TMC5160_CACHE_READ, addresses[i], &value);
+        recordCache(icID, addresses[i], cacheHit);
+
+        if (cacheHit)
+        {
+            values[i] = value;
+            continue;
+        }
+
+        address = addresses[i] & TMC5160_ADDRESS_MASK;
+
+        // Send the read request. The reply belongs to the previous request.
+        data[0] = address;
+        data[1] = 0;
+        data[2] = 0;
+        data[3] = 0;
+        data[4] = 0;
+        readWriteSPI(icID, &data[0], sizeof(data));
+
+        if (pendingValue)
+        {
+            *pendingValue = ((uint32_t)data[1] << 24) | ((uint32_t) data[2] << 16) | ( data[3] <<  8) | ( data[4]);
+            tmc5160_cache(icID, TMC5160_CACHE_FILL_READ, pendingAddress, (uint32_t *)pendingValue);
+        }
+
+        pendingValue = &values[i];
+        pendingAddress = address;
+    }
+
+    if (!pendingValue)
+        return;
+
+    // Rewrite the last address to receive the last read reply
+    data[0] = address;
+    readWriteSPI(icID, &data[0], sizeof(data));
+
+    *pendingValue = ((uint32_t)data[1] << 24) | ((uint32_t) data[2] << 16) | ( data[3] <<  8) | ( data[4]);
+    tmc5160_cache(icID, TMC5160_CACHE_FILL_READ, pendingAddress, (uint32_t *)pendingValue);
 }
 
 void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value)
@@ -225,12 +529,56 @@ void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value)
     data[4] = 0xFF & (value>>0);
 
     // Send the write request
-    tmc5160_readWriteSPI(icID, &data[0], sizeof(data));
+    readWriteSPI(icID, &data[0], sizeof(data));
 
     //Cache the registers with write-only access
     tmc5160_cache(icID, TMC5160_CACHE_WRITE, address, (uint32_t *)&value);
 }
 
+#if TMC5160_SPI_BATCH_SUPPORT == 1
+void writeRegistersSPI(uint16_t icID, const TMC5160RegisterWrite *writes, size_t count)
+{
+    uint8_t data[TMC5160_SPI_BATCH_SIZE * 5];
+
+    while(count > 0)
+    {
+        size_t batchSize = (count < TMC5160_SPI_BATCH_SIZE)? count : TMC5160_SPI_BATCH_SIZE;
+
+        for(size_t i = 0; i < batchSize; i++)
+        {
+            uint8_t *datagram = &data[i * 5];
+
+            datagram[0] = writes[i].address | TMC5160_WRITE_BIT;
+            datagram[1] = 0xFF & (writes[i].value>>24);
+            datagram[2] = 0xFF & (writes[i].value>>16);
+            datagram[3] = 0xFF & (writes[i].value>>8);
+            datagram[4] = 0xFF & (writes[i].value>>0);
+        }
+
+        // Send all write requests of this batch at once
+        readWriteSPIBatch(icID, &data[0], 5, batchSize);
+
+        //Cache the registers with write-only access
+        for(size_t i = 0; i < batchSize; i++)
+        {
+            uint32_t value = writes[i].value;
+            tmc5160_cache(icID, TMC5160_CACHE_WRITE, writes[i].address, &value);
+        }
+
+        writes += batchSize;
+        count  -= batchSize;
+    }
+}
+#else
+void writeRegistersSPI(uint16_t icID, const TMC5160RegisterWrite *writes, size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        writeRegisterSPI(icID, writes[i].address, writes[i].value);
+    }
+}
+#endif
+
 int32_t readRegisterUART(uint16_t icID, uint8_t address)
 {
     uint8_t data[8] = { 0 };
@@ -241,26 +589,31 @@ int32_t readRegisterUART(uint16_t icID, uint8_t address)
     data[2] = address;
     data[3] = CRC8(data, 3);
 
-    if (!tmc5160_readWriteUART(icID, &data[0], 4, 8))
+    if (!readWriteUART(icID, &data[0], 4, 8))
         return 0;
 
     // Byte 0: Sync nibble correct?
-    if (data[0] != 0x05)
-        return 0;
-
     // Byte 1: Master address correct?
-    if (data[1] != 0xFF)
-        return 0;
-
     // Byte 2: Address correct?
-    if (data[2] != address)
+    if (data[0] != 0x05 || data[1] != 0xFF || data[2] != address)
+    {
+        recordReplyError(icID, false);
         return 0;
+    }
 
     // Byte 7: CRC correct?
     if (data[7] != CRC8(data, 7))
+    {
+        recordReplyError(icID, true);
         return 0;
+    }
+
+    uint32_t result = ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
 
-    return ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+    // Keep the shadow copy of read-through registers up to date
+    tmc5160_cache(icID, TMC5160_CACHE_FILL_READ, address, &result);
+
+    return result;
 }
 
 void writeRegisterUART(uint16_t icID, uint8_t address, int32_t value)
@@ -276,7 +629,7 @@ void writeRegisterUART(uint16_t icID, uint8_t address, int32_t value)
     data[6] = (value      ) & 0xFF;
     data[7] = CRC8(data, 7);
 
-    tmc5160_readWriteUART(icID, &data[0], 8, 0);
+    readWriteUART(icID, &data[0], 8, 0);
 
     //Cache the registers with write-only access
     tmc5160_cache(icID, TMC5160_CACHE_WRITE, address, (uint32_t *)&value);
@@ -36,6 +36,51 @@
 //#define TMC5160_ENABLE_TMC_CACHE   0
 #endif
 
+// To serve reads of stable read/write configuration registers from the cache, set TMC5160_CACHE_READ_THROUGH to '1'.
+// The registers listed in TMC5160_CACHE_READ_THROUGH_REGISTERS are then read from the chip once (or written)
+// and afterwards read from their shadow copies. The policy is applied by tmc5160_initCache() and can
+// also be changed per register at runtime with tmc5160_setCacheReadThrough().
+// Call tmc5160_invalidateCache() if the chip might have lost its configuration (e.g. after a reset).
+#ifndef TMC5160_CACHE_READ_THROUGH
+#define TMC5160_CACHE_READ_THROUGH   0
+//#define TMC5160_CACHE_READ_THROUGH   1
+#endif
+
+#ifndef TMC5160_CACHE_READ_THROUGH_REGISTERS
+#define TMC5160_CACHE_READ_THROUGH_REGISTERS   { TMC5160_GCONF, TMC5160_RAMPMODE, TMC5160_SWMODE, TMC5160_ENCMODE, TMC5160_CHOPCONF }
+#endif
+
+// To send batched register writes (tmc5160_writeRegisters) with one callback per batch, set
+// TMC5160_SPI_BATCH_SUPPORT to '1' and implement tmc5160_readWriteSPIBatch().
+// With '0', batched writes fall back to one tmc5160_readWriteSPI() call per register.
+#ifndef TMC5160_SPI_BATCH_SUPPORT
+#define TMC5160_SPI_BATCH_SUPPORT   0
+//#define TMC5160_SPI_BATCH_SUPPORT   1
+#endif
+
+// Maximum amount of datagrams handed to tmc5160_readWriteSPIBatch() in one call.
+// The datagrams are assembled on the stack (5 bytes each).
+#ifndef TMC5160_SPI_BATCH_SIZE
+#define TMC5160_SPI_BATCH_SIZE   16
+#endif
+
+// To record bus transaction statistics (transfers, bytes, cache hits/misses, CRC errors and
+// latency histograms per register) set TMC5160_BUS_STATISTICS to '1'. The statistics are kept for
+// the first TMC5160_BUS_STATISTICS_COUNT ICs, see tmc/helpers/BusStatistics.h. The application
+// has to implement tmc_bus_statistics_getTime() and link tmc/helpers/BusStatistics.c.
+#ifndef TMC5160_BUS_STATISTICS
+#define TMC5160_BUS_STATISTICS   0
+//#define TMC5160_BUS_STATISTICS   1
+#endif
+
+#ifndef TMC5160_BUS_STATISTICS_COUNT
+#define TMC5160_BUS_STATISTICS_COUNT   1
+#endif
+
+#if TMC5160_BUS_STATISTICS == 1
+#include "tmc/helpers/BusStatistics.h"
+#endif
+
 /******************************************************************************/
 
 typedef enum {
@@ -51,17 +96,41 @@ typedef struct
     bool isSigned;
 } RegisterField;
 
+typedef struct
+{
+    uint8_t address;
+    int32_t value;
+} TMC5160RegisterWrite;
+
 // => TMC-API wrapper
 extern void tmc5160_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength);
 extern bool tmc5160_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength);
 extern TMC5160BusType tmc5160_getBusType(uint16_t icID);
 extern uint8_t tmc5160_getNodeAddress(uint16_t icID);
+#if TMC5160_SPI_BATCH_SUPPORT == 1
+// Sends [datagramCount] datagrams of [datagramLength] bytes each, stored back to back in [data].
+// Every datagram needs its own chip select assertion and de-assertion, e.g. through a DMA
+// transfer with hardware-controlled chip select. The received bytes are not evaluated.
+extern void tmc5160_readWriteSPIBatch(uint16_t icID, uint8_t *data, size_t datagramLength, size_t datagramCount);
+#endif
 // => TMC-API wrapper
 
 int32_t tmc5160_readRegister(uint16_t icID, uint8_t address);
+// Reads multiple registers at once. Over SPI the read requests are pipelined:
+// each transfer sends the next request and receives the reply to the previous one,
+// so reading n registers takes n+1 transfers instead of 2n.
+void tmc5160_readRegisters(uint16_t icID, const uint8_t *addresses, int32_t *values, size_t count);
 void tmc5160_writeRegister(uint16_t icID, uint8_t address, int32_t value);
+// Writes multiple registers in order. Over SPI the whole batch is handed to
+// tmc5160_readWriteSPIBatch() when TMC5160_SPI_BATCH_SUPPORT is enabled.
+void tmc5160_writeRegisters(uint16_t icID, const TMC5160RegisterWrite *writes, size_t count);
 void tmc5160_rotateMotor(uint16_t icID, uint8_t motor, int32_t velocity);
 
+#if TMC5160_BUS_STATISTICS == 1
+// Returns the bus statistics of [icID] or NULL if [icID] >= TMC5160_BUS_STATISTICS_COUNT
+TMC_BusStatistics *tmc5160_getBusStatistics(uint16_t icID);
+#endif
+
 static inline uint32_t tmc5160_fieldExtract(uint32_t data, RegisterField field)
 {
     uint32_t value = (data & field.mask) >> field.shift;
@@ -98,6 +167,56 @@ static inline void tmc5160_fieldWrite(uint16_t icID, RegisterField field, uint32
     tmc5160_writeRegister(icID, field.address, regValue);
 }
 
+// Coalesced field updates: Several fields of one register are changed with a single write.
+// The register value is taken from the cache if possible (write-only registers or valid
+// read-through registers), otherwise it is read from the chip once in tmc5160_fieldBegin().
+// Example:
+//     TMC5160FieldUpdate update = tmc5160_fieldBegin(icID, field1.address);
+//     tmc5160_fieldSet(&update, field1, value1);
+//     tmc5160_fieldSet(&update, field2, value2);
+//     tmc5160_fieldCommit(&update);
+typedef struct
+{
+    uint16_t icID;
+    uint8_t address;
+    bool modified;
+    uint32_t value;
+} TMC5160FieldUpdate;
+
+static inline TMC5160FieldUpdate tmc5160_fieldBegin(uint16_t icID, uint8_t address)
+{
+    TMC5160FieldUpdate update;
+
+    update.icID     = icID;
+    update.address  = address;
+    update.modified = false;
+    update.value    = tmc5160_readRegister(icID, address);
+
+    return update;
+}
+
+// Returns false if the field belongs to a different register than the one passed to tmc5160_fieldBegin()
+static inline bool tmc5160_fieldSet(TMC5160FieldUpdate *update, RegisterField field, uint32_t value)
+{
+    if (field.address != update->address)
+        return false;
+
+    update->value    = tmc5160_fieldUpdate(update->value, field, value);
+    update->modified = true;
+
+    return true;
+}
+
+// Writes the register if any field has been set
+static inline void tmc5160_fieldCommit(TMC5160FieldUpdate *update)
+{
+    if (!update->modified)
+        return;
+
+    tmc5160_writeRegister(update->icID, update->address, update->value);
+    update->modified = false;
+}
+
 /**************************************************************** Cache Implementation *************************************************************************/
 
 #if TMC5160_CACHE == 1
@@ -116,7 +235,11 @@ typedef enum {
    // Only used to initialize the cache with hardware defaults. This will allow reading
    // from write-only registers that have a value inside them on reset. When using this
    // operation, a restore will *not* rewrite that filled register!
-   TMC5160_CACHE_FILL_DEFAULT
+   TMC5160_CACHE_FILL_DEFAULT,
+
+   // Special operation: Put a value read from the chip into the cache without marking the
+   // entry as dirty. Only stored for registers using the read-through policy.
+   TMC5160_CACHE_FILL_READ
 
 } TMC5160CacheOp;
 
@@ -132,6 +255,13 @@ typedef struct
 #define TMC5160_IS_READABLE(x)     ((x) & TMC5160_ACCESS_READ)
 #define ARRAY_SIZE(x)              (sizeof(x)/sizeof(x[0]))
 
+// Registers that may use the read-through cache policy: configuration registers that are only
+// changed by the application. Positions, counters and other values the chip updates itself
+// (e.g. XACTUAL, X_ENC) are excluded even when they are plain read/write registers.
+#define TMC5160_READ_THROUGH_CAPABLE_REGISTERS { \
+    TMC5160_GCONF, TMC5160_FACTORY_CONF, TMC5160_RAMPMODE, TMC5160_XTARGET, TMC5160_SWMODE, \
+    TMC5160_ENCMODE, TMC5160_CHOPCONF }
+
 // Default Register values
 #define R00 0x00000008  // GCONF
 #define R09 0x00010606  // SHORTCONF
@@ -216,6 +346,11 @@ static const TMC5160RegisterConstants tmc5160_RegisterConstants[] =
 
 extern uint8_t tmc5160_dirtyBits[TMC5160_IC_CACHE_COUNT][TMC5160_REGISTER_COUNT/8];
 extern int32_t tmc5160_shadowRegister[TMC5160_IC_CACHE_COUNT][TMC5160_REGISTER_COUNT];
+extern uint8_t tmc5160_validBits[TMC5160_IC_CACHE_COUNT][TMC5160_REGISTER_COUNT/8];
+extern uint8_t tmc5160_readThroughBits[TMC5160_IC_CACHE_COUNT][TMC5160_REGISTER_COUNT/8];
+bool tmc5160_setCacheReadThrough(uint16_t icID, uint8_t address, bool enable);
+bool tmc5160_getCacheReadThrough(uint16_t icID, uint8_t address);
+void tmc5160_invalidateCache(uint16_t icID);
 void tmc5160_setDirtyBit(uint16_t icID, uint8_t index, bool value);
 bool tmc5160_getDirtyBit(uint16_t icID, uint8_t index);
 extern bool tmc5160_cache(uint16_t icID, TMC5160CacheOp operation, uint8_t address, uint32_t *value);
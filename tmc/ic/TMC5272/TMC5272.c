@@ -34,6 +34,7 @@ const uint8_t tmcCRCTable_Poly7Reflected[256] = {
 
 static int32_t readRegisterSPI(uint16_t icID, uint8_t address);
 static void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value);
+static void writeRegistersSPI(uint16_t icID, const TMC5272RegisterWrite *writes, size_t count);
 static int32_t readRegisterUART(uint16_t icID, uint8_t registerAddress);
 static void writeRegisterUART(uint16_t icID, uint8_t registerAddress, int32_t value);
 static uint8_t CRC8(uint8_t *data, uint32_t bytes);
@@ -69,6 +70,23 @@ void tmc5272_writeRegister(uint16_t icID, uint8_t address, int32_t value)
 	}
 }
 
+void tmc5272_writeRegisters(uint16_t icID, const TMC5272RegisterWrite *writes, size_t count)
+{
+	TMC5272BusType bus = tmc5272_getBusType(icID);
+
+	if(bus == IC_BUS_SPI)
+	{
+		writeRegistersSPI(icID, writes, count);
+	}
+	else if(bus == IC_BUS_UART)
+	{
+		for(size_t i = 0; i < count; i++)
+		{
+			writeRegisterUART(icID, writes[i].address, writes[i].value);
+		}
+	}
+}
+
 int32_t readRegisterSPI(uint16_t icID, uint8_t address)
 {
 	uint8_t data[5] = { 0 };
@@ -102,6 +120,43 @@ void writeRegisterSPI(uint16_t icID, uint8_t address, int32_t value)
 	tmc5272_readWriteSPI(icID, &data[0], sizeof(data));
 }
 
+#if TMC5272_SPI_BATCH_SUPPORT == 1
+void writeRegistersSPI(uint16_t icID, const TMC5272RegisterWrite *writes, size_t count)
+{
+	uint8_t data[TMC5272_SPI_BATCH_SIZE * 5];
+
+	while(count > 0)
+	{
+		size_t batchSize = (count < TMC5272_SPI_BATCH_SIZE)? count : TMC5272_SPI_BATCH_SIZE;
+
+		for(size_t i = 0; i < batchSize; i++)
+		{
+			uint8_t *datagram = &data[i * 5];
+
+			datagram[0] = writes[i].address | TMC5272_WRITE_BIT;
+			datagram[1] = 0xFF & (writes[i].value>>24);
+			datagram[2] = 0xFF & (writes[i].value>>16);
+			datagram[3] = 0xFF & (writes[i].value>>8);
+			datagram[4] = 0xFF & (writes[i].value>>0);
+		}
+
+		// Send all write requests of this batch at once
+		tmc5272_readWriteSPIBatch(icID, &data[0], 5, batchSize);
+
+		writes += batchSize;
+		count  -= batchSize;
+	}
+}
+#else
+void writeRegistersSPI(uint16_t icID, const TMC5272RegisterWrite *writes, size_t count)
+{
+	for(size_t i = 0; i < count; i++)
+	{
+		writeRegisterSPI(icID, writes[i].address, writes[i].value);
+	}
+}
+#endif
+
 int32_t readRegisterUART(uint16_t icID, uint8_t registerAddress)
 {
 	uint8_t data[8] = { 0 };
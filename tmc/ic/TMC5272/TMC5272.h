@@ -24,6 +24,20 @@
 // and put the table into your own .c file
 //#define TMC_API_EXTERNAL_CRC_TABLE 1
 
+// To send batched register writes (tmc5272_writeRegisters) with one callback per batch, set
+// TMC5272_SPI_BATCH_SUPPORT to '1' and implement tmc5272_readWriteSPIBatch().
+// With '0', batched writes fall back to one tmc5272_readWriteSPI() call per register.
+#ifndef TMC5272_SPI_BATCH_SUPPORT
+#define TMC5272_SPI_BATCH_SUPPORT   0
+//#define TMC5272_SPI_BATCH_SUPPORT   1
+#endif
+
+// Maximum amount of datagrams handed to tmc5272_readWriteSPIBatch() in one call.
+// The datagrams are assembled on the stack (5 bytes each).
+#ifndef TMC5272_SPI_BATCH_SIZE
+#define TMC5272_SPI_BATCH_SIZE   16
+#endif
+
 // Default Register values
 #define R00 0x00000008  // GCONF
 #define R0A 0x00000020  // DRVCONF
@@ -56,15 +70,30 @@ typedef enum {
 	IC_BUS_UART,
 } TMC5272BusType;
 
+typedef struct
+{
+	uint8_t address;
+	int32_t value;
+} TMC5272RegisterWrite;
+
 // => TMC-API wrapper
 extern void tmc5272_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength);
 extern bool tmc5272_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength);
 extern TMC5272BusType tmc5272_getBusType(uint16_t icID);
 extern uint8_t tmc5272_getNodeAddress(uint16_t icID);
+#if TMC5272_SPI_BATCH_SUPPORT == 1
+// Sends [datagramCount] datagrams of [datagramLength] bytes each, stored back to back in [data].
+// Every datagram needs its own chip select assertion and de-assertion, e.g. through a DMA
+// transfer with hardware-controlled chip select. The received bytes are not evaluated.
+extern void tmc5272_readWriteSPIBatch(uint16_t icID, uint8_t *data, size_t datagramLength, size_t datagramCount);
+#endif
 // => TMC-API wrapper
 
 int32_t tmc5272_readRegister(uint16_t icID, uint8_t address);
 void tmc5272_writeRegister(uint16_t icID, uint8_t address, int32_t value);
+// Writes multiple registers in order. Over SPI the whole batch is handed to
+// tmc5272_readWriteSPIBatch() when TMC5272_SPI_BATCH_SUPPORT is enabled.
+void tmc5272_writeRegisters(uint16_t icID, const TMC5272RegisterWrite *writes, size_t count);
 void tmc5272_rotateMotor(uint16_t icID, uint8_t motor, int32_t velocity);
 
 typedef struct
@@ -16,7 +16,8 @@ static int32_t writeRegisterUART(uint16_t icID, uint16_t address, uint32_t write
 // Internal helper functions
 static bool isRTMIDatagramHeader(uint8_t byte_value);
 static bool handleRTMIDatagram(uint16_t icID, uint8_t *data);
-static uint8_t CRC8(uint8_t *data, uint32_t bytes);
+static size_t buildRTMIStreamWrite(uint8_t *data, uint8_t rtmi_index, uint32_t value, bool isRTMICRCEnabled);
+static uint8_t CRC8(const uint8_t *data, uint32_t bytes);
 
 // Constants
 #define SPI_WRITE_BIT     0x80
@@ -128,25 +129,39 @@ int32_t tmc6460_writeRegister(uint16_t icID, uint16_t address, uint32_t writeVal
 
 int32_t tmc6460_writeRTMIStreamedRegister(uint16_t icID, uint8_t rtmi_index, uint32_t value)
 {
-    bool isRTMICRCEnabled = tmc6460_isRTMICRCEnabled(icID);
-    size_t writeSize = isRTMICRCEnabled? 6:5;
-
     uint8_t data[6] = { 0 };
 
-    data[0] = UART_STREAM_WRITE | ((rtmi_index << 1) & 0x0E);
-    data[1] = (value >> 24) & 0xFF;
-    data[2] = (value >> 16) & 0xFF;
-    data[3] = (value >>  8) & 0xFF;
-    data[4] = (value      ) & 0xFF;
+    size_t writeSize = buildRTMIStreamWrite(&data[0], rtmi_index, value, tmc6460_isRTMICRCEnabled(icID));
 
-    if (isRTMICRCEnabled)
+    if (!tmc6460_readWriteUART(icID, &data[0], writeSize, 0))
     {
-        data[5] = CRC8(&data[0], 5);
+        return -2;
     }
 
-    if (!tmc6460_readWriteUART(icID, &data[0], writeSize, 0))
+    return 0;
+}
+
+int32_t tmc6460_writeRTMIStreamedRegisters(uint16_t icID, const uint8_t *rtmi_indices, const uint32_t *values, size_t count)
+{
+    bool isRTMICRCEnabled = tmc6460_isRTMICRCEnabled(icID);
+
+    uint8_t data[TMC6460_RTMI_WRITE_BATCH_SIZE * 6];
+
+    for (size_t i = 0; i < count; i += TMC6460_RTMI_WRITE_BATCH_SIZE)
     {
-        return -2;
+        size_t blockSize = (count - i < TMC6460_RTMI_WRITE_BATCH_SIZE)? count - i : TMC6460_RTMI_WRITE_BATCH_SIZE;
+        size_t writeSize = 0;
+
+        // Write requests get no reply, so the datagrams can be sent back to back
+        for (size_t j = 0; j < blockSize; j++)
+        {
+            writeSize += buildRTMIStreamWrite(&data[writeSize], rtmi_indices[i + j], values[i + j], isRTMICRCEnabled);
+        }
+
+        if (!tmc6460_readWriteUART(icID, &data[0], writeSize, 0))
+        {
+            return -2;
+        }
     }
 
     return 0;
@@ -291,6 +306,23 @@ static int32_t writeRegisterUART(uint16_t icID, uint16_t address, uint32_t write
     return 0;
 }
 
+// Returns the datagram size
+static size_t buildRTMIStreamWrite(uint8_t *data, uint8_t rtmi_index, uint32_t value, bool isRTMICRCEnabled)
+{
+    data[0] = UART_STREAM_WRITE | ((rtmi_index << 1) & 0x0E);
+    data[1] = (value >> 24) & 0xFF;
+    data[2] = (value >> 16) & 0xFF;
+    data[3] = (value >>  8) & 0xFF;
+    data[4] = (value      ) & 0xFF;
+
+    if (!isRTMICRCEnabled)
+        return 5;
+
+    data[5] = CRC8(&data[0], 5);
+
+    return 6;
+}
+
 static bool isRTMIDatagramHeader(uint8_t byte_value)
 {
     return (byte_value & 0x81) == 0x01;
@@ -339,10 +371,218 @@ bool tmc6460_processRTMI(uint16_t icID, uint32_t packetLimit)
 
     return true;
 }
+
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT == 1
+
+void tmc6460_initRTMIRingBuffer(TMC6460RTMIRingBuffer *ring, const uint8_t *buffer, size_t size)
+{
+    ring->buffer       = buffer;
+    ring->size         = size;
+    ring->readIndex    = 0;
+    ring->crcErrors    = 0;
+    ring->skippedBytes = 0;
+}
+
+static bool flushRTMIBatch(uint16_t icID, TMC6460RTMIBatch *batch)
+{
+    bool stop = tmc6460_RTMIBatchCallback(icID, batch);
+
+    for (uint8_t i = 0; i < TMC6460_RTMI_CHANNELS; i++)
+    {
+        batch->count[i] = 0;
+    }
+
+    return stop;
+}
+
+uint32_t tmc6460_processRTMIBuffer(uint16_t icID, TMC6460RTMIRingBuffer *ring, size_t writeIndex, TMC6460RTMIBatch *batch)
+{
+    bool isRTMICRCEnabled = tmc6460_isRTMICRCEnabled(icID);
+    size_t datagramSize = isRTMICRCEnabled? 6:5;
+
+    const uint8_t *buffer = ring->buffer;
+    size_t size = ring->size;
+    size_t readIndex = ring->readIndex;
+    size_t available = (writeIndex >= readIndex)? writeIndex - readIndex : writeIndex + size - readIndex;
+
+    uint32_t delivered = 0;
+    uint32_t pending = 0;
+    bool stop = false;
+
+    for (uint8_t i = 0; i < TMC6460_RTMI_CHANNELS; i++)
+    {
+        batch->count[i] = 0;
+    }
+
+    while (!stop && available >= datagramSize)
+    {
+        const uint8_t *datagram = &buffer[readIndex];
+        uint8_t wrapped[6];
+
+        // Datagrams crossing the end of the buffer are gathered, all others are parsed in place
+        if (readIndex + datagramSize > size)
+        {
+            for (size_t i = 0; i < datagramSize; i++)
+            {
+                wrapped[i] = buffer[(readIndex + i) % size];
+            }
+            datagram = &wrapped[0];
+        }
+
+        // Resynchronize on the next RTMI header after a lost byte.
+        // A header with a CRC mismatch may be a data byte, so the search continues after it.
+        bool valid = isRTMIDatagramHeader(datagram[0]);
+        if (!valid)
+        {
+            ring->skippedBytes++;
+        }
+        else if (isRTMICRCEnabled && datagram[5] != CRC8(datagram, 5))
+        {
+            ring->crcErrors++;
+            valid = false;
+        }
+
+        if (!valid)
+        {
+            readIndex = (readIndex + 1 < size)? readIndex + 1 : 0;
+            available--;
+            continue;
+        }
+
+        uint8_t index = TMC6460_RTMI_STATUS_INDEX(datagram[0]);
+        uint32_t sample = batch->count[index]++;
+
+        batch->status[index][sample] = datagram[0];
+        batch->value[index][sample]  = ((uint32_t) datagram[1] << 24) | ((uint32_t) datagram[2] << 16) | ((uint32_t) datagram[3] << 8) | datagram[4];
+        pending++;
+
+        readIndex += datagramSize;
+        if (readIndex >= size)
+            readIndex -= size;
+        available -= datagramSize;
+
+        if (batch->count[index] == TMC6460_RTMI_BATCH_SIZE)
+        {
+            delivered += pending;
+            pending = 0;
+            stop = flushRTMIBatch(icID, batch);
+        }
+    }
+
+    if (pending > 0)
+    {
+        delivered += pending;
+        flushRTMIBatch(icID, batch);
+    }
+
+    ring->readIndex = readIndex;
+
+    return delivered;
+}
+#endif
+
+#if TMC_API_TMC6460_RTMI_RECORDER_SUPPORT == 1
+
+void tmc6460_initRTMIRecorder(TMC6460RTMIRecorder *recorder)
+{
+    for (uint8_t i = 0; i < TMC6460_RTMI_CHANNELS; i++)
+    {
+        recorder->channels[i].head      = 0;
+        recorder->channels[i].tail      = 0;
+        recorder->channels[i].overflows = 0;
+
+        tmc6460_configureRTMIChannel(recorder, i, 1, false, false);
+    }
+}
+
+void tmc6460_configureRTMIChannel(TMC6460RTMIRecorder *recorder, uint8_t rtmi_index, uint16_t decimation, bool aggregate, bool isSigned)
+{
+    TMC6460RTMIChannel *channel = &recorder->channels[rtmi_index & (TMC6460_RTMI_CHANNELS - 1)];
+
+    channel->decimation = (decimation > 0)? decimation : 1;
+    channel->aggregate  = aggregate;
+    channel->isSigned   = isSigned;
+
+    // Restart the current interval
+    channel->samples    = 0;
+    channel->sum        = 0;
+}
+
+static bool isRTMISampleLess(TMC6460RTMIChannel *channel, uint32_t a, uint32_t b)
+{
+    return (channel->isSigned)? (int32_t) a < (int32_t) b : a < b;
+}
+
+void tmc6460_recordRTMISample(TMC6460RTMIRecorder *recorder, uint8_t status, uint32_t value)
+{
+    TMC6460RTMIChannel *channel = &recorder->channels[TMC6460_RTMI_STATUS_INDEX(status)];
+
+    if (channel->aggregate)
+    {
+        if (channel->samples == 0 || isRTMISampleLess(channel, value, channel->min))
+            channel->min = value;
+
+        if (channel->samples == 0 || isRTMISampleLess(channel, channel->max, value))
+            channel->max = value;
+
+        channel->sum += (channel->isSigned)? (int64_t) (int32_t) value : (int64_t) value;
+    }
+
+    if (++channel->samples < channel->decimation)
+        return;
+
+    uint32_t head = channel->head;
+
+    if (head - channel->tail >= TMC6460_RTMI_RECORDER_LENGTH)
+    {
+        // The consumer did not keep up, drop the record
+        channel->overflows++;
+    }
+    else
+    {
+        TMC6460RTMIRecord *record = &channel->records[head & (TMC6460_RTMI_RECORDER_LENGTH - 1)];
+
+        record->value  = value;
+        record->status = status;
+
+        if (channel->aggregate)
+        {
+            record->min  = channel->min;
+            record->max  = channel->max;
+            record->mean = (uint32_t) (channel->sum / channel->samples);
+        }
+        else
+        {
+            record->min  = value;
+            record->max  = value;
+            record->mean = value;
+        }
+
+        TMC6460_RTMI_MEMORY_BARRIER();
+        channel->head = head + 1;
+    }
+
+    channel->samples = 0;
+    channel->sum     = 0;
+}
+
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT == 1
+void tmc6460_recordRTMIBatch(TMC6460RTMIRecorder *recorder, const TMC6460RTMIBatch *batch)
+{
+    for (uint8_t i = 0; i < TMC6460_RTMI_CHANNELS; i++)
+    {
+        for (uint32_t j = 0; j < batch->count[i]; j++)
+        {
+            tmc6460_recordRTMISample(recorder, batch->status[i][j], batch->value[i][j]);
+        }
+    }
+}
+#endif
+#endif
 #endif
 
 // CRC
-static uint8_t CRC8(uint8_t *data, uint32_t bytes)
+static uint8_t CRC8(const uint8_t *data, uint32_t bytes)
 {
     uint8_t result = 0;
     while(bytes--)
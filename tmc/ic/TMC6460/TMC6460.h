@@ -23,6 +23,43 @@
 #define TMC_API_TMC6460_RTMI_SUPPORT 0
 #endif
 
+// Parsing RTMI datagrams from a receive ring buffer (e.g. filled by DMA) with
+// tmc6460_processRTMIBuffer(). Requires TMC_API_TMC6460_RTMI_SUPPORT.
+#ifndef TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+//#define TMC_API_TMC6460_RTMI_BUFFER_SUPPORT 1
+#define TMC_API_TMC6460_RTMI_BUFFER_SUPPORT 0
+#endif
+
+// Maximum amount of samples per RTMI index that tmc6460_processRTMIBuffer()
+// collects before handing them to tmc6460_RTMIBatchCallback()
+#ifndef TMC6460_RTMI_BATCH_SIZE
+#define TMC6460_RTMI_BATCH_SIZE 32
+#endif
+
+// Recording RTMI samples per RTMI index into lock-free ring buffers with the
+// TMC6460RTMIRecorder. Requires TMC_API_TMC6460_RTMI_SUPPORT.
+#ifndef TMC_API_TMC6460_RTMI_RECORDER_SUPPORT
+//#define TMC_API_TMC6460_RTMI_RECORDER_SUPPORT 1
+#define TMC_API_TMC6460_RTMI_RECORDER_SUPPORT 0
+#endif
+
+// Records per RTMI index kept by the recorder, has to be a power of two
+#ifndef TMC6460_RTMI_RECORDER_LENGTH
+#define TMC6460_RTMI_RECORDER_LENGTH 32
+#endif
+
+// Orders the record accesses before the index update. The default works for
+// GCC-compatible compilers, on single core MCUs a compiler barrier is sufficient.
+#ifndef TMC6460_RTMI_MEMORY_BARRIER
+#define TMC6460_RTMI_MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+// Maximum amount of datagrams tmc6460_writeRTMIStreamedRegisters() hands to
+// a single tmc6460_readWriteUART() call. The datagrams are assembled on the stack.
+#ifndef TMC6460_RTMI_WRITE_BATCH_SIZE
+#define TMC6460_RTMI_WRITE_BATCH_SIZE 8
+#endif
+
 #ifndef TMC_API_TMC6460_CRC_SUPPORT
 //#define TMC_API_TMC6460_CRC_SUPPORT 1
 #define TMC_API_TMC6460_CRC_SUPPORT 0
@@ -36,6 +73,77 @@ enum TMC6460BusType {
     TMC6460_BUS_END_
 };
 
+// Amount of RTMI channels (UART.RTMI_CH_0 - UART.RTMI_CH_7)
+#define TMC6460_RTMI_CHANNELS 8
+
+// RTMI index (UART.RTMI_CH_x) of a received RTMI datagram, taken from its status byte.
+// The TMC-API assumes the RTMI datagram header uses the same layout as the
+// streamed register write built by tmc6460_writeRTMIStreamedRegister():
+// bit 0 set and bit 7 cleared mark the header, bits [3:1] hold the RTMI index.
+// Only tmc6460_processRTMIBuffer() and the recorder sort samples by this index,
+// tmc6460_processRTMI() hands the raw status byte to the application.
+// If the status byte of your datagrams is laid out differently, define this
+// from the build system.
+#ifndef TMC6460_RTMI_STATUS_INDEX
+#define TMC6460_RTMI_STATUS_INDEX(status) (((status) >> 1) & 0x07)
+#endif
+
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+// Receive ring buffer of the application, e.g. the target of a circular DMA transfer.
+// Only [readIndex] and the error counters are updated by the TMC-API.
+typedef struct
+{
+    const uint8_t *buffer;
+    size_t size;
+    size_t readIndex;       // Start of the oldest byte not yet parsed
+    uint32_t crcErrors;     // RTMI datagrams discarded due to a CRC mismatch
+    uint32_t skippedBytes;  // Bytes discarded while searching for an RTMI header
+} TMC6460RTMIRingBuffer;
+
+// Decoded RTMI samples, sorted by RTMI index. For each index, [count] samples
+// are stored in [status] and [value] in the order of reception.
+typedef struct
+{
+    uint32_t count[TMC6460_RTMI_CHANNELS];
+    uint8_t status[TMC6460_RTMI_CHANNELS][TMC6460_RTMI_BATCH_SIZE];
+    uint32_t value[TMC6460_RTMI_CHANNELS][TMC6460_RTMI_BATCH_SIZE];
+} TMC6460RTMIBatch;
+#endif
+
+#if TMC_API_TMC6460_RTMI_RECORDER_SUPPORT
+// One record of an RTMI index. Without aggregation, min, max and mean equal the value.
+typedef struct
+{
+    uint32_t value;   // Last sample of the decimation interval
+    uint32_t min;
+    uint32_t max;
+    uint32_t mean;    // Rounded towards zero
+    uint8_t status;   // Status byte of the last sample
+} TMC6460RTMIRecord;
+
+typedef struct
+{
+    TMC6460RTMIRecord records[TMC6460_RTMI_RECORDER_LENGTH];
+    volatile uint32_t head;      // Next record to write, only modified by the producer
+    volatile uint32_t tail;      // Next record to read, only modified by the consumer
+    volatile uint32_t overflows; // Records dropped because the ring buffer was full
+
+    // Producer state
+    uint16_t decimation;         // Samples per record
+    bool aggregate;              // Calculate min, max and mean over the decimation interval
+    bool isSigned;               // Interpret the samples as signed values for min, max and mean
+    uint16_t samples;            // Samples of the current interval
+    uint32_t min;
+    uint32_t max;
+    int64_t sum;
+} TMC6460RTMIChannel;
+
+typedef struct
+{
+    TMC6460RTMIChannel channels[TMC6460_RTMI_CHANNELS];
+} TMC6460RTMIRecorder;
+#endif
+
 /*** TMC-API wrapper functions ************************************************/
 // Each callback function has an [icID] parameter. Calling TMC-API functions
 // that interact with a TMC6460 IC (such as tmc6460_readRegister) always take
@@ -88,6 +196,14 @@ extern bool tmc6460_isRTMIEnabled(uint16_t icID);
 // UART that have not yet been handed to the TMC-API.
 extern uint32_t tmc6460_availableBytes(uint16_t icID);
 
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+// The TMC-API will call this function from tmc6460_processRTMIBuffer() every
+// time the samples of an RTMI index fill up [batch], and once at the end for
+// the remaining samples. The samples are discarded after this function returns.
+// If no further data shall be gathered, return true, otherwise false.
+extern bool tmc6460_RTMIBatchCallback(uint16_t icID, const TMC6460RTMIBatch *batch);
+#endif
+
 #endif /* TMC_API_TMC6460_RTMI_SUPPORT */
 
 #if TMC_API_TMC6460_CRC_SUPPORT
@@ -111,9 +227,70 @@ int32_t tmc6460_writeRegister(uint16_t icID, uint16_t address, uint32_t writeVal
 // Since this datagram structure is UART-specific, it will always use UART,
 // it will not check the bus mode - hence it won't call tmc6460_getBusType().
 int32_t tmc6460_writeRTMIStreamedRegister(uint16_t icID, uint8_t rtmi_index, uint32_t value);
+// Writes [count] streamed registers, sending up to TMC6460_RTMI_WRITE_BATCH_SIZE
+// datagrams with one tmc6460_readWriteUART() call.
+int32_t tmc6460_writeRTMIStreamedRegisters(uint16_t icID, const uint8_t *rtmi_indices, const uint32_t *values, size_t count);
 
 #if TMC_API_TMC6460_RTMI_SUPPORT
 bool tmc6460_processRTMI(uint16_t icID, uint32_t packetLimit);
+
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+void tmc6460_initRTMIRingBuffer(TMC6460RTMIRingBuffer *ring, const uint8_t *buffer, size_t size);
+
+// Parses the RTMI datagrams in [ring] from its read index up to [writeIndex]
+// (the position the next received byte will be written to) without copying them
+// through tmc6460_readWriteUART(). Bytes that do not start a valid RTMI datagram
+// are skipped until the next RTMI header. An incomplete datagram at the end is
+// left in the buffer for the next call.
+// The samples are collected in [batch] and handed to tmc6460_RTMIBatchCallback().
+// Returns the amount of samples delivered.
+uint32_t tmc6460_processRTMIBuffer(uint16_t icID, TMC6460RTMIRingBuffer *ring, size_t writeIndex, TMC6460RTMIBatch *batch);
+#endif
+
+#if TMC_API_TMC6460_RTMI_RECORDER_SUPPORT
+// The recorder sorts RTMI samples by their RTMI index into one single producer/
+// single consumer ring buffer per index. The producer (e.g. the UART interrupt
+// or tmc6460_RTMIDataCallback()) records the samples, consumers on another thread
+// read the records of each index without blocking the producer.
+// Every [decimation] samples of an index form one record. If the ring buffer of
+// an index is full, new records are dropped and counted in its overflows.
+
+// Initializes all indices without decimation and aggregation
+void tmc6460_initRTMIRecorder(TMC6460RTMIRecorder *recorder);
+// Must not run concurrently with the producer. [decimation] 0 is treated as 1.
+void tmc6460_configureRTMIChannel(TMC6460RTMIRecorder *recorder, uint8_t rtmi_index, uint16_t decimation, bool aggregate, bool isSigned);
+
+// Producer side
+void tmc6460_recordRTMISample(TMC6460RTMIRecorder *recorder, uint8_t status, uint32_t value);
+#if TMC_API_TMC6460_RTMI_BUFFER_SUPPORT
+void tmc6460_recordRTMIBatch(TMC6460RTMIRecorder *recorder, const TMC6460RTMIBatch *batch);
+#endif
+
+// Consumer side
+static inline uint32_t tmc6460_getRTMIRecordCount(TMC6460RTMIRecorder *recorder, uint8_t rtmi_index)
+{
+    TMC6460RTMIChannel *channel = &recorder->channels[rtmi_index & (TMC6460_RTMI_CHANNELS - 1)];
+
+    return channel->head - channel->tail;
+}
+
+// Returns false if no record of [rtmi_index] is available
+static inline bool tmc6460_readRTMIRecord(TMC6460RTMIRecorder *recorder, uint8_t rtmi_index, TMC6460RTMIRecord *record)
+{
+    TMC6460RTMIChannel *channel = &recorder->channels[rtmi_index & (TMC6460_RTMI_CHANNELS - 1)];
+    uint32_t tail = channel->tail;
+
+    if (channel->head == tail)
+        return false;
+
+    TMC6460_RTMI_MEMORY_BARRIER();
+    *record = channel->records[tail & (TMC6460_RTMI_RECORDER_LENGTH - 1)];
+    TMC6460_RTMI_MEMORY_BARRIER();
+    channel->tail = tail + 1;
+
+    return true;
+}
+#endif
 #endif
 
 static inline uint32_t tmc6460_extractField(uint32_t registerValue, TMC6460RegisterField field)
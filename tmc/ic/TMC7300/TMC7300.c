@@ -46,6 +46,8 @@ static inline bool tmc7300_cache(uint16_t icID, TMC7300CacheOp operation, uint8_
 
 uint8_t tmc7300_dirtyBits[TMC7300_IC_CACHE_COUNT][TMC7300_REGISTER_COUNT/8]= {0};
 int32_t tmc7300_shadowRegister[TMC7300_IC_CACHE_COUNT][TMC7300_REGISTER_COUNT];
+uint8_t tmc7300_validBits[TMC7300_IC_CACHE_COUNT][TMC7300_REGISTER_COUNT/8] = {0};
+uint8_t tmc7300_readThroughBits[TMC7300_IC_CACHE_COUNT][TMC7300_REGISTER_COUNT/8] = {0};
 
 void tmc7300_setDirtyBit(uint16_t icID, uint8_t index, bool value)
 {
@@ -67,6 +69,75 @@ bool tmc7300_getDirtyBit(uint16_t icID, uint8_t index)
     uint8_t shift = (index % 8);
     return ((*tmp) >> shift) & 1;
 }
+
+static void setCacheBit(uint8_t *bits, uint8_t index, bool value)
+{
+    if(index >= TMC7300_REGISTER_COUNT)
+        return;
+
+    uint8_t mask = 1 << (index % 8);
+    bits[index / 8] = value ? (bits[index / 8] | mask) : (bits[index / 8] & ~mask);
+}
+
+static bool getCacheBit(uint8_t *bits, uint8_t index)
+{
+    if(index >= TMC7300_REGISTER_COUNT)
+        return false;
+
+    return (bits[index / 8] >> (index % 8)) & 1;
+}
+
+static bool isReadThroughCapable(uint8_t address)
+{
+    static const uint8_t capableRegisters[] = TMC7300_READ_THROUGH_CAPABLE_REGISTERS;
+
+    for (size_t i = 0; i < ARRAY_SIZE(capableRegisters); i++)
+    {
+        if (capableRegisters[i] == address)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * Sets the cache policy of a readable register. With read-through enabled, reads are served from the
+ * shadow copy once it holds a valid value (after the first read from or write to the chip).
+ * Only the configuration registers listed in TMC7300_READ_THROUGH_CAPABLE_REGISTERS support this.
+ */
+bool tmc7300_setCacheReadThrough(uint16_t icID, uint8_t address, bool enable)
+{
+    if (icID >= TMC7300_IC_CACHE_COUNT || address >= TMC7300_REGISTER_COUNT)
+        return false;
+
+    if (enable && !isReadThroughCapable(address))
+        return false;
+
+    setCacheBit(tmc7300_readThroughBits[icID], address, enable);
+    setCacheBit(tmc7300_validBits[icID], address, false);
+    return true;
+}
+
+bool tmc7300_getCacheReadThrough(uint16_t icID, uint8_t address)
+{
+    if (icID >= TMC7300_IC_CACHE_COUNT)
+        return false;
+
+    return getCacheBit(tmc7300_readThroughBits[icID], address);
+}
+
+/*
+ * Marks the shadow copies of all read-through registers as invalid,
+ * so they are read from the chip again on the next access.
+ */
+void tmc7300_invalidateCache(uint16_t icID)
+{
+    if (icID >= TMC7300_IC_CACHE_COUNT)
+        return;
+
+    for (size_t i = 0; i < TMC7300_REGISTER_COUNT/8; i++)
+        tmc7300_validBits[icID][i] = 0;
+}
 /*
  * This function is used to cache the value written to the Write-Only registers in the form of shadow array.
  * The shadow copy is then used to read these kinds of registers.
@@ -82,9 +153,10 @@ bool tmc7300_cache(uint16_t icID, TMC7300CacheOp operation, uint8_t address, uin
         if (icID >= TMC7300_IC_CACHE_COUNT)
             return false;
 
-        // Only non-readable registers care about caching
-        // Note: This could also be used to cache i.e. RW config registers to reduce bus accesses
-        if (TMC7300_IS_READABLE(tmc7300_registerAccess[address]))
+        // Non-readable registers are always served from the cache. Readable registers only
+        // if they use the read-through policy and their shadow copy holds a valid value.
+        if (TMC7300_IS_READABLE(tmc7300_registerAccess[address])
+            && !(getCacheBit(tmc7300_readThroughBits[icID], address) && getCacheBit(tmc7300_validBits[icID], address)))
             return false;
 
         // Grab the value from the cache
@@ -105,15 +177,45 @@ bool tmc7300_cache(uint16_t icID, TMC7300CacheOp operation, uint8_t address, uin
         if (operation == TMC7300_CACHE_WRITE)
         {
             tmc7300_setDirtyBit(icID, address, true);
+
+            // Writing a read-through register makes its shadow copy valid
+            if (getCacheBit(tmc7300_readThroughBits[icID], address))
+                setCacheBit(tmc7300_validBits[icID], address, true);
         }
 
         return true;
     }
+    else if (operation == TMC7300_CACHE_FILL_READ)
+    {
+        // Store values read from the chip for read-through registers
+
+        // only supported chips have a cache
+        if (icID >= TMC7300_IC_CACHE_COUNT)
+            return false;
+
+        if (!getCacheBit(tmc7300_readThroughBits[icID], address))
+            return false;
+
+        tmc7300_shadowRegister[icID][address] = *value;
+        setCacheBit(tmc7300_validBits[icID], address, true);
+        return true;
+    }
     return false;
 }
 
 void tmc7300_initCache()
 {
+#if TMC7300_CACHE_READ_THROUGH == 1
+    // Apply the default read-through policy
+    static const uint8_t readThroughRegisters[] = TMC7300_CACHE_READ_THROUGH_REGISTERS;
+
+    for (size_t id = 0; id < TMC7300_IC_CACHE_COUNT; id++)
+    {
+        for (size_t k = 0; k < ARRAY_SIZE(readThroughRegisters); k++)
+            tmc7300_setCacheReadThrough(id, readThroughRegisters[k], true);
+    }
+#endif
+
     // Check if we have constants defined
     if(ARRAY_SIZE(tmc7300_RegisterConstants) == 0)
         return;
@@ -161,6 +263,67 @@ static int32_t readRegisterUART(uint16_t icID, uint8_t registerAddress);
 static void writeRegisterUART(uint16_t icID, uint8_t registerAddress, int32_t value );
 static uint8_t CRC8(uint8_t *data, uint32_t bytes);
 
+/************************************************************** Bus statistics ******************************************************************/
+#if TMC7300_BUS_STATISTICS == 1
+static TMC_BusStatistics busStatistics[TMC7300_BUS_STATISTICS_COUNT];
+
+TMC_BusStatistics *tmc7300_getBusStatistics(uint16_t icID)
+{
+    if (icID >= TMC7300_BUS_STATISTICS_COUNT)
+        return NULL;
+
+    return &busStatistics[icID];
+}
+
+static bool readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength)
+{
+    TMC_BusStatistics *statistics = tmc7300_getBusStatistics(icID);
+
+    if (!statistics)
+        return tmc7300_readWriteUART(icID, data, writeLength, readLength);
+
+    uint8_t address = data[2];
+    uint32_t startTime = tmc_bus_statistics_getTime();
+
+    bool success = tmc7300_readWriteUART(icID, data, writeLength, readLength);
+
+    tmc_bus_statistics_recordTransfer(statistics, tmc_bus_statistics_getTime() - startTime);
+    tmc_bus_statistics_recordDatagram(statistics, address, writeLength, success ? readLength : 0);
+
+    if (!success)
+        tmc_bus_statistics_recordReplyError(statistics);
+
+    return success;
+}
+
+static void recordCache(uint16_t icID, uint8_t address, bool hit)
+{
+    TMC_BusStatistics *statistics = tmc7300_getBusStatistics(icID);
+
+    if (statistics)
+        tmc_bus_statistics_recordCache(statistics, address, hit);
+}
+
+static void recordReplyError(uint16_t icID, bool crcError)
+{
+    TMC_BusStatistics *statistics = tmc7300_getBusStatistics(icID);
+
+    if (!statistics)
+        return;
+
+    if (crcError)
+        tmc_bus_statistics_recordCRCError(statistics);
+    else
+        tmc_bus_statistics_recordReplyError(statistics);
+}
+#else
+// Statistics disabled: Call the callbacks directly
+#define readWriteUART        tmc7300_readWriteUART
+#define recordCache(icID, address, hit)
+#define recordReplyError(icID, crcError)
+#endif
+/*************************************************************************************************************************************************/
+
 int32_t tmc7300_readRegister(uint16_t icID, uint8_t address)
 {
     return readRegisterUART(icID, address);
@@ -177,8 +340,11 @@ int32_t readRegisterUART(uint16_t icID, uint8_t registerAddress)
 {
     uint32_t value;
 
-    // Read from cache for registers with write-only access
-    if (tmc7300_cache(icID, TMC7300_CACHE_READ, registerAddress, &value))
+    // Read from cache for write-only registers and valid read-through registers
+    bool cacheHit = tmc7300_cache(icID, TMC7300_CACHE_READ, registerAddress, &value);
+    recordCache(icID, registerAddress, cacheHit);
+
+    if (cacheHit)
         return value;
 
     uint8_t data[8] = { 0 };
@@ -189,26 +355,31 @@ int32_t readRegisterUART(uint16_t icID, uint8_t registerAddress)
     data[2] = registerAddress;
     data[3] = CRC8(data, 3);
 
-    if (!tmc7300_readWriteUART(icID, &data[0], 4, 8))
+    if (!readWriteUART(icID, &data[0], 4, 8))
         return tmc7300_shadowRegister[0][registerAddress];
 
     // Byte 0: Sync nibble correct?
-    if (data[0] != 0x05)
-        return 0;
-
     // Byte 1: Master address correct?
-    if (data[1] != 0xFF)
-        return 0;
-
     // Byte 2: Address correct?
-    if (data[2] != registerAddress)
+    if (data[0] != 0x05 || data[1] != 0xFF || data[2] != registerAddress)
+    {
+        recordReplyError(icID, false);
         return 0;
+    }
 
     // Byte 7: CRC correct?
     if (data[7] != CRC8(data, 7))
+    {
+        recordReplyError(icID, true);
         return 0;
+    }
 
-    return ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+    uint32_t result = ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+
+    // Keep the shadow copy of read-through registers up to date
+    tmc7300_cache(icID, TMC7300_CACHE_FILL_READ, registerAddress, &result);
+
+    return result;
 }
 
 void writeRegisterUART(uint16_t icID, uint8_t registerAddress, int32_t value )
@@ -224,7 +395,7 @@ void writeRegisterUART(uint16_t icID, uint8_t registerAddress, int32_t value )
     data[6] = (value      ) & 0xFF;
     data[7] = CRC8(data, 7);
 
-    tmc7300_readWriteUART(icID, &data[0], 8, 0);
+    readWriteUART(icID, &data[0], 8, 0);
 
 
     // Write to the shadow register and mark the register dirty
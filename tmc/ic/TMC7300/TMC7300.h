@@ -39,6 +39,37 @@
 //#define TMC7300_ENABLE_TMC_CACHE   0
 #endif
 
+// To serve reads of stable read/write configuration registers from the cache, set TMC7300_CACHE_READ_THROUGH to '1'.
+// The registers listed in TMC7300_CACHE_READ_THROUGH_REGISTERS are then read from the chip once (or written)
+// and afterwards read from their shadow copies. The policy is applied by tmc7300_initCache() and can
+// also be changed per register at runtime with tmc7300_setCacheReadThrough().
+// Call tmc7300_invalidateCache() if the chip might have lost its configuration (e.g. after a reset).
+#ifndef TMC7300_CACHE_READ_THROUGH
+#define TMC7300_CACHE_READ_THROUGH   0
+//#define TMC7300_CACHE_READ_THROUGH   1
+#endif
+
+#ifndef TMC7300_CACHE_READ_THROUGH_REGISTERS
+#define TMC7300_CACHE_READ_THROUGH_REGISTERS   { TMC7300_GCONF, TMC7300_CHOPCONF, TMC7300_PWMCONF }
+#endif
+
+// To record bus transaction statistics (transfers, bytes, cache hits/misses, CRC errors and
+// latency histograms per register) set TMC7300_BUS_STATISTICS to '1'. The statistics are kept for
+// the first TMC7300_BUS_STATISTICS_COUNT ICs, see tmc/helpers/BusStatistics.h. The application
+// has to implement tmc_bus_statistics_getTime() and link tmc/helpers/BusStatistics.c.
+#ifndef TMC7300_BUS_STATISTICS
+#define TMC7300_BUS_STATISTICS   0
+//#define TMC7300_BUS_STATISTICS   1
+#endif
+
+#ifndef TMC7300_BUS_STATISTICS_COUNT
+#define TMC7300_BUS_STATISTICS_COUNT   1
+#endif
+
+#if TMC7300_BUS_STATISTICS == 1
+#include "tmc/helpers/BusStatistics.h"
+#endif
+
 /******************************************************************************/
 
 
@@ -52,6 +83,11 @@ extern uint8_t tmc7300_getNodeAddress(uint16_t icID);
 int32_t tmc7300_readRegister(uint16_t icID, uint8_t address);
 void tmc7300_writeRegister(uint16_t icID, uint8_t address, int32_t value);
 
+#if TMC7300_BUS_STATISTICS == 1
+// Returns the bus statistics of [icID] or NULL if [icID] >= TMC7300_BUS_STATISTICS_COUNT
+TMC_BusStatistics *tmc7300_getBusStatistics(uint16_t icID);
+#endif
+
 typedef struct
 {
     uint32_t mask;
@@ -95,6 +131,56 @@ static inline void tmc7300_fieldWrite(uint16_t icID, RegisterField field, uint32
 
     tmc7300_writeRegister(icID, field.address, regValue);
 }
+
+// Coalesced field updates: Several fields of one register are changed with a single write.
+// The register value is taken from the cache if possible (write-only registers or valid
+// read-through registers), otherwise it is read from the chip once in tmc7300_fieldBegin().
+// Example:
+//     TMC7300FieldUpdate update = tmc7300_fieldBegin(icID, field1.address);
+//     tmc7300_fieldSet(&update, field1, value1);
+//     tmc7300_fieldSet(&update, field2, value2);
+//     tmc7300_fieldCommit(&update);
+typedef struct
+{
+    uint16_t icID;
+    uint8_t address;
+    bool modified;
+    uint32_t value;
+} TMC7300FieldUpdate;
+
+static inline TMC7300FieldUpdate tmc7300_fieldBegin(uint16_t icID, uint8_t address)
+{
+    TMC7300FieldUpdate update;
+
+    update.icID     = icID;
+    update.address  = address;
+    update.modified = false;
+    update.value    = tmc7300_readRegister(icID, address);
+
+    return update;
+}
+
+// Returns false if the field belongs to a different register than the one passed to tmc7300_fieldBegin()
+static inline bool tmc7300_fieldSet(TMC7300FieldUpdate *update, RegisterField field, uint32_t value)
+{
+    if (field.address != update->address)
+        return false;
+
+    update->value    = tmc7300_fieldUpdate(update->value, field, value);
+    update->modified = true;
+
+    return true;
+}
+
+// Writes the register if any field has been set
+static inline void tmc7300_fieldCommit(TMC7300FieldUpdate *update)
+{
+    if (!update->modified)
+        return;
+
+    tmc7300_writeRegister(update->icID, update->address, update->value);
+    update->modified = false;
+}
 /**************************************************************** Cache Implementation *************************************************************************/
 #if TMC7300_CACHE == 1
 #ifdef TMC7300_ENABLE_TMC_CACHE
@@ -111,6 +197,11 @@ static inline void tmc7300_fieldWrite(uint16_t icID, RegisterField field, uint32
 #define TMC7300_IS_READABLE(x)     ((x) & TMC7300_ACCESS_READ)
 #define ARRAY_SIZE(x)             (sizeof(x)/sizeof(x[0]))
 
+// Registers that may use the read-through cache policy: configuration registers that are only
+// changed by the application, not values the chip updates itself.
+#define TMC7300_READ_THROUGH_CAPABLE_REGISTERS { \
+    TMC7300_GCONF, TMC7300_CHOPCONF, TMC7300_PWMCONF }
+
 typedef enum {
     TMC7300_CACHE_READ,
     TMC7300_CACHE_WRITE,
@@ -119,6 +210,10 @@ typedef enum {
     // from write-only registers that have a value inside them on reset. When using this
     // operation, a restore will *not* rewrite that filled register!
     TMC7300_CACHE_FILL_DEFAULT,
+
+    // Special operation: Put a value read from the chip into the cache without marking the
+    // entry as dirty. Only stored for registers using the read-through policy.
+    TMC7300_CACHE_FILL_READ
 } TMC7300CacheOp;
 
 typedef struct{
@@ -192,6 +287,11 @@ static const TMC7300RegisterConstants tmc7300_RegisterConstants[] =
 
 extern uint8_t tmc7300_dirtyBits[TMC7300_IC_CACHE_COUNT][TMC7300_REGISTER_COUNT/8];
 extern int32_t tmc7300_shadowRegister[TMC7300_IC_CACHE_COUNT][TMC7300_REGISTER_COUNT];
+extern uint8_t tmc7300_validBits[TMC7300_IC_CACHE_COUNT][TMC7300_REGISTER_COUNT/8];
+extern uint8_t tmc7300_readThroughBits[TMC7300_IC_CACHE_COUNT][TMC7300_REGISTER_COUNT/8];
+bool tmc7300_setCacheReadThrough(uint16_t icID, uint8_t address, bool enable);
+bool tmc7300_getCacheReadThrough(uint16_t icID, uint8_t address);
+void tmc7300_invalidateCache(uint16_t icID);
 bool tmc7300_cache(uint16_t icID, TMC7300CacheOp operation, uint8_t address, uint32_t *value);
 void tmc7300_initCache(void);
 void tmc7300_setDirtyBit(uint16_t icID, uint8_t index, bool value);
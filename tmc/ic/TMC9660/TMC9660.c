@@ -4,6 +4,7 @@
 
 
 #include "TMC9660.h"
+#include "TMC9660_PARAM_HW_Abstraction.h"
 
 // ToDo: Make the timing function & callback usable with multiple TMC-API chips in use.
 void tmc_delayMicroseconds(uint32_t microseconds)
@@ -46,6 +47,20 @@ static int32_t tmc9660_reg_sendCommand_UART(uint16_t icID, uint8_t cmd, uint16_t
 
 static uint8_t calcParamChecksum(uint8_t *data, uint32_t bytes);
 static uint8_t CRC8(uint8_t *data, uint32_t bytes);
+static void buildBlRequest(uint8_t *data, TMC9660BusAddresses addresses, uint8_t cmd, uint32_t writeValue);
+static void waitForRequestSlot(uint16_t icID, bool probe);
+static void updatePacing(uint16_t icID, bool replyValid, bool probe);
+
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+static int32_t tmc9660_bl_sendCommand_SPI(uint16_t icID, uint8_t cmd, uint32_t writeValue, uint32_t *readValue);
+static size_t transferBlockSPI(uint16_t icID, uint8_t cmd, const uint32_t *writeWords, uint32_t *readWords, size_t count, uint32_t *checksum, int32_t *status);
+static int32_t tmc9660_param_sendCommand_SPI(uint16_t icID, uint8_t cmd, uint16_t type, uint8_t index, uint32_t writeValue, uint32_t *readValue);
+static int32_t tmc9660_param_getVersionASCII_SPI(uint16_t icID, uint8_t *versionString);
+static int32_t tmc9660_param_readTMCLMemory_SPI(uint16_t icID, uint32_t cmdIndex, uint8_t *command);
+static int32_t tmc9660_param_returnToBootloader_SPI(uint16_t icID);
+static int32_t tmc9660_reg_sendCommand_SPI(uint16_t icID, uint8_t cmd, uint16_t registerOffset, uint8_t registerBlock, uint32_t writeValue, uint32_t *readValue);
+static size_t sendParamBatchSPI(uint16_t icID, TMC9660ParamRequest *requests, size_t count);
+#endif
 
 /*** General functions implementation ********************************************/
 #if TMC_API_TMC9660_FAULT_PIN_SUPPORTED != 0
@@ -64,7 +79,9 @@ int32_t tmc9660_bl_sendCommand(uint16_t icID, uint8_t cmd, uint32_t writeValue,
 
     if(bus == TMC9660_BUS_SPI)
     {
-        // ToDo: SPI support
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+        return tmc9660_bl_sendCommand_SPI(icID, cmd, writeValue, readValue);
+#endif
     }
     else if(bus == TMC9660_BUS_UART)
     {
@@ -79,6 +96,32 @@ static int32_t tmc9660_bl_sendCommand_UART(uint16_t icID, uint8_t cmd, uint32_t
     uint8_t data[8] = { 0 };
     TMC9660BusAddresses addresses = tmc9660_getBusAddresses(icID);
 
+    buildBlRequest(data, addresses, cmd, writeValue);
+
+    // Workaround: Leave the bootloader a short moment between a reply and the next request
+    waitForRequestSlot(icID, false);
+
+    if (!tmc9660_readWriteUART(icID, &data[0], 8, 8)) {
+      updatePacing(icID, false, false);
+      return -1;
+    }
+
+    bool replyValid = data[7] == CRC8(data, 7);
+    updatePacing(icID, replyValid, false);
+
+    if (!replyValid)
+        return -5;
+
+    if (readValue)
+    {
+        *readValue = ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | ((uint32_t)data[5] << 8) | data[6];
+    }
+
+    return data[2];
+}
+
+static void buildBlRequest(uint8_t *data, TMC9660BusAddresses addresses, uint8_t cmd, uint32_t writeValue)
+{
     data[0] = 0x55;       // Sync byte
     data[1] = 0x01 | (addresses.device); // Device Address
     data[2] = cmd;  // Command
@@ -87,20 +130,364 @@ static int32_t tmc9660_bl_sendCommand_UART(uint16_t icID, uint8_t cmd, uint32_t
     data[5] = (writeValue >> 8 ) & 0xFF;
     data[6] = (writeValue      ) & 0xFF;
     data[7] = CRC8(data, 7);
+}
 
-    if (!tmc9660_readWriteUART(icID, &data[0], 8, 8)) {
-      return -1;
+/*** Bootloader pacing ***********************************************************/
+
+typedef struct
+{
+    bool initialized;
+    uint32_t lastReplyTime;
+    uint32_t gap;        // µs between a reply and the next request
+    uint32_t minGap;     // Lower bound of the gap while probing, learned from failed requests
+    uint32_t successes;  // Valid replies since the lower bound has last been changed
+} TMC9660BlPacing;
+
+static TMC9660BlPacing blPacing[TMC9660_BL_PACING_IC_COUNT];
+
+static TMC9660BlPacing *getPacing(uint16_t icID)
+{
+    if (icID >= TMC9660_BL_PACING_IC_COUNT)
+        return NULL;
+
+    TMC9660BlPacing *pacing = &blPacing[icID];
+
+    if (!pacing->initialized)
+    {
+        pacing->initialized   = true;
+        pacing->lastReplyTime = tmc_getMicrosecondTimestamp() - TMC9660_BL_PACING_GAP_DEFAULT;
+        pacing->gap           = TMC9660_BL_PACING_GAP_DEFAULT;
+        pacing->minGap        = TMC9660_BL_PACING_GAP_MIN;
+        pacing->successes     = 0;
+    }
+
+    return pacing;
+}
+
+void tmc9660_bl_resetPacing(uint16_t icID)
+{
+    if (icID < TMC9660_BL_PACING_IC_COUNT)
+        blPacing[icID].initialized = false;
+}
+
+// Waits until the gap after the last reply has passed. Time spent by the
+// application since the last reply counts towards the gap.
+// Without [probe], the gap is at least TMC9660_BL_PACING_GAP_DEFAULT.
+static void waitForRequestSlot(uint16_t icID, bool probe)
+{
+    TMC9660BlPacing *pacing = getPacing(icID);
+
+    if (!pacing)
+        return;
+
+    uint32_t gap = (probe || pacing->gap > TMC9660_BL_PACING_GAP_DEFAULT)? pacing->gap : TMC9660_BL_PACING_GAP_DEFAULT;
+
+    while (tmc_getMicrosecondTimestamp() - pacing->lastReplyTime < gap);
+}
+
+// [probe] may only be set for requests that are retried after a failure (bulk transfers),
+// only those shrink the gap below TMC9660_BL_PACING_GAP_DEFAULT.
+static void updatePacing(uint16_t icID, bool replyValid, bool probe)
+{
+    TMC9660BlPacing *pacing = getPacing(icID);
+
+    if (!pacing)
+    {
+        // No pacing state: Fixed delay after each reply
+        tmc_delayMicroseconds(TMC9660_BL_PACING_GAP_DEFAULT);
+        return;
     }
 
+    pacing->lastReplyTime = tmc_getMicrosecondTimestamp();
+
+    if (replyValid)
+    {
+        uint32_t minGap = pacing->minGap;
+
+        if (probe)
+        {
+            // Probe for a smaller lower bound after a long run of valid replies,
+            // so single failures caused by line noise do not slow down the rest of the transfer
+            if (++pacing->successes >= 256)
+            {
+                pacing->minGap   -= pacing->minGap / 8;
+                pacing->minGap    = (pacing->minGap > TMC9660_BL_PACING_GAP_MIN)? pacing->minGap : TMC9660_BL_PACING_GAP_MIN;
+                pacing->successes = 0;
+            }
+
+            minGap = pacing->minGap;
+        }
+        else if (minGap < TMC9660_BL_PACING_GAP_DEFAULT)
+        {
+            minGap = TMC9660_BL_PACING_GAP_DEFAULT;
+        }
+
+        // Shrink the gap by 1/8, but not below the lower bound
+        uint32_t gap = pacing->gap - (pacing->gap + 7) / 8;
+        pacing->gap = (gap > minGap)? gap : minGap;
+    }
+    else
+    {
+        // Raise the lower bound above the failed gap and back off
+        uint32_t minGap = pacing->gap + pacing->gap / 4 + 1;
+
+        pacing->minGap    = (minGap < TMC9660_BL_PACING_GAP_MAX)? minGap : TMC9660_BL_PACING_GAP_MAX;
+        pacing->gap       = (pacing->gap * 2 > pacing->minGap)? pacing->gap * 2 : pacing->minGap;
+        pacing->gap       = (pacing->gap < TMC9660_BL_PACING_GAP_MAX)? pacing->gap : TMC9660_BL_PACING_GAP_MAX;
+        pacing->successes = 0;
+    }
+}
+
+/*** Bootloader bulk memory access ***********************************************/
+
+// Reply status of successful bootloader commands
+#define TMC9660_BL_STATUS_OK  0
+
+uint32_t tmc9660_bl_updateChecksum(uint32_t checksum, uint32_t word)
+{
+    return ((checksum << 1) | (checksum >> 31)) + word;
+}
+
+// Sends a single bootloader command and checks its reply. Returns a TMC9660BlTransferStatus.
+static int32_t sendBlCommandChecked(uint16_t icID, uint8_t cmd, uint32_t writeValue, uint32_t *readValue)
+{
+    uint8_t data[8];
+
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+    if (tmc9660_getBusType(icID) == TMC9660_BUS_SPI)
+    {
+        // SPI datagrams are not protected by a checksum, only the status can be checked
+        if (tmc9660_bl_sendCommand_SPI(icID, cmd, writeValue, readValue) != TMC9660_BL_STATUS_OK)
+            return TMC9660_BLTRANSFER_COMMAND_ERROR;
+
+        return TMC9660_BLTRANSFER_OK;
+    }
+#endif
+
+    buildBlRequest(data, tmc9660_getBusAddresses(icID), cmd, writeValue);
+
+    waitForRequestSlot(icID, false);
+    bool replyValid = tmc9660_readWriteUART(icID, &data[0], 8, 8) && data[7] == CRC8(data, 7);
+    updatePacing(icID, replyValid, false);
+
+    if (!replyValid)
+        return TMC9660_BLTRANSFER_BUS_ERROR;
+
+    if (data[2] != TMC9660_BL_STATUS_OK)
+        return TMC9660_BLTRANSFER_COMMAND_ERROR;
+
     if (readValue)
     {
         *readValue = ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | ((uint32_t)data[5] << 8) | data[6];
     }
 
-    // Workaround: Wait a short moment before proceeding
-    tmc_delayMicroseconds(10);
+    return TMC9660_BLTRANSFER_OK;
+}
+
+// Sends up to TMC9660_UART_STREAM_SIZE requests of [cmd] with the values of [writeWords] (or 0 if NULL).
+// The reply values are stored in [readWords] (if not NULL). Returns the amount of requests that have
+// been replied successfully before the first failed one, the reason of the failure is stored in [status].
+static size_t transferBlock(uint16_t icID, uint8_t cmd, const uint32_t *writeWords, uint32_t *readWords, size_t count, uint32_t *checksum, int32_t *status)
+{
+    uint8_t data[TMC9660_UART_STREAM_SIZE * 8];
+    TMC9660BusAddresses addresses = tmc9660_getBusAddresses(icID);
+    size_t received = 0;
 
-    return data[2];
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+    if (tmc9660_getBusType(icID) == TMC9660_BUS_SPI)
+        return transferBlockSPI(icID, cmd, writeWords, readWords, count, checksum, status);
+#endif
+
+    for (size_t i = 0; i < count; i++)
+    {
+        buildBlRequest(&data[i * 8], addresses, cmd, (writeWords)? writeWords[i] : 0);
+    }
+
+#if TMC9660_UART_STREAM_SUPPORT == 1
+    // Send the whole block at once, the pacing only applies between blocks
+    waitForRequestSlot(icID, true);
+    received = tmc9660_readWriteUARTStream(icID, &data[0], 8, count);
+#else
+    for (; received < count; received++)
+    {
+        uint8_t *datagram = &data[received * 8];
+
+        waitForRequestSlot(icID, true);
+
+        if (!tmc9660_readWriteUART(icID, datagram, 8, 8))
+        {
+            updatePacing(icID, false, true);
+            break;
+        }
+
+        bool replyValid = datagram[7] == CRC8(datagram, 7);
+        updatePacing(icID, replyValid, true);
+
+        if (!replyValid)
+        {
+            // Checked again below, stop sending the remaining requests
+            received++;
+            break;
+        }
+    }
+#endif
+
+    *status = TMC9660_BLTRANSFER_OK;
+
+    size_t i;
+    for (i = 0; i < received; i++)
+    {
+        uint8_t *reply = &data[i * 8];
+
+        if (reply[7] != CRC8(reply, 7))
+        {
+            *status = TMC9660_BLTRANSFER_BUS_ERROR;
+            break;
+        }
+
+        if (reply[2] != TMC9660_BL_STATUS_OK)
+        {
+            *status = TMC9660_BLTRANSFER_COMMAND_ERROR;
+            break;
+        }
+
+        uint32_t value = ((uint32_t)reply[3] << 24) | ((uint32_t)reply[4] << 16) | ((uint32_t)reply[5] << 8) | reply[6];
+
+        if (readWords)
+            readWords[i] = value;
+
+        if (checksum)
+            *checksum = tmc9660_bl_updateChecksum(*checksum, (writeWords)? writeWords[i] : value);
+    }
+
+    if (i == received && received < count)
+        *status = TMC9660_BLTRANSFER_BUS_ERROR;
+
+#if TMC9660_UART_STREAM_SUPPORT == 1
+    updatePacing(icID, *status != TMC9660_BLTRANSFER_BUS_ERROR, true);
+#endif
+
+    return i;
+}
+
+static int32_t bulkTransfer(uint16_t icID, uint8_t bank, uint32_t address, uint8_t cmd, const uint32_t *writeWords, uint32_t *readWords, size_t count, uint32_t *checksum)
+{
+    TMC9660BusType bus = tmc9660_getBusType(icID);
+
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+    if (bus != TMC9660_BUS_UART && bus != TMC9660_BUS_SPI)
+        return TMC9660_BLTRANSFER_BUS_ERROR;
+#else
+    if (bus != TMC9660_BUS_UART)
+        return TMC9660_BLTRANSFER_BUS_ERROR;
+#endif
+
+    size_t done = 0;
+    uint32_t retries = 0;
+    bool addressSet = false;
+
+    while (done < count)
+    {
+        int32_t status = TMC9660_BLTRANSFER_OK;
+
+        if (!addressSet)
+        {
+            // (Re)start the auto-increment at the next word
+            status = sendBlCommandChecked(icID, TMC9660_BLCMD_SET_BANK, bank, NULL);
+
+            if (status == TMC9660_BLTRANSFER_OK)
+                status = sendBlCommandChecked(icID, TMC9660_BLCMD_SET_ADDRESS, address + 4 * done, NULL);
+
+            addressSet = (status == TMC9660_BLTRANSFER_OK);
+        }
+
+        if (addressSet)
+        {
+            size_t blockSize = (count - done < TMC9660_UART_STREAM_SIZE)? count - done : TMC9660_UART_STREAM_SIZE;
+
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+            // SPI blocks need no buffer, pipeline all remaining words
+            if (bus == TMC9660_BUS_SPI)
+                blockSize = count - done;
+#endif
+
+            size_t transferred = transferBlock(icID, cmd, (writeWords)? &writeWords[done] : NULL, (readWords)? &readWords[done] : NULL, blockSize, checksum, &status);
+
+            // Only failures without any progress in between count as retries
+            if (transferred > 0)
+                retries = 0;
+
+            done += transferred;
+        }
+
+        if (status == TMC9660_BLTRANSFER_COMMAND_ERROR)
+            return status;
+
+        if (status == TMC9660_BLTRANSFER_BUS_ERROR)
+        {
+            if (retries++ >= TMC9660_BL_RETRIES)
+                return status;
+
+            // The address counter of the chip is unknown after a lost reply
+            addressSet = false;
+        }
+    }
+
+    return TMC9660_BLTRANSFER_OK;
+}
+
+int32_t tmc9660_bl_writeMemory(uint16_t icID, uint8_t bank, uint32_t address, const uint32_t *words, size_t count, uint32_t *checksum)
+{
+    return bulkTransfer(icID, bank, address, TMC9660_BLCMD_WRITE_32_INC, words, NULL, count, checksum);
+}
+
+int32_t tmc9660_bl_readMemory(uint16_t icID, uint8_t bank, uint32_t address, uint32_t *words, size_t count, uint32_t *checksum)
+{
+    return bulkTransfer(icID, bank, address, TMC9660_BLCMD_READ_32_INC, NULL, words, count, checksum);
+}
+
+int32_t tmc9660_bl_verifyMemory(uint16_t icID, uint8_t bank, uint32_t address, size_t count, uint32_t checksum)
+{
+    uint32_t readChecksum = 0;
+    int32_t status = bulkTransfer(icID, bank, address, TMC9660_BLCMD_READ_32_INC, NULL, NULL, count, &readChecksum);
+
+    if (status != TMC9660_BLTRANSFER_OK)
+        return status;
+
+    return (readChecksum == checksum)? TMC9660_BLTRANSFER_OK : TMC9660_BLTRANSFER_VERIFY_ERROR;
+}
+
+int32_t tmc9660_bl_waitWhileBusy(uint16_t icID, uint32_t timeout)
+{
+    uint32_t startTime = tmc_getMicrosecondTimestamp();
+
+    while (true)
+    {
+        uint32_t busy = 0;
+        int32_t status = sendBlCommandChecked(icID, TMC9660_BLCMD_MEM_IS_BUSY, 0, &busy);
+
+        if (status != TMC9660_BLTRANSFER_OK)
+            return status;
+
+        if (!busy)
+            return TMC9660_BLTRANSFER_OK;
+
+        if (tmc_getMicrosecondTimestamp() - startTime >= timeout)
+            return TMC9660_BLTRANSFER_TIMEOUT;
+    }
+}
+
+int32_t tmc9660_bl_eraseFlashSector(uint16_t icID, uint8_t bank, uint32_t address, uint32_t timeout)
+{
+    int32_t status = sendBlCommandChecked(icID, TMC9660_BLCMD_SET_BANK, bank, NULL);
+
+    if (status == TMC9660_BLTRANSFER_OK)
+        status = sendBlCommandChecked(icID, TMC9660_BLCMD_FLASH_ERASE_SECTOR, address, NULL);
+
+    if (status != TMC9660_BLTRANSFER_OK)
+        return status;
+
+    return tmc9660_bl_waitWhileBusy(icID, timeout);
 }
 
 static uint8_t CRC8(uint8_t *data, uint32_t bytes)
@@ -129,7 +516,9 @@ int32_t tmc9660_param_sendCommand(uint16_t icID, uint8_t cmd, uint16_t type, uin
 
     if(bus == TMC9660_BUS_SPI)
     {
-        // ToDo: SPI support
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+        return tmc9660_param_sendCommand_SPI(icID, cmd, type, index, writeValue, readValue);
+#endif
     }
     else if(bus == TMC9660_BUS_UART)
     {
@@ -145,7 +534,9 @@ int32_t tmc9660_param_getVersionASCII(uint16_t icID, uint8_t *versionString)
 
     if(bus == TMC9660_BUS_SPI)
     {
-        // ToDo: SPI support
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+        return tmc9660_param_getVersionASCII_SPI(icID, versionString);
+#endif
     }
     else if(bus == TMC9660_BUS_UART)
     {
@@ -161,7 +552,9 @@ int32_t tmc9660_param_readTMCLMemory(uint16_t icID, uint32_t cmdIndex, uint8_t *
 
     if(bus == TMC9660_BUS_SPI)
     {
-        // ToDo: SPI support
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+        return tmc9660_param_readTMCLMemory_SPI(icID, cmdIndex, command);
+#endif
     }
     else if(bus == TMC9660_BUS_UART)
     {
@@ -177,7 +570,9 @@ int32_t tmc9660_param_returnToBootloader(uint16_t icID)
 
     if(bus == TMC9660_BUS_SPI)
     {
-        // ToDo: SPI support
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+        return tmc9660_param_returnToBootloader_SPI(icID);
+#endif
     }
     else if(bus == TMC9660_BUS_UART)
     {
@@ -187,7 +582,7 @@ int32_t tmc9660_param_returnToBootloader(uint16_t icID)
     return -1;
 }
 
-static bool sendRequestUART(uint16_t icID, uint8_t cmd, uint16_t type, uint8_t index, uint32_t writeValue, uint8_t *data, TMC9660BusAddresses addresses, bool expectReply)
+static void buildParamRequest(uint8_t *data, uint8_t cmd, uint16_t type, uint8_t index, uint32_t writeValue, TMC9660BusAddresses addresses)
 {
     // Create the request datagram
     uint8_t syncByte = 0x01 | (addresses.device);
@@ -200,10 +595,75 @@ static bool sendRequestUART(uint16_t icID, uint8_t cmd, uint16_t type, uint8_t i
     data[6] = (writeValue >> 8) & 0xFF;
     data[7] = (writeValue) & 0xFF;
     data[8] = calcParamChecksum(&data[0], 8);
+}
+
+static bool sendRequestUART(uint16_t icID, uint8_t cmd, uint16_t type, uint8_t index, uint32_t writeValue, uint8_t *data, TMC9660BusAddresses addresses, bool expectReply)
+{
+    buildParamRequest(data, cmd, type, index, writeValue, addresses);
 
     return tmc9660_readWriteUART(icID, &data[0], 9, (expectReply)? 9:0);
 }
 
+// Checks the reply to [request] and stores its status and value.
+// Returns true if the reply status is TMC9660_PARAMSTATUS_OK.
+static bool unpackParamReply(TMC9660ParamRequest *request, uint8_t *data, bool replied, TMC9660BusAddresses addresses)
+{
+    uint8_t syncByte = 0x01 | (addresses.device);
+
+    if (!replied)
+        request->status = -2;
+    else if (data[0] != addresses.host)
+        request->status = -3;
+    else if (data[1] != syncByte)
+        request->status = -4;
+    else if (data[8] != calcParamChecksum(&data[0], 8))
+        request->status = -5;
+    else if (data[3] != request->cmd)
+        request->status = -6;
+    else
+        request->status = data[2];
+
+    if (request->status < 0)
+        return false;
+
+    request->value = ((uint32_t)data[4] << 24) | ((uint32_t)data[5] << 16) | ((uint32_t)data[6] << 8) | data[7];
+
+    return request->status == TMC9660_PARAMSTATUS_OK;
+}
+
+// Sends up to TMC9660_UART_STREAM_SIZE requests, see tmc9660_param_sendCommands()
+static size_t sendParamBlockUART(uint16_t icID, TMC9660ParamRequest *requests, size_t count)
+{
+    uint8_t data[TMC9660_UART_STREAM_SIZE * 9];
+    TMC9660BusAddresses addresses = tmc9660_getBusAddresses(icID);
+    size_t successful = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        buildParamRequest(&data[i * 9], requests[i].cmd, requests[i].type, requests[i].index, requests[i].value, addresses);
+    }
+
+#if TMC9660_UART_STREAM_SUPPORT == 1
+    // Keep the whole block in flight, the replies arrive in order
+    size_t received = tmc9660_readWriteUARTStream(icID, &data[0], 9, count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        successful += unpackParamReply(&requests[i], &data[i * 9], i < received, addresses);
+    }
+#else
+    // One round trip per request. A missing reply does not affect the following requests.
+    for (size_t i = 0; i < count; i++)
+    {
+        bool replied = tmc9660_readWriteUART(icID, &data[i * 9], 9, 9);
+
+        successful += unpackParamReply(&requests[i], &data[i * 9], replied, addresses);
+    }
+#endif
+
+    return successful;
+}
+
 static int32_t tmc9660_param_sendCommand_UART(uint16_t icID, uint8_t cmd, uint16_t type, uint8_t index, uint32_t writeValue, uint32_t *readValue)
 {
     uint8_t data[9] = { 0 };
@@ -286,7 +746,9 @@ int32_t tmc9660_reg_sendCommand(uint16_t icID, uint8_t cmd, uint16_t registerOff
 
     if(bus == TMC9660_BUS_SPI)
     {
-        // ToDo: SPI support
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+        return tmc9660_reg_sendCommand_SPI(icID, cmd, registerOffset, registerBlock, writeValue, readValue);
+#endif
     }
     else if(bus == TMC9660_BUS_UART)
     {
@@ -346,6 +808,278 @@ static int32_t tmc9660_reg_sendCommand_UART(uint16_t icID, uint8_t cmd, uint16_t
     return data[2];
 }
 
+/*** SPI implementation ***********************************************************/
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+/*
+ * Each SPI datagram shifts out the reply to the request of the previous datagram.
+ *
+ * Bootloader mode uses 5 byte datagrams without a checksum:
+ *   Request: command, value[31:24], value[23:16], value[15:8], value[7:0]
+ *   Reply:   status,  value[31:24], value[23:16], value[15:8], value[7:0]
+ *
+ * Parameter and register mode use the TMCL datagram without the module address (8 bytes):
+ *   Request: command, type[7:0], type[11:8] << 4 | index,  value[31:24], ..., value[7:0], checksum
+ *   Reply:   ready,   status,    command,                  value[31:24], ..., value[7:0], checksum
+ * Register mode packs the offset and block as offset[7:0], offset[10:8] << 5 | block.
+ * The checksum is the sum of the seven bytes before it. While the firmware processes the
+ * previous request, the ready byte reads TMC9660_SPI_REPLY_BUSY and the request sent with
+ * that datagram is dropped, so it is resent. A datagram of zeros fetches a reply without
+ * sending a new request. The special commands reply with 8 data bytes instead, just like
+ * the UART replies after the host address. These never start with TMC9660_SPI_REPLY_BUSY.
+ */
+
+#define TMC9660_SPI_BL_DATAGRAM_SIZE  5
+#define TMC9660_SPI_DATAGRAM_SIZE     8
+
+static void buildBlRequestSPI(uint8_t *data, uint8_t cmd, uint32_t writeValue)
+{
+    data[0] = cmd;
+    data[1] = (writeValue >> 24) & 0xFF;
+    data[2] = (writeValue >> 16) & 0xFF;
+    data[3] = (writeValue >> 8 ) & 0xFF;
+    data[4] = (writeValue      ) & 0xFF;
+}
+
+static int32_t tmc9660_bl_sendCommand_SPI(uint16_t icID, uint8_t cmd, uint32_t writeValue, uint32_t *readValue)
+{
+    uint8_t data[TMC9660_SPI_BL_DATAGRAM_SIZE];
+
+    buildBlRequestSPI(data, cmd, writeValue);
+    tmc9660_readWriteSPI(icID, &data[0], TMC9660_SPI_BL_DATAGRAM_SIZE);
+
+    // The reply is shifted out while sending the next datagram
+    buildBlRequestSPI(data, TMC9660_BLCMD_NO_OP, 0);
+    tmc9660_readWriteSPI(icID, &data[0], TMC9660_SPI_BL_DATAGRAM_SIZE);
+
+    if (readValue)
+    {
+        *readValue = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 8) | data[4];
+    }
+
+    return data[0];
+}
+
+// Like transferBlock(), but without a limit of [count]. Each datagram carries the next request along
+// with the reply to the previous one, a final TMC9660_BLCMD_NO_OP fetches the last reply.
+static size_t transferBlockSPI(uint16_t icID, uint8_t cmd, const uint32_t *writeWords, uint32_t *readWords, size_t count, uint32_t *checksum, int32_t *status)
+{
+    uint8_t data[TMC9660_SPI_BL_DATAGRAM_SIZE];
+
+    *status = TMC9660_BLTRANSFER_OK;
+
+    for (size_t i = 0; i <= count; i++)
+    {
+        if (i < count)
+            buildBlRequestSPI(data, cmd, (writeWords)? writeWords[i] : 0);
+        else
+            buildBlRequestSPI(data, TMC9660_BLCMD_NO_OP, 0);
+
+        tmc9660_readWriteSPI(icID, &data[0], TMC9660_SPI_BL_DATAGRAM_SIZE);
+
+        // The first datagram has no reply of this block
+        if (i == 0)
+            continue;
+
+        if (data[0] != TMC9660_BL_STATUS_OK)
+        {
+            *status = TMC9660_BLTRANSFER_COMMAND_ERROR;
+            return i - 1;
+        }
+
+        uint32_t value = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 8) | data[4];
+
+        if (readWords)
+            readWords[i - 1] = value;
+
+        if (checksum)
+            *checksum = tmc9660_bl_updateChecksum(*checksum, (writeWords)? writeWords[i - 1] : value);
+    }
+
+    return count;
+}
+
+static void buildRequestSPI(uint8_t *data, uint8_t cmd, uint8_t typeLow, uint8_t typeHigh, uint32_t writeValue)
+{
+    data[0] = cmd;
+    data[1] = typeLow;
+    data[2] = typeHigh;
+    data[3] = (writeValue >> 24) & 0xFF;
+    data[4] = (writeValue >> 16) & 0xFF;
+    data[5] = (writeValue >> 8) & 0xFF;
+    data[6] = (writeValue) & 0xFF;
+    data[7] = calcParamChecksum(&data[0], 7);
+}
+
+static void buildParamRequestSPI(uint8_t *data, uint8_t cmd, uint16_t type, uint8_t index, uint32_t writeValue)
+{
+    buildRequestSPI(data, cmd, type & 0xFF, (type >> 8) << 4 | (index & 0x0F), writeValue);
+}
+
+// Sends [request] without evaluating the bytes shifted out at the same time
+static void sendRequestSPI(uint16_t icID, const uint8_t *request)
+{
+    uint8_t data[TMC9660_SPI_DATAGRAM_SIZE];
+
+    for (size_t i = 0; i < TMC9660_SPI_DATAGRAM_SIZE; i++)
+    {
+        data[i] = request[i];
+    }
+
+    tmc9660_readWriteSPI(icID, &data[0], TMC9660_SPI_DATAGRAM_SIZE);
+}
+
+// Fetches the reply to the previous request into [reply] while sending [request] (or no request if NULL).
+// While the firmware is busy, the datagram is resent up to TMC9660_SPI_REPLY_POLLS times.
+// Returns false if no reply has been received.
+static bool exchangeSPI(uint16_t icID, const uint8_t *request, uint8_t *reply)
+{
+    for (uint32_t polls = 1; ; polls++)
+    {
+        for (size_t i = 0; i < TMC9660_SPI_DATAGRAM_SIZE; i++)
+        {
+            reply[i] = (request)? request[i] : 0;
+        }
+
+        tmc9660_readWriteSPI(icID, &reply[0], TMC9660_SPI_DATAGRAM_SIZE);
+
+        if (reply[0] != TMC9660_SPI_REPLY_BUSY)
+            return true;
+
+        if (polls >= TMC9660_SPI_REPLY_POLLS)
+            return false;
+
+        tmc_delayMicroseconds(TMC9660_SPI_POLL_INTERVAL);
+    }
+}
+
+// Checks the reply to [cmd] and returns its status, or a negative value on errors
+static int32_t unpackReplySPI(uint8_t cmd, uint8_t *data, uint32_t *readValue)
+{
+    if (data[7] != calcParamChecksum(&data[0], 7))
+        return -5;
+    if (data[2] != cmd)
+        return -6;
+
+    if (readValue)
+    {
+        *readValue = ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | ((uint32_t)data[5] << 8) | data[6];
+    }
+
+    return data[1];
+}
+
+// Pipelines the requests, see tmc9660_param_sendCommands()
+static size_t sendParamBatchSPI(uint16_t icID, TMC9660ParamRequest *requests, size_t count)
+{
+    uint8_t next[TMC9660_SPI_DATAGRAM_SIZE];
+    uint8_t reply[TMC9660_SPI_DATAGRAM_SIZE];
+    size_t successful = 0;
+
+    if (count == 0)
+        return 0;
+
+    buildParamRequestSPI(next, requests[0].cmd, requests[0].type, requests[0].index, requests[0].value);
+    sendRequestSPI(icID, next);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        bool last = (i + 1 == count);
+
+        if (!last)
+            buildParamRequestSPI(next, requests[i + 1].cmd, requests[i + 1].type, requests[i + 1].index, requests[i + 1].value);
+
+        if (!exchangeSPI(icID, (last)? NULL : next, reply))
+        {
+            // The following requests have not been accepted either
+            for (; i < count; i++)
+            {
+                requests[i].status = -2;
+            }
+
+            break;
+        }
+
+        requests[i].status = unpackReplySPI(requests[i].cmd, reply, &requests[i].value);
+        successful += requests[i].status == TMC9660_PARAMSTATUS_OK;
+    }
+
+    return successful;
+}
+
+static int32_t tmc9660_param_sendCommand_SPI(uint16_t icID, uint8_t cmd, uint16_t type, uint8_t index, uint32_t writeValue, uint32_t *readValue)
+{
+    uint8_t data[TMC9660_SPI_DATAGRAM_SIZE];
+
+    buildParamRequestSPI(data, cmd, type, index, writeValue);
+    sendRequestSPI(icID, data);
+
+    if (!exchangeSPI(icID, NULL, data))
+        return -2;
+
+    return unpackReplySPI(cmd, data, readValue);
+}
+
+static int32_t tmc9660_param_getVersionASCII_SPI(uint16_t icID, uint8_t *versionString)
+{
+    uint8_t data[TMC9660_SPI_DATAGRAM_SIZE];
+
+    buildParamRequestSPI(data, TMC9660_CMD_GET_VERSION, 0, 0, 0);
+    sendRequestSPI(icID, data);
+
+    if (!exchangeSPI(icID, NULL, data))
+        return -2;
+
+    for (size_t i = 0; i < 8; i++)
+    {
+        versionString[i] = data[i];
+    }
+
+    return 0;
+}
+
+static int32_t tmc9660_param_readTMCLMemory_SPI(uint16_t icID, uint32_t cmdIndex, uint8_t *command)
+{
+    uint8_t data[TMC9660_SPI_DATAGRAM_SIZE];
+
+    buildParamRequestSPI(data, TMC9660_CMD_READ_MEM, 0, 0, cmdIndex);
+    sendRequestSPI(icID, data);
+
+    if (!exchangeSPI(icID, NULL, data))
+        return -2;
+
+    for (size_t i = 0; i < 7; i++)
+    {
+        command[i] = data[i];
+    }
+
+    return 0;
+}
+
+static int32_t tmc9660_param_returnToBootloader_SPI(uint16_t icID)
+{
+    uint8_t data[TMC9660_SPI_DATAGRAM_SIZE];
+
+    // The firmware does not reply after leaving parameter mode
+    buildParamRequestSPI(data, TMC9660_CMD_BOOT, 0x981, 0x2, 0xA3B4C5D6);
+    sendRequestSPI(icID, data);
+
+    return 0;
+}
+
+static int32_t tmc9660_reg_sendCommand_SPI(uint16_t icID, uint8_t cmd, uint16_t registerOffset, uint8_t registerBlock, uint32_t writeValue, uint32_t *readValue)
+{
+    uint8_t data[TMC9660_SPI_DATAGRAM_SIZE];
+
+    buildRequestSPI(data, cmd, registerOffset & 0xFF, (registerOffset >> 8) << 5 | (registerBlock & 0x1F), writeValue);
+    sendRequestSPI(icID, data);
+
+    if (!exchangeSPI(icID, NULL, data))
+        return -2;
+
+    return unpackReplySPI(cmd, data, readValue);
+}
+#endif
+
 static uint8_t calcParamChecksum(uint8_t *data, uint32_t bytes)
 {
     uint8_t checksum = 0;
@@ -391,3 +1125,85 @@ bool tmc9660_param_setGlobalParameter(uint16_t icID, uint16_t index, uint32_t va
 
     return result == TMC9660_PARAMSTATUS_OK;
 }
+
+size_t tmc9660_param_sendCommands(uint16_t icID, TMC9660ParamRequest *requests, size_t count)
+{
+    TMC9660BusType bus = tmc9660_getBusType(icID);
+    size_t successful = 0;
+
+    if(bus == TMC9660_BUS_UART)
+    {
+        for (size_t i = 0; i < count; i += TMC9660_UART_STREAM_SIZE)
+        {
+            size_t blockSize = (count - i < TMC9660_UART_STREAM_SIZE)? count - i : TMC9660_UART_STREAM_SIZE;
+
+            successful += sendParamBlockUART(icID, &requests[i], blockSize);
+        }
+
+        return successful;
+    }
+
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+    if(bus == TMC9660_BUS_SPI)
+        return sendParamBatchSPI(icID, requests, count);
+#endif
+
+    for (size_t i = 0; i < count; i++)
+    {
+        requests[i].status = -1;
+    }
+
+    return 0;
+}
+
+bool tmc9660_param_readAxisState(uint16_t icID, TMC9660AxisState *state)
+{
+    // Same order as the members of TMC9660AxisState
+    static const uint16_t parameters[] = {
+        TMC9660_PARAM_ACTUAL_POSITION,
+        TMC9660_PARAM_ACTUAL_VELOCITY,
+        TMC9660_PARAM_ACTUAL_TORQUE,
+        TMC9660_PARAM_ACTUAL_FLUX,
+        TMC9660_PARAM_ACTUAL_TOTAL_MOTOR_CURRENT,
+        TMC9660_PARAM_SUPPLY_VOLTAGE,
+        TMC9660_PARAM_CHIP_TEMPERATURE,
+        TMC9660_PARAM_EXTERNAL_TEMPERATURE,
+        TMC9660_PARAM_GENERAL_STATUS_FLAGS,
+        TMC9660_PARAM_GENERAL_ERROR_FLAGS,
+        TMC9660_PARAM_GDRV_ERROR_FLAGS,
+        TMC9660_PARAM_ADC_STATUS_FLAGS,
+    };
+    TMC9660ParamRequest requests[sizeof(parameters) / sizeof(parameters[0])];
+    uint32_t values[sizeof(parameters) / sizeof(parameters[0])];
+    const size_t count = sizeof(parameters) / sizeof(parameters[0]);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        requests[i].cmd   = TMC9660_CMD_GAP;
+        requests[i].type  = parameters[i];
+        requests[i].index = 0;
+        requests[i].value = 0;
+    }
+
+    size_t successful = tmc9660_param_sendCommands(icID, requests, count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i] = (requests[i].status == TMC9660_PARAMSTATUS_OK)? requests[i].value : 0;
+    }
+
+    state->actualPosition          = values[0];
+    state->actualVelocity          = values[1];
+    state->actualTorque            = values[2];
+    state->actualFlux              = values[3];
+    state->actualTotalMotorCurrent = values[4];
+    state->supplyVoltage           = values[5];
+    state->chipTemperature         = values[6];
+    state->externalTemperature     = values[7];
+    state->generalStatusFlags      = values[8];
+    state->generalErrorFlags       = values[9];
+    state->gdrvErrorFlags          = values[10];
+    state->adcStatusFlags          = values[11];
+
+    return successful == count;
+}
@@ -24,6 +24,66 @@
 // If enabled, this requires an additional wrapper function
 //#define TMC_API_TMC9660_FAULT_PIN_SUPPORTED 1
 
+// Uncomment if you want to access the TMC9660 via SPI
+// If enabled, this requires the wrapper function tmc9660_readWriteSPI()
+//#define TMC_API_TMC9660_SPI_SUPPORTED 1
+
+// SPI parameter and register mode: While the firmware processes a request, the first reply byte
+// is TMC9660_SPI_REPLY_BUSY. The reply is polled up to TMC9660_SPI_REPLY_POLLS times,
+// TMC9660_SPI_POLL_INTERVAL µs apart.
+#define TMC9660_SPI_REPLY_BUSY  0xFF
+#ifndef TMC9660_SPI_REPLY_POLLS
+#define TMC9660_SPI_REPLY_POLLS   100
+#endif
+
+#ifndef TMC9660_SPI_POLL_INTERVAL
+#define TMC9660_SPI_POLL_INTERVAL   10
+#endif
+
+// To stream bulk bootloader transfers (tmc9660_bl_writeMemory() etc.) and batched parameter
+// requests (tmc9660_param_sendCommands()) with one callback per block, set
+// TMC9660_UART_STREAM_SUPPORT to '1' and implement tmc9660_readWriteUARTStream().
+// With '0', each request is sent with its own tmc9660_readWriteUART() call.
+#ifndef TMC9660_UART_STREAM_SUPPORT
+#define TMC9660_UART_STREAM_SUPPORT   0
+//#define TMC9660_UART_STREAM_SUPPORT   1
+#endif
+
+// Maximum amount of datagrams per block of a bulk transfer or a parameter batch.
+// The datagrams are assembled on the stack (8 or 9 bytes each).
+#ifndef TMC9660_UART_STREAM_SIZE
+#define TMC9660_UART_STREAM_SIZE   16
+#endif
+
+// Bootloader requests are paced adaptively: The gap between a reply and the next request
+// starts at TMC9660_BL_PACING_GAP_DEFAULT µs. After a missing or corrupted reply it is doubled
+// and only shrinks to 5/4 of the failed gap again, until a long run of valid replies lowers that bound.
+// Single commands (tmc9660_bl_sendCommand() etc.) always wait at least TMC9660_BL_PACING_GAP_DEFAULT µs.
+// Only the words of bulk transfers, which resume after failures, shrink the gap further, down to
+// TMC9660_BL_PACING_GAP_MIN µs. By default that is the same as TMC9660_BL_PACING_GAP_DEFAULT.
+// The pacing state is kept for the first TMC9660_BL_PACING_IC_COUNT ICs, the others
+// always wait TMC9660_BL_PACING_GAP_DEFAULT µs after each reply.
+#ifndef TMC9660_BL_PACING_IC_COUNT
+#define TMC9660_BL_PACING_IC_COUNT   1
+#endif
+
+#ifndef TMC9660_BL_PACING_GAP_DEFAULT
+#define TMC9660_BL_PACING_GAP_DEFAULT   10
+#endif
+
+#ifndef TMC9660_BL_PACING_GAP_MIN
+#define TMC9660_BL_PACING_GAP_MIN   TMC9660_BL_PACING_GAP_DEFAULT
+#endif
+
+#ifndef TMC9660_BL_PACING_GAP_MAX
+#define TMC9660_BL_PACING_GAP_MAX   1000
+#endif
+
+// Amount of times a bulk transfer resumes after a missing or corrupted reply without any word transferred in between
+#ifndef TMC9660_BL_RETRIES
+#define TMC9660_BL_RETRIES   3
+#endif
+
 /*** TMC9660 constants ********************************************************/
 typedef enum TMC9660BusType_ {
     TMC9660_BUS_SPI,
@@ -143,9 +203,53 @@ typedef enum TMC9660ParamStatus_ {
     TMC9660_PARAMSTATUS_CMD_LOADED                = 101, // Command successfully loaded into script memory
 } TMC9660ParamStatus;
 
+typedef enum TMC9660BlTransferStatus_ {
+    TMC9660_BLTRANSFER_OK             =  0,
+    TMC9660_BLTRANSFER_BUS_ERROR      = -1, // Missing or corrupted replies, retries exhausted
+    TMC9660_BLTRANSFER_COMMAND_ERROR  = -2, // The bootloader replied with an error status
+    TMC9660_BLTRANSFER_VERIFY_ERROR   = -3, // Checksum of the read back data does not match
+    TMC9660_BLTRANSFER_TIMEOUT        = -4, // Memory still busy after the timeout
+} TMC9660BlTransferStatus;
+
+// One request of a parameter batch (tmc9660_param_sendCommands())
+typedef struct TMC9660ParamRequest_ {
+    uint8_t cmd;      // E.g. TMC9660_CMD_GAP, TMC9660_CMD_SAP, TMC9660_CMD_GGP
+    uint16_t type;
+    uint8_t index;
+    uint32_t value;   // Value to write, replaced by the reply value
+    int32_t status;   // Reply status (TMC9660ParamStatus) or negative error code, see tmc9660_param_sendCommands()
+} TMC9660ParamRequest;
+
+// Axis state read with one parameter batch by tmc9660_param_readAxisState()
+typedef struct TMC9660AxisState_ {
+    int32_t actualPosition;
+    int32_t actualVelocity;
+    int32_t actualTorque;
+    int32_t actualFlux;
+    uint32_t actualTotalMotorCurrent;
+    uint32_t supplyVoltage;
+    uint32_t chipTemperature;
+    uint32_t externalTemperature;
+    uint32_t generalStatusFlags;
+    uint32_t generalErrorFlags;
+    uint32_t gdrvErrorFlags;
+    uint32_t adcStatusFlags;
+} TMC9660AxisState;
+
 /*** TMC-API wrapper functions ************************************************/
-//extern void tmc9660_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength);
+#if TMC_API_TMC9660_SPI_SUPPORTED != 0
+// Sends [dataLength] bytes of [data] in one SPI datagram (chip select asserted once) and stores
+// the bytes received at the same time in [data]
+extern void tmc9660_readWriteSPI(uint16_t icID, uint8_t *data, size_t dataLength);
+#endif
 extern bool tmc9660_readWriteUART(uint16_t icID, uint8_t *data, size_t writeLength, size_t readLength);
+#if TMC9660_UART_STREAM_SUPPORT == 1
+// Sends [datagramCount] requests of [datagramLength] bytes each, stored back to back in [data], and
+// receives one reply of [datagramLength] bytes per request into the place of its request.
+// Requests may be sent before the reply to the previous one has arrived (e.g. with DMA on a full
+// duplex UART). Returns the amount of replies received in order, stopping at the first missing one.
+extern size_t tmc9660_readWriteUARTStream(uint16_t icID, uint8_t *data, size_t datagramLength, size_t datagramCount);
+#endif
 
 #if TMC_API_TMC9660_FAULT_PIN_SUPPORTED != 0
 extern bool tmc9660_isFaultPinAsserted(uint16_t icID);
@@ -168,8 +272,29 @@ void tmc9660_waitForFaultDeassertion(uint16_t icID);
 #endif
 
 /*** TMC9660 Bootloader Mode functions ****************************************/
+// Returns the reply status, -1 if no reply has been received or -5 if the reply CRC is wrong
 int32_t tmc9660_bl_sendCommand(uint16_t icID, uint8_t cmd, uint32_t writeValue, uint32_t *readValue);
 
+// Bulk memory access: Sets the bank and address once, then transfers [count] 32 bit words with the
+// auto-incrementing WRITE_32_INC/READ_32_INC commands. Missing or corrupted replies resume the
+// transfer at the failed word. Return a TMC9660BlTransferStatus.
+// [checksum] (may be NULL) is updated with every transferred word (see tmc9660_bl_updateChecksum()),
+// so a running checksum can be kept over several calls. Start it with 0.
+int32_t tmc9660_bl_writeMemory(uint16_t icID, uint8_t bank, uint32_t address, const uint32_t *words, size_t count, uint32_t *checksum);
+int32_t tmc9660_bl_readMemory(uint16_t icID, uint8_t bank, uint32_t address, uint32_t *words, size_t count, uint32_t *checksum);
+// Reads [count] words back without storing them and compares their checksum to [checksum]
+int32_t tmc9660_bl_verifyMemory(uint16_t icID, uint8_t bank, uint32_t address, size_t count, uint32_t checksum);
+
+// Erases the flash sector at [address] of [bank] and waits until the memory is no longer busy
+int32_t tmc9660_bl_eraseFlashSector(uint16_t icID, uint8_t bank, uint32_t address, uint32_t timeout);
+// Polls MEM_IS_BUSY of the selected bank for up to [timeout] µs
+int32_t tmc9660_bl_waitWhileBusy(uint16_t icID, uint32_t timeout);
+
+// Running checksum of bulk transfers: Rotate left by one bit and add the word
+uint32_t tmc9660_bl_updateChecksum(uint32_t checksum, uint32_t word);
+// Restarts the adaptive pacing of [icID] from TMC9660_BL_PACING_GAP_DEFAULT
+void tmc9660_bl_resetPacing(uint16_t icID);
+
 /*** TMC9660 Parameter Mode functions *****************************************/
 int32_t tmc9660_param_sendCommand(uint16_t icID, uint8_t cmd, uint16_t type, uint8_t index, uint32_t writeValue, uint32_t *readValue);
 
@@ -184,6 +309,20 @@ bool tmc9660_param_setParameter(uint16_t icID, uint16_t type, uint32_t value);
 uint32_t tmc9660_param_getGlobalParameter(uint16_t icID, uint16_t index);
 bool tmc9660_param_setGlobalParameter(uint16_t icID, uint16_t index, uint32_t value);
 
+// Sends a batch of parameter mode commands. With TMC9660_UART_STREAM_SUPPORT, blocks of up to
+// TMC9660_UART_STREAM_SIZE requests are kept in flight and the replies are matched to the
+// requests by their order and command number. Via SPI, each request is sent with the datagram
+// that fetches the reply to the previous one. A request without a reply ends an SPI batch.
+// The status of each request is its reply status or a negative error code:
+//   -1: Bus not supported, -2: No reply, -3: Wrong host address, -4: Wrong module address,
+//   -5: Checksum error, -6: Reply to a different command
+// Returns the amount of requests with the reply status TMC9660_PARAMSTATUS_OK.
+size_t tmc9660_param_sendCommands(uint16_t icID, TMC9660ParamRequest *requests, size_t count);
+
+// Reads all values of [state] with one batch. Returns false if any value could not be read,
+// [state] then contains 0 for those values.
+bool tmc9660_param_readAxisState(uint16_t icID, TMC9660AxisState *state);
+
 /*** TMC9660 Register Mode functions *****************************************/
 int32_t tmc9660_reg_sendCommand(uint16_t icID, uint8_t cmd, uint16_t registerOffset, uint8_t registerBlock, uint32_t writeValue, uint32_t *readValue);
 
@@ -79,7 +79,7 @@ void tmc_linearRamp_computeRampPosition(TMC_LinearRamp *linearRamp)
 		int64_t sqrtiValue = tmc_limitS64(((int64_t)120 * (int64_t)linearRamp->acceleration * (int64_t)(abs(targetPositionsDifference))) / (int64_t)linearRamp->encoderSteps, 0, (int64_t)linearRamp->maxVelocity*(int64_t)linearRamp->maxVelocity);
 
 		// compute max allowed ramp velocity to ramp down to target
-		int32_t maxRampStop = tmc_sqrti(sqrtiValue);
+		int32_t maxRampStop = tmc_sqrti64(sqrtiValue);
 
 		// compute max allowed ramp velocity
 		int32_t maxRampTargetVelocity = 0;
@@ -9,6 +9,9 @@
 #include "LinearRamp1.h"
 #include "tmc/helpers/Functions.h"
 
+static int32_t getStepsPerTick(TMC_LinearRamp *linearRamp, uint32_t velocity);
+static bool canDriveOn(TMC_LinearRamp *linearRamp, int32_t diffx);
+
 void tmc_ramp_linear_init(TMC_LinearRamp *linearRamp)
 {
 	linearRamp->maxVelocity         = 0;
@@ -23,8 +26,10 @@ void tmc_ramp_linear_init(TMC_LinearRamp *linearRamp)
 	linearRamp->rampMode            = TMC_RAMP_LINEAR_MODE_VELOCITY;
 	linearRamp->state               = TMC_RAMP_LINEAR_STATE_IDLE;
 	linearRamp->precision           = TMC_RAMP_LINEAR_DEFAULT_PRECISION;
+	linearRamp->precisionShift      = tmc_ramp_linear_get_precision_shift(TMC_RAMP_LINEAR_DEFAULT_PRECISION);
 	linearRamp->homingDistance      = TMC_RAMP_LINEAR_DEFAULT_HOMING_DISTANCE;
 	linearRamp->stopVelocity        = TMC_RAMP_LINEAR_DEFAULT_STOP_VELOCITY;
+	linearRamp->multiStep           = false;
 }
 
 void tmc_ramp_linear_set_enabled(TMC_LinearRamp *linearRamp, bool enabled)
@@ -70,6 +75,7 @@ void tmc_ramp_linear_set_mode(TMC_LinearRamp *linearRamp, TMC_LinearRamp_Mode mo
 void tmc_ramp_linear_set_precision(TMC_LinearRamp * linearRamp, uint32_t precision)
 {
 	linearRamp->precision = precision;
+	linearRamp->precisionShift = tmc_ramp_linear_get_precision_shift(precision);
 }
 
 void tmc_ramp_linear_set_homingDistance(TMC_LinearRamp *linearRamp, uint32_t homingDistance)
@@ -82,6 +88,13 @@ void tmc_ramp_linear_set_stopVelocity(TMC_LinearRamp *linearRamp, uint32_t stopV
 	linearRamp->stopVelocity = stopVelocity;
 }
 
+// Multi step mode: Velocities above one step per tick (|velocity| > precision) move the
+// ramp position by the full position change per tick instead of by one step.
+void tmc_ramp_linear_set_multiStep(TMC_LinearRamp *linearRamp, bool multiStep)
+{
+	linearRamp->multiStep = multiStep;
+}
+
 bool tmc_ramp_linear_get_enabled(TMC_LinearRamp *linearRamp)
 {
 	return linearRamp->rampEnabled;
@@ -153,15 +166,54 @@ uint32_t tmc_ramp_linear_get_stopVelocity(TMC_LinearRamp *linearRamp)
 	return linearRamp->stopVelocity;
 }
 
+bool tmc_ramp_linear_get_multiStep(TMC_LinearRamp *linearRamp)
+{
+	return linearRamp->multiStep;
+}
+
 int32_t tmc_ramp_linear_compute(TMC_LinearRamp *linearRamp)
 {
 	tmc_ramp_linear_compute_position(linearRamp);
 	return tmc_ramp_linear_compute_velocity(linearRamp);
 }
 
+int32_t tmc_ramp_linear_compute_steps(TMC_LinearRamp *linearRamp, uint32_t *stepTimes, uint32_t maxStepTimes)
+{
+	int32_t accumulator = linearRamp->accumulatorPosition;
+	int32_t dx = tmc_ramp_linear_compute(linearRamp);
+
+	if(dx == 0)
+		return 0;
+
+	int32_t steps = (linearRamp->multiStep) ? abs(dx) : 1;
+
+	for(int32_t k = 1; k <= steps && (uint32_t)k <= maxStepTimes; k++)
+		stepTimes[k-1] = tmc_ramp_linear_get_stepTime(accumulator, linearRamp->rampVelocity, linearRamp->precision, k, TMC_RAMP_LINEAR_TICK_FRACTION);
+
+	return (dx < 0) ? -steps : steps;
+}
+
+uint32_t tmc_ramp_linear_get_stepTime(int32_t accumulator, int32_t velocity, uint32_t precision, uint32_t step, uint32_t tickLength)
+{
+	if(velocity == 0)
+		return tickLength;
+
+	// The position accumulator moves linearly from its old value by the velocity within the tick.
+	// Step k happens when it crosses k * precision in the direction of the velocity.
+	uint64_t speed = abs(velocity);
+	uint64_t distance = (int64_t)step * precision - ((velocity < 0) ? -(int64_t)accumulator : (int64_t)accumulator);
+	uint64_t time = (distance * tickLength + speed - 1) / speed;
+
+	return MAX(1, MIN(time, tickLength));
+}
+
 int32_t tmc_ramp_linear_compute_velocity(TMC_LinearRamp *linearRamp)
 {
 	bool accelerating = linearRamp->rampVelocity != linearRamp->targetVelocity;
+	int32_t previousVelocity = linearRamp->rampVelocity;
+
+	bool useShift = tmc_ramp_linear_precision_shift_matches(linearRamp->precisionShift, linearRamp->precision);
+	int32_t dx;
 
 	if (linearRamp->rampEnabled)
 	{
@@ -169,8 +221,17 @@ int32_t tmc_ramp_linear_compute_velocity(TMC_LinearRamp *linearRamp)
 		linearRamp->accumulatorVelocity += linearRamp->acceleration;
 
 		// Calculate the velocity delta value and keep the remainder of the velocity accumulator
-		int32_t dv = linearRamp->accumulatorVelocity / linearRamp->precision;
-		linearRamp->accumulatorVelocity = linearRamp->accumulatorVelocity % linearRamp->precision;
+		int32_t dv;
+		if(useShift)
+		{
+			dv = (uint32_t)linearRamp->accumulatorVelocity >> linearRamp->precisionShift;
+			linearRamp->accumulatorVelocity = (uint32_t)linearRamp->accumulatorVelocity & (linearRamp->precision - 1);
+		}
+		else
+		{
+			dv = linearRamp->accumulatorVelocity / linearRamp->precision;
+			linearRamp->accumulatorVelocity = linearRamp->accumulatorVelocity % linearRamp->precision;
+		}
 
 		// Add dv to rampVelocity, and regulate to target velocity
 		if(linearRamp->rampVelocity < linearRamp->targetVelocity)
@@ -188,20 +249,43 @@ int32_t tmc_ramp_linear_compute_velocity(TMC_LinearRamp *linearRamp)
 
 	// Calculate the velocity delta value and keep the remainder of the position accumulator
 	linearRamp->accumulatorPosition += linearRamp->rampVelocity;
-	int32_t dx = linearRamp->accumulatorPosition / (int32_t) linearRamp->precision;
-	linearRamp->accumulatorPosition = linearRamp->accumulatorPosition % (int32_t) linearRamp->precision;
+	if(useShift)
+	{
+		// Round towards zero like the division: negative values are biased by precision - 1 before shifting
+		int32_t mask = linearRamp->precision - 1;
+		dx = (linearRamp->accumulatorPosition + ((linearRamp->accumulatorPosition >> 31) & mask)) >> linearRamp->precisionShift;
+		linearRamp->accumulatorPosition -= dx * (int32_t) linearRamp->precision;
+	}
+	else
+	{
+		dx = linearRamp->accumulatorPosition / (int32_t) linearRamp->precision;
+		linearRamp->accumulatorPosition = linearRamp->accumulatorPosition % (int32_t) linearRamp->precision;
+	}
 
 	if(dx == 0)
 		return dx;
 
 	// Change actual position determined by position change
-	linearRamp->rampPosition += (dx < 0) ? (-1) : (1);
-
-	// Count acceleration steps needed for decelerating later
-	linearRamp->accelerationSteps += (abs(linearRamp->rampVelocity) < abs(linearRamp->targetVelocity)) ? accelerating : -accelerating;
+	int32_t steps = (linearRamp->multiStep) ? abs(dx) : 1;
+	linearRamp->rampPosition += (dx < 0) ? (-steps) : (steps);
+
+	// Count acceleration steps needed for decelerating later.
+	// Multi step mode compares the velocity at the start of the tick, so the steps of the
+	// tick reaching the target velocity are still counted as acceleration steps.
+	int32_t velocity = (linearRamp->multiStep) ? previousVelocity : linearRamp->rampVelocity;
+	int32_t direction = (abs(velocity) < abs(linearRamp->targetVelocity)) ? accelerating : -accelerating;
+	linearRamp->accelerationSteps += direction;
 	if (linearRamp->accelerationSteps < 0)
 		linearRamp->accelerationSteps = 0;
 
+	// Multi step mode: count the remaining steps of this tick
+	if (steps > 1)
+	{
+		linearRamp->accelerationSteps += direction * (steps - 1);
+		if (linearRamp->accelerationSteps < 0)
+			linearRamp->accelerationSteps = 0;
+	}
+
 	return dx;
 }
 
@@ -236,8 +320,9 @@ void tmc_ramp_linear_compute_position(TMC_LinearRamp *linearRamp)
 			diffx = abs(linearRamp->targetPosition - linearRamp->rampPosition);
 
 		// Steps left required for braking?
-		// (+ 1 to compensate rounding (flooring) errors of the position accumulator)
-		if(linearRamp->accelerationSteps + 1 >= diffx)
+		// (+ 1 to compensate rounding (flooring) errors of the position accumulator,
+		// see tmc_ramp_linear_can_drive_on() for the multi step mode)
+		if(!canDriveOn(linearRamp, diffx))
 		{
 			linearRamp->targetVelocity = 0;
 			linearRamp->state = TMC_RAMP_LINEAR_STATE_BRAKING;
@@ -279,14 +364,16 @@ void tmc_ramp_linear_compute_position(TMC_LinearRamp *linearRamp)
 
 				// Enough space to accelerate again?
 				// (+ 1 to compensate rounding (flooring) errors of the position accumulator)
-				if(linearRamp->accelerationSteps + 1 < diffx)
+				if(canDriveOn(linearRamp, diffx))
 				{
 					linearRamp->state = TMC_RAMP_LINEAR_STATE_DRIVING;
 				}
 			}
 			else
 			{	// Standing still (not at the target position)
-				if(abs(linearRamp->targetPosition - linearRamp->rampPosition) <= linearRamp->homingDistance)
+				// Multi step mode may stop farther away than a first tick drives, a new ramp would brake at once
+				if(abs(linearRamp->targetPosition - linearRamp->rampPosition) <= linearRamp->homingDistance
+				|| (linearRamp->multiStep && !canDriveOn(linearRamp, abs(linearRamp->targetPosition - linearRamp->rampPosition))))
 				{	// Within homing distance - drive with stop velocity
 					linearRamp->targetVelocity = (linearRamp->targetPosition > linearRamp->rampPosition)? linearRamp->stopVelocity : -linearRamp->stopVelocity;
 				}
@@ -300,3 +387,341 @@ void tmc_ramp_linear_compute_position(TMC_LinearRamp *linearRamp)
 		break;
 	}
 }
+
+// Shifts are considerably faster than divisions on cores without (fast) hardware division.
+int8_t tmc_ramp_linear_get_precision_shift(uint32_t precision)
+{
+	// The position accumulator is divided by (int32_t) precision and velocities are 32 bit, so 2^31 is excluded
+	if(precision == 0 || precision >= 0x80000000u || (precision & (precision - 1)) != 0)
+		return -1;
+
+	int8_t shift = 0;
+	while((1u << shift) != precision)
+		shift++;
+
+	return shift;
+}
+
+// Upper limit of the steps done per tick at the given velocity
+static int32_t getStepsPerTick(TMC_LinearRamp *linearRamp, uint32_t velocity)
+{
+	if(!linearRamp->multiStep)
+		return 1;
+
+	if(tmc_ramp_linear_precision_shift_matches(linearRamp->precisionShift, linearRamp->precision))
+		return (velocity >> linearRamp->precisionShift) + 1;
+
+	return velocity / linearRamp->precision + 1;
+}
+
+// Braking check of the position mode: Whether the ramp can keep driving towards the target, diffx steps away
+static bool canDriveOn(TMC_LinearRamp *linearRamp, int32_t diffx)
+{
+	if(!linearRamp->multiStep)
+		return linearRamp->accelerationSteps + 1 < diffx;
+
+	return tmc_ramp_linear_can_drive_on(abs(linearRamp->rampVelocity), linearRamp->maxVelocity, linearRamp->acceleration,
+			linearRamp->precision, linearRamp->precisionShift, diffx);
+}
+
+// Closed-form advance
+//
+// tmc_ramp_linear_advance() splits the requested ticks into windows in which the
+// position state machine cannot change anything but the target velocity it already
+// set, and in which the velocity follows one closed-form expression:
+//   v(k) = v + dir * F(k) with F(k) = floor((accumulatorVelocity + k * acceleration) / precision)
+// A window ends before the tick that reaches the target velocity, before the velocity
+// changes its sign, crosses one position per tick (|v| = precision) or crosses |targetVelocity|.
+// These ticks, as well as state transitions, are computed with the regular per-tick functions.
+
+// Upper limit of a window, keeps all sums within 64 bit
+#define ADVANCE_MAX_TICKS  ((uint32_t)1 << 24)
+#define ADVANCE_NEVER      UINT32_MAX
+
+static uint32_t advanceWindow(TMC_LinearRamp *linearRamp, uint32_t ticks);
+static uint32_t advanceVelocity(TMC_LinearRamp *linearRamp, uint32_t ticks, int64_t *dxSum);
+static uint32_t ticksUntil(uint64_t accumulator, uint64_t acceleration, uint64_t precision, int64_t dv, uint32_t ticks);
+static uint64_t floorSum(uint64_t n, uint64_t m, uint64_t a, uint64_t b);
+
+int32_t tmc_ramp_linear_advance(TMC_LinearRamp *linearRamp, uint32_t ticks)
+{
+	int64_t dxSum = 0;
+
+	while(ticks > 0)
+	{
+		uint32_t window = (ticks >= TMC_RAMP_LINEAR_ADVANCE_MIN_TICKS) ? advanceWindow(linearRamp, ticks) : 0;
+		uint32_t done = 0;
+
+		if(window > 0)
+		{
+			// The state machine keeps its state for the whole window - run it for the first tick
+			tmc_ramp_linear_compute_position(linearRamp);
+			done = advanceVelocity(linearRamp, window, &dxSum);
+
+			if(done == 0)
+			{
+				dxSum += tmc_ramp_linear_compute_velocity(linearRamp);
+				done = 1;
+			}
+		}
+		else
+		{
+			dxSum += tmc_ramp_linear_compute(linearRamp);
+			done = 1;
+		}
+
+		ticks -= done;
+	}
+
+	return dxSum;
+}
+
+// Returns the amount of ticks in which tmc_ramp_linear_compute_position() does not change its state
+// (0 if it might change in the next tick).
+static uint32_t advanceWindow(TMC_LinearRamp *linearRamp, uint32_t ticks)
+{
+	int32_t diffx;
+
+	if (!linearRamp->rampEnabled || linearRamp->rampMode != TMC_RAMP_LINEAR_MODE_POSITION)
+		return ticks;
+
+	switch(linearRamp->state) {
+	case TMC_RAMP_LINEAR_STATE_IDLE:
+		// Standing still on the target position
+		if(linearRamp->rampPosition == linearRamp->targetPosition && linearRamp->rampVelocity == 0 && linearRamp->targetVelocity == 0)
+			return ticks;
+		break;
+	case TMC_RAMP_LINEAR_STATE_DRIVING:
+		if(linearRamp->rampVelocity > 0)
+			diffx = linearRamp->targetPosition - linearRamp->rampPosition;
+		else if(linearRamp->rampVelocity < 0)
+			diffx = -(linearRamp->targetPosition - linearRamp->rampPosition);
+		else
+			diffx = abs(linearRamp->targetPosition - linearRamp->rampPosition);
+
+		if(linearRamp->multiStep)
+		{
+			// The velocity stays below the highest velocity of the window, which limits both the steps per
+			// tick and the braking distance compared by tmc_ramp_linear_can_drive_on()
+			uint64_t velocity = MAX((uint32_t)abs(linearRamp->rampVelocity), linearRamp->maxVelocity);
+			int64_t maxSteps = getStepsPerTick(linearRamp, velocity);
+
+			if(linearRamp->acceleration <= 0)
+				break;
+
+			int64_t margin = (int64_t)diffx - maxSteps - (int64_t)(velocity * velocity / (2 * (uint64_t)linearRamp->acceleration)) - 1;
+			if(margin >= 0)
+				return MIN(ticks, margin / maxSteps + 1);
+			break;
+		}
+
+		// Each tick reduces diffx by at most one and increases the acceleration steps by at most one
+		int64_t margin = (int64_t)diffx - linearRamp->accelerationSteps - 1;
+		if(margin > 0)
+			return MIN(ticks, (margin + 1) / 2);
+		break;
+	case TMC_RAMP_LINEAR_STATE_BRAKING:
+		// Multi step mode may accelerate again at any tick, see tmc_ramp_linear_can_drive_on()
+		if(linearRamp->multiStep || linearRamp->rampPosition == linearRamp->targetPosition || linearRamp->rampVelocity == 0 || linearRamp->targetVelocity != 0)
+			break;
+
+		diffx = (linearRamp->rampVelocity > 0) ? linearRamp->targetPosition - linearRamp->rampPosition : -(linearRamp->targetPosition - linearRamp->rampPosition);
+
+		// While braking, every step reduces diffx and the acceleration steps by one (the latter stops at zero),
+		// so there is no way back to DRIVING within the window. The window ends before the target position
+		// can be reached, advanceVelocity() ends it before the velocity reaches zero.
+		if(linearRamp->accelerationSteps + 1 >= diffx)
+			return MIN(ticks, (uint32_t)abs(linearRamp->targetPosition - linearRamp->rampPosition));
+		break;
+	}
+
+	return 0;
+}
+
+// Applies up to [ticks] calls of tmc_ramp_linear_compute_velocity() in closed form.
+// Returns the amount of ticks applied, 0 if the next tick has to be computed regularly.
+static uint32_t advanceVelocity(TMC_LinearRamp *linearRamp, uint32_t ticks, int64_t *dxSum)
+{
+	int64_t precision    = linearRamp->precision;
+	int64_t velocity     = linearRamp->rampVelocity;
+	int64_t target       = linearRamp->targetVelocity;
+	int64_t acceleration = linearRamp->acceleration;
+	int64_t accumulator  = linearRamp->accumulatorVelocity;
+	int64_t limit        = INT32_MAX - precision;
+
+	// Only use ranges where the per-tick calculations can't overflow
+	if(precision == 0 || precision > INT32_MAX || acceleration < 0 || acceleration > limit)
+		return 0;
+
+	if(accumulator < 0 || accumulator >= precision || llabs(velocity) > limit || llabs(target) > limit)
+		return 0;
+
+	if(!linearRamp->rampEnabled)
+	{
+		// Velocity is taken over in the first tick and stays constant afterwards
+		if(velocity != target)
+			return 0;
+
+		acceleration = 0;
+		accumulator = 0;
+	}
+
+	ticks = MIN(ticks, ADVANCE_MAX_TICKS);
+
+	int32_t direction = (velocity < target) ? 1 : (velocity > target) ? -1 : 0;
+	int32_t sign;
+	int64_t magnitude;
+	int64_t firstMagnitude;
+
+	if(direction != 0)
+	{
+		// Stop before the tick that reaches the target velocity
+		uint32_t k = ticksUntil(accumulator, acceleration, precision, llabs(target - velocity), ticks);
+		if(k != ADVANCE_NEVER)
+			ticks = k - 1;
+
+		if(ticks == 0)
+			return 0;
+
+		int64_t firstVelocity = velocity + direction * (int64_t)((accumulator + acceleration) / precision);
+
+		// Work on the magnitude of the velocity: sign * v(k) = magnitude + sign * direction * F(k)
+		sign = (firstVelocity > 0) ? 1 : (firstVelocity < 0) ? -1 : direction;
+		magnitude = sign * velocity;
+		firstMagnitude = sign * firstVelocity;
+
+		if(sign == direction)
+		{
+			// Velocity magnitude increases: stop before reaching one position per tick
+			if(firstMagnitude < precision && (k = ticksUntil(accumulator, acceleration, precision, precision - magnitude, ticks)) != ADVANCE_NEVER)
+				ticks = k - 1;
+		}
+		else
+		{
+			// Velocity magnitude decreases: stop before the sign changes
+			if((k = ticksUntil(accumulator, acceleration, precision, magnitude + 1, ticks)) != ADVANCE_NEVER)
+				ticks = k - 1;
+
+			// ... before dropping below one position per tick
+			if(firstMagnitude >= precision && (k = ticksUntil(accumulator, acceleration, precision, magnitude - precision + 1, ticks)) != ADVANCE_NEVER)
+				ticks = k - 1;
+
+			// ... and before dropping below the target velocity magnitude (target of opposite sign)
+			if(sign * target < 0 && firstMagnitude >= llabs(target) && (k = ticksUntil(accumulator, acceleration, precision, magnitude - llabs(target) + 1, ticks)) != ADVANCE_NEVER)
+				ticks = k - 1;
+		}
+
+		if(ticks == 0)
+			return 0;
+	}
+	else
+	{
+		sign = (velocity < 0) ? -1 : 1;
+		magnitude = sign * velocity;
+		firstMagnitude = magnitude;
+	}
+
+	// Below one position per tick, every tick moves by at most one position.
+	// A position accumulator of the opposite sign only delays the first step then.
+	// Above, every tick moves - the first tick has to bring the accumulator to the right sign.
+	bool slow = firstMagnitude < precision;
+	if(!slow && sign * linearRamp->accumulatorPosition < 0)
+		return 0;
+
+	if(linearRamp->multiStep)
+	{
+		// The first tick counts its acceleration steps by the velocity before the tick
+		// (see tmc_ramp_linear_compute_velocity), the window uses the one after it
+		if(direction != 0 && (llabs(velocity) < llabs(target)) != (firstMagnitude < llabs(target)))
+			return 0;
+
+		// Keep the step count of the window within 32 bit
+		if(!slow)
+			ticks = MIN(ticks, INT32_MAX / (MAX(llabs(velocity), llabs(target)) / precision + 1));
+	}
+
+	// Sum of the velocities of all ticks in the window
+	uint64_t velocityChange = (direction != 0) ? floorSum(ticks, precision, acceleration, accumulator + acceleration) : 0;
+	int64_t velocitySum = sign * ((int64_t)ticks * magnitude + sign * direction * (int64_t)velocityChange);
+
+	int64_t position = linearRamp->accumulatorPosition + velocitySum;
+	int64_t dx = position / precision;
+	linearRamp->accumulatorPosition = position % precision;
+
+	// Amount of steps: Below one step per tick, every tick moves by at most one step
+	uint32_t steps = (slow || linearRamp->multiStep) ? llabs(dx) : ticks;
+	linearRamp->rampPosition += sign * (int32_t)steps;
+
+	if(steps > 0)
+	{
+		// Count acceleration steps needed for decelerating later (see tmc_ramp_linear_compute_velocity)
+		if(direction == 0)
+		{
+			if(linearRamp->accelerationSteps < 0)
+				linearRamp->accelerationSteps = 0;
+		}
+		else if(firstMagnitude < llabs(target))
+		{
+			linearRamp->accelerationSteps = MAX(linearRamp->accelerationSteps + 1, 0) + (steps - 1);
+		}
+		else
+		{
+			linearRamp->accelerationSteps = MAX((int64_t)linearRamp->accelerationSteps - steps, 0);
+		}
+	}
+
+	uint64_t velocityAccumulator = accumulator + (uint64_t)ticks * acceleration;
+	linearRamp->rampVelocity += direction * (int32_t)(velocityAccumulator / precision);
+	linearRamp->accumulatorVelocity = velocityAccumulator % precision;
+
+	*dxSum += dx;
+
+	return ticks;
+}
+
+// Returns the first tick k (1 <= k <= ticks) with floor((accumulator + k * acceleration) / precision) >= dv,
+// ADVANCE_NEVER if there is none.
+static uint32_t ticksUntil(uint64_t accumulator, uint64_t acceleration, uint64_t precision, int64_t dv, uint32_t ticks)
+{
+	if(dv <= (int64_t)((accumulator + acceleration) / precision))
+		return 1;
+
+	if((accumulator + ticks * acceleration) / precision < (uint64_t)dv)
+		return ADVANCE_NEVER;
+
+	return ((uint64_t)dv * precision - accumulator + acceleration - 1) / acceleration;
+}
+
+// Sum of floor((a * i + b) / m) for i = 0 .. n-1
+static uint64_t floorSum(uint64_t n, uint64_t m, uint64_t a, uint64_t b)
+{
+	uint64_t sum = 0;
+
+	while(1)
+	{
+		if(a >= m)
+		{
+			sum += (n * (n - 1) / 2) * (a / m);
+			a %= m;
+		}
+
+		if(b >= m)
+		{
+			sum += n * (b / m);
+			b %= m;
+		}
+
+		uint64_t yMax = a * n + b;
+		if(yMax < m)
+			break;
+
+		n = yMax / m;
+		b = yMax % m;
+
+		uint64_t tmp = m;
+		m = a;
+		a = tmp;
+	}
+
+	return sum;
+}
@@ -10,29 +10,14 @@
 #define TMC_RAMP_LINEARRAMP1_H_
 
 #include "tmc/helpers/API_Header.h"
+#include "LinearRampCommon.h"
 #include "Ramp.h"
 
-// Default precision of the calculations. Internal calculations use a precision
-// of 1/TMC_RAMP_LINEAR_PRECISION for acceleration and velocity.
-// When using 2**N as precision, this results in N digits of precision.
-#define TMC_RAMP_LINEAR_DEFAULT_PRECISION ((uint32_t)1<<17)
+// Resolution of the step times reported by tmc_ramp_linear_compute_steps() (one tick)
+#define TMC_RAMP_LINEAR_TICK_FRACTION ((uint32_t)1<<16)
 
-// Position mode: When hitting the target position a velocity below the V_STOP threshold will be cut off to velocity 0
-#define TMC_RAMP_LINEAR_DEFAULT_HOMING_DISTANCE 5
-
-// Position mode: When barely missing the target position by HOMING_DISTANCE or less, the remainder will be driven with V_STOP velocity
-#define TMC_RAMP_LINEAR_DEFAULT_STOP_VELOCITY 5
-
-typedef enum {
-	TMC_RAMP_LINEAR_MODE_VELOCITY,
-	TMC_RAMP_LINEAR_MODE_POSITION
-} TMC_LinearRamp_Mode;
-
-typedef enum {
-	TMC_RAMP_LINEAR_STATE_IDLE,
-	TMC_RAMP_LINEAR_STATE_DRIVING,
-	TMC_RAMP_LINEAR_STATE_BRAKING
-} TMC_LinearRamp_State;
+// Below this amount of ticks, tmc_ramp_linear_compute() per tick is faster than tmc_ramp_linear_advance()
+#define TMC_RAMP_LINEAR_ADVANCE_MIN_TICKS 8
 
 typedef struct
 {
@@ -49,8 +34,10 @@ typedef struct
 	TMC_LinearRamp_State state;
 	int32_t accelerationSteps;
 	uint32_t precision;
+	int8_t precisionShift;  // log2(precision) if precision is a power of two, -1 otherwise (set by tmc_ramp_linear_set_precision)
 	uint32_t homingDistance;
 	uint32_t stopVelocity;
+	bool multiStep;  // Apply the full position change per tick instead of at most one step
 } TMC_LinearRamp;
 
 void tmc_ramp_linear_init(TMC_LinearRamp *linearRamp);
@@ -58,6 +45,29 @@ int32_t tmc_ramp_linear_compute(TMC_LinearRamp *linearRamp);
 int32_t tmc_ramp_linear_compute_velocity(TMC_LinearRamp *linearRamp);
 void tmc_ramp_linear_compute_position(TMC_LinearRamp *linearRamp);
 
+// Advances the ramp by [ticks] calls of tmc_ramp_linear_compute() and returns the sum of
+// their position deltas. The result is identical to calling tmc_ramp_linear_compute()
+// [ticks] times, but ramp phases without state changes (accelerating, cruising, braking)
+// are computed in closed form instead of tick by tick.
+int32_t tmc_ramp_linear_advance(TMC_LinearRamp *linearRamp, uint32_t ticks);
+
+// Computes one tick like tmc_ramp_linear_compute() and returns the steps done in this tick
+// (negative when moving backwards). The time of each step within the tick is written to
+// [stepTimes] (up to [maxStepTimes] entries) in units of 1/TMC_RAMP_LINEAR_TICK_FRACTION ticks,
+// so a step pulse scheduler can spread the steps over the tick.
+// Without multi step mode, at most one step is done per tick.
+// In multi step mode, the position mode brakes by the braking distance of the ramp velocity.
+// It may stop up to the steps of a tick short of the target and homes from there with the
+// stop velocity. With accelerations above one step per tick^2, or when a move starts too fast
+// to brake in time, the ramp can pass the target and returns to it.
+int32_t tmc_ramp_linear_compute_steps(TMC_LinearRamp *linearRamp, uint32_t *stepTimes, uint32_t maxStepTimes);
+
+// Time of step [step] (1, 2, ...) within a tick with the ramp velocity [velocity], which started
+// with the position accumulator at [accumulator]. Returned in units of 1/[tickLength] ticks,
+// rounded up and limited to 1 .. [tickLength]. Used by tmc_ramp_linear_compute_steps() and
+// ramp/StepTiming (in timer ticks).
+uint32_t tmc_ramp_linear_get_stepTime(int32_t accumulator, int32_t velocity, uint32_t precision, uint32_t step, uint32_t tickLength);
+
 void tmc_ramp_linear_set_enabled(TMC_LinearRamp *linearRamp, bool enabled);
 void tmc_ramp_linear_set_maxVelocity(TMC_LinearRamp *linearRamp, uint32_t maxVelocity);
 void tmc_ramp_linear_set_targetPosition(TMC_LinearRamp *linearRamp, int32_t targetPosition);
@@ -69,6 +79,7 @@ void tmc_ramp_linear_set_mode(TMC_LinearRamp *linearRamp, TMC_LinearRamp_Mode mo
 void tmc_ramp_linear_set_precision(TMC_LinearRamp * linearRamp, uint32_t precision);
 void tmc_ramp_linear_set_homingDistance(TMC_LinearRamp *linearRamp, uint32_t homingDistance);
 void tmc_ramp_linear_set_stopVelocity(TMC_LinearRamp *linearRamp, uint32_t stopVelocity);
+void tmc_ramp_linear_set_multiStep(TMC_LinearRamp *linearRamp, bool multiStep);
 
 bool tmc_ramp_linear_get_enabled(TMC_LinearRamp *linearRamp);
 uint32_t tmc_ramp_linear_get_maxVelocity(TMC_LinearRamp *linearRamp);
@@ -84,5 +95,6 @@ uint32_t tmc_ramp_linear_get_acceleration_limit(TMC_LinearRamp *linearRamp);
 uint32_t tmc_ramp_linear_get_velocity_limit(TMC_LinearRamp *linearRamp);
 uint32_t tmc_ramp_linear_get_homingDistance(TMC_LinearRamp *linearRamp);
 uint32_t tmc_ramp_linear_get_stopVelocity(TMC_LinearRamp *linearRamp);
+bool tmc_ramp_linear_get_multiStep(TMC_LinearRamp *linearRamp);
 
 #endif /* TMC_RAMP_LINEARRAMP1_H_ */
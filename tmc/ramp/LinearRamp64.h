@@ -0,0 +1,81 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+
+#ifndef TMC_RAMP_LINEARRAMP64_H_
+#define TMC_RAMP_LINEARRAMP64_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRampCommon.h"
+
+/*
+ *  Linear ramp with 64 bit positions and accumulators.
+ *
+ *  Same algorithm, units and API shape as TMC_LinearRamp (LinearRamp1), for axes
+ *  that would overflow 32 bit positions (e.g. conveyors running continuously) or
+ *  need a fine precision together with a high acceleration:
+ *  - rampPosition and targetPosition are 64 bit wide
+ *  - the acceleration is 64 bit wide, limited to precision^2 (one step per tick^2)
+ *    instead of 0xFFFFFFFF / precision
+ *
+ *  Velocities stay 32 bit, so the precision must not exceed 2^31. The multi step
+ *  mode and the closed-form advance of TMC_LinearRamp are not available.
+ *
+ *  The 64 bit arithmetic is slower on 32 bit cores: Use TMC_LinearRamp where the
+ *  range is sufficient, and a power of two precision to avoid 64 bit divisions.
+ */
+
+typedef struct
+{
+	uint32_t maxVelocity;
+	int64_t targetPosition;
+	int64_t rampPosition;
+	int32_t targetVelocity;
+	int32_t rampVelocity;
+	int64_t acceleration;
+	bool rampEnabled;
+	int64_t accumulatorVelocity;
+	int64_t accumulatorPosition;
+	TMC_LinearRamp_Mode rampMode;
+	TMC_LinearRamp_State state;
+	int64_t accelerationSteps;
+	uint32_t precision;
+	int8_t precisionShift;  // log2(precision) if precision is a power of two, -1 otherwise (set by tmc_ramp_linear64_set_precision)
+	uint32_t homingDistance;
+	uint32_t stopVelocity;
+} TMC_LinearRamp64;
+
+void tmc_ramp_linear64_init(TMC_LinearRamp64 *linearRamp);
+int32_t tmc_ramp_linear64_compute(TMC_LinearRamp64 *linearRamp);
+int32_t tmc_ramp_linear64_compute_velocity(TMC_LinearRamp64 *linearRamp);
+void tmc_ramp_linear64_compute_position(TMC_LinearRamp64 *linearRamp);
+
+void tmc_ramp_linear64_set_enabled(TMC_LinearRamp64 *linearRamp, bool enabled);
+void tmc_ramp_linear64_set_maxVelocity(TMC_LinearRamp64 *linearRamp, uint32_t maxVelocity);
+void tmc_ramp_linear64_set_targetPosition(TMC_LinearRamp64 *linearRamp, int64_t targetPosition);
+void tmc_ramp_linear64_set_rampPosition(TMC_LinearRamp64 *linearRamp, int64_t rampPosition);
+void tmc_ramp_linear64_set_targetVelocity(TMC_LinearRamp64 *linearRamp, int32_t targetVelocity);
+void tmc_ramp_linear64_set_rampVelocity(TMC_LinearRamp64 *linearRamp, int32_t rampVelocity);
+void tmc_ramp_linear64_set_acceleration(TMC_LinearRamp64 *linearRamp, int64_t acceleration);
+void tmc_ramp_linear64_set_mode(TMC_LinearRamp64 *linearRamp, TMC_LinearRamp_Mode mode);
+void tmc_ramp_linear64_set_precision(TMC_LinearRamp64 *linearRamp, uint32_t precision);
+void tmc_ramp_linear64_set_homingDistance(TMC_LinearRamp64 *linearRamp, uint32_t homingDistance);
+void tmc_ramp_linear64_set_stopVelocity(TMC_LinearRamp64 *linearRamp, uint32_t stopVelocity);
+
+bool tmc_ramp_linear64_get_enabled(TMC_LinearRamp64 *linearRamp);
+uint32_t tmc_ramp_linear64_get_maxVelocity(TMC_LinearRamp64 *linearRamp);
+int64_t tmc_ramp_linear64_get_targetPosition(TMC_LinearRamp64 *linearRamp);
+int64_t tmc_ramp_linear64_get_rampPosition(TMC_LinearRamp64 *linearRamp);
+int32_t tmc_ramp_linear64_get_targetVelocity(TMC_LinearRamp64 *linearRamp);
+int32_t tmc_ramp_linear64_get_rampVelocity(TMC_LinearRamp64 *linearRamp);
+int64_t tmc_ramp_linear64_get_acceleration(TMC_LinearRamp64 *linearRamp);
+TMC_LinearRamp_State tmc_ramp_linear64_get_state(TMC_LinearRamp64 *linearRamp);
+TMC_LinearRamp_Mode tmc_ramp_linear64_get_mode(TMC_LinearRamp64 *linearRamp);
+uint32_t tmc_ramp_linear64_get_precision(TMC_LinearRamp64 *linearRamp);
+uint64_t tmc_ramp_linear64_get_acceleration_limit(TMC_LinearRamp64 *linearRamp);
+uint32_t tmc_ramp_linear64_get_velocity_limit(TMC_LinearRamp64 *linearRamp);
+uint32_t tmc_ramp_linear64_get_homingDistance(TMC_LinearRamp64 *linearRamp);
+uint32_t tmc_ramp_linear64_get_stopVelocity(TMC_LinearRamp64 *linearRamp);
+
+#endif /* TMC_RAMP_LINEARRAMP64_H_ */
@@ -0,0 +1,252 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+
+#include "LinearRampBatch.h"
+#include "tmc/helpers/Functions.h"
+
+static inline void computeVelocity(TMC_LinearRampBatch *batch, uint32_t axis, bool useShift);
+static void computePosition(TMC_LinearRampBatch *batch, uint32_t axis);
+static bool canDriveOn(TMC_LinearRampBatch *batch, uint32_t axis, int32_t diffx);
+
+void tmc_ramp_linear_batch_init(TMC_LinearRampBatch *batch, uint32_t axes)
+{
+	TMC_LinearRamp linearRamp;
+
+	batch->axes = MIN(axes, TMC_RAMP_LINEAR_BATCH_MAX_AXES);
+	tmc_ramp_linear_batch_set_precision(batch, TMC_RAMP_LINEAR_DEFAULT_PRECISION);
+
+	tmc_ramp_linear_init(&linearRamp);
+	linearRamp.accelerationSteps = 0;
+
+	for(uint32_t i = 0; i < TMC_RAMP_LINEAR_BATCH_MAX_AXES; i++)
+	{
+		tmc_ramp_linear_batch_load(batch, i, &linearRamp);
+		batch->dx[i] = 0;
+	}
+}
+
+void tmc_ramp_linear_batch_set_precision(TMC_LinearRampBatch *batch, uint32_t precision)
+{
+	batch->precision = precision;
+	batch->precisionShift = tmc_ramp_linear_get_precision_shift(precision);
+}
+
+void tmc_ramp_linear_batch_load(TMC_LinearRampBatch *batch, uint32_t axis, const TMC_LinearRamp *linearRamp)
+{
+	if(axis >= TMC_RAMP_LINEAR_BATCH_MAX_AXES)
+		return;
+
+	batch->maxVelocity[axis]          = linearRamp->maxVelocity;
+	batch->targetPosition[axis]       = linearRamp->targetPosition;
+	batch->rampPosition[axis]         = linearRamp->rampPosition;
+	batch->targetVelocity[axis]       = linearRamp->targetVelocity;
+	batch->rampVelocity[axis]         = linearRamp->rampVelocity;
+	batch->acceleration[axis]         = linearRamp->acceleration;
+	batch->rampEnabled[axis]          = linearRamp->rampEnabled;
+	batch->multiStep[axis]            = linearRamp->multiStep;
+	batch->accumulatorVelocity[axis]  = linearRamp->accumulatorVelocity;
+	batch->accumulatorPosition[axis]  = linearRamp->accumulatorPosition;
+	batch->rampMode[axis]             = linearRamp->rampMode;
+	batch->state[axis]                = linearRamp->state;
+	batch->accelerationSteps[axis]    = linearRamp->accelerationSteps;
+	batch->homingDistance[axis]       = linearRamp->homingDistance;
+	batch->stopVelocity[axis]         = linearRamp->stopVelocity;
+}
+
+void tmc_ramp_linear_batch_store(const TMC_LinearRampBatch *batch, uint32_t axis, TMC_LinearRamp *linearRamp)
+{
+	if(axis >= TMC_RAMP_LINEAR_BATCH_MAX_AXES)
+		return;
+
+	linearRamp->maxVelocity          = batch->maxVelocity[axis];
+	linearRamp->targetPosition       = batch->targetPosition[axis];
+	linearRamp->rampPosition         = batch->rampPosition[axis];
+	linearRamp->targetVelocity       = batch->targetVelocity[axis];
+	linearRamp->rampVelocity         = batch->rampVelocity[axis];
+	linearRamp->acceleration         = batch->acceleration[axis];
+	linearRamp->rampEnabled          = batch->rampEnabled[axis];
+	linearRamp->multiStep            = batch->multiStep[axis];
+	linearRamp->accumulatorVelocity  = batch->accumulatorVelocity[axis];
+	linearRamp->accumulatorPosition  = batch->accumulatorPosition[axis];
+	linearRamp->rampMode             = batch->rampMode[axis];
+	linearRamp->state                = batch->state[axis];
+	linearRamp->accelerationSteps    = batch->accelerationSteps[axis];
+	linearRamp->homingDistance       = batch->homingDistance[axis];
+	linearRamp->stopVelocity         = batch->stopVelocity[axis];
+	tmc_ramp_linear_set_precision(linearRamp, batch->precision);
+}
+
+void tmc_ramp_linear_batch_compute(TMC_LinearRampBatch *batch)
+{
+	uint32_t axes = batch->axes;
+
+	// Position mode state machines (branching, only for axes in position mode)
+	for(uint32_t i = 0; i < axes; i++)
+	{
+		if(batch->rampEnabled[i] && batch->rampMode[i] == TMC_RAMP_LINEAR_MODE_POSITION)
+			computePosition(batch, i);
+	}
+
+	// Velocity and position accumulators (branch free, vectorizable)
+	if(tmc_ramp_linear_precision_shift_matches(batch->precisionShift, batch->precision))
+	{
+		for(uint32_t i = 0; i < axes; i++)
+			computeVelocity(batch, i, true);
+	}
+	else
+	{
+		for(uint32_t i = 0; i < axes; i++)
+			computeVelocity(batch, i, false);
+	}
+}
+
+// Same calculation as tmc_ramp_linear_compute_velocity(), with the branches replaced by selects.
+// [useShift] is a constant in both callers, so the compiler generates a separate loop for each.
+static inline void computeVelocity(TMC_LinearRampBatch *batch, uint32_t axis, bool useShift)
+{
+	const int32_t precision = batch->precision;
+	const int32_t shift     = batch->precisionShift;
+	const int32_t mask      = precision - 1;
+
+	int32_t rampVelocity   = batch->rampVelocity[axis];
+	int32_t targetVelocity = batch->targetVelocity[axis];
+	int32_t enabled        = batch->rampEnabled[axis];
+	int32_t multiStep      = batch->multiStep[axis];
+	int32_t accelerating   = rampVelocity != targetVelocity;
+
+	// Add current acceleration to accumulator (the division by precision is unsigned)
+	uint32_t accumulatorVelocity = (uint32_t)batch->accumulatorVelocity[axis] + (uint32_t)batch->acceleration[axis];
+	int32_t dv = useShift ? (int32_t)(accumulatorVelocity >> shift) : (int32_t)(accumulatorVelocity / (uint32_t)precision);
+	accumulatorVelocity = useShift ? (accumulatorVelocity & mask) : (accumulatorVelocity % (uint32_t)precision);
+
+	// Add dv to rampVelocity, and regulate to target velocity
+	int32_t increased = MIN(rampVelocity + dv, targetVelocity);
+	int32_t decreased = MAX(rampVelocity - dv, targetVelocity);
+	int32_t velocity  = (rampVelocity < targetVelocity) ? increased : (rampVelocity > targetVelocity) ? decreased : rampVelocity;
+
+	// Disabled ramps use the target velocity directly
+	velocity = enabled ? velocity : targetVelocity;
+	batch->rampVelocity[axis] = velocity;
+	batch->accumulatorVelocity[axis] = enabled ? (int32_t)accumulatorVelocity : 0;
+
+	// Position accumulator. The shift variant rounds towards zero like the division
+	// (requires an arithmetic right shift of negative values, as done by all common compilers).
+	int32_t accumulatorPosition = batch->accumulatorPosition[axis] + velocity;
+	int32_t dx = useShift ? ((accumulatorPosition + ((accumulatorPosition >> 31) & mask)) >> shift) : (accumulatorPosition / precision);
+	batch->accumulatorPosition[axis] = accumulatorPosition - dx * precision;
+
+	// Change actual position determined by position change
+	int32_t steps = multiStep ? abs(dx) : (dx != 0);
+	batch->rampPosition[axis] += (dx < 0) ? -steps : steps;
+
+	// Count acceleration steps needed for decelerating later. Multi step mode compares the
+	// velocity at the start of the tick and counts all steps of the tick.
+	int32_t accelerationSteps = batch->accelerationSteps[axis];
+	int32_t countVelocity = multiStep ? rampVelocity : velocity;
+	int32_t stepsDelta = (abs(countVelocity) < abs(targetVelocity)) ? accelerating : -accelerating;
+	int32_t newSteps = MAX(accelerationSteps + stepsDelta * steps, 0);
+	batch->accelerationSteps[axis] = (dx != 0) ? newSteps : accelerationSteps;
+
+	batch->dx[axis] = dx;
+}
+
+// Same state machine as tmc_ramp_linear_compute_position()
+static void computePosition(TMC_LinearRampBatch *batch, uint32_t axis)
+{
+	int32_t rampPosition   = batch->rampPosition[axis];
+	int32_t targetPosition = batch->targetPosition[axis];
+	int32_t rampVelocity   = batch->rampVelocity[axis];
+
+	// Calculate steps needed to target
+	int32_t diffx = 0;
+
+	switch(batch->state[axis]) {
+	case TMC_RAMP_LINEAR_STATE_IDLE:
+		if(rampVelocity == 0)
+			batch->accelerationSteps[axis] = 0;
+
+		if(rampPosition == targetPosition)
+			break;
+
+		batch->state[axis] = TMC_RAMP_LINEAR_STATE_DRIVING;
+		break;
+	case TMC_RAMP_LINEAR_STATE_DRIVING:
+		// Calculate distance to target (positive = driving towards target)
+		if(rampVelocity > 0)
+			diffx = targetPosition - rampPosition;
+		else if(rampVelocity < 0)
+			diffx = -(targetPosition - rampPosition);
+		else
+			diffx = abs(targetPosition - rampPosition);
+
+		// Steps left required for braking?
+		// (+ 1 to compensate rounding (flooring) errors of the position accumulator,
+		// see tmc_ramp_linear_can_drive_on() for the multi step mode)
+		if(!canDriveOn(batch, axis, diffx))
+		{
+			batch->targetVelocity[axis] = 0;
+			batch->state[axis] = TMC_RAMP_LINEAR_STATE_BRAKING;
+		}
+		else
+		{	// Driving - apply VMAX (this also allows mid-ramp VMAX changes)
+			batch->targetVelocity[axis] = (targetPosition > rampPosition) ? batch->maxVelocity[axis] : -batch->maxVelocity[axis];
+		}
+		break;
+	case TMC_RAMP_LINEAR_STATE_BRAKING:
+		if(targetPosition == rampPosition)
+		{
+			if(abs(rampVelocity) <= batch->stopVelocity[axis])
+			{	// Position reached, velocity within cutoff threshold (or zero)
+				batch->rampVelocity[axis] = 0;
+				batch->targetVelocity[axis] = 0;
+				batch->state[axis] = TMC_RAMP_LINEAR_STATE_IDLE;
+			}
+		}
+		else
+		{	// We're not at the target position
+			if(rampVelocity != 0)
+			{	// Still decelerating
+
+				// Calculate distance to target (positive = driving towards target)
+				if(rampVelocity > 0)
+					diffx = targetPosition - rampPosition;
+				else
+					diffx = -(targetPosition - rampPosition);
+
+				// Enough space to accelerate again?
+				// (+ 1 to compensate rounding (flooring) errors of the position accumulator)
+				if(canDriveOn(batch, axis, diffx))
+				{
+					batch->state[axis] = TMC_RAMP_LINEAR_STATE_DRIVING;
+				}
+			}
+			else
+			{	// Standing still (not at the target position)
+				// Multi step mode may stop farther away than a first tick drives, a new ramp would brake at once
+				if(abs(targetPosition - rampPosition) <= batch->homingDistance[axis]
+				|| (batch->multiStep[axis] && !canDriveOn(batch, axis, abs(targetPosition - rampPosition))))
+				{	// Within homing distance - drive with stop velocity
+					batch->targetVelocity[axis] = (targetPosition > rampPosition)? batch->stopVelocity[axis] : -batch->stopVelocity[axis];
+				}
+				else
+				{	// Not within homing distance - start a new motion by switching to RAMP_IDLE
+					// Since (targetPosition != actualPosition) a new ramp will be started.
+					batch->state[axis] = TMC_RAMP_LINEAR_STATE_IDLE;
+				}
+			}
+		}
+		break;
+	}
+}
+
+// Same as canDriveOn() of LinearRamp1
+static bool canDriveOn(TMC_LinearRampBatch *batch, uint32_t axis, int32_t diffx)
+{
+	if(!batch->multiStep[axis])
+		return batch->accelerationSteps[axis] + 1 < diffx;
+
+	return tmc_ramp_linear_can_drive_on(abs(batch->rampVelocity[axis]), batch->maxVelocity[axis], batch->acceleration[axis],
+			batch->precision, batch->precisionShift, diffx);
+}
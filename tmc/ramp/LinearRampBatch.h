@@ -0,0 +1,80 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+
+#ifndef TMC_RAMP_LINEARRAMPBATCH_H_
+#define TMC_RAMP_LINEARRAMPBATCH_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+/*
+ *  Batch version of the linear ramp (LinearRamp1) for many axes.
+ *
+ *  The ramp states of all axes are stored as structure of arrays, so one tick of
+ *  all axes is computed with a few loops over plain integer arrays. These loops
+ *  are branch free and can be vectorized by the compiler (e.g. SSE/AVX, NEON),
+ *  which requires auto-vectorization to be enabled (GCC: -O3 or -ftree-vectorize).
+ *  Without SIMD support, the same loops run as plain scalar code.
+ *  Each axis gives exactly the same results as tmc_ramp_linear_compute() with
+ *  the same parameters.
+ *
+ *  All axes of a batch share one precision value. With a power of two precision
+ *  (e.g. TMC_RAMP_LINEAR_DEFAULT_PRECISION) the divisions are replaced by shifts,
+ *  which is required for the vectorized code. Other precision values use the
+ *  regular divisions.
+ *
+ *  The multi step mode of the linear ramp (tmc_ramp_linear_set_multiStep) is set
+ *  per axis with the multiStep array. Axes without it move by at most one
+ *  position per tick.
+ *
+ *  The per-axis arrays may be read and written directly. Alternatively, axes can
+ *  be converted from and to TMC_LinearRamp with tmc_ramp_linear_batch_load() and
+ *  tmc_ramp_linear_batch_store().
+ */
+
+// Maximum amount of axes per batch
+#ifndef TMC_RAMP_LINEAR_BATCH_MAX_AXES
+#define TMC_RAMP_LINEAR_BATCH_MAX_AXES 32
+#endif
+
+typedef struct
+{
+	uint32_t axes;
+	uint32_t precision;
+	int32_t precisionShift;  // log2(precision) for power of two precision values, -1 otherwise
+
+	// Per axis ramp state, see TMC_LinearRamp
+	uint32_t maxVelocity[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t targetPosition[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t rampPosition[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t targetVelocity[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t rampVelocity[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t acceleration[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t accumulatorVelocity[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t accumulatorPosition[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t accelerationSteps[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	uint32_t homingDistance[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	uint32_t stopVelocity[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t rampEnabled[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t multiStep[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t rampMode[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+	int32_t state[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+
+	// Position change of the last tick per axis (return value of tmc_ramp_linear_compute())
+	int32_t dx[TMC_RAMP_LINEAR_BATCH_MAX_AXES];
+} TMC_LinearRampBatch;
+
+// Initializes [axes] axes like tmc_ramp_linear_init() with the default precision
+void tmc_ramp_linear_batch_init(TMC_LinearRampBatch *batch, uint32_t axes);
+void tmc_ramp_linear_batch_set_precision(TMC_LinearRampBatch *batch, uint32_t precision);
+
+// Copies an axis from/to a TMC_LinearRamp. The precision of the batch is not changed by loading an axis.
+void tmc_ramp_linear_batch_load(TMC_LinearRampBatch *batch, uint32_t axis, const TMC_LinearRamp *linearRamp);
+void tmc_ramp_linear_batch_store(const TMC_LinearRampBatch *batch, uint32_t axis, TMC_LinearRamp *linearRamp);
+
+// Computes one tick for all axes, the position changes are stored in batch->dx
+void tmc_ramp_linear_batch_compute(TMC_LinearRampBatch *batch);
+
+#endif /* TMC_RAMP_LINEARRAMPBATCH_H_ */
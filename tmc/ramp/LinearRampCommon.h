@@ -0,0 +1,72 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+
+#ifndef TMC_RAMP_LINEARRAMPCOMMON_H_
+#define TMC_RAMP_LINEARRAMPCOMMON_H_
+
+#include "tmc/helpers/API_Header.h"
+
+// Definitions shared by the linear ramp types (LinearRamp1, LinearRamp64, LinearRampBatch).
+// Kept apart from LinearRamp1.h, so LinearRamp64.h does not need LinearRamp1.h, which includes Ramp.h.
+
+// Default precision of the calculations. Internal calculations use a precision
+// of 1/TMC_RAMP_LINEAR_PRECISION for acceleration and velocity.
+// When using 2**N as precision, this results in N digits of precision.
+#define TMC_RAMP_LINEAR_DEFAULT_PRECISION ((uint32_t)1<<17)
+
+// Position mode: When hitting the target position a velocity below the V_STOP threshold will be cut off to velocity 0
+#define TMC_RAMP_LINEAR_DEFAULT_HOMING_DISTANCE 5
+
+// Position mode: When barely missing the target position by HOMING_DISTANCE or less, the remainder will be driven with V_STOP velocity
+#define TMC_RAMP_LINEAR_DEFAULT_STOP_VELOCITY 5
+
+typedef enum {
+	TMC_RAMP_LINEAR_MODE_VELOCITY,
+	TMC_RAMP_LINEAR_MODE_POSITION
+} TMC_LinearRamp_Mode;
+
+typedef enum {
+	TMC_RAMP_LINEAR_STATE_IDLE,
+	TMC_RAMP_LINEAR_STATE_DRIVING,
+	TMC_RAMP_LINEAR_STATE_BRAKING
+} TMC_LinearRamp_State;
+
+// Power of two precision values allow replacing the divisions of the ramp calculations with shifts.
+// Returns log2(precision) for powers of two below 2^31, -1 otherwise. Implemented in LinearRamp1.c.
+int8_t tmc_ramp_linear_get_precision_shift(uint32_t precision);
+
+// The precision might have been written directly, so a stored shift is only used if it still matches
+static inline bool tmc_ramp_linear_precision_shift_matches(int8_t precisionShift, uint32_t precision)
+{
+	return precisionShift >= 0 && precisionShift < 31 && ((uint32_t)1 << precisionShift) == precision;
+}
+
+// Multi step mode braking check of the position mode: Returns whether the ramp can drive on towards
+// the target for one more tick (diffx steps away) and still brake in time.
+// Braking from the velocity v takes v * (v - dv) / (2 * acceleration) steps, dv being the velocity
+// change per tick. This is compared with the distance left after the steps of the next tick, using
+// multiplications only. Counting the acceleration steps like the single step mode is off by up to
+// the steps of a tick, which in multi step mode are many.
+static inline bool tmc_ramp_linear_can_drive_on(uint32_t velocity, uint32_t maxVelocity, uint32_t acceleration, uint32_t precision, int8_t precisionShift, int32_t diffx)
+{
+	bool useShift = tmc_ramp_linear_precision_shift_matches(precisionShift, precision);
+	uint32_t dv = (useShift) ? acceleration >> precisionShift : acceleration / precision;
+
+	// Highest velocity of the next tick (the velocity accumulator adds less than one precision unit)
+	if(velocity < maxVelocity)
+		velocity = (maxVelocity - velocity > dv + 1) ? velocity + dv + 1 : maxVelocity;
+
+	// Steps of the next tick, rounded up
+	uint32_t steps = ((useShift) ? velocity >> precisionShift : velocity / precision) + 1;
+
+	if(diffx <= (int32_t)steps)
+		return false;
+
+	uint64_t brakingVelocity = (velocity > dv) ? (uint64_t)velocity * (velocity - dv) : 0;
+
+	return brakingVelocity < 2 * (uint64_t)acceleration * (uint32_t)(diffx - steps);
+}
+
+#endif /* TMC_RAMP_LINEARRAMPCOMMON_H_ */
@@ -0,0 +1,221 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+
+#include "MotionPlanner.h"
+#include "tmc/helpers/Functions.h"
+
+static TMC_MotionSegment *getSegment(TMC_MotionPlanner *planner, uint8_t index);
+static int32_t getStart(TMC_MotionPlanner *planner, uint8_t index);
+static int32_t getDirection(TMC_MotionPlanner *planner, uint8_t index);
+static void plan(TMC_MotionPlanner *planner);
+static uint32_t getReachableVelocity(TMC_MotionPlanner *planner, uint32_t endVelocity, uint32_t distance);
+static uint32_t getPlanningDistance(TMC_MotionPlanner *planner, uint32_t distance);
+
+void tmc_motion_planner_init(TMC_MotionPlanner *planner, int32_t position, uint32_t acceleration, uint8_t distanceShift)
+{
+	planner->first          = 0;
+	planner->count          = 0;
+	planner->startPosition  = position;
+	planner->acceleration   = acceleration;
+	planner->distanceShift  = distanceShift;
+	planner->maxVelocity    = 0;
+	planner->updateDistance = 0;
+}
+
+bool tmc_motion_planner_addSegment(TMC_MotionPlanner *planner, int32_t position, uint32_t maxVelocity)
+{
+	if(planner->count >= TMC_MOTION_PLANNER_QUEUE_LENGTH)
+		return false;
+
+	TMC_MotionSegment *segment = getSegment(planner, planner->count);
+	segment->position          = position;
+	segment->maxVelocity       = maxVelocity;
+	segment->junctionVelocity  = 0;
+	planner->count++;
+
+	plan(planner);
+
+	return true;
+}
+
+void tmc_motion_planner_update(TMC_MotionPlanner *planner, int32_t actualPosition, bool targetReached, int32_t *targetPosition, uint32_t *maxVelocity)
+{
+	// Remove the segments that have been passed
+	while(planner->count > 0)
+	{
+		TMC_MotionSegment *segment = getSegment(planner, 0);
+		int32_t direction = getDirection(planner, 0);
+
+		if(direction > 0 && actualPosition < segment->position)
+			break;
+
+		if(direction < 0 && actualPosition > segment->position)
+			break;
+
+		// Stops are only left once the ramp has finished them
+		if(segment->junctionVelocity == 0 && !targetReached)
+			break;
+
+		planner->startPosition = segment->position;
+		planner->first = (planner->first + 1) % TMC_MOTION_PLANNER_QUEUE_LENGTH;
+		planner->count--;
+	}
+
+	if(planner->count == 0)
+	{	// Hold the last waypoint
+		*targetPosition = planner->startPosition;
+		*maxVelocity = planner->maxVelocity;
+		return;
+	}
+
+	// Drive to the next waypoint with a junction velocity of zero
+	uint8_t last = 0;
+	while(getSegment(planner, last)->junctionVelocity != 0)
+		last++;
+
+	*targetPosition = getSegment(planner, last)->position;
+
+	// Limit the velocity, so the end of the current segment is passed with its junction velocity.
+	// Stops at the target position are left to the ramp.
+	TMC_MotionSegment *segment = getSegment(planner, 0);
+	planner->maxVelocity = segment->maxVelocity;
+	if(segment->junctionVelocity != 0)
+	{
+		uint32_t distance = getPlanningDistance(planner, abs(segment->position - actualPosition));
+		planner->maxVelocity = MIN(planner->maxVelocity, getReachableVelocity(planner, segment->junctionVelocity, distance));
+	}
+
+	*maxVelocity = planner->maxVelocity;
+}
+
+int32_t tmc_motion_planner_compute(TMC_MotionPlanner *planner, TMC_LinearRamp *linearRamp)
+{
+	int32_t targetPosition;
+	uint32_t maxVelocity;
+
+	bool targetReached = linearRamp->state == TMC_RAMP_LINEAR_STATE_IDLE && linearRamp->rampPosition == linearRamp->targetPosition;
+
+	// A lowered velocity limit is applied in the next tick and reduces the velocity from the one
+	// after, up to two ticks of steps (velocity / precision + 1 each) are driven until then
+	uint32_t velocity = abs(linearRamp->rampVelocity);
+	uint32_t highestVelocity = velocity;
+	for(uint8_t i = 0; i < planner->count; i++)
+		highestVelocity = MAX(highestVelocity, getSegment(planner, i)->maxVelocity);
+
+	tmc_motion_planner_setUpdateDistance(planner, 2 * (highestVelocity / linearRamp->precision + 1));
+
+	tmc_motion_planner_update(planner, linearRamp->rampPosition, targetReached, &targetPosition, &maxVelocity);
+
+	tmc_ramp_linear_set_mode(linearRamp, TMC_RAMP_LINEAR_MODE_POSITION);
+	tmc_ramp_linear_set_acceleration(linearRamp, planner->acceleration);
+	tmc_ramp_linear_set_targetPosition(linearRamp, targetPosition);
+	tmc_ramp_linear_set_maxVelocity(linearRamp, maxVelocity);
+
+	// The ramp finds its braking point by counting the steps of its acceleration. Changing the
+	// velocity limit on every waypoint lets that count drift, so it is replaced with the
+	// braking distance of the actual velocity: velocity^2 / (2 * acceleration). Multi step mode
+	// computes that braking distance itself (see tmc_ramp_linear_can_drive_on()).
+	if(planner->acceleration != 0 && !linearRamp->multiStep)
+	{
+		uint64_t steps = ((uint64_t)velocity * velocity + 2 * (uint64_t)planner->acceleration - 1) / (2 * (uint64_t)planner->acceleration);
+		linearRamp->accelerationSteps = MIN(steps, INT32_MAX);
+	}
+
+	return tmc_ramp_linear_compute(linearRamp);
+}
+
+void tmc_motion_planner_setUpdateDistance(TMC_MotionPlanner *planner, uint32_t updateDistance)
+{
+	if(planner->updateDistance == updateDistance)
+		return;
+
+	planner->updateDistance = updateDistance;
+
+	if(planner->count > 0)
+		plan(planner);
+}
+
+void tmc_motion_planner_clear(TMC_MotionPlanner *planner, int32_t position)
+{
+	planner->count = 0;
+	planner->startPosition = position;
+}
+
+uint8_t tmc_motion_planner_getCount(TMC_MotionPlanner *planner)
+{
+	return planner->count;
+}
+
+bool tmc_motion_planner_isFull(TMC_MotionPlanner *planner)
+{
+	return planner->count >= TMC_MOTION_PLANNER_QUEUE_LENGTH;
+}
+
+static TMC_MotionSegment *getSegment(TMC_MotionPlanner *planner, uint8_t index)
+{
+	return &planner->segments[(planner->first + index) % TMC_MOTION_PLANNER_QUEUE_LENGTH];
+}
+
+static int32_t getStart(TMC_MotionPlanner *planner, uint8_t index)
+{
+	return (index == 0) ? planner->startPosition : getSegment(planner, index - 1)->position;
+}
+
+static int32_t getDirection(TMC_MotionPlanner *planner, uint8_t index)
+{
+	int32_t start = getStart(planner, index);
+	int32_t end = getSegment(planner, index)->position;
+
+	return (end > start) ? 1 : (end < start) ? -1 : 0;
+}
+
+// Look-ahead: Computes the junction velocities backwards from the last queued waypoint,
+// which has to be reached with velocity zero. Every junction velocity is limited by the
+// velocity from which the next junction velocity can still be reached within the next segment.
+// Accelerating is left to the ramp, so no forward pass is needed.
+static void plan(TMC_MotionPlanner *planner)
+{
+	getSegment(planner, planner->count - 1)->junctionVelocity = 0;
+
+	for(int32_t i = planner->count - 2; i >= 0; i--)
+	{
+		TMC_MotionSegment *segment = getSegment(planner, i);
+		TMC_MotionSegment *next = getSegment(planner, i + 1);
+		int32_t direction = getDirection(planner, i);
+
+		// Stop at reversals and zero length segments
+		if(direction == 0 || direction != getDirection(planner, i + 1))
+		{
+			segment->junctionVelocity = 0;
+			continue;
+		}
+
+		uint32_t velocity = MIN(segment->maxVelocity, next->maxVelocity);
+		uint32_t distance = getPlanningDistance(planner, abs(next->position - segment->position));
+		segment->junctionVelocity = MIN(velocity, getReachableVelocity(planner, next->junctionVelocity, distance));
+	}
+}
+
+// Distance left for slowing down: the axis moves up to [updateDistance] positions
+// before a lowered velocity limit takes effect
+static uint32_t getPlanningDistance(TMC_MotionPlanner *planner, uint32_t distance)
+{
+	return (distance > planner->updateDistance) ? distance - planner->updateDistance : 0;
+}
+
+// Highest velocity from which [endVelocity] can be reached within [distance] positions:
+// sqrt(endVelocity^2 + 2 * acceleration * distance << distanceShift), saturated to 32 bit
+static uint32_t getReachableVelocity(TMC_MotionPlanner *planner, uint32_t endVelocity, uint32_t distance)
+{
+	uint64_t velocitySquared = (uint64_t)endVelocity * endVelocity;
+	uint64_t limit = (UINT64_MAX - velocitySquared) >> (planner->distanceShift + 1);
+
+	if(planner->acceleration != 0 && distance > limit / planner->acceleration)
+		return UINT32_MAX;
+
+	velocitySquared += ((uint64_t)planner->acceleration * distance) << (planner->distanceShift + 1);
+
+	return tmc_sqrti64(velocitySquared);
+}
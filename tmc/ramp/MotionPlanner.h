@@ -0,0 +1,96 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+
+#ifndef TMC_RAMP_MOTIONPLANNER_H_
+#define TMC_RAMP_MOTIONPLANNER_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+/*
+ *  Multi segment motion planner with velocity look-ahead for one axis.
+ *
+ *  Segments (target position + maximum velocity) are queued with
+ *  tmc_motion_planner_addSegment(). For every queued waypoint the planner computes
+ *  the junction velocity: the velocity the axis may still have when passing it.
+ *  Waypoints where the direction reverses and the last queued waypoint have a
+ *  junction velocity of zero, all others are limited by the maximum velocities of
+ *  both segments and by the distance to the following waypoints (look-ahead), so
+ *  the axis can always stop at the end of the queue.
+ *
+ *  Consecutive segments in the same direction are driven as one move without
+ *  stopping: The target position is the last waypoint before the next stop, the
+ *  maximum velocity is lowered on the way, so every waypoint is passed with at most
+ *  its junction velocity. tmc_motion_planner_update() computes these two values
+ *  from the actual position, they can be written to
+ *  - a linear ramp in position mode (tmc_motion_planner_compute() does this), or
+ *  - the internal ramp of a TMC5xxx in positioning mode (XTARGET, VMAX). AMAX and
+ *    DMAX of the IC have to be set to the acceleration of the planner. Use
+ *    TMC_MOTION_PLANNER_TMC5XXX_DISTANCE_SHIFT for the internal ramp units, call
+ *    the update at least every few milliseconds and set the distance the axis
+ *    moves in between with tmc_motion_planner_setUpdateDistance().
+ *
+ *  Velocities and the acceleration use the units of the ramp they are written to.
+ */
+
+// Amount of segments that can be queued
+#ifndef TMC_MOTION_PLANNER_QUEUE_LENGTH
+#define TMC_MOTION_PLANNER_QUEUE_LENGTH 16
+#endif
+
+// Braking distance = velocity^2 / (2 * acceleration) >> distanceShift
+// Linear ramp (TMC_LinearRamp): The precision cancels out
+#define TMC_MOTION_PLANNER_LINEAR_RAMP_DISTANCE_SHIFT  0
+// Internal ramp of the TMC5xxx (VMAX/AMAX units, independent of the clock frequency)
+#define TMC_MOTION_PLANNER_TMC5XXX_DISTANCE_SHIFT      7
+
+typedef struct
+{
+	int32_t position;            // End of the segment (waypoint)
+	uint32_t maxVelocity;
+	uint32_t junctionVelocity;   // Planned velocity when passing the end of the segment
+} TMC_MotionSegment;
+
+typedef struct
+{
+	TMC_MotionSegment segments[TMC_MOTION_PLANNER_QUEUE_LENGTH];
+	uint8_t first;               // Index of the current segment
+	uint8_t count;
+	int32_t startPosition;       // Start of the current segment (end of the previous one)
+	uint32_t acceleration;
+	uint8_t distanceShift;
+	uint32_t maxVelocity;        // Last velocity limit returned by tmc_motion_planner_update()
+	uint32_t updateDistance;     // Positions the axis can move until a velocity limit takes effect
+} TMC_MotionPlanner;
+
+void tmc_motion_planner_init(TMC_MotionPlanner *planner, int32_t position, uint32_t acceleration, uint8_t distanceShift);
+
+// Queues a segment from the previous waypoint to [position].
+// Returns false if the queue is full.
+bool tmc_motion_planner_addSegment(TMC_MotionPlanner *planner, int32_t position, uint32_t maxVelocity);
+
+// Computes the target position and the maximum velocity for the ramp at [actualPosition]
+// and removes the segments that have been passed. Waypoints with a junction velocity of zero
+// are only removed once [targetReached] is set: the ramp is standing still at its target
+// position (TMC5xxx: position_reached flag of RAMP_STAT).
+void tmc_motion_planner_update(TMC_MotionPlanner *planner, int32_t actualPosition, bool targetReached, int32_t *targetPosition, uint32_t *maxVelocity);
+
+// Runs the planner on a linear ramp: Updates the ramp targets (position mode) and computes one tick.
+// Returns the position change like tmc_ramp_linear_compute().
+int32_t tmc_motion_planner_compute(TMC_MotionPlanner *planner, TMC_LinearRamp *linearRamp);
+
+// Sets the positions the axis can move between two updates until a lowered velocity limit
+// takes effect. The junction velocities and velocity limits are planned that much earlier.
+// TMC5xxx: the distance driven at the highest velocity within the update interval.
+// tmc_motion_planner_compute() sets it for the linear ramp.
+void tmc_motion_planner_setUpdateDistance(TMC_MotionPlanner *planner, uint32_t updateDistance);
+
+// Removes all queued segments, the current position becomes the start of the next segment
+void tmc_motion_planner_clear(TMC_MotionPlanner *planner, int32_t position);
+
+uint8_t tmc_motion_planner_getCount(TMC_MotionPlanner *planner);
+bool tmc_motion_planner_isFull(TMC_MotionPlanner *planner);
+
+#endif /* TMC_RAMP_MOTIONPLANNER_H_ */
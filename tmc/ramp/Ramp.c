@@ -11,6 +11,12 @@
 void tmc_ramp_init(void *ramp, TMC_RampType type)
 {
 	switch(type) {
+	case TMC_RAMP_TYPE_SCURVE:
+		tmc_ramp_scurve_init((TMC_SCurveRamp *)ramp);
+		break;
+	case TMC_RAMP_TYPE_LINEAR64:
+		tmc_ramp_linear64_init((TMC_LinearRamp64 *)ramp);
+		break;
 	case TMC_RAMP_TYPE_LINEAR:
 	default:
 		tmc_ramp_linear_init((TMC_LinearRamp *)ramp);
@@ -24,11 +30,31 @@ int32_t tmc_ramp_compute(void *ramp, TMC_RampType type, uint32_t delta)
 	int32_t dxSum = 0;
 
 	switch(type) {
+	case TMC_RAMP_TYPE_SCURVE:
+		for (i = 0; i < delta; i++)
+		{
+			dxSum += tmc_ramp_scurve_compute((TMC_SCurveRamp *)ramp);
+		}
+		break;
+	case TMC_RAMP_TYPE_LINEAR64:
+		for (i = 0; i < delta; i++)
+		{
+			dxSum += tmc_ramp_linear64_compute((TMC_LinearRamp64 *)ramp);
+		}
+		break;
 	case TMC_RAMP_TYPE_LINEAR:
 	default:
-		for (i = 0; i < delta; i++)
+		// The closed-form advance only pays off for longer intervals
+		if (delta < TMC_RAMP_LINEAR_ADVANCE_MIN_TICKS)
 		{
-			dxSum += tmc_ramp_linear_compute((TMC_LinearRamp *)ramp);
+			for (i = 0; i < delta; i++)
+			{
+				dxSum += tmc_ramp_linear_compute((TMC_LinearRamp *)ramp);
+			}
+		}
+		else
+		{
+			dxSum = tmc_ramp_linear_advance((TMC_LinearRamp *)ramp, delta);
 		}
 		break;
 	}
@@ -43,6 +69,12 @@ int32_t tmc_ramp_get_rampVelocity(void *ramp, TMC_RampType type)
 	case TMC_RAMP_TYPE_LINEAR:
 		v = tmc_ramp_linear_get_rampVelocity((TMC_LinearRamp *)ramp);
 		break;
+	case TMC_RAMP_TYPE_SCURVE:
+		v = tmc_ramp_scurve_get_rampVelocity((TMC_SCurveRamp *)ramp);
+		break;
+	case TMC_RAMP_TYPE_LINEAR64:
+		v = tmc_ramp_linear64_get_rampVelocity((TMC_LinearRamp64 *)ramp);
+		break;
 	}
 	return v;
 }
@@ -54,6 +86,12 @@ int32_t tmc_ramp_get_rampPosition(void *ramp, TMC_RampType type)
 	case TMC_RAMP_TYPE_LINEAR:
 		x = tmc_ramp_linear_get_rampPosition((TMC_LinearRamp *)ramp);
 		break;
+	case TMC_RAMP_TYPE_SCURVE:
+		x = tmc_ramp_scurve_get_rampPosition((TMC_SCurveRamp *)ramp);
+		break;
+	case TMC_RAMP_TYPE_LINEAR64:
+		x = (int32_t)tmc_ramp_linear64_get_rampPosition((TMC_LinearRamp64 *)ramp);
+		break;
 	}
 	return x;
 }
@@ -65,6 +103,12 @@ bool tmc_ramp_get_enabled(void *ramp, TMC_RampType type)
 	case TMC_RAMP_TYPE_LINEAR:
 		enabled = tmc_ramp_linear_get_enabled((TMC_LinearRamp *)ramp);
 		break;
+	case TMC_RAMP_TYPE_SCURVE:
+		enabled = tmc_ramp_scurve_get_enabled((TMC_SCurveRamp *)ramp);
+		break;
+	case TMC_RAMP_TYPE_LINEAR64:
+		enabled = tmc_ramp_linear64_get_enabled((TMC_LinearRamp64 *)ramp);
+		break;
 	}
 	return enabled;
 }
@@ -72,6 +116,12 @@ bool tmc_ramp_get_enabled(void *ramp, TMC_RampType type)
 void tmc_ramp_set_enabled(void *ramp, TMC_RampType type, bool enabled)
 {
 	switch(type) {
+	case TMC_RAMP_TYPE_SCURVE:
+		tmc_ramp_scurve_set_enabled((TMC_SCurveRamp *)ramp, enabled);
+		break;
+	case TMC_RAMP_TYPE_LINEAR64:
+		tmc_ramp_linear64_set_enabled((TMC_LinearRamp64 *)ramp, enabled);
+		break;
 	case TMC_RAMP_TYPE_LINEAR:
 	default:
 		tmc_ramp_linear_set_enabled((TMC_LinearRamp *)ramp, enabled);
@@ -82,6 +132,12 @@ void tmc_ramp_set_enabled(void *ramp, TMC_RampType type, bool enabled)
 void tmc_ramp_toggle_enabled(void *ramp, TMC_RampType type)
 {
 	switch(type) {
+	case TMC_RAMP_TYPE_SCURVE:
+		tmc_ramp_scurve_set_enabled((TMC_SCurveRamp *)ramp, !tmc_ramp_get_enabled(ramp, type));
+		break;
+	case TMC_RAMP_TYPE_LINEAR64:
+		tmc_ramp_linear64_set_enabled((TMC_LinearRamp64 *)ramp, !tmc_ramp_get_enabled(ramp, type));
+		break;
 	case TMC_RAMP_TYPE_LINEAR:
 	default:
 		tmc_ramp_linear_set_enabled((TMC_LinearRamp *)ramp, !tmc_ramp_get_enabled(ramp, type));
@@ -10,9 +10,13 @@
 #define TMC_RAMP_RAMP_H_
 
 #include "LinearRamp1.h"
+#include "SCurveRamp.h"
+#include "LinearRamp64.h"
 
 typedef enum {
-	TMC_RAMP_TYPE_LINEAR
+	TMC_RAMP_TYPE_LINEAR,
+	TMC_RAMP_TYPE_SCURVE,
+	TMC_RAMP_TYPE_LINEAR64
 } TMC_RampType;
 
 // Initializes ramp parameters for given type
@@ -29,6 +33,7 @@ int32_t tmc_ramp_compute(void *ramp, TMC_RampType type, uint32_t delta);
 int32_t tmc_ramp_get_rampVelocity(void *ramp, TMC_RampType type);
 
 // Returns the current ramp position computed by the given ramp
+// (TMC_RAMP_TYPE_LINEAR64: the lower 32 bits, wrapping around like the position registers of the ICs)
 int32_t tmc_ramp_get_rampPosition(void *ramp, TMC_RampType type);
 
 // Enable/disable ramps
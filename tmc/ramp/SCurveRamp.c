@@ -0,0 +1,856 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+
+#include "SCurveRamp.h"
+#include "tmc/helpers/Functions.h"
+
+#define Q16_SATURATED  ((uint64_t)1 << 62)
+
+static uint64_t getReductionVelocity(TMC_SCurveRamp *sCurveRamp);
+static int32_t getTargetAcceleration(TMC_SCurveRamp *sCurveRamp);
+static void planMove(TMC_SCurveRamp *sCurveRamp, int32_t diffx);
+static void startBraking(TMC_SCurveRamp *sCurveRamp, int64_t remainder);
+static uint64_t getMoveDistance(TMC_SCurveRamp *sCurveRamp, uint64_t peakVelocity, uint64_t v, int64_t a);
+static uint64_t getStopDistance(TMC_SCurveRamp *sCurveRamp, uint64_t v, int64_t a);
+static uint64_t getDecelerationDistance(TMC_SCurveRamp *sCurveRamp, uint64_t v, int64_t a, uint64_t *brakingTime);
+static uint64_t getBrakingDistance(uint64_t v, uint64_t d, uint64_t maxA, uint64_t j, uint64_t *brakingTime);
+static uint64_t divCeil(uint64_t a, uint64_t b);
+static uint64_t mulSaturated(uint64_t a, uint64_t b);
+static uint64_t addQ16(uint64_t a, uint64_t b);
+static uint64_t ratioQ16(uint64_t numerator, uint64_t denominator);
+static uint64_t mulQ16(uint64_t a, uint64_t b);
+static uint64_t sqrtQ16(uint64_t x);
+static uint64_t sqrtCeil(uint64_t x);
+
+void tmc_ramp_scurve_init(TMC_SCurveRamp *sCurveRamp)
+{
+	sCurveRamp->maxVelocity             = 0;
+	sCurveRamp->targetPosition          = 0;
+	sCurveRamp->targetVelocity          = 0;
+	sCurveRamp->rampVelocity            = 0;
+	sCurveRamp->rampPosition            = 0;
+	sCurveRamp->acceleration            = 0;
+	sCurveRamp->rampAcceleration        = 0;
+	sCurveRamp->jerk                    = 0;
+	sCurveRamp->rampEnabled             = true;
+	sCurveRamp->accumulatorAcceleration = 0;
+	sCurveRamp->accumulatorVelocity     = 0;
+	sCurveRamp->accumulatorPosition     = 0;
+	sCurveRamp->rampMode                = TMC_RAMP_SCURVE_MODE_VELOCITY;
+	sCurveRamp->state                   = TMC_RAMP_SCURVE_STATE_IDLE;
+	sCurveRamp->planned                 = false;
+	sCurveRamp->exactBraking            = false;
+	sCurveRamp->plannedTarget           = 0;
+	sCurveRamp->accelerationTicks       = 0;
+	sCurveRamp->accelerationSum         = 0;
+	sCurveRamp->brakingDistance         = 0;
+	sCurveRamp->correctionVelocity      = 0;
+	sCurveRamp->correctionRemainder     = 0;
+	sCurveRamp->correctionAccumulator   = 0;
+	sCurveRamp->precision               = TMC_RAMP_SCURVE_DEFAULT_PRECISION;
+	sCurveRamp->homingDistance          = TMC_RAMP_SCURVE_DEFAULT_HOMING_DISTANCE;
+	sCurveRamp->stopVelocity            = TMC_RAMP_SCURVE_DEFAULT_STOP_VELOCITY;
+}
+
+void tmc_ramp_scurve_set_enabled(TMC_SCurveRamp *sCurveRamp, bool enabled)
+{
+	sCurveRamp->rampEnabled = enabled;
+}
+
+void tmc_ramp_scurve_set_maxVelocity(TMC_SCurveRamp *sCurveRamp, uint32_t maxVelocity)
+{
+	// A lower maximum velocity is applied right away, a higher one with the next move
+	if(maxVelocity < sCurveRamp->maxVelocity)
+		sCurveRamp->planned = false;
+
+	sCurveRamp->maxVelocity = maxVelocity;
+}
+
+void tmc_ramp_scurve_set_targetPosition(TMC_SCurveRamp *sCurveRamp, int32_t targetPosition)
+{
+	sCurveRamp->targetPosition = targetPosition;
+}
+
+void tmc_ramp_scurve_set_rampPosition(TMC_SCurveRamp *sCurveRamp, int32_t rampPosition)
+{
+	sCurveRamp->rampPosition = rampPosition;
+	sCurveRamp->planned = false;
+}
+
+void tmc_ramp_scurve_set_targetVelocity(TMC_SCurveRamp *sCurveRamp, int32_t targetVelocity)
+{
+	sCurveRamp->targetVelocity = targetVelocity;
+}
+
+void tmc_ramp_scurve_set_rampVelocity(TMC_SCurveRamp *sCurveRamp, int32_t rampVelocity)
+{
+	sCurveRamp->rampVelocity = rampVelocity;
+	sCurveRamp->planned = false;
+}
+
+void tmc_ramp_scurve_set_acceleration(TMC_SCurveRamp *sCurveRamp, int32_t acceleration)
+{
+	if(acceleration != sCurveRamp->acceleration)
+		sCurveRamp->planned = false;
+
+	sCurveRamp->acceleration = acceleration;
+}
+
+void tmc_ramp_scurve_set_jerk(TMC_SCurveRamp *sCurveRamp, int32_t jerk)
+{
+	if(jerk != sCurveRamp->jerk)
+		sCurveRamp->planned = false;
+
+	sCurveRamp->jerk = jerk;
+}
+
+void tmc_ramp_scurve_set_mode(TMC_SCurveRamp *sCurveRamp, TMC_SCurveRamp_Mode mode)
+{
+	// Drop the position mode plan, including the braking correction
+	if(mode != sCurveRamp->rampMode)
+	{
+		sCurveRamp->planned = false;
+		sCurveRamp->correctionVelocity = 0;
+		sCurveRamp->correctionRemainder = 0;
+	}
+
+	sCurveRamp->rampMode = mode;
+}
+
+void tmc_ramp_scurve_set_precision(TMC_SCurveRamp *sCurveRamp, uint32_t precision)
+{
+	if(precision != sCurveRamp->precision)
+		sCurveRamp->planned = false;
+
+	sCurveRamp->precision = precision;
+}
+
+void tmc_ramp_scurve_set_homingDistance(TMC_SCurveRamp *sCurveRamp, uint32_t homingDistance)
+{
+	sCurveRamp->homingDistance = homingDistance;
+}
+
+void tmc_ramp_scurve_set_stopVelocity(TMC_SCurveRamp *sCurveRamp, uint32_t stopVelocity)
+{
+	sCurveRamp->stopVelocity = stopVelocity;
+}
+
+bool tmc_ramp_scurve_get_enabled(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->rampEnabled;
+}
+
+uint32_t tmc_ramp_scurve_get_maxVelocity(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->maxVelocity;
+}
+
+int32_t tmc_ramp_scurve_get_targetPosition(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->targetPosition;
+}
+
+int32_t tmc_ramp_scurve_get_rampPosition(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->rampPosition;
+}
+
+int32_t tmc_ramp_scurve_get_targetVelocity(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->targetVelocity;
+}
+
+int32_t tmc_ramp_scurve_get_rampVelocity(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->rampVelocity;
+}
+
+int32_t tmc_ramp_scurve_get_acceleration(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->acceleration;
+}
+
+int32_t tmc_ramp_scurve_get_rampAcceleration(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->rampAcceleration;
+}
+
+int32_t tmc_ramp_scurve_get_jerk(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->jerk;
+}
+
+TMC_SCurveRamp_State tmc_ramp_scurve_get_state(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->state;
+}
+
+TMC_SCurveRamp_Mode tmc_ramp_scurve_get_mode(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->rampMode;
+}
+
+uint32_t tmc_ramp_scurve_get_precision(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->precision;
+}
+
+uint32_t tmc_ramp_scurve_get_homingDistance(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->homingDistance;
+}
+
+uint32_t tmc_ramp_scurve_get_stopVelocity(TMC_SCurveRamp *sCurveRamp)
+{
+	return sCurveRamp->stopVelocity;
+}
+
+int32_t tmc_ramp_scurve_compute(TMC_SCurveRamp *sCurveRamp)
+{
+	tmc_ramp_scurve_compute_position(sCurveRamp);
+	return tmc_ramp_scurve_compute_velocity(sCurveRamp);
+}
+
+int32_t tmc_ramp_scurve_compute_velocity(TMC_SCurveRamp *sCurveRamp)
+{
+	bool accelerating = sCurveRamp->rampVelocity != sCurveRamp->targetVelocity;
+
+	if (sCurveRamp->rampEnabled)
+	{
+		int32_t dv = sCurveRamp->targetVelocity - sCurveRamp->rampVelocity;
+		int32_t targetAcceleration = 0;
+
+		if(sCurveRamp->jerk > 0)
+		{
+			targetAcceleration = getTargetAcceleration(sCurveRamp);
+
+			// Add jerk to accumulator
+			int64_t accumulator = (int64_t)sCurveRamp->accumulatorAcceleration + sCurveRamp->jerk;
+
+			// Calculate the acceleration delta value and keep the remainder of the acceleration accumulator
+			int32_t da = accumulator / sCurveRamp->precision;
+			sCurveRamp->accumulatorAcceleration = accumulator % sCurveRamp->precision;
+
+			// Move the acceleration towards the target acceleration
+			if(sCurveRamp->rampAcceleration < targetAcceleration)
+				sCurveRamp->rampAcceleration = MIN((int64_t)sCurveRamp->rampAcceleration + da, targetAcceleration);
+			else if(sCurveRamp->rampAcceleration > targetAcceleration)
+				sCurveRamp->rampAcceleration = MAX((int64_t)sCurveRamp->rampAcceleration - da, targetAcceleration);
+		}
+		else
+		{
+			// No jerk limit - apply the acceleration directly
+			if(dv > 0)
+				targetAcceleration = sCurveRamp->acceleration;
+			else if(dv < 0)
+				targetAcceleration = -sCurveRamp->acceleration;
+
+			sCurveRamp->rampAcceleration = targetAcceleration;
+			sCurveRamp->accumulatorAcceleration = 0;
+		}
+
+		// Add current acceleration to accumulator
+		int64_t accumulator = (int64_t)sCurveRamp->accumulatorVelocity + sCurveRamp->rampAcceleration;
+
+		// Calculate the velocity delta value and keep the remainder of the velocity accumulator
+		int32_t dvRamp = accumulator / (int32_t) sCurveRamp->precision;
+		sCurveRamp->accumulatorVelocity = accumulator % (int32_t) sCurveRamp->precision;
+
+		// Add the velocity delta to rampVelocity. When the target velocity is reached,
+		// the remaining acceleration (rounding leftovers) is dropped.
+		if((dv >= 0 && dvRamp >= dv) || (dv <= 0 && dvRamp <= dv))
+		{
+			sCurveRamp->rampVelocity = sCurveRamp->targetVelocity;
+			sCurveRamp->rampAcceleration = 0;
+			sCurveRamp->accumulatorAcceleration = 0;
+			sCurveRamp->accumulatorVelocity = 0;
+		}
+		else
+		{
+			sCurveRamp->rampVelocity += dvRamp;
+		}
+	}
+	else
+	{
+		// use target velocity directly
+		sCurveRamp->rampVelocity = sCurveRamp->targetVelocity;
+		// Reset acceleration and accumulators
+		sCurveRamp->rampAcceleration = 0;
+		sCurveRamp->accumulatorAcceleration = 0;
+		sCurveRamp->accumulatorVelocity = 0;
+	}
+
+	// Position mode: Count the acceleration of a move started at rest. Braking from the reached
+	// velocity V runs through the same velocity changes in reverse, so it takes as many ticks and
+	// drives T * V minus the velocities summed up while accelerating.
+	if(sCurveRamp->exactBraking && accelerating && sCurveRamp->state == TMC_RAMP_SCURVE_STATE_DRIVING)
+	{
+		uint32_t velocity = abs(sCurveRamp->rampVelocity);
+
+		sCurveRamp->accelerationTicks++;
+		sCurveRamp->accelerationSum += velocity;
+
+		if(sCurveRamp->rampVelocity == sCurveRamp->targetVelocity)
+			sCurveRamp->brakingDistance = (uint64_t)sCurveRamp->accelerationTicks * velocity - sCurveRamp->accelerationSum;
+	}
+
+	// Calculate the position delta value and keep the remainder of the position accumulator
+	sCurveRamp->accumulatorPosition += sCurveRamp->rampVelocity;
+
+	// Position mode braking: Drive this tick's share of the braking point remainder (see startBraking)
+	if(sCurveRamp->state == TMC_RAMP_SCURVE_STATE_BRAKING && (sCurveRamp->correctionVelocity || sCurveRamp->correctionRemainder))
+	{
+		int32_t correction = sCurveRamp->correctionVelocity;
+
+		sCurveRamp->correctionAccumulator += sCurveRamp->correctionRemainder;
+		if(sCurveRamp->correctionAccumulator >= sCurveRamp->accelerationTicks)
+		{
+			sCurveRamp->correctionAccumulator -= sCurveRamp->accelerationTicks;
+			correction++;
+		}
+
+		sCurveRamp->accumulatorPosition += (sCurveRamp->targetPosition > sCurveRamp->rampPosition) ? correction : -correction;
+
+		// The last braking tick has been reached
+		if(sCurveRamp->rampVelocity == 0)
+		{
+			sCurveRamp->correctionVelocity = 0;
+			sCurveRamp->correctionRemainder = 0;
+		}
+	}
+
+	int32_t dx = sCurveRamp->accumulatorPosition / (int32_t) sCurveRamp->precision;
+	sCurveRamp->accumulatorPosition = sCurveRamp->accumulatorPosition % (int32_t) sCurveRamp->precision;
+
+	// Change actual position determined by position change
+	sCurveRamp->rampPosition += dx;
+
+	return dx;
+}
+
+void tmc_ramp_scurve_compute_position(TMC_SCurveRamp *sCurveRamp)
+{
+	if (!sCurveRamp->rampEnabled)
+		return;
+
+	if (sCurveRamp->rampMode != TMC_RAMP_SCURVE_MODE_POSITION)
+		return;
+
+	// Calculate steps needed to target
+	int32_t diffx = 0;
+
+	switch(sCurveRamp->state) {
+	case TMC_RAMP_SCURVE_STATE_IDLE:
+		if(sCurveRamp->rampPosition == sCurveRamp->targetPosition)
+			break;
+
+		sCurveRamp->planned = false;
+		sCurveRamp->state = TMC_RAMP_SCURVE_STATE_DRIVING;
+		break;
+	case TMC_RAMP_SCURVE_STATE_DRIVING:
+		// Calculate distance to target (positive = driving towards target)
+		if(sCurveRamp->rampVelocity > 0)
+			diffx = sCurveRamp->targetPosition - sCurveRamp->rampPosition;
+		else if(sCurveRamp->rampVelocity < 0)
+			diffx = -(sCurveRamp->targetPosition - sCurveRamp->rampPosition);
+		else
+			diffx = abs(sCurveRamp->targetPosition - sCurveRamp->rampPosition);
+
+		// Plan the move when starting, after a target position change or when the maximum
+		// velocity was lowered below the planned velocity
+		if(!sCurveRamp->planned || sCurveRamp->targetPosition != sCurveRamp->plannedTarget
+			|| (uint32_t)abs(sCurveRamp->targetVelocity) > sCurveRamp->maxVelocity)
+		{
+			planMove(sCurveRamp, diffx);
+
+			if(sCurveRamp->state != TMC_RAMP_SCURVE_STATE_DRIVING)
+				break;
+		}
+
+		// Planned velocity reached: Drive on until one more tick would leave less than the
+		// braking distance (in 1/precision positions) to the target
+		if(sCurveRamp->rampVelocity == sCurveRamp->targetVelocity)
+		{
+			int32_t velocity = abs(sCurveRamp->rampVelocity);
+			int64_t distance = (int64_t)diffx * sCurveRamp->precision
+					- ((sCurveRamp->rampVelocity < 0) ? -sCurveRamp->accumulatorPosition : sCurveRamp->accumulatorPosition);
+			int64_t remainder = distance - (int64_t)sCurveRamp->brakingDistance;
+
+			if(remainder < velocity)
+				startBraking(sCurveRamp, remainder);
+		}
+		break;
+	case TMC_RAMP_SCURVE_STATE_BRAKING:
+		if(sCurveRamp->targetPosition == sCurveRamp->rampPosition)
+		{
+			if(abs(sCurveRamp->rampVelocity) <= sCurveRamp->stopVelocity)
+			{	// Position reached, velocity within cutoff threshold (or zero)
+				sCurveRamp->rampVelocity = 0;
+				sCurveRamp->rampAcceleration = 0;
+				sCurveRamp->targetVelocity = 0;
+				sCurveRamp->state = TMC_RAMP_SCURVE_STATE_IDLE;
+			}
+		}
+		else
+		{	// We're not at the target position
+			if(sCurveRamp->rampVelocity != 0)
+			{	// Still decelerating
+
+				// Target position moved - plan the move anew from the current motion
+				if(sCurveRamp->targetPosition != sCurveRamp->plannedTarget)
+				{
+					sCurveRamp->planned = false;
+					sCurveRamp->correctionVelocity = 0;
+					sCurveRamp->correctionRemainder = 0;
+					sCurveRamp->state = TMC_RAMP_SCURVE_STATE_DRIVING;
+				}
+			}
+			else
+			{	// Standing still (not at the target position)
+				if(abs(sCurveRamp->targetPosition - sCurveRamp->rampPosition) <= sCurveRamp->homingDistance)
+				{	// Within homing distance - drive with stop velocity
+					sCurveRamp->targetVelocity = (sCurveRamp->targetPosition > sCurveRamp->rampPosition)? sCurveRamp->stopVelocity : -sCurveRamp->stopVelocity;
+				}
+				else
+				{	// Not within homing distance - start a new motion by switching to RAMP_IDLE
+					// Since (targetPosition != actualPosition) a new ramp will be started.
+					sCurveRamp->state = TMC_RAMP_SCURVE_STATE_IDLE;
+				}
+			}
+		}
+		break;
+	}
+}
+
+// Plans the move towards the target position, diffx positions away. This runs once per move and
+// after changes of the target position or the ramp parameters, not per tick.
+// The planned velocity is the highest one up to maxVelocity, for which accelerating and braking fit
+// into the distance (upper bounds, see getMoveDistance). A move started at rest brakes exactly by
+// the counted acceleration (see tmc_ramp_scurve_compute_velocity). Otherwise the braking distance
+// is the upper bound of the planned velocity, the ramp may then stop short of the target.
+static void planMove(TMC_SCurveRamp *sCurveRamp, int32_t diffx)
+{
+	int32_t direction = (sCurveRamp->targetPosition > sCurveRamp->rampPosition) ? 1 : -1;
+
+	// Velocity and acceleration towards the target
+	int64_t v = (int64_t)direction * sCurveRamp->rampVelocity;
+	int64_t a = (int64_t)direction * sCurveRamp->rampAcceleration;
+	bool atRest = (v == 0 && a == 0);
+
+	sCurveRamp->planned = true;
+	sCurveRamp->plannedTarget = sCurveRamp->targetPosition;
+	sCurveRamp->exactBraking = false;
+	sCurveRamp->accelerationTicks = 0;
+	sCurveRamp->accelerationSum = 0;
+	sCurveRamp->brakingDistance = 0;
+	sCurveRamp->correctionVelocity = 0;
+	sCurveRamp->correctionRemainder = 0;
+
+	// Distance to the target (Q16), less the position fraction already driven towards it
+	uint64_t distance = (uint64_t)MAX(diffx, 0) << 16;
+	int32_t fraction = direction * sCurveRamp->accumulatorPosition;
+	if(fraction > 0)
+		distance -= MIN(distance, ratioQ16(fraction, sCurveRamp->precision));
+
+	// Moving away from the target, at the target, or too fast to stop in time: Brake now.
+	// Removing a deceleration in progress costs further velocity, which must not reverse the
+	// direction of movement. A new ramp is started from standstill.
+	if(v < 0 || diffx <= 0
+		|| (!atRest && getStopDistance(sCurveRamp, v, a) >= distance)
+		|| (a < 0 && (uint64_t)v <= getReductionVelocity(sCurveRamp) + 1))
+	{
+		sCurveRamp->targetVelocity = 0;
+		sCurveRamp->state = TMC_RAMP_SCURVE_STATE_BRAKING;
+		return;
+	}
+
+	uint32_t velocity = sCurveRamp->maxVelocity;
+
+	if(getMoveDistance(sCurveRamp, velocity, v, a) > distance)
+	{
+		// Highest velocity fitting into the distance, the move distance grows with the velocity
+		uint32_t low = 0;
+		uint32_t high = velocity;
+
+		while(high - low > 1)
+		{
+			uint32_t middle = low + (high - low) / 2;
+
+			if(getMoveDistance(sCurveRamp, middle, v, a) <= distance)
+				low = middle;
+			else
+				high = middle;
+		}
+
+		velocity = low;
+	}
+
+	if(velocity == 0)
+	{
+		if(atRest)
+		{	// Too short for any ramp - drive with stop velocity
+			sCurveRamp->targetVelocity = direction * (int32_t)sCurveRamp->stopVelocity;
+		}
+		else
+		{
+			sCurveRamp->targetVelocity = 0;
+		}
+
+		sCurveRamp->state = TMC_RAMP_SCURVE_STATE_BRAKING;
+		return;
+	}
+
+	sCurveRamp->targetVelocity = direction * (int32_t)velocity;
+
+	if(atRest)
+	{
+		// Accelerate from clean accumulators, braking then mirrors the acceleration
+		sCurveRamp->accumulatorAcceleration = 0;
+		sCurveRamp->accumulatorVelocity = 0;
+		sCurveRamp->exactBraking = true;
+	}
+	else
+	{
+		// Upper bound of the braking distance (Q16 positions) in 1/precision positions
+		uint64_t stopDistance = getStopDistance(sCurveRamp, velocity, 0);
+
+		sCurveRamp->brakingDistance = addQ16(mulSaturated(stopDistance >> 16, sCurveRamp->precision),
+				divCeil((stopDistance & 0xFFFF) * sCurveRamp->precision, (uint64_t)1 << 16));
+	}
+}
+
+// Starts braking, [remainder] (1/precision positions) before the braking distance is reached.
+// Braking only starts at a tick, so the remainder is left over at the end of braking. A move started
+// at rest brakes for exactly as many ticks as it accelerated, the remainder is split evenly over
+// these ticks and driven on top of the braking velocity. It is less than one tick at the planned
+// velocity, so the share of each tick is less than the velocity change of a tick.
+static void startBraking(TMC_SCurveRamp *sCurveRamp, int64_t remainder)
+{
+	sCurveRamp->targetVelocity = 0;
+	sCurveRamp->state = TMC_RAMP_SCURVE_STATE_BRAKING;
+	sCurveRamp->correctionVelocity = 0;
+	sCurveRamp->correctionRemainder = 0;
+	sCurveRamp->correctionAccumulator = 0;
+
+	if(sCurveRamp->exactBraking && remainder > 0 && sCurveRamp->accelerationTicks > 0)
+	{
+		sCurveRamp->correctionVelocity = remainder / sCurveRamp->accelerationTicks;
+		sCurveRamp->correctionRemainder = remainder % sCurveRamp->accelerationTicks;
+	}
+}
+
+// Velocity change needed to bring the current acceleration back to zero
+static uint64_t getReductionVelocity(TMC_SCurveRamp *sCurveRamp)
+{
+	uint32_t absAcceleration = abs(sCurveRamp->rampAcceleration);
+
+	if(sCurveRamp->jerk <= 0)
+		return 0;
+
+	return ((uint64_t)absAcceleration * absAcceleration) / (2 * (uint64_t)sCurveRamp->jerk);
+}
+
+// Acceleration the jerk-limited ramp is currently moving towards
+static int32_t getTargetAcceleration(TMC_SCurveRamp *sCurveRamp)
+{
+	int32_t dv = sCurveRamp->targetVelocity - sCurveRamp->rampVelocity;
+	uint64_t reductionVelocity = getReductionVelocity(sCurveRamp);
+
+	// Build up acceleration towards the target velocity, unless the remaining
+	// velocity difference is needed to reduce the acceleration to zero again
+	if(dv > 0 && !(sCurveRamp->rampAcceleration > 0 && reductionVelocity >= (uint32_t)dv))
+		return sCurveRamp->acceleration;
+	else if(dv < 0 && !(sCurveRamp->rampAcceleration < 0 && reductionVelocity >= (uint32_t)-dv))
+		return -sCurveRamp->acceleration;
+
+	return 0;
+}
+
+// Upper bound of the distance (Q16) to accelerate from the velocity v and acceleration a towards the
+// target to peakVelocity, and to stop from there. Braking runs through the velocities of the
+// acceleration in reverse, the acceleration drives one tick at the peak velocity more. So
+// accelerating from v takes at most the braking distance from the peak velocity plus that tick.
+// A deceleration in progress is reduced first, this drives at most v for a/j ticks. Slowing down
+// to a lower peak velocity takes at most the stop distance from v.
+static uint64_t getMoveDistance(TMC_SCurveRamp *sCurveRamp, uint64_t peakVelocity, uint64_t v, int64_t a)
+{
+	uint64_t stopDistance = getStopDistance(sCurveRamp, peakVelocity, 0);
+	uint64_t distance = addQ16(stopDistance, ratioQ16(peakVelocity, sCurveRamp->precision));
+
+	if(peakVelocity < v)
+		return addQ16(distance, getStopDistance(sCurveRamp, v, a));
+
+	if(a < 0 && sCurveRamp->jerk > 0)
+		distance = addQ16(distance, mulSaturated(v, ratioQ16(-a, sCurveRamp->jerk)));
+
+	return addQ16(distance, stopDistance);
+}
+
+// Upper bound of the braking distance (Q16), starting with a remaining acceleration a in driving
+// direction. It is reduced to zero with the jerk j first, this takes v*a/j + a^3/(3*j^2)
+// positions and increases the velocity by a^2/(2*j). The lag of the discrete ramp adds
+// a/j + (a/j)^2 positions and a/j velocity units for the rest of the braking time (see
+// getDecelerationDistance).
+static uint64_t getStopDistance(TMC_SCurveRamp *sCurveRamp, uint64_t v, int64_t a)
+{
+	uint64_t distance = 0;     // Q16
+	uint64_t velocityLag = 0;  // Q16
+	uint64_t brakingTime;      // Q16
+
+	if(a > 0 && sCurveRamp->jerk > 0 && sCurveRamp->acceleration > 0)
+	{
+		uint64_t aByJerk = ratioQ16(a, sCurveRamp->jerk);
+
+		distance = addQ16(distance, mulSaturated(v, aByJerk));
+		distance = addQ16(distance, divCeil(mulSaturated(mulQ16(aByJerk, aByJerk), a), 3));
+		distance = addQ16(distance, aByJerk);
+		distance = addQ16(distance, mulQ16(aByJerk, aByJerk));
+		v += divCeil(mulSaturated(a, a), 2 * (uint64_t)sCurveRamp->jerk);
+		velocityLag = aByJerk;
+		a = 0;
+	}
+
+	distance = addQ16(distance, getDecelerationDistance(sCurveRamp, v, a, &brakingTime));
+
+	return addQ16(distance, mulQ16(velocityLag, brakingTime));
+}
+
+// Upper bound of the braking distance without acceleration in driving direction (a <= 0,
+// all values in ramp units, the precision cancels out). From velocity v the velocity is
+// reduced to zero with the jerk j:
+//    v >= A^2/j: acceleration limit A is reached: v^2/(2*A) + v*A/(2*j)
+//    otherwise:  acceleration limit is not reached: sqrt(v^3/j)
+// A deceleration still in progress is handled by getBrakingDistance.
+//
+// The accumulators truncate, so the discrete ramp lags behind the continuous profile:
+// - The velocity is up to one unit too high while decelerating. Over the braking time
+//   of T ticks this adds T/precision positions: v/A + A/j or 2*sqrt(v/j).
+// - The acceleration is up to one unit too low while it is built up. This leaves up to
+//   A/j or sqrt(v/j) velocity units too much, adding the product with the remaining
+//   braking time: v/j + (A/j)^2 or 2*v/j.
+// The terms are summed in 1/65536 positions (Q16), each one rounded up. The braking time is
+// returned in [brakingTime] (ticks / precision, Q16).
+static uint64_t getDecelerationDistance(TMC_SCurveRamp *sCurveRamp, uint64_t v, int64_t a, uint64_t *brakingTime)
+{
+	uint64_t maxA = MAX(sCurveRamp->acceleration, 0);
+	uint64_t j = MAX(sCurveRamp->jerk, 0);
+	uint64_t distance = 0;  // Q16
+
+	*brakingTime = 0;
+
+	if(v == 0 && a <= 0)
+		return 0;
+
+	if(maxA == 0)
+	{
+		*brakingTime = Q16_SATURATED;
+		return Q16_SATURATED;
+	}
+
+	if(j == 0)
+	{
+		// Linear ramp: v^2/(2*A), plus v/A for the velocity lag
+		*brakingTime = ratioQ16(v, maxA);
+		return addQ16(ratioQ16(mulSaturated(v, v), 2 * maxA), *brakingTime);
+	}
+
+	if(a < 0)
+		return getBrakingDistance(v, MIN((uint64_t)-a, maxA), maxA, j, brakingTime);
+
+	if(mulSaturated(v, j) >= maxA * maxA)
+	{
+		uint64_t maxAByJerk = ratioQ16(maxA, j);
+
+		*brakingTime = addQ16(ratioQ16(v, maxA), maxAByJerk);
+		distance = addQ16(distance, ratioQ16(mulSaturated(v, v), 2 * maxA));
+		distance = addQ16(distance, divCeil(mulSaturated(v, maxAByJerk), 2));
+		distance = addQ16(distance, *brakingTime);
+		distance = addQ16(distance, ratioQ16(v, j));
+		distance = addQ16(distance, mulQ16(maxAByJerk, maxAByJerk));
+	}
+	else
+	{
+		uint64_t vByJerk = ratioQ16(v, j);
+
+		*brakingTime = 2 * sqrtQ16(vByJerk);
+		distance = addQ16(distance, sqrtQ16(mulSaturated(mulSaturated(v, v), vByJerk)));
+		distance = addQ16(distance, *brakingTime);
+		distance = addQ16(distance, 2 * vByJerk);
+	}
+
+	return distance;
+}
+
+// Upper bound of the braking distance with a deceleration d (0 < d <= A) already in progress.
+// The deceleration is built up to the peak deceleration D, held and reduced to zero again:
+// 1. d to D: takes t1 = (D-d)/j, the velocity drops to v1 = v - (D^2-d^2)/(2*j):
+//    v1*t1 + d*t1^2/2 + j*t1^3/3
+// 2. Holding A until the velocity is down to v2 = A^2/(2*j): v2*th + A*th^2/2 with th = (v1-v2)/A
+// 3. D to 0: D^3/(6*j^2)
+// The peak deceleration is A if v >= (2*A^2 - d^2)/(2*j). Otherwise D^2 = j*v + d^2/2, there is
+// no hold phase and v1 = v/2 + d^2/(4*j). If reducing d to zero already takes the whole velocity
+// (v <= d^2/(2*j)), the ramp stops after (d-s)/j with s = sqrt(d^2 - 2*j*v), within
+// (d-s)^2 * (d+2*s) / (6*j^2) positions. Rounding s down overestimates this distance.
+// The lag of the discrete ramp is added as in getDecelerationDistance: the braking time T for the
+// velocity, t1*T + t1^2 for the deceleration being built up one unit too low.
+static uint64_t getBrakingDistance(uint64_t v, uint64_t d, uint64_t maxA, uint64_t j, uint64_t *brakingTime)
+{
+	uint64_t distance = 0;  // Q16
+
+	if(mulSaturated(2 * j, v) <= d * d)
+	{
+		uint64_t sSquared = d * d - 2 * j * v;
+		uint64_t s = (sSquared < ((uint64_t)1 << 32)) ? tmc_sqrti64(sSquared << 32) : (uint64_t)tmc_sqrti64(sSquared) << 16;  // Q16
+		uint64_t stopTime = divCeil((d << 16) - s, j);  // Q16
+
+		distance = divCeil(mulQ16(mulQ16(stopTime, stopTime), (d << 16) + 2 * s), 6);
+		*brakingTime = stopTime;
+		return addQ16(distance, stopTime);
+	}
+
+	uint64_t peak;          // Q16
+	uint64_t v1;            // Rounded up
+	uint64_t holdTime = 0;  // Q16
+
+	if(2 * j * v >= 2 * maxA * maxA - d * d)
+	{
+		// v2 rounded down overestimates the hold phase
+		uint64_t v2 = (maxA * maxA) / (2 * j);
+
+		peak = maxA << 16;
+		v1 = v - (maxA * maxA - d * d) / (2 * j);
+
+		if(v1 > v2)
+		{
+			holdTime = ratioQ16(v1 - v2, maxA);
+			distance = addQ16(distance, mulSaturated(v2, holdTime));
+			distance = addQ16(distance, divCeil(mulSaturated(mulQ16(holdTime, holdTime), maxA), 2));
+		}
+	}
+	else
+	{
+		uint64_t peakSquared2 = 2 * j * v + d * d;  // 2 * D^2
+
+		if(peakSquared2 < ((uint64_t)1 << 48))
+			peak = sqrtQ16(peakSquared2 << 15);
+		else
+			peak = sqrtCeil(divCeil(peakSquared2, 2)) << 16;
+
+		v1 = divCeil(peakSquared2, 4 * j);
+	}
+
+	uint64_t buildUpTime = divCeil(peak - (d << 16), j);  // Q16
+	uint64_t reductionTime = divCeil(peak, j);            // Q16
+	uint64_t buildUpTimeSquared = mulQ16(buildUpTime, buildUpTime);
+
+	*brakingTime = addQ16(addQ16(buildUpTime, holdTime), reductionTime);
+
+	distance = addQ16(distance, mulSaturated(v1, buildUpTime));
+	distance = addQ16(distance, divCeil(mulSaturated(buildUpTimeSquared, d), 2));
+	distance = addQ16(distance, divCeil(mulSaturated(mulQ16(buildUpTimeSquared, buildUpTime), j), 3));
+	distance = addQ16(distance, divCeil(mulQ16(mulQ16(reductionTime, reductionTime), peak), 6));
+	distance = addQ16(distance, *brakingTime);
+	distance = addQ16(distance, mulQ16(buildUpTime, *brakingTime));
+	distance = addQ16(distance, buildUpTimeSquared);
+
+	return distance;
+}
+
+// Fractions already collected in the velocity and acceleration accumulators are rounded up to the
+// next unit, the fraction of a position in the position accumulator is added before the distance
+// is rounded down to positions.
+uint32_t tmc_ramp_scurve_get_stopDistance(TMC_SCurveRamp *sCurveRamp)
+{
+	uint64_t v = abs(sCurveRamp->rampVelocity);
+	int32_t direction = (sCurveRamp->rampVelocity < 0) ? -1 : 1;
+
+	if(v == 0)
+		return 0;
+
+	// Acceleration in driving direction, negative while decelerating
+	int64_t a = (int64_t)direction * sCurveRamp->rampAcceleration;
+
+	// Velocity fraction in driving direction
+	if((int64_t)direction * sCurveRamp->accumulatorVelocity > 0)
+		v++;
+
+	// Acceleration fraction, while the acceleration in driving direction is being increased
+	// (built up, or a deceleration is being reduced)
+	if(sCurveRamp->jerk > 0 && sCurveRamp->accumulatorAcceleration > 0
+		&& (int64_t)direction * getTargetAcceleration(sCurveRamp) > a && a < sCurveRamp->acceleration)
+		a++;
+
+	uint64_t distance = getStopDistance(sCurveRamp, v, a);
+
+	// Position fraction in driving direction
+	if((int64_t)direction * sCurveRamp->accumulatorPosition > 0)
+		distance = addQ16(distance, ratioQ16(abs(sCurveRamp->accumulatorPosition), sCurveRamp->precision));
+
+	return MIN(distance >> 16, UINT32_MAX);
+}
+
+// Returns a / b, rounded up
+static uint64_t divCeil(uint64_t a, uint64_t b)
+{
+	return a / b + ((a % b) ? 1 : 0);
+}
+
+// Fixed point helpers for the stop distance. Values are in 1/65536 units and rounded up.
+// Results saturate at Q16_SATURATED, which is far beyond any representable distance.
+
+// Returns a * b, saturated to Q16_SATURATED
+static uint64_t mulSaturated(uint64_t a, uint64_t b)
+{
+	if(a != 0 && b > Q16_SATURATED / a)
+		return Q16_SATURATED;
+
+	return MIN(a * b, Q16_SATURATED);
+}
+
+// Returns a + b (both Q16), saturated
+static uint64_t addQ16(uint64_t a, uint64_t b)
+{
+	return MIN(a + b, Q16_SATURATED);
+}
+
+// Returns numerator / denominator as Q16
+static uint64_t ratioQ16(uint64_t numerator, uint64_t denominator)
+{
+	uint64_t quotient = numerator / denominator;
+
+	if(quotient >= (Q16_SATURATED >> 16))
+		return Q16_SATURATED;
+
+	return (quotient << 16) + divCeil((numerator % denominator) << 16, denominator);
+}
+
+// Returns a * b (both Q16) as Q16
+static uint64_t mulQ16(uint64_t a, uint64_t b)
+{
+	uint64_t high = mulSaturated(a >> 16, b);
+	uint64_t low = divCeil(mulSaturated(a & 0xFFFF, b), 1 << 16);
+
+	return addQ16(high, low);
+}
+
+// Returns sqrt(x) (both Q16)
+static uint64_t sqrtQ16(uint64_t x)
+{
+	if(x >= Q16_SATURATED)
+		return Q16_SATURATED;
+
+	if(x < ((uint64_t)1 << 47))
+		return sqrtCeil(x << 16);
+
+	return sqrtCeil(x) << 8;
+}
+
+// Returns sqrt(x), rounded up
+static uint64_t sqrtCeil(uint64_t x)
+{
+	uint64_t root = tmc_sqrti64(x);
+
+	return (root * root < x) ? root + 1 : root;
+}
@@ -0,0 +1,128 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+
+#ifndef TMC_RAMP_SCURVERAMP_H_
+#define TMC_RAMP_SCURVERAMP_H_
+
+#include "tmc/helpers/API_Header.h"
+
+/*
+ *  Jerk-limited (S-curve) ramp generator.
+ *
+ *  Works like the linear ramp (LinearRamp1), but the acceleration is not applied
+ *  instantly. Instead it is ramped up and down with the jerk value, so the
+ *  acceleration is continuous and the velocity follows an S-shaped curve.
+ *
+ *  Units (per call of tmc_ramp_scurve_compute, all scaled by the precision):
+ *  - velocity:     positions / precision
+ *  - acceleration: velocity / precision (same as TMC_LinearRamp)
+ *  - jerk:         acceleration / precision
+ *
+ *  A jerk of 0 disables the jerk limit, the ramp then behaves like the linear ramp.
+ *
+ *  Position mode plans each move once, when it starts and after changes of the
+ *  target position or the ramp parameters: the peak velocity is the highest one
+ *  up to maxVelocity for which accelerating and braking fit into the distance.
+ *  A move started at rest counts its acceleration ticks T and sums up the
+ *  velocities. Braking from the peak velocity V runs through the same velocity
+ *  changes in reverse, so it drives exactly T * V minus that sum. The ramp holds
+ *  V until one more tick would pass this braking point. The remainder left by
+ *  braking at a tick boundary is split over the T braking ticks and driven on
+ *  top of the braking velocity, so the target is reached with a single ramp,
+ *  without passing it or reversing the direction of movement.
+ *  A move planned while moving (a new target, changed parameters) brakes at the
+ *  estimated upper bound of the braking distance instead and may stop short.
+ *  A leftover within the homing distance is driven with the stop velocity,
+ *  otherwise a new move is started from standstill.
+ */
+
+// Default precision of the calculations (see TMC_RAMP_LINEAR_DEFAULT_PRECISION)
+#define TMC_RAMP_SCURVE_DEFAULT_PRECISION ((uint32_t)1<<17)
+
+// Position mode: When hitting the target position a velocity below the V_STOP threshold will be cut off to velocity 0
+#define TMC_RAMP_SCURVE_DEFAULT_HOMING_DISTANCE 5
+
+// Position mode: When barely missing the target position by HOMING_DISTANCE or less, the remainder will be driven with V_STOP velocity
+#define TMC_RAMP_SCURVE_DEFAULT_STOP_VELOCITY 5
+
+typedef enum {
+	TMC_RAMP_SCURVE_MODE_VELOCITY,
+	TMC_RAMP_SCURVE_MODE_POSITION
+} TMC_SCurveRamp_Mode;
+
+typedef enum {
+	TMC_RAMP_SCURVE_STATE_IDLE,
+	TMC_RAMP_SCURVE_STATE_DRIVING,
+	TMC_RAMP_SCURVE_STATE_BRAKING
+} TMC_SCurveRamp_State;
+
+typedef struct
+{
+	uint32_t maxVelocity;
+	int32_t targetPosition;
+	int32_t rampPosition;
+	int32_t targetVelocity;
+	int32_t rampVelocity;
+	int32_t acceleration;      // Maximum acceleration
+	int32_t rampAcceleration;  // Current acceleration, positive values increase the velocity
+	int32_t jerk;
+	bool rampEnabled;
+	int32_t accumulatorAcceleration;
+	int32_t accumulatorVelocity;
+	int32_t accumulatorPosition;
+	TMC_SCurveRamp_Mode rampMode;
+	TMC_SCurveRamp_State state;
+	bool planned;                    // Position mode: the move towards plannedTarget is planned
+	bool exactBraking;               // Position mode: the move started at rest, braking mirrors the acceleration
+	int32_t plannedTarget;           // Target position of the planned move, a new target replans it
+	uint32_t accelerationTicks;      // Ticks spent accelerating to the planned velocity
+	uint64_t accelerationSum;        // Sum of the velocities while accelerating
+	uint64_t brakingDistance;        // Distance needed to brake from the planned velocity, in 1/precision positions
+	uint32_t correctionVelocity;     // Braking: part of the braking point remainder driven every tick
+	uint32_t correctionRemainder;    // Braking: rest of the remainder, spread over the braking ticks
+	uint32_t correctionAccumulator;
+	uint32_t precision;
+	uint32_t homingDistance;
+	uint32_t stopVelocity;
+} TMC_SCurveRamp;
+
+void tmc_ramp_scurve_init(TMC_SCurveRamp *sCurveRamp);
+int32_t tmc_ramp_scurve_compute(TMC_SCurveRamp *sCurveRamp);
+int32_t tmc_ramp_scurve_compute_velocity(TMC_SCurveRamp *sCurveRamp);
+void tmc_ramp_scurve_compute_position(TMC_SCurveRamp *sCurveRamp);
+
+// Upper bound of the positions needed to stop from the current velocity and acceleration,
+// including a deceleration already in progress.
+uint32_t tmc_ramp_scurve_get_stopDistance(TMC_SCurveRamp *sCurveRamp);
+
+void tmc_ramp_scurve_set_enabled(TMC_SCurveRamp *sCurveRamp, bool enabled);
+void tmc_ramp_scurve_set_maxVelocity(TMC_SCurveRamp *sCurveRamp, uint32_t maxVelocity);
+void tmc_ramp_scurve_set_targetPosition(TMC_SCurveRamp *sCurveRamp, int32_t targetPosition);
+void tmc_ramp_scurve_set_rampPosition(TMC_SCurveRamp *sCurveRamp, int32_t rampPosition);
+void tmc_ramp_scurve_set_targetVelocity(TMC_SCurveRamp *sCurveRamp, int32_t targetVelocity);
+void tmc_ramp_scurve_set_rampVelocity(TMC_SCurveRamp *sCurveRamp, int32_t rampVelocity);
+void tmc_ramp_scurve_set_acceleration(TMC_SCurveRamp *sCurveRamp, int32_t acceleration);
+void tmc_ramp_scurve_set_jerk(TMC_SCurveRamp *sCurveRamp, int32_t jerk);
+void tmc_ramp_scurve_set_mode(TMC_SCurveRamp *sCurveRamp, TMC_SCurveRamp_Mode mode);
+void tmc_ramp_scurve_set_precision(TMC_SCurveRamp *sCurveRamp, uint32_t precision);
+void tmc_ramp_scurve_set_homingDistance(TMC_SCurveRamp *sCurveRamp, uint32_t homingDistance);
+void tmc_ramp_scurve_set_stopVelocity(TMC_SCurveRamp *sCurveRamp, uint32_t stopVelocity);
+
+bool tmc_ramp_scurve_get_enabled(TMC_SCurveRamp *sCurveRamp);
+uint32_t tmc_ramp_scurve_get_maxVelocity(TMC_SCurveRamp *sCurveRamp);
+int32_t tmc_ramp_scurve_get_targetPosition(TMC_SCurveRamp *sCurveRamp);
+int32_t tmc_ramp_scurve_get_rampPosition(TMC_SCurveRamp *sCurveRamp);
+int32_t tmc_ramp_scurve_get_targetVelocity(TMC_SCurveRamp *sCurveRamp);
+int32_t tmc_ramp_scurve_get_rampVelocity(TMC_SCurveRamp *sCurveRamp);
+int32_t tmc_ramp_scurve_get_acceleration(TMC_SCurveRamp *sCurveRamp);
+int32_t tmc_ramp_scurve_get_rampAcceleration(TMC_SCurveRamp *sCurveRamp);
+int32_t tmc_ramp_scurve_get_jerk(TMC_SCurveRamp *sCurveRamp);
+TMC_SCurveRamp_State tmc_ramp_scurve_get_state(TMC_SCurveRamp *sCurveRamp);
+TMC_SCurveRamp_Mode tmc_ramp_scurve_get_mode(TMC_SCurveRamp *sCurveRamp);
+uint32_t tmc_ramp_scurve_get_precision(TMC_SCurveRamp *sCurveRamp);
+uint32_t tmc_ramp_scurve_get_homingDistance(TMC_SCurveRamp *sCurveRamp);
+uint32_t tmc_ramp_scurve_get_stopVelocity(TMC_SCurveRamp *sCurveRamp);
+
+#endif /* TMC_RAMP_SCURVERAMP_H_ */
@@ -0,0 +1,108 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+
+#include "StepTiming.h"
+#include "tmc/helpers/Functions.h"
+
+static bool pushPending(TMC_StepTiming *stepTiming);
+static void push(TMC_StepTiming *stepTiming, uint64_t time, int32_t direction);
+
+void tmc_step_timing_init(TMC_StepTiming *stepTiming, uint32_t timerTicksPerRampTick)
+{
+	stepTiming->head                   = 0;
+	stepTiming->tail                   = 0;
+	stepTiming->timerTicksPerRampTick  = timerTicksPerRampTick;
+	stepTiming->tickStart              = 0;
+	stepTiming->lastStep               = 0;
+	stepTiming->pendingStep            = 1;
+	stepTiming->pendingSteps           = 0;
+}
+
+uint32_t tmc_step_timing_fill(TMC_StepTiming *stepTiming, TMC_LinearRamp *linearRamp, uint32_t maxRampTicks)
+{
+	uint32_t ticks;
+
+	// The steps of a partly queued tick come first
+	if(!pushPending(stepTiming))
+		return 0;
+
+	for(ticks = 0; ticks < maxRampTicks; ticks++)
+	{
+		// Compute the tick on a copy, it is only applied once all of its steps fit into the queue
+		TMC_LinearRamp nextRamp = *linearRamp;
+		int32_t accumulator = linearRamp->accumulatorPosition;
+		int32_t dx = tmc_ramp_linear_compute(&nextRamp);
+		uint32_t steps = (dx == 0) ? 0 : (linearRamp->multiStep) ? (uint32_t)abs(dx) : 1;
+
+		// A tick with more steps than the queue length never fits, it is queued in parts
+		if(steps > tmc_step_timing_getFree(stepTiming) && steps <= TMC_STEP_TIMING_QUEUE_LENGTH)
+			break;
+
+		// While standing still, the next movement starts with this tick
+		if(linearRamp->rampVelocity == 0)
+			stepTiming->lastStep = stepTiming->tickStart;
+
+		*linearRamp = nextRamp;
+
+		stepTiming->pendingTickStart    = stepTiming->tickStart;
+		stepTiming->pendingAccumulator  = accumulator;
+		stepTiming->pendingVelocity     = linearRamp->rampVelocity;
+		stepTiming->pendingPrecision    = linearRamp->precision;
+		stepTiming->pendingStep         = 1;
+		stepTiming->pendingSteps        = steps;
+
+		stepTiming->tickStart += stepTiming->timerTicksPerRampTick;
+
+		if(!pushPending(stepTiming))
+		{
+			ticks++;
+			break;
+		}
+	}
+
+	return ticks;
+}
+
+void tmc_step_timing_clear(TMC_StepTiming *stepTiming)
+{
+	stepTiming->tail = stepTiming->head;
+	stepTiming->pendingStep  = 1;
+	stepTiming->pendingSteps = 0;
+}
+
+// Queues the steps of the pending tick while there is space. Returns true once all are queued.
+static bool pushPending(TMC_StepTiming *stepTiming)
+{
+	int32_t direction = (stepTiming->pendingVelocity < 0) ? -1 : 1;
+
+	for(; stepTiming->pendingStep <= stepTiming->pendingSteps; stepTiming->pendingStep++)
+	{
+		if(tmc_step_timing_getFree(stepTiming) == 0)
+			return false;
+
+		uint32_t stepTime = tmc_ramp_linear_get_stepTime(stepTiming->pendingAccumulator, stepTiming->pendingVelocity,
+				stepTiming->pendingPrecision, stepTiming->pendingStep, stepTiming->timerTicksPerRampTick);
+
+		push(stepTiming, stepTiming->pendingTickStart + stepTime, direction);
+	}
+
+	return true;
+}
+
+static void push(TMC_StepTiming *stepTiming, uint64_t time, int32_t direction)
+{
+	uint32_t head = stepTiming->head;
+
+	// Steps are at least one timer tick apart, which also keeps the sign of the interval valid
+	time = MAX(time, stepTiming->lastStep + 1);
+	uint64_t interval = MIN(time - stepTiming->lastStep, (uint64_t)INT32_MAX);
+
+	stepTiming->intervals[head & (TMC_STEP_TIMING_QUEUE_LENGTH - 1)] = direction * (int32_t)interval;
+	stepTiming->lastStep = time;
+
+	// Publish the entry after it has been written
+	TMC_STEP_TIMING_MEMORY_BARRIER();
+	stepTiming->head = head + 1;
+}
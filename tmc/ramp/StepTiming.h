@@ -0,0 +1,112 @@
+/*******************************************************************************
+* Copyright © 2024 Analog Devices, Inc.
+*******************************************************************************/
+
+
+#ifndef TMC_RAMP_STEPTIMING_H_
+#define TMC_RAMP_STEPTIMING_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+/*
+ *  Step pulse timing for STEP/DIR drivers (e.g. TMC2209, TMC2130, TMC2160, TMC262).
+ *
+ *  tmc_step_timing_fill() computes ticks of a linear ramp (TMC_LinearRamp) and
+ *  converts the step times within each ramp tick into the intervals between two
+ *  steps, measured in ticks of a hardware timer. The intervals are stored in a
+ *  lock-free single producer/single consumer ring buffer.
+ *
+ *  The main loop (producer) keeps the queue filled with tmc_step_timing_fill(),
+ *  the timer interrupt (consumer) pops one interval per step with
+ *  tmc_step_timing_pop(), sets the DIR pin from its sign, reloads the timer with
+ *  its magnitude and issues the step pulse once the timer expires.
+ *
+ *  The first step after standing still is measured from the start of the first
+ *  ramp tick with a velocity. Intervals are at least one timer tick and are
+ *  saturated to INT32_MAX timer ticks.
+ *
+ *  For velocities above one step per ramp tick, enable the multi step mode of the
+ *  ramp (tmc_ramp_linear_set_multiStep). A ramp tick is only computed once all of
+ *  its steps fit into the queue. A ramp tick with more steps than the queue length
+ *  (maximum velocity / precision) is queued in parts: The steps that don't fit are
+ *  kept and queued first by the next calls of tmc_step_timing_fill(), see
+ *  tmc_step_timing_getPendingSteps().
+ */
+
+// Length of the ring buffer, has to be a power of two
+#ifndef TMC_STEP_TIMING_QUEUE_LENGTH
+#define TMC_STEP_TIMING_QUEUE_LENGTH 256
+#endif
+
+// Orders the buffer accesses before the index update. The default works for
+// GCC-compatible compilers, on single core MCUs a compiler barrier is sufficient.
+#ifndef TMC_STEP_TIMING_MEMORY_BARRIER
+#define TMC_STEP_TIMING_MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+typedef struct
+{
+	int32_t intervals[TMC_STEP_TIMING_QUEUE_LENGTH];  // Timer ticks since the previous step, negative for backward steps
+	volatile uint32_t head;  // Next entry to write, only modified by the producer
+	volatile uint32_t tail;  // Next entry to read, only modified by the consumer
+	uint32_t timerTicksPerRampTick;
+	uint64_t tickStart;      // Timer time of the start of the next ramp tick
+	uint64_t lastStep;       // Timer time of the last queued step
+
+	// Ramp tick whose steps did not all fit into the queue
+	uint64_t pendingTickStart;
+	int32_t pendingAccumulator;  // Position accumulator at the start of the tick
+	int32_t pendingVelocity;
+	uint32_t pendingPrecision;
+	uint32_t pendingStep;        // Next step of the tick to queue, pendingSteps + 1 once all are queued
+	uint32_t pendingSteps;       // Steps of the tick
+} TMC_StepTiming;
+
+// [timerTicksPerRampTick]: Timer frequency / ramp tick frequency
+void tmc_step_timing_init(TMC_StepTiming *stepTiming, uint32_t timerTicksPerRampTick);
+
+// Queues the pending steps of a partly queued ramp tick, then computes up to [maxRampTicks]
+// ticks of [linearRamp] and queues their steps. A ramp tick is only applied to [linearRamp]
+// while the queue has space for all of its steps, or if it has more steps than the queue length.
+// Returns the amount of ramp ticks computed.
+uint32_t tmc_step_timing_fill(TMC_StepTiming *stepTiming, TMC_LinearRamp *linearRamp, uint32_t maxRampTicks);
+
+// Removes all queued intervals and pending steps. Must not run concurrently with tmc_step_timing_pop().
+void tmc_step_timing_clear(TMC_StepTiming *stepTiming);
+
+// Steps of an already computed ramp tick that are not queued yet. The motor position
+// lags behind the ramp position by this amount of steps plus the queued steps.
+static inline uint32_t tmc_step_timing_getPendingSteps(TMC_StepTiming *stepTiming)
+{
+	return stepTiming->pendingSteps + 1 - stepTiming->pendingStep;
+}
+
+static inline uint32_t tmc_step_timing_getCount(TMC_StepTiming *stepTiming)
+{
+	return stepTiming->head - stepTiming->tail;
+}
+
+static inline uint32_t tmc_step_timing_getFree(TMC_StepTiming *stepTiming)
+{
+	return TMC_STEP_TIMING_QUEUE_LENGTH - tmc_step_timing_getCount(stepTiming);
+}
+
+// Consumer side, O(1) for use in the timer interrupt.
+// Returns false if the queue is empty.
+static inline bool tmc_step_timing_pop(TMC_StepTiming *stepTiming, int32_t *interval)
+{
+	uint32_t tail = stepTiming->tail;
+
+	if(stepTiming->head == tail)
+		return false;
+
+	TMC_STEP_TIMING_MEMORY_BARRIER();
+	*interval = stepTiming->intervals[tail & (TMC_STEP_TIMING_QUEUE_LENGTH - 1)];
+	TMC_STEP_TIMING_MEMORY_BARRIER();
+	stepTiming->tail = tail + 1;
+
+	return true;
+}
+
+#endif /* TMC_RAMP_STEPTIMING_H_ */